@@ -139,6 +139,11 @@ void arch_sched_ipi(void)
 	}
 }
 
+void arch_sched_ipi_cpu(int cpu_id)
+{
+	z_arc_connect_ici_generate(cpu_id);
+}
+
 static int arc_smp_init(struct device *dev)
 {
 	ARG_UNUSED(dev);
@@ -71,6 +71,7 @@ extern void arch_switch(void *switch_to, void **switched_from);
 extern void z_arc_fatal_error(unsigned int reason, const z_arch_esf_t *esf);
 
 extern void arch_sched_ipi(void);
+extern void arch_sched_ipi_cpu(int cpu_id);
 
 #ifdef __cplusplus
 }
@@ -123,4 +123,10 @@ void arch_sched_ipi(void)
 {
 	z_loapic_ipi(0, LOAPIC_ICR_IPI_OTHERS, CONFIG_SCHED_IPI_VECTOR);
 }
+
+void arch_sched_ipi_cpu(int cpu_id)
+{
+	z_loapic_ipi(x86_cpu_loapics[cpu_id], LOAPIC_ICR_IPI_SPECIFIC,
+		     CONFIG_SCHED_IPI_VECTOR);
+}
 #endif
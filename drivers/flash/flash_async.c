@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <kernel.h>
+#include <init.h>
+#include <spinlock.h>
+#include <drivers/flash.h>
+
+#include "flash_priv.h"
+
+/* All devices share one thread, each queue is a work item in it */
+static K_THREAD_STACK_DEFINE(flash_workq_stack,
+			     CONFIG_FLASH_ASYNC_STACK_SIZE);
+static struct k_work_q flash_workq;
+
+static int flash_op_exec_default(struct device *dev, struct flash_op *op)
+{
+	switch (op->type) {
+	case FLASH_OP_READ:
+		return flash_read(dev, op->offset, op->data, op->len);
+	case FLASH_OP_WRITE:
+		return flash_write(dev, op->offset, op->data, op->len);
+	case FLASH_OP_ERASE:
+		return flash_erase(dev, op->offset, op->len);
+	default:
+		return -EINVAL;
+	}
+}
+
+static void flash_op_complete(struct device *dev, struct flash_op *op,
+			      int result)
+{
+	/* The callback may reuse the operation */
+	struct k_poll_signal *signal = op->signal;
+
+	op->result = result;
+
+	if (op->callback) {
+		op->callback(dev, op);
+	}
+
+	if (signal) {
+		k_poll_signal_raise(signal, result);
+	}
+}
+
+static void flash_op_queue_work(struct k_work *work)
+{
+	struct flash_op_queue *queue =
+		CONTAINER_OF(work, struct flash_op_queue, work);
+	k_spinlock_key_t key;
+	sys_snode_t *node;
+	struct flash_op *op;
+
+	/* Operations submitted after the queue was found empty submit the
+	 * work item again.
+	 */
+	while (true) {
+		key = k_spin_lock(&queue->lock);
+		node = sys_slist_get(&queue->ops);
+		k_spin_unlock(&queue->lock, key);
+
+		if (!node) {
+			break;
+		}
+
+		op = CONTAINER_OF(node, struct flash_op, node);
+		flash_op_complete(queue->dev, op,
+				  queue->exec(queue->dev, op));
+	}
+}
+
+void flash_op_queue_init(struct flash_op_queue *queue, struct device *dev,
+			 flash_op_exec_t exec)
+{
+	sys_slist_init(&queue->ops);
+	k_work_init(&queue->work, flash_op_queue_work);
+	queue->dev = dev;
+	queue->exec = exec ? exec : flash_op_exec_default;
+}
+
+int flash_op_queue_submit(struct flash_op_queue *queue, struct flash_op *op)
+{
+	k_spinlock_key_t key;
+
+	if (op->type != FLASH_OP_READ && op->type != FLASH_OP_WRITE &&
+	    op->type != FLASH_OP_ERASE) {
+		return -EINVAL;
+	}
+
+	op->result = -EINPROGRESS;
+
+	key = k_spin_lock(&queue->lock);
+	sys_slist_append(&queue->ops, &op->node);
+	k_spin_unlock(&queue->lock, key);
+
+	k_work_submit_to_queue(&flash_workq, &queue->work);
+
+	return 0;
+}
+
+bool flash_op_queue_is_current(void)
+{
+	return k_current_get() == &flash_workq.thread;
+}
+
+static int flash_async_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_q_start(&flash_workq, flash_workq_stack,
+		       K_THREAD_STACK_SIZEOF(flash_workq_stack),
+		       CONFIG_FLASH_ASYNC_THREAD_PRIO);
+	k_thread_name_set(&flash_workq.thread, "flash_async");
+
+	return 0;
+}
+
+SYS_INIT(flash_async_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -14,4 +14,35 @@ static inline void flash_page_layout_not_implemented(void)
 }
 #endif
 
+#if defined(CONFIG_FLASH_ASYNC)
+/* Does one queued operation, blocking until it is done */
+typedef int (*flash_op_exec_t)(struct device *dev, struct flash_op *op);
+
+/* Queue of the operations submitted to a device, done in order by the
+ * flash work queue thread.
+ */
+struct flash_op_queue {
+	sys_slist_t ops;
+	struct k_spinlock lock;
+	struct k_work work;
+	struct device *dev;
+	flash_op_exec_t exec;
+};
+
+/* Set up the queue of a device, exec does the operations. If it is NULL
+ * the read, write and erase calls of the driver are used.
+ */
+void flash_op_queue_init(struct flash_op_queue *queue, struct device *dev,
+			 flash_op_exec_t exec);
+
+/* Queue an operation, to be used by the submit call of the driver */
+int flash_op_queue_submit(struct flash_op_queue *queue, struct flash_op *op);
+
+/* True when called while doing a queued operation. Drivers can then
+ * sleep instead of busy waiting for the flash, as nobody is blocked on
+ * the call.
+ */
+bool flash_op_queue_is_current(void);
+#endif /* CONFIG_FLASH_ASYNC */
+
 #endif
@@ -13,6 +13,8 @@
 #include <stats/stats.h>
 #include <string.h>
 
+#include "flash_priv.h"
+
 #ifdef CONFIG_ARCH_POSIX
 
 #include <unistd.h>
@@ -136,6 +138,10 @@ static u8_t mock_flash[FLASH_SIMULATOR_FLASH_SIZE];
 
 static bool write_protection;
 
+#ifdef CONFIG_FLASH_ASYNC
+static struct flash_op_queue flash_sim_queue;
+#endif
+
 static const struct flash_driver_api flash_sim_api;
 
 static int flash_range_is_valid(struct device *dev, off_t offset, size_t len)
@@ -163,6 +169,23 @@ static bool flash_wp_is_set(void)
 	return write_protection;
 }
 
+#ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
+static void flash_sim_delay(s32_t us)
+{
+#ifdef CONFIG_FLASH_ASYNC
+	/* queued operations let the submitter run meanwhile, unless the
+	 * delay is shorter than the one tick k_usleep() would round it to
+	 */
+	if (flash_op_queue_is_current() &&
+	    us >= USEC_PER_SEC / CONFIG_SYS_CLOCK_TICKS_PER_SEC) {
+		k_usleep(us);
+		return;
+	}
+#endif
+	k_busy_wait(us);
+}
+#endif
+
 static int flash_sim_read(struct device *dev, const off_t offset, void *data,
 			  const size_t len)
 {
@@ -185,7 +208,7 @@ static int flash_sim_read(struct device *dev, const off_t offset, void *data,
 	STATS_INCN(flash_sim_stats, bytes_read, len);
 
 #ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
-	k_busy_wait(CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US);
+	flash_sim_delay(CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US);
 	STATS_INCN(flash_sim_stats, flash_read_time_us,
 		   CONFIG_FLASH_SIMULATOR_MIN_READ_TIME_US);
 #endif
@@ -258,7 +281,7 @@ static int flash_sim_write(struct device *dev, const off_t offset,
 
 #ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
 	/* wait before returning */
-	k_busy_wait(CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US);
+	flash_sim_delay(CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US);
 	STATS_INCN(flash_sim_stats, flash_write_time_us,
 		   CONFIG_FLASH_SIMULATOR_MIN_WRITE_TIME_US);
 #endif
@@ -319,7 +342,7 @@ static int flash_sim_erase(struct device *dev, const off_t offset,
 
 #ifdef CONFIG_FLASH_SIMULATOR_SIMULATE_TIMING
 	/* wait before returning */
-	k_busy_wait(CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US);
+	flash_sim_delay(CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US);
 	STATS_INCN(flash_sim_stats, flash_erase_time_us,
 		   CONFIG_FLASH_SIMULATOR_MIN_ERASE_TIME_US);
 #endif
@@ -342,6 +365,13 @@ static void flash_sim_page_layout(struct device *dev,
 }
 #endif
 
+#ifdef CONFIG_FLASH_ASYNC
+static int flash_sim_submit(struct device *dev, struct flash_op *op)
+{
+	return flash_op_queue_submit(&flash_sim_queue, op);
+}
+#endif
+
 static const struct flash_driver_api flash_sim_api = {
 	.read = flash_sim_read,
 	.write = flash_sim_write,
@@ -351,6 +381,9 @@ static const struct flash_driver_api flash_sim_api = {
 #ifdef CONFIG_FLASH_PAGE_LAYOUT
 	.page_layout = flash_sim_page_layout,
 #endif
+#ifdef CONFIG_FLASH_ASYNC
+	.submit = flash_sim_submit,
+#endif
 };
 
 #ifdef CONFIG_ARCH_POSIX
@@ -403,6 +436,9 @@ static int flash_init(struct device *dev)
 	STATS_INIT_AND_REG(flash_sim_stats, STATS_SIZE_32, "flash_sim_stats");
 	STATS_INIT_AND_REG(flash_sim_thresholds, STATS_SIZE_32,
 			   "flash_sim_thresholds");
+#ifdef CONFIG_FLASH_ASYNC
+	flash_op_queue_init(&flash_sim_queue, dev, NULL);
+#endif
 	return flash_mock_init(dev);
 }
 
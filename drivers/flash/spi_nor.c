@@ -62,6 +62,7 @@ LOG_MODULE_REGISTER(spi_nor, CONFIG_FLASH_LOG_LEVEL);
  * @spi_cfg: The SPI configuration
  * @cs_ctrl: The GPIO pin used to emulate the SPI CS if required
  * @sem: The semaphore to access to the flash
+ * @queue: The operations queued with flash_submit()
  */
 struct spi_nor_data {
 	struct device *spi;
@@ -76,6 +77,9 @@ struct spi_nor_data {
 	u32_t ts_enter_dpd;
 #endif
 	struct k_sem sem;
+#ifdef CONFIG_FLASH_ASYNC
+	struct flash_op_queue queue;
+#endif /* CONFIG_FLASH_ASYNC */
 };
 
 /* Capture the time at which the device entered deep power-down. */
@@ -309,6 +313,37 @@ static int spi_nor_wait_until_ready(struct device *dev)
 	return ret;
 }
 
+/**
+ * @brief Wait until an erase is done
+ *
+ * Erases take from tens of milliseconds to seconds. When the erase was
+ * queued with flash_submit() the status is polled once per millisecond,
+ * so other threads, including the submitter, can run meanwhile.
+ *
+ * @param dev The device structure
+ * @return 0 on success, negative errno code otherwise
+ */
+static int spi_nor_wait_until_erased(struct device *dev)
+{
+#ifdef CONFIG_FLASH_ASYNC
+	int ret;
+	u8_t reg;
+
+	if (flash_op_queue_is_current()) {
+		while (true) {
+			ret = spi_nor_cmd_read(dev, SPI_NOR_CMD_RDSR, &reg, 1);
+			if (ret || !(reg & SPI_NOR_WIP_BIT)) {
+				return ret;
+			}
+
+			k_sleep(K_MSEC(1));
+		}
+	}
+#endif /* CONFIG_FLASH_ASYNC */
+
+	return spi_nor_wait_until_ready(dev);
+}
+
 static int spi_nor_read(struct device *dev, off_t addr, void *dest,
 			size_t size)
 {
@@ -425,7 +460,7 @@ static int spi_nor_erase(struct device *dev, off_t addr, size_t size)
 			goto out;
 		}
 
-		spi_nor_wait_until_ready(dev);
+		spi_nor_wait_until_erased(dev);
 	}
 
 out:
@@ -456,6 +491,15 @@ static int spi_nor_write_protection_set(struct device *dev, bool write_protect)
 	return ret;
 }
 
+#ifdef CONFIG_FLASH_ASYNC
+static int spi_nor_submit(struct device *dev, struct flash_op *op)
+{
+	struct spi_nor_data *const driver_data = dev->driver_data;
+
+	return flash_op_queue_submit(&driver_data->queue, op);
+}
+#endif /* CONFIG_FLASH_ASYNC */
+
 /**
  * @brief Configure the flash
  *
@@ -514,12 +558,16 @@ static int spi_nor_configure(struct device *dev)
  */
 static int spi_nor_init(struct device *dev)
 {
-	if (IS_ENABLED(CONFIG_MULTITHREADING)) {
-		struct spi_nor_data *const driver_data = dev->driver_data;
+	struct spi_nor_data *const driver_data = dev->driver_data;
 
+	if (IS_ENABLED(CONFIG_MULTITHREADING)) {
 		k_sem_init(&driver_data->sem, 1, UINT_MAX);
 	}
 
+#ifdef CONFIG_FLASH_ASYNC
+	flash_op_queue_init(&driver_data->queue, dev, NULL);
+#endif /* CONFIG_FLASH_ASYNC */
+
 	return spi_nor_configure(dev);
 }
 
@@ -562,6 +610,9 @@ static const struct flash_driver_api spi_nor_api = {
 	.page_layout = spi_nor_pages_layout,
 #endif
 	.write_block_size = 1,
+#ifdef CONFIG_FLASH_ASYNC
+	.submit = spi_nor_submit,
+#endif /* CONFIG_FLASH_ASYNC */
 };
 
 static const struct spi_nor_config flash_id = {
@@ -24,6 +24,11 @@
 #include <stddef.h>
 #include <sys/types.h>
 #include <device.h>
+#if defined(CONFIG_FLASH_ASYNC)
+#include <errno.h>
+#include <kernel.h>
+#include <sys/slist.h>
+#endif /* CONFIG_FLASH_ASYNC */
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +75,52 @@ typedef void (*flash_api_pages_layout)(struct device *dev,
 				       size_t *layout_size);
 #endif /* CONFIG_FLASH_PAGE_LAYOUT */
 
+#if defined(CONFIG_FLASH_ASYNC)
+/** Operations that can be queued with flash_submit() */
+enum flash_op_type {
+	FLASH_OP_READ,
+	FLASH_OP_WRITE,
+	FLASH_OP_ERASE,
+};
+
+struct flash_op;
+
+/**
+ * @brief Completion callback of a queued operation
+ *
+ * Called from the flash work queue thread once the operation is done,
+ * with its result in @p op->result. The operation can be reused, or
+ * submitted again, from the callback.
+ */
+typedef void (*flash_op_callback_t)(struct device *dev, struct flash_op *op);
+
+/** Queued flash operation */
+struct flash_op {
+	/** Used by the driver while the operation is queued */
+	sys_snode_t node;
+	/** FLASH_OP_READ, FLASH_OP_WRITE or FLASH_OP_ERASE */
+	enum flash_op_type type;
+	/** Offset of the operation, as for the blocking calls */
+	off_t offset;
+	/** Buffer read into or written from, unused for erase. It must
+	 * stay valid until the operation is complete.
+	 */
+	void *data;
+	/** Number of bytes to read, write or erase */
+	size_t len;
+	/** Called on completion, can be NULL */
+	flash_op_callback_t callback;
+	/** Raised with the result on completion, can be NULL */
+	struct k_poll_signal *signal;
+	/** 0 on success, negative errno code on fail */
+	int result;
+	/** Free for the submitter to use */
+	void *user_data;
+};
+
+typedef int (*flash_api_submit)(struct device *dev, struct flash_op *op);
+#endif /* CONFIG_FLASH_ASYNC */
+
 struct flash_driver_api {
 	flash_api_read read;
 	flash_api_write write;
@@ -79,6 +130,9 @@ struct flash_driver_api {
 	flash_api_pages_layout page_layout;
 #endif /* CONFIG_FLASH_PAGE_LAYOUT */
 	const size_t write_block_size;
+#if defined(CONFIG_FLASH_ASYNC)
+	flash_api_submit submit;
+#endif /* CONFIG_FLASH_ASYNC */
 };
 
 /**
@@ -291,6 +345,42 @@ static inline size_t z_impl_flash_get_write_block_size(struct device *dev)
 	return api->write_block_size;
 }
 
+#if defined(CONFIG_FLASH_ASYNC)
+/**
+ *  @brief  Queue a read, write or erase operation
+ *
+ *  The operation is added to the queue of the device and the call
+ *  returns without waiting for it. The operations of a device are done
+ *  one at a time, in the order they were submitted, by the flash work
+ *  queue thread. When one is done its result is stored in @p op->result,
+ *  then @p op->callback is called and @p op->signal is raised, so the
+ *  caller can overlap for instance the erase of the next sector with
+ *  preparing the data to write to it.
+ *
+ *  The operation and its buffer must stay valid until it is complete.
+ *  Queued operations are not ordered against the blocking calls, and
+ *  write protection is not changed by the queue.
+ *
+ *  @param  dev             : flash device
+ *  @param  op              : Operation to queue
+ *
+ *  @return  0 if the operation was queued, -ENOTSUP if the driver does
+ *           not queue operations, -EINVAL if the operation type is
+ *           invalid.
+ */
+static inline int flash_submit(struct device *dev, struct flash_op *op)
+{
+	const struct flash_driver_api *api =
+		(const struct flash_driver_api *)dev->driver_api;
+
+	if (api->submit == NULL) {
+		return -ENOTSUP;
+	}
+
+	return api->submit(dev, op);
+}
+#endif /* CONFIG_FLASH_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,6 +43,8 @@ extern "C" {
  * @param write_block_size Alignment size
  * @param nvs_lock Mutex
  * @param flash_device Flash Device
+ * @param lookup_cache Address of the most recent allocation table entry
+ * of the ids hashing to each entry, when CONFIG_NVS_LOOKUP_CACHE is enabled
  */
 struct nvs_fs {
 	off_t offset;		/* filesystem offset in flash */
@@ -57,6 +59,9 @@ struct nvs_fs {
 
 	struct k_mutex nvs_lock;
 	struct device *flash_device;
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	u32_t lookup_cache[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+#endif
 };
 
 /**
@@ -86,6 +86,15 @@ extern bool z_priq_rb_lessthan(struct rbnode *a, struct rbnode *b);
 
 #define Z_WAIT_Q_INIT(wait_q) { { { .lessthan_fn = z_priq_rb_lessthan } } }
 
+#elif defined(CONFIG_WAITQ_MULTIQ)
+
+typedef struct {
+	struct _priq_mq waitq;
+} _wait_q_t;
+
+/* The per-priority lists are initialized as they get populated */
+#define Z_WAIT_Q_INIT(wait_q) { { .bitmask = 0 } }
+
 #else
 
 typedef struct {
@@ -483,6 +492,13 @@ struct _thread_base {
 	/* CPU index on which thread was last run */
 	u8_t cpu;
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* 1 + index of the CPU whose run queue holds this thread,
+	 * 0 while it is not queued
+	 */
+	u8_t runq_cpu;
+#endif
+
 	/* Recursive count of irq_lock() calls */
 	u8_t global_lock_count;
 
@@ -3502,6 +3518,8 @@ static inline unsigned int z_impl_k_sem_count_get(struct k_sem *sem)
 struct k_msgq {
 	/** Message queue wait queue */
 	_wait_q_t wait_q;
+	/** Threads waiting on a zero-copy claim */
+	_wait_q_t claim_wait_q;
 	/** Lock */
 	struct k_spinlock lock;
 	/** Message size */
@@ -3533,6 +3551,7 @@ struct k_msgq {
 #define _K_MSGQ_INITIALIZER(obj, q_buffer, q_msg_size, q_max_msgs) \
 	{ \
 	.wait_q = Z_WAIT_Q_INIT(&obj.wait_q), \
+	.claim_wait_q = Z_WAIT_Q_INIT(&obj.claim_wait_q), \
 	.msg_size = q_msg_size, \
 	.max_msgs = q_max_msgs, \
 	.buffer_start = q_buffer, \
@@ -3549,6 +3568,8 @@ struct k_msgq {
 
 
 #define K_MSGQ_FLAG_ALLOC	BIT(0)
+#define K_MSGQ_FLAG_PUT_CLAIM	BIT(1)
+#define K_MSGQ_FLAG_GET_CLAIM	BIT(2)
 
 /**
  * @brief Message Queue Attributes
@@ -3702,6 +3723,132 @@ __syscall int k_msgq_get(struct k_msgq *q, void *data, s32_t timeout);
  */
 __syscall int k_msgq_peek(struct k_msgq *q, void *data);
 
+/**
+ * @brief Send several messages to a message queue.
+ *
+ * This routine sends up to @a num_msgs messages, stored back to back at
+ * @a data, to message queue @a q.  The messages are handed to waiting
+ * receivers or copied into the ring buffer under a single hold of the
+ * queue lock, and the scheduler is invoked at most once.  It never
+ * waits: messages that do not fit are not sent.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ * @param data Pointer to the messages.
+ * @param num_msgs Number of messages at @a data.
+ *
+ * @return Number of messages sent.  None are sent while a zero-copy send
+ *         (k_msgq_put_claim()) is in progress.
+ */
+__syscall int k_msgq_put_batch(struct k_msgq *q, const void *data,
+			       u32_t num_msgs);
+
+/**
+ * @brief Receive several messages from a message queue.
+ *
+ * This routine receives up to @a max_msgs messages from message queue
+ * @a q, in "first in, first out" order, and stores them back to back
+ * at @a data.  The messages are copied out and the freed space is
+ * refilled from waiting senders under a single hold of the queue lock,
+ * and the scheduler is invoked at most once.  It never waits.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ * @param data Address of area to hold up to @a max_msgs messages.
+ * @param max_msgs Maximum number of messages to receive.
+ *
+ * @return Number of messages received.  None are received while a
+ *         zero-copy receive (k_msgq_get_claim()) is in progress.
+ */
+__syscall int k_msgq_get_batch(struct k_msgq *q, void *data, u32_t max_msgs);
+
+/**
+ * @brief Claim the next free slot of a message queue for writing.
+ *
+ * This routine returns the address of the ring buffer entry the next
+ * message will be stored in, so that the caller can build the message
+ * in place rather than copying it in with k_msgq_put().  The message
+ * is sent by k_msgq_put_commit().
+ *
+ * Only one send claim can be outstanding per queue; until it is
+ * committed, other sends to @a q wait for it as they would for a free
+ * entry.  The claimed entry is still reported as free by
+ * k_msgq_num_free_get().
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Set to the address of the claimed entry.
+ * @param timeout Non-negative waiting period to claim an entry (in
+ *                milliseconds), or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @retval 0 Entry claimed.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+int k_msgq_put_claim(struct k_msgq *q, void **data, s32_t timeout);
+
+/**
+ * @brief Send the message built in a claimed entry.
+ *
+ * This routine sends the message written in place after
+ * k_msgq_put_claim().  If a receiver is waiting it gets the message
+ * copied into its buffer, otherwise the entry is added to the queue.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ *
+ * @retval 0 Message sent.
+ * @retval -EINVAL No send claim is outstanding.
+ */
+int k_msgq_put_commit(struct k_msgq *q);
+
+/**
+ * @brief Claim the oldest message of a message queue for reading.
+ *
+ * This routine returns the address of the ring buffer entry holding
+ * the oldest message, so that the caller can read it in place rather
+ * than copying it out with k_msgq_get().  The message stays in the
+ * queue until k_msgq_get_commit() is called.
+ *
+ * Only one receive claim can be outstanding per queue; until it is
+ * committed, other receives from @a q wait for it as they would for a
+ * message.
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Set to the address of the claimed message.
+ * @param timeout Non-negative waiting period to claim a message (in
+ *                milliseconds), or one of the special values K_NO_WAIT and
+ *                K_FOREVER.
+ *
+ * @retval 0 Message claimed.
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+int k_msgq_get_claim(struct k_msgq *q, void **data, s32_t timeout);
+
+/**
+ * @brief Release a message claimed for reading.
+ *
+ * This routine removes the message claimed by k_msgq_get_claim() from
+ * the queue and lets a waiting sender, if any, use the freed entry.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Address of the message queue.
+ *
+ * @retval 0 Message removed.
+ * @retval -EINVAL No receive claim is outstanding, or the queue was
+ *         purged since the claim.
+ */
+int k_msgq_get_commit(struct k_msgq *q);
+
 /**
  * @brief Purge a message queue.
  *
@@ -4191,6 +4338,28 @@ extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
  * @cond INTERNAL_HIDDEN
  */
 
+/**
+ * @brief Memory slab magazine statistics.
+ *
+ * Counts of allocations and frees served by the per-CPU magazines
+ * (hits) or which had to go to the shared free list (misses).
+ */
+struct k_mem_slab_magazine_stats {
+	u32_t alloc_hits;
+	u32_t alloc_misses;
+	u32_t free_hits;
+	u32_t free_misses;
+};
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+struct k_mem_slab_magazine {
+	struct k_spinlock lock;
+	u32_t count;
+	void *blocks[CONFIG_MEM_SLAB_MAGAZINE_SIZE];
+	struct k_mem_slab_magazine_stats stats;
+};
+#endif
+
 struct k_mem_slab {
 	_wait_q_t wait_q;
 	u32_t num_blocks;
@@ -4199,6 +4368,14 @@ struct k_mem_slab {
 	char *free_list;
 	u32_t num_used;
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	/* per-CPU caches of free blocks, counted in num_used */
+	struct k_mem_slab_magazine mag[CONFIG_MP_NUM_CPUS];
+
+	/* frees skip the magazines while threads may be waiting */
+	bool mag_bypass;
+#endif
+
 	_OBJECT_TRACING_NEXT_PTR(k_mem_slab)
 	_OBJECT_TRACING_LINKED_FLAG
 };
@@ -4325,7 +4502,17 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	u32_t cached = 0U;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		cached += slab->mag[i].count;
+	}
+
+	return slab->num_used - cached;
+#else
 	return slab->num_used;
+#endif
 }
 
 /**
@@ -4341,9 +4528,25 @@ static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - k_mem_slab_num_used_get(slab);
 }
 
+/**
+ * @brief Get the per-CPU magazine statistics of a memory slab.
+ *
+ * This routine sums the hit and miss counters of all the per-CPU
+ * magazines of @a slab.  A low hit rate means the magazines are too
+ * small for the allocation pattern, see CONFIG_MEM_SLAB_MAGAZINE_SIZE.
+ *
+ * @param slab Address of the memory slab.
+ * @param stats Where to store the statistics.
+ *
+ * @retval 0 Statistics stored in @a stats.
+ * @retval -ENOTSUP Magazines are not enabled (CONFIG_MEM_SLAB_MAGAZINE).
+ */
+extern int k_mem_slab_magazine_stats_get(struct k_mem_slab *slab,
+				struct k_mem_slab_magazine_stats *stats);
+
 /** @} */
 
 /**
@@ -4351,7 +4554,11 @@ static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
  */
 
 struct k_mem_pool {
+#ifdef CONFIG_MEM_POOL_TLSF
+	struct sys_tlsf base;
+#else
 	struct sys_mem_pool_base base;
+#endif
 	_wait_q_t wait_q;
 };
 
@@ -4384,6 +4591,18 @@ struct k_mem_pool {
  * @param align Alignment of the pool's buffer (power of 2).
  * @req K-MPOOL-001
  */
+#ifdef CONFIG_MEM_POOL_TLSF
+#define K_MEM_POOL_DEFINE(name, minsz, maxsz, nmax, align)		\
+	char __aligned(MAX(WB_UP(align), Z_TLSF_UNIT))			\
+		_mpool_buf_##name[Z_TLSF_BUF_SIZE(WB_UP(maxsz), nmax)];	\
+	Z_STRUCT_SECTION_ITERABLE(k_mem_pool, name) = { \
+		.base = {						\
+			.buf = _mpool_buf_##name,			\
+			.size = sizeof(_mpool_buf_##name)		\
+		} \
+	}; \
+	BUILD_ASSERT(WB_UP(maxsz) >= _MPOOL_MINBLK)
+#else
 #define K_MEM_POOL_DEFINE(name, minsz, maxsz, nmax, align)		\
 	char __aligned(WB_UP(align)) _mpool_buf_##name[WB_UP(maxsz) * nmax \
 				  + _MPOOL_BITS_SIZE(maxsz, minsz, nmax)]; \
@@ -4399,6 +4618,7 @@ struct k_mem_pool {
 		} \
 	}; \
 	BUILD_ASSERT(WB_UP(maxsz) >= _MPOOL_MINBLK)
+#endif
 
 /**
  * @brief Allocate memory from a memory pool.
@@ -4459,6 +4679,35 @@ extern void k_mem_pool_free(struct k_mem_block *block);
  */
 extern void k_mem_pool_free_id(struct k_mem_block_id *id);
 
+/**
+ * @brief Memory pool statistics.
+ *
+ * Byte counts include the allocator's per-block headers.
+ */
+struct k_mem_pool_stats {
+	/** Bytes in free blocks */
+	size_t free_bytes;
+	/** Bytes in allocated blocks */
+	size_t allocated_bytes;
+	/** Highest value @a allocated_bytes has reached */
+	size_t max_allocated_bytes;
+	/** Largest allocation that can currently succeed */
+	size_t largest_free_block;
+};
+
+/**
+ * @brief Get the usage statistics of a memory pool.
+ *
+ * @param pool Address of the memory pool.
+ * @param stats Where to store the statistics.
+ *
+ * @retval 0 Statistics stored in @a stats.
+ * @retval -ENOTSUP The pool allocator does not keep statistics
+ *         (only CONFIG_MEM_POOL_TLSF does).
+ */
+extern int k_mem_pool_stats_get(struct k_mem_pool *pool,
+				struct k_mem_pool_stats *stats);
+
 /**
  * @}
  */
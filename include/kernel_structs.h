@@ -83,12 +83,19 @@ struct _ready_q {
 	struct k_thread *cache;
 #endif
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* one run queue per CPU, indexed by _thread_base.runq_cpu */
+#define Z_RUNQ_DIM [CONFIG_MP_NUM_CPUS]
+#else
+#define Z_RUNQ_DIM
+#endif
+
 #if defined(CONFIG_SCHED_DUMB)
-	sys_dlist_t runq;
+	sys_dlist_t runq Z_RUNQ_DIM;
 #elif defined(CONFIG_SCHED_SCALABLE)
-	struct _priq_rb runq;
+	struct _priq_rb runq Z_RUNQ_DIM;
 #elif defined(CONFIG_SCHED_MULTIQ)
-	struct _priq_mq runq;
+	struct _priq_mq runq Z_RUNQ_DIM;
 #endif
 };
 
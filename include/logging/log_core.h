@@ -595,6 +595,33 @@ void log_generic_from_user(struct log_msg_ids src_level,
  */
 bool log_is_strdup(const void *buf);
 
+/**
+ * @brief Get mask of string format specifiers (%s).
+ *
+ * Result is stored as the mask (argument n is n'th bit). Bit is set if %s was
+ * found.
+ *
+ * @note Algorithm does not take into account complex format specifiers as they
+ *	 hardly used in log messages and including them would significantly
+ *	 extended this function which is called on every log message is feature
+ *	 is enabled.
+ *
+ * @param str String.
+ * @param nargs Number of arguments in the string.
+ *
+ * @return Mask with %s format specifiers found.
+ */
+u32_t z_log_get_s_mask(const char *str, u32_t nargs);
+
+/**
+ * @brief Check if address is in read only section.
+ *
+ * @param addr Address.
+ *
+ * @return True if address identified within read only section.
+ */
+bool z_log_is_rodata(const void *addr);
+
 /** @brief Free allocated buffer.
  *
  * @param buf Buffer.
@@ -7,6 +7,7 @@
 #define ZEPHYR_INCLUDE_LOGGING_LOG_MSG_H_
 
 #include <sys/atomic.h>
+#include <sys/util.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -133,7 +134,14 @@ struct log_msg_ext_head_data {
 	} data;
 };
 
-/** @brief Log message structure. */
+/** @brief Log message structure.
+ *
+ * With CONFIG_LOG_MSG_PACKED the payload is variable length: the
+ * arguments of a standard message followed by the strings it refers to
+ * that were duplicated with log_strdup(), or the data of a hexdump
+ * message followed by its metadata string if duplicated. The message
+ * is never extended with chunks.
+ */
 struct log_msg {
 	struct log_msg *next;   /*!< Used by logger core list.*/
 	struct log_msg_hdr hdr; /*!< Message header. */
@@ -162,6 +170,15 @@ union log_msg_chunk {
 /** @brief Function for initialization of the log message pool. */
 void log_msg_pool_init(void);
 
+/** @brief Check if buffer is located in the log message pool.
+ *
+ * @param buf Buffer.
+ *
+ * @return True if @p buf points into the log message pool, e.g. to a
+ *	   string inlined in a message with CONFIG_LOG_MSG_PACKED.
+ */
+bool log_msg_pool_contains(const void *buf);
+
 /** @brief Function for indicating that message is in use.
  *
  *  @details Message can be used (read) by multiple users. Internal reference
@@ -313,6 +330,24 @@ union log_msg_chunk *log_msg_no_space_handle(void);
  */
 union log_msg_chunk *log_msg_chunk_alloc(void);
 
+/** @brief Create standard log message with variable number of arguments.
+ *
+ *  @details Function resets header and sets following fields:
+ *		- message type
+ *		- string pointer
+ *		- number of arguments
+ *		- arguments
+ *
+ *  @param str   String.
+ *  @param args  Array with arguments.
+ *  @param nargs Number of arguments.
+ *
+ *  @return Pointer to allocated head of the message or NULL.
+ */
+struct log_msg *log_msg_create_n(const char *str,
+				 log_arg_t *args,
+				 u32_t nargs);
+
 /** @brief Allocate chunk for standard log message.
  *
  *  @return Allocated chunk of NULL.
@@ -341,6 +376,10 @@ static inline struct log_msg *z_log_msg_std_alloc(void)
  */
 static inline struct log_msg *log_msg_create_0(const char *str)
 {
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKED)) {
+		return log_msg_create_n(str, NULL, 0);
+	}
+
 	struct log_msg *msg = z_log_msg_std_alloc();
 
 	if (msg != NULL) {
@@ -366,6 +405,12 @@ static inline struct log_msg *log_msg_create_0(const char *str)
 static inline struct log_msg *log_msg_create_1(const char *str,
 					       log_arg_t arg1)
 {
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKED)) {
+		log_arg_t args[] = { arg1 };
+
+		return log_msg_create_n(str, args, 1);
+	}
+
 	struct  log_msg *msg = z_log_msg_std_alloc();
 
 	if (msg != NULL) {
@@ -395,6 +440,12 @@ static inline struct log_msg *log_msg_create_2(const char *str,
 					       log_arg_t arg1,
 					       log_arg_t arg2)
 {
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKED)) {
+		log_arg_t args[] = { arg1, arg2 };
+
+		return log_msg_create_n(str, args, 2);
+	}
+
 	struct  log_msg *msg = z_log_msg_std_alloc();
 
 	if (msg != NULL) {
@@ -427,6 +478,12 @@ static inline struct log_msg *log_msg_create_3(const char *str,
 					       log_arg_t arg2,
 					       log_arg_t arg3)
 {
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKED)) {
+		log_arg_t args[] = { arg1, arg2, arg3 };
+
+		return log_msg_create_n(str, args, 3);
+	}
+
 	struct  log_msg *msg = z_log_msg_std_alloc();
 
 	if (msg != NULL) {
@@ -440,24 +497,6 @@ static inline struct log_msg *log_msg_create_3(const char *str,
 	return msg;
 }
 
-/** @brief Create standard log message with variable number of arguments.
- *
- *  @details Function resets header and sets following fields:
- *		- message type
- *		- string pointer
- *		- number of arguments
- *		- arguments
- *
- *  @param str   String.
- *  @param args  Array with arguments.
- *  @param nargs Number of arguments.
- *
- *  @return Pointer to allocated head of the message or NULL.
- */
-struct log_msg *log_msg_create_n(const char *str,
-				 log_arg_t *args,
-				 u32_t nargs);
-
 /**
  * @}
  */
@@ -49,6 +49,11 @@ extern "C" {
  */
 #define LOG_OUTPUT_FLAG_FORMAT_SYST		BIT(7)
 
+/** @brief Flag forcing dictionary based binary format, see
+ *	   @ref log_output_dict
+ */
+#define LOG_OUTPUT_FLAG_FORMAT_DICT		BIT(8)
+
 /**
  * @brief Prototype of the function processing output data.
  *
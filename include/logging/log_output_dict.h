@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_
+
+#include <logging/log_msg.h>
+#include <logging/log_output.h>
+#include <stdarg.h>
+#include <toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dictionary based log output
+ * @defgroup log_output_dict Dictionary based log output
+ * @ingroup logger
+ * @{
+ */
+
+/** @brief First byte of every record, used to resynchronize a stream. */
+#define LOG_DICT_MAGIC 0xA5
+
+/** @brief Record with format string address and arguments. */
+#define LOG_DICT_TYPE_STD 0
+
+/** @brief Record with hexdump data. */
+#define LOG_DICT_TYPE_HEXDUMP 1
+
+/** @brief Record with number of dropped messages. */
+#define LOG_DICT_TYPE_DROPPED 2
+
+/** @brief Pack record type, level and domain into one byte. */
+#define LOG_DICT_IDS(type, level, domain_id) \
+	((type) | ((level) << 2) | ((domain_id) << 5))
+
+/** @brief Header of a dictionary log record.
+ *
+ * All values are in target byte order and followed by:
+ *
+ * - standard record: format string address, u8_t number of arguments,
+ *   the log_arg_t arguments, u8_t number of inline strings, then for
+ *   each string its u8_t argument index and its nul terminated content.
+ * - hexdump record: u8_t set if metadata follows as a nul terminated
+ *   string, otherwise metadata address, then u16_t length and the data.
+ * - dropped record: u32_t number of dropped messages.
+ */
+struct log_dict_hdr {
+	u8_t magic;
+	u8_t ids;
+	u16_t source_id;
+	u32_t timestamp;
+} __packed;
+
+/** @brief Process log message in dictionary format.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param msg        Log message.
+ * @param flags      Optional flags.
+ */
+void log_output_msg_dict_process(const struct log_output *log_output,
+				 struct log_msg *msg, u32_t flags);
+
+/** @brief Process log string in dictionary format.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param src_level  Log source and level structure.
+ * @param timestamp  Timestamp.
+ * @param fmt        String.
+ * @param ap         String arguments.
+ * @param flags      Optional flags.
+ */
+void log_output_string_dict_process(const struct log_output *log_output,
+				    struct log_msg_ids src_level,
+				    u32_t timestamp, const char *fmt,
+				    va_list ap, u32_t flags);
+
+/** @brief Process log hexdump in dictionary format.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param src_level  Log source and level structure.
+ * @param timestamp  Timestamp.
+ * @param metadata   String.
+ * @param data       Data.
+ * @param length     Data length.
+ * @param flags      Optional flags.
+ */
+void log_output_hexdump_dict_process(const struct log_output *log_output,
+				     struct log_msg_ids src_level,
+				     u32_t timestamp, const char *metadata,
+				     const u8_t *data, u32_t length,
+				     u32_t flags);
+
+/** @brief Process dropped messages indication in dictionary format.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param cnt        Number of dropped messages.
+ */
+void log_output_dropped_dict_process(const struct log_output *log_output,
+				     u32_t cnt);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_ */
@@ -126,6 +126,9 @@ enum ethernet_hw_caps {
 
 	/** VLAN Tag stripping */
 	ETHERNET_HW_VLAN_TAG_STRIP	= BIT(14),
+
+	/** TCP segmentation offload (TSO) supported for IPv4 */
+	ETHERNET_HW_TSO			= BIT(15),
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -324,6 +327,26 @@ struct ethernet_lldp {
 #endif /* CONFIG_NET_LLDP */
 
 /** Ethernet L2 context that is needed for VLAN */
+#if defined(CONFIG_NET_ETHERNET_GRO)
+/** TCP flow that received segments are being coalesced for */
+struct ethernet_gro_flow {
+	/** Packet holding the coalesced segments, NULL if slot is free */
+	struct net_pkt *pkt;
+
+	/** Sequence number the next in-order segment must have */
+	u32_t next_seq;
+
+	/** One's complement sum of the coalesced payload */
+	u16_t payload_sum;
+
+	/** Payload length of the first segment */
+	u16_t mss;
+
+	/** Length of the IPv4 and TCP headers */
+	u8_t hdr_len;
+};
+#endif
+
 struct ethernet_context {
 #if defined(CONFIG_NET_VLAN)
 	struct ethernet_vlan vlan[NET_VLAN_MAX_COUNT];
@@ -367,6 +390,19 @@ struct ethernet_context {
 	int port;
 #endif
 
+#if defined(CONFIG_NET_ETHERNET_GRO)
+	struct {
+		/** Flows being coalesced */
+		struct ethernet_gro_flow flows[CONFIG_NET_ETHERNET_GRO_FLOWS];
+
+		/** Passes the held packets on if no new segments arrive */
+		struct k_delayed_work flush;
+
+		/** Slot to reuse next when all of them are taken */
+		u8_t evict;
+	} gro;
+#endif
+
 #if defined(CONFIG_NET_VLAN)
 	/** Flag that tells whether how many VLAN tags are enabled for this
 	 * context. The same information can be dug from the vlan array but
@@ -501,6 +537,26 @@ enum ethernet_hw_caps net_eth_get_hw_capabilities(struct net_if *iface)
 	return eth->get_capabilities(net_if_get_device(iface));
 }
 
+/**
+ * @brief Return the largest TCP/IPv4 packet the stack may build for
+ * this interface and leave to segmentation offload.
+ *
+ * @param iface Network interface
+ *
+ * @return Maximum IPv4 packet length, or 0 if the interface does not do
+ * segmentation offload.
+ */
+#if defined(CONFIG_NET_ETHERNET_GSO)
+size_t net_eth_get_gso_max_size(struct net_if *iface);
+#else
+static inline size_t net_eth_get_gso_max_size(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	return 0;
+}
+#endif
+
 /**
  * @brief Add VLAN tag to the interface.
  *
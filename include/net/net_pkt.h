@@ -163,6 +163,11 @@ struct net_pkt {
 				 * Used only if defined(CONFIG_NET_ROUTE)
 				 */
 	u8_t family     : 3;	/* IPv4 vs IPv6 */
+	u8_t l2_processed : 1;	/* Has L2 already handled this incoming pkt.
+				 * Used only if
+				 * defined(CONFIG_NET_ETHERNET_GRO) or
+				 * defined(CONFIG_NET_IPV4_FRAGMENT)
+				 */
 
 	union {
 		u8_t ipv4_auto_arp_msg : 1; /* Is this pkt IPv4 autoconf ARP
@@ -383,6 +388,26 @@ static inline bool net_pkt_forwarding(struct net_pkt *pkt)
 }
 #endif
 
+#if defined(CONFIG_NET_ETHERNET_GRO) || defined(CONFIG_NET_IPV4_FRAGMENT)
+static inline bool net_pkt_is_l2_processed(struct net_pkt *pkt)
+{
+	return pkt->l2_processed;
+}
+
+static inline void net_pkt_set_l2_processed(struct net_pkt *pkt,
+					    bool is_l2_processed)
+{
+	pkt->l2_processed = is_l2_processed;
+}
+#else
+static inline bool net_pkt_is_l2_processed(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+#endif
+
 #if defined(CONFIG_NET_IPV4)
 static inline u8_t net_pkt_ipv4_ttl(struct net_pkt *pkt)
 {
@@ -202,6 +202,26 @@ struct net_stats_ipv6_mld {
 	net_stats_t drop;
 };
 
+/**
+ * @brief IPv4 fragmentation statistics
+ */
+struct net_stats_ipv4_frag {
+	/** Number of received IPv4 fragments */
+	net_stats_t recv;
+
+	/** Number of reassembled IPv4 packets */
+	net_stats_t reassembled;
+
+	/** Number of dropped IPv4 fragments */
+	net_stats_t drop;
+
+	/** Number of IPv4 reassemblies that timed out */
+	net_stats_t timeout;
+
+	/** Number of sent IPv4 fragments */
+	net_stats_t sent;
+};
+
 /**
  * @brief Network packet transfer times for calculating average TX time
  */
@@ -263,6 +283,11 @@ struct net_stats {
 	struct net_stats_ip ipv4;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_IPV4_FRAGMENT)
+	/** IPv4 fragmentation statistics */
+	struct net_stats_ipv4_frag ipv4_frag;
+#endif
+
 #if defined(CONFIG_NET_STATISTICS_ICMP)
 	/** ICMP statistics */
 	struct net_stats_icmp icmp;
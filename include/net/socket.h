@@ -26,6 +26,7 @@
 #include <net/net_ip.h>
 #include <net/dns_resolve.h>
 #include <net/socket_select.h>
+#include <net/socket_epoll.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -54,8 +55,14 @@ struct zsock_pollfd {
 
 /** zsock_recv: Read data without removing it from socket input queue */
 #define ZSOCK_MSG_PEEK 0x02
+/** zsock_recvmsg: Control data was discarded, buffer too small */
+#define ZSOCK_MSG_CTRUNC 0x08
+/** zsock_recvmsg: Datagram was truncated, buffer too small */
+#define ZSOCK_MSG_TRUNC 0x20
 /** zsock_recv/zsock_send: Override operation to non-blocking */
 #define ZSOCK_MSG_DONTWAIT 0x40
+/** zsock_recvmmsg: Block for the first message only */
+#define ZSOCK_MSG_WAITFORONE 0x10000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -285,6 +292,26 @@ static inline ssize_t zsock_send(int sock, const void *buf, size_t len,
 __syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
 				int flags);
 
+/**
+ * @brief Send multiple messages with a single call
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/sendmmsg.2.html>`__
+ * for normative description.
+ * The socket is looked up once and each message is sent as with
+ * :c:func:`zsock_sendmsg`. On return, ``msg_len`` of each sent message
+ * holds the number of bytes sent.
+ * This function is also exposed as ``sendmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages sent, or -1 with errno set if none was sent.
+ */
+__syscall int zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
 /**
  * @brief Receive data from an arbitrary network address
  *
@@ -301,6 +328,82 @@ __syscall ssize_t zsock_recvfrom(int sock, void *buf, size_t max_len,
 				 int flags, struct sockaddr *src_addr,
 				 socklen_t *addrlen);
 
+/**
+ * @brief Receive a message from an arbitrary network address
+ *
+ * @details
+ * @rst
+ * See `POSIX.1-2017 article
+ * <http://pubs.opengroup.org/onlinepubs/9699919799/functions/recvmsg.html>`__
+ * for normative description.
+ * Data is scattered over the ``msg_iov`` buffers. For datagram sockets,
+ * ``MSG_TRUNC`` is set in ``msg_flags`` if the datagram did not fit. The
+ * only ancillary data supported is ``IP_PKTINFO``/``IPV6_PKTINFO``, when
+ * enabled with the ``IP_PKTINFO``/``IPV6_RECVPKTINFO`` socket options.
+ * This function is also exposed as ``recvmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+__syscall ssize_t zsock_recvmsg(int sock, struct msghdr *msg, int flags);
+
+/**
+ * @brief Receive multiple messages with a single call
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/recvmmsg.2.html>`__
+ * for normative description.
+ * The timeout argument of the Linux call is not supported. With
+ * ``MSG_WAITFORONE``, the call blocks for the first message only and
+ * returns as soon as no more messages are queued. On return, ``msg_len``
+ * of each received message holds the number of bytes received.
+ * This function is also exposed as ``recvmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages received, or -1 with errno set if none was
+ * received.
+ */
+__syscall int zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive a datagram without copying its data
+ *
+ * @details Instead of copying, the ``msg_iov`` entries are set to point
+ * to the payload in the network buffers of the received packet, one entry
+ * per buffer fragment. ``msg_iovlen`` is the number of entries available
+ * on input and the number of entries filled on output. If the payload
+ * spans more fragments than entries, ``MSG_TRUNC`` is set in
+ * ``msg_flags``. ``msg_name`` and ancillary data are handled as with
+ * zsock_recvmsg(). ``MSG_PEEK`` is not supported.
+ *
+ * The buffers stay valid until the handle stored in @p handle is passed
+ * to zsock_recv_zc_release(). Holding on to them keeps the network
+ * buffers allocated, so the application should release each handle as
+ * soon as it is done with the data.
+ *
+ * Only native UDP sockets support this call. It is not a system call and
+ * is available only with :option:`CONFIG_NET_SOCKETS_RECV_ZEROCOPY`.
+ *
+ * @param sock Socket
+ * @param msg Message header, filled with references to the data
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ * @param handle Where to store the handle to release the data
+ *
+ * @return Number of payload bytes referenced, or -1 with errno set.
+ */
+ssize_t zsock_recv_zc(int sock, struct msghdr *msg, int flags,
+		      void **handle);
+
+/**
+ * @brief Release data received with zsock_recv_zc()
+ *
+ * @param handle Handle returned by zsock_recv_zc()
+ */
+void zsock_recv_zc_release(void *handle);
+
 /**
  * @brief Receive data from a connected peer
  *
@@ -618,12 +721,29 @@ static inline ssize_t sendmsg(int sock, const struct msghdr *message,
 	return zsock_sendmsg(sock, message, flags);
 }
 
+static inline int sendmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 			       struct sockaddr *src_addr, socklen_t *addrlen)
 {
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline ssize_t recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg(sock, msg, flags);
+}
+
+static inline int recvmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
@@ -728,6 +848,9 @@ static inline int inet_pton(sa_family_t family, const char *src, void *dst)
 
 #define MSG_PEEK ZSOCK_MSG_PEEK
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_CTRUNC ZSOCK_MSG_CTRUNC
+#define MSG_TRUNC ZSOCK_MSG_TRUNC
+#define MSG_WAITFORONE ZSOCK_MSG_WAITFORONE
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
@@ -765,10 +888,32 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 /** sockopt: Disable TCP buffering (ignored, for compatibility) */
 #define TCP_NODELAY 1
 
+/* Socket options for IPPROTO_IP level */
+/** sockopt: Pass destination address and interface to recvmsg() */
+#define IP_PKTINFO 8
+
+/** Ancillary data of IP_PKTINFO type */
+struct in_pktinfo {
+	int            ipi_ifindex;  /* Interface index */
+	struct in_addr ipi_spec_dst; /* Local address */
+	struct in_addr ipi_addr;     /* Header destination address */
+};
+
 /* Socket options for IPPROTO_IPV6 level */
 /** sockopt: Don't support IPv4 access (ignored, for compatibility) */
 #define IPV6_V6ONLY 26
 
+/** sockopt: Pass destination address and interface to recvmsg() */
+#define IPV6_RECVPKTINFO 49
+/** Ancillary data type of IPV6_RECVPKTINFO */
+#define IPV6_PKTINFO 50
+
+/** Ancillary data of IPV6_PKTINFO type */
+struct in6_pktinfo {
+	struct in6_addr ipi6_addr;    /* Destination address */
+	int             ipi6_ifindex; /* Interface index */
+};
+
 /** sockopt: Socket priority */
 #define SO_PRIORITY 12
 
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+#define ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+
+/**
+ * @brief BSD Sockets compatible API
+ * @defgroup bsd_sockets BSD Sockets compatible API
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/types.h>
+#include <sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** zsock_epoll: Socket is readable (same value as ZSOCK_POLLIN) */
+#define ZSOCK_EPOLLIN 1
+/** zsock_epoll: Socket is writable (same value as ZSOCK_POLLOUT) */
+#define ZSOCK_EPOLLOUT 4
+/** zsock_epoll: Report the socket only when it becomes ready again */
+#define ZSOCK_EPOLLET BIT(31)
+
+/** zsock_epoll_ctl: Add a socket to the interest set */
+#define ZSOCK_EPOLL_CTL_ADD 1
+/** zsock_epoll_ctl: Remove a socket from the interest set */
+#define ZSOCK_EPOLL_CTL_DEL 2
+/** zsock_epoll_ctl: Change the events of a socket in the interest set */
+#define ZSOCK_EPOLL_CTL_MOD 3
+
+typedef union zsock_epoll_data {
+	void *ptr;
+	int fd;
+	u32_t u32;
+	u64_t u64;
+} zsock_epoll_data_t;
+
+struct zsock_epoll_event {
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
+/**
+ * @brief Create an interest set of sockets
+ *
+ * @details
+ * @rst
+ * Sockets added to the set with :c:func:`zsock_epoll_ctl()` stay in it
+ * until they are removed or closed, and :c:func:`zsock_epoll_wait()` only
+ * looks at the sockets that have become ready, so its cost does not
+ * grow with the number of sockets in the set. A socket can be in one
+ * set at a time, and only plain (non-TLS) sockets are supported.
+ * The set is closed with :c:func:`zsock_close()`.
+ * This function is also exposed as ``epoll_create()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param size Ignored, but must be greater than zero
+ *
+ * @return File descriptor of the set, or -1 with errno set
+ */
+int zsock_epoll_create(int size);
+
+/**
+ * @brief Add, change or remove a socket in an interest set
+ *
+ * @details
+ * @rst
+ * ``event->events`` is a mask of ``ZSOCK_EPOLLIN`` and ``ZSOCK_EPOLLOUT``.
+ * The socket is reported by :c:func:`zsock_epoll_wait()` for as long as
+ * it is ready, unless ``ZSOCK_EPOLLET`` is given, in which case it is
+ * reported once each time it becomes ready. As with :c:func:`zsock_poll()`,
+ * sockets are assumed to be always writable.
+ * This function is also exposed as ``epoll_ctl()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd File descriptor of the set
+ * @param op ZSOCK_EPOLL_CTL_ADD, ZSOCK_EPOLL_CTL_DEL or ZSOCK_EPOLL_CTL_MOD
+ * @param fd Socket
+ * @param event Events to watch and data to report, unused for
+ *        ZSOCK_EPOLL_CTL_DEL
+ *
+ * @return 0 on success, -1 with errno set otherwise
+ */
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for sockets of an interest set to become ready
+ *
+ * @details
+ * @rst
+ * This function is also exposed as ``epoll_wait()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd File descriptor of the set
+ * @param events Ready sockets are stored here
+ * @param maxevents Size of @p events
+ * @param timeout Timeout in milliseconds, -1 to wait forever
+ *
+ * @return Number of ready sockets, 0 on timeout, or -1 with errno set
+ */
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout);
+
+#ifdef CONFIG_NET_SOCKETS_POSIX_NAMES
+
+#define epoll_data_t zsock_epoll_data_t
+#define epoll_event zsock_epoll_event
+
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
+static inline int epoll_create(int size)
+{
+	return zsock_epoll_create(size);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
+#endif /* CONFIG_NET_SOCKETS_POSIX_NAMES */
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_ */
@@ -0,0 +1,192 @@
+/** @file
+ * @brief Packet socket rings.
+ *
+ * Descriptor rings shared between a packet socket and the application,
+ * so that frames can be received and sent without copying them and
+ * without a system call per frame.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_SOCKET_PACKET_RING_H_
+#define ZEPHYR_INCLUDE_NET_SOCKET_PACKET_RING_H_
+
+#include <errno.h>
+#include <zephyr/types.h>
+#include <sys/atomic.h>
+#include <sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Packet socket rings
+ * @defgroup socket_packet_ring Packet socket rings
+ * @ingroup networking
+ * @{
+ *
+ * A packet socket can be given four single producer, single consumer
+ * rings with setsockopt() at the SOL_PACKET level:
+ *
+ * - PACKET_RING_RX: received frames, filled by the stack. The data is
+ *   left in the network buffers it was received into, and the
+ *   descriptors point to it directly. A frame spread over several
+ *   buffers takes several descriptors, which are added at once.
+ * - PACKET_RING_FILL: received frames given back by the application,
+ *   so that their network buffers can be reused. Until then the
+ *   buffers are not available for receiving. The ring is drained when
+ *   a frame is received and on send(), recv() and poll() calls.
+ * - PACKET_RING_TX: frames to send, one descriptor each, placed in the
+ *   memory region registered with PACKET_RING_UMEM. They are sent
+ *   without copying when send() is called on the socket with no data,
+ *   one call sending everything that is in the ring.
+ * - PACKET_RING_COMPLETION: sent frames, whose memory can be reused.
+ *
+ * The option value is a pointer to the ring, which the application
+ * allocates with NET_PACKET_RING_BYTES() and initializes with
+ * net_packet_ring_init(). poll() reports ZSOCK_POLLIN when the RX ring
+ * is not empty.
+ */
+
+/** Protocol level for packet socket options */
+#define SOL_PACKET 263
+
+/** Packet socket options */
+enum {
+	/** Register the memory of the frames to send,
+	 * struct net_packet_umem is the value.
+	 */
+	PACKET_RING_UMEM = 1,
+	PACKET_RING_RX,
+	PACKET_RING_FILL,
+	PACKET_RING_TX,
+	PACKET_RING_COMPLETION,
+};
+
+/** Memory region holding the frames to send */
+struct net_packet_umem {
+	void *addr;
+	size_t len;
+};
+
+/** The frame continues in the next descriptor */
+#define NET_PACKET_DESC_MORE BIT(0)
+
+/** Frame descriptor */
+struct net_packet_desc {
+	/** Frame data. An offset in the registered memory region in the
+	 * TX and completion rings, a pointer to the network buffer in the
+	 * RX and fill rings.
+	 */
+	uintptr_t addr;
+	/** Length of the data */
+	u16_t len;
+	/** NET_PACKET_DESC_* flags */
+	u16_t flags;
+	/** Received frame the descriptor belongs to. The last descriptor
+	 * of a frame is given back in the fill ring.
+	 */
+	void *cookie;
+};
+
+/** Descriptor ring. The indices run freely and are masked on access. */
+struct net_packet_ring {
+	atomic_t producer;
+	atomic_t consumer;
+	/** Number of descriptors, a power of two */
+	u32_t size;
+	struct net_packet_desc desc[];
+};
+
+/** Bytes needed for a ring of @p size descriptors */
+#define NET_PACKET_RING_BYTES(size) \
+	(sizeof(struct net_packet_ring) + \
+	 (size) * sizeof(struct net_packet_desc))
+
+/**
+ * @brief Initialize an empty ring
+ *
+ * @param ring Ring memory, NET_PACKET_RING_BYTES(size) long
+ * @param size Number of descriptors, a power of two
+ */
+static inline void net_packet_ring_init(struct net_packet_ring *ring,
+					u32_t size)
+{
+	atomic_set(&ring->producer, 0);
+	atomic_set(&ring->consumer, 0);
+	ring->size = size;
+}
+
+/** @return Number of descriptors the consumer can take */
+static inline u32_t net_packet_ring_count(struct net_packet_ring *ring)
+{
+	return (u32_t)atomic_get(&ring->producer) -
+		(u32_t)atomic_get(&ring->consumer);
+}
+
+/** @return Number of descriptors the producer can add */
+static inline u32_t net_packet_ring_space(struct net_packet_ring *ring)
+{
+	return ring->size - net_packet_ring_count(ring);
+}
+
+/** @return Descriptor at the free running index @p idx */
+static inline struct net_packet_desc *
+net_packet_ring_desc(struct net_packet_ring *ring, u32_t idx)
+{
+	return &ring->desc[idx & (ring->size - 1)];
+}
+
+/**
+ * @brief Descriptor the consumer takes next
+ *
+ * @return Descriptor, or NULL if the ring is empty
+ */
+static inline struct net_packet_desc *
+net_packet_ring_peek(struct net_packet_ring *ring)
+{
+	if (!net_packet_ring_count(ring)) {
+		return NULL;
+	}
+
+	return net_packet_ring_desc(ring, atomic_get(&ring->consumer));
+}
+
+/** @brief Release the descriptor returned by net_packet_ring_peek() */
+static inline void net_packet_ring_release(struct net_packet_ring *ring)
+{
+	atomic_inc(&ring->consumer);
+}
+
+/**
+ * @brief Add a descriptor to the ring
+ *
+ * @return 0 on success, -ENOSPC if the ring is full
+ */
+static inline int net_packet_ring_put(struct net_packet_ring *ring,
+				      const struct net_packet_desc *desc)
+{
+	if (!net_packet_ring_space(ring)) {
+		return -ENOSPC;
+	}
+
+	*net_packet_ring_desc(ring, atomic_get(&ring->producer)) = *desc;
+	atomic_inc(&ring->producer);
+
+	return 0;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_NET_SOCKET_PACKET_RING_H_ */
@@ -59,5 +59,6 @@ struct _priq_mq {
 void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread);
 void z_priq_mq_remove(struct _priq_mq *pq, struct k_thread *thread);
 struct k_thread *z_priq_mq_best(struct _priq_mq *pq);
+struct k_thread *z_priq_mq_next(struct _priq_mq *pq, struct k_thread *thread);
 
 #endif /* ZEPHYR_INCLUDE_SCHED_PRIQ_H_ */
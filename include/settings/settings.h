@@ -312,6 +312,61 @@ int settings_save_one(const char *name, const void *value, size_t val_len);
  */
 int settings_delete(const char *name);
 
+/**
+ * Start a settings transaction.
+ *
+ * The values given to @ref settings_txn_save_one and
+ * @ref settings_txn_delete are kept in RAM until
+ * @ref settings_txn_commit writes them to persisted storage at once.
+ * Only one transaction can be open at a time.
+ *
+ * @return 0 on success, -EBUSY if a transaction is already open,
+ * -ENOENT if there is no storage to save to.
+ */
+int settings_txn_begin(void);
+
+/**
+ * Stage a serialized value in the open transaction. A value staged
+ * earlier for the same name is replaced.
+ *
+ * @param name Name/key of the settings item.
+ * @param value Pointer to the value of the settings item.
+ * @param val_len Length of the value.
+ *
+ * @return 0 on success, -EINVAL if no transaction is open, -ENOMEM if
+ * the value does not fit in CONFIG_SETTINGS_TXN_BUF_SIZE.
+ */
+int settings_txn_save_one(const char *name, const void *value,
+			  size_t val_len);
+
+/**
+ * Stage the deletion of a serialized value in the open transaction.
+ *
+ * @param name Name/key of the settings item.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int settings_txn_delete(const char *name);
+
+/**
+ * Write the staged values to persisted storage and close the
+ * transaction.
+ *
+ * The values are stored as a whole: if the device loses power during the
+ * commit, either all or none of them are loaded afterwards. Unlike
+ * @ref settings_save_one, unchanged values are written again. The
+ * transaction is closed also when the commit fails.
+ *
+ * @return 0 on success, -ENOTSUP if the storage back-end does not
+ * support transactions, other non-zero value on failure.
+ */
+int settings_txn_commit(void);
+
+/**
+ * Close the open transaction, dropping the staged values.
+ */
+void settings_txn_abort(void);
+
 /**
  * Call commit for all settings handler. This should apply all
  * settings which has been set, but not applied yet.
@@ -341,6 +396,34 @@ int settings_commit_subtree(const char *subtree);
 
 struct settings_store_itf;
 
+/**
+ * Values staged in a settings transaction.
+ */
+struct settings_txn {
+	char *buf;
+	/**< Staged records, read with @ref settings_txn_next. */
+
+	size_t len;
+	/**< Length of the records in bytes. */
+
+	size_t cnt;
+	/**< Number of records. */
+};
+
+/**
+ * Record of a settings transaction.
+ */
+struct settings_txn_rec {
+	const char *name;
+	/**< Name/key of the settings item. */
+
+	const void *value;
+	/**< Value, NULL if the item is deleted. */
+
+	size_t val_len;
+	/**< Length of the value. */
+};
+
 /**
  * Backend handler node for storage handling.
  */
@@ -422,6 +505,16 @@ struct settings_store_itf {
 	 * Parameters:
 	 *  - cs - Corresponding backend handler node
 	 */
+
+	int (*csi_save_txn)(struct settings_store *cs,
+			    const struct settings_txn *txn);
+	/**< Save the records of a transaction to storage, all of them or
+	 * none if interrupted.
+	 *
+	 * Parameters:
+	 *  - cs - Corresponding backend handler node
+	 *  - txn - Records to save, unique by name
+	 */
 };
 
 /**
@@ -440,6 +533,20 @@ void settings_src_register(struct settings_store *cs);
  */
 void settings_dst_register(struct settings_store *cs);
 
+/**
+ * Get the next record of a settings transaction.
+ *
+ * @param[in]     txn Transaction.
+ * @param[in,out] off Offset of the record in the transaction, 0 for the
+ *                    first one. Set to the offset of the next record.
+ * @param[out]    rec Record.
+ *
+ * @return 0 on success, -ENOENT after the last record, -EINVAL if the
+ * records are malformed.
+ */
+int settings_txn_next(const struct settings_txn *txn, size_t *off,
+		      struct settings_txn_rec *rec);
+
 
 /*
  * API for handler lookup
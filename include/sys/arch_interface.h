@@ -338,6 +338,15 @@ static inline struct _cpu *arch_curr_cpu(void);
  * This will invoke z_sched_ipi() on other CPUs in the system.
  */
 void arch_sched_ipi(void);
+
+/**
+ * Send an interrupt to one CPU
+ *
+ * This will invoke z_sched_ipi() on the given CPU only.
+ *
+ * @param cpu_id Index of the target CPU in _kernel.cpus[]
+ */
+void arch_sched_ipi_cpu(int cpu_id);
 #endif /* CONFIG_SMP */
 
 /** @} */
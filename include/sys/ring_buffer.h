@@ -38,6 +38,10 @@ struct ring_buf {
 			u32_t tmp_tail;
 			u32_t tmp_head;
 		} byte_mode;
+		struct ring_buf_misc_mpsc_mode {
+			atomic_t reserve; /**< Producers' reservation word */
+			u32_t tmp_head;   /**< Same as byte_mode.tmp_head */
+		} mpsc_mode;
 	} misc;
 	u32_t size;   /**< Size of buf in 32-bit chunks */
 
@@ -51,6 +55,12 @@ struct ring_buf {
 /**
  * @defgroup ring_buffer_apis Ring Buffer APIs
  * @ingroup kernel_apis
+ *
+ * In byte mode one writer and one reader may access a ring buffer
+ * concurrently, e.g. an ISR and a thread or two CPUs, without any
+ * locking: each side only updates its own index, with an atomic store
+ * after it is done with the data.  Several writers can share a ring
+ * buffer without locking through ring_buf_mpsc_put().
  * @{
  */
 
@@ -345,6 +355,37 @@ int ring_buf_put_finish(struct ring_buf *buf, u32_t size);
  */
 u32_t ring_buf_put(struct ring_buf *buf, const u8_t *data, u32_t size);
 
+/**
+ * @brief Write (copy) data to a ring buffer shared by several writers.
+ *
+ * This routine writes data to a ring buffer @a buf, all or nothing,
+ * and may be called concurrently by any number of writers, from any
+ * mix of threads, ISRs and CPUs, without a lock and without masking
+ * interrupts. Space is reserved with an atomic compare-and-swap and
+ * the data becomes visible to the reader once every writer that
+ * reserved space before it has finished copying, so a writer that
+ * is interrupted in the middle of its copy delays, but never blocks,
+ * the writers that interrupted it.
+ *
+ * The single reader uses the regular byte access calls
+ * (ring_buf_get(), ring_buf_get_claim() and ring_buf_get_finish()),
+ * concurrently with the writers.
+ *
+ * @warning
+ * Ring buffer instance should not mix this call with the other byte
+ * writing calls (ring_buf_put(), ring_buf_put_claim() and
+ * ring_buf_put_finish()) nor with item access. The ring buffer size
+ * must not exceed 2^24 - 1 bytes.
+ *
+ * @param buf Address of ring buffer.
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ *
+ * @retval Number of bytes written, either @a size or 0 if there is not
+ *         enough free space.
+ */
+u32_t ring_buf_mpsc_put(struct ring_buf *buf, const u8_t *data, u32_t size);
+
 /**
  * @brief Get address of a valid data in a ring buffer.
  *
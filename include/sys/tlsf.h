@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_TLSF_H_
+#define ZEPHYR_INCLUDE_SYS_TLSF_H_
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/*
+ * Two-level segregated fit (TLSF) heap.
+ *
+ * Free blocks are kept in lists indexed first by the power of two of
+ * their size and then by the next Z_TLSF_SL_BITS bits below it, with a
+ * bitmap per level so a fitting list is found with two find-first-set
+ * operations.  Blocks are split to the requested size, carry an 8
+ * byte header and are coalesced with their physical neighbours on
+ * free, so a request only wastes its header and the rounding to
+ * Z_TLSF_UNIT.
+ *
+ * The heap is not synchronized; callers provide locking.
+ */
+
+/* Allocation unit and header size, in bytes */
+#define Z_TLSF_UNIT 8
+
+#define Z_TLSF_SL_BITS 3
+#define Z_TLSF_SL_COUNT (1 << Z_TLSF_SL_BITS)
+
+/* Blocks are addressed by 24 bit unit indices */
+#define Z_TLSF_MAX_UNITS (1UL << 24)
+#define Z_TLSF_FL_MAX (24 - Z_TLSF_SL_BITS + 1)
+
+#define Z_TLSF_HAVE_FL(units, l) \
+	((units) >= (1UL << (Z_TLSF_SL_BITS + (l))) ? 1 : 0)
+
+/* Number of first level classes needed for a heap of @a bytes */
+#define Z_TLSF_FL_COUNT(bytes)				\
+	(1 +						\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 0) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 1) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 2) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 3) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 4) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 5) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 6) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 7) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 8) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 9) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 10) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 11) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 12) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 13) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 14) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 15) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 16) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 17) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 18) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 19) +	\
+	 Z_TLSF_HAVE_FL((bytes) / Z_TLSF_UNIT, 20))
+
+/* Bytes of the buffer used for the free list heads */
+#define Z_TLSF_CTL_SIZE(bytes) \
+	(Z_TLSF_FL_COUNT(bytes) * Z_TLSF_SL_COUNT * sizeof(u32_t))
+
+/*
+ * Buffer size guaranteeing that @a n blocks of @a sz bytes can be
+ * allocated at the same time: one header and rounding per block, the
+ * end marker and the list heads.  The heads are sized for a bound on
+ * the whole buffer, as that is what z_sys_tlsf_init() indexes.
+ */
+#define Z_TLSF_BLOCKS_SIZE(sz, n) \
+	(((sz) + 2 * Z_TLSF_UNIT) * (n) + Z_TLSF_UNIT)
+
+#define Z_TLSF_BUF_SIZE(sz, n)					\
+	(Z_TLSF_BLOCKS_SIZE(sz, n) +				\
+	 Z_TLSF_CTL_SIZE(2 * Z_TLSF_BLOCKS_SIZE(sz, n) + 64))
+
+struct sys_tlsf_stats {
+	/* bytes in free blocks, headers included */
+	size_t free_bytes;
+	/* bytes in allocated blocks, headers included */
+	size_t allocated_bytes;
+	/* high-water mark of allocated_bytes */
+	size_t max_allocated_bytes;
+	/* largest request that can currently succeed */
+	size_t largest_free;
+};
+
+struct sys_tlsf {
+	void *buf;
+	size_t size;
+
+	/* set up by z_sys_tlsf_init() */
+	u32_t *heads;
+	u32_t end;
+	u32_t block_units;
+	u32_t used_units;
+	u32_t max_used_units;
+	u32_t fl_bitmap;
+	u8_t fl_count;
+	u8_t sl_bitmap[Z_TLSF_FL_MAX];
+};
+
+void z_sys_tlsf_init(struct sys_tlsf *h);
+
+void *z_sys_tlsf_alloc(struct sys_tlsf *h, size_t bytes);
+
+void z_sys_tlsf_free(struct sys_tlsf *h, void *mem);
+
+/* Unit index of an allocated block, and the inverse */
+u32_t z_sys_tlsf_block_id(struct sys_tlsf *h, void *mem);
+
+void *z_sys_tlsf_block_mem(struct sys_tlsf *h, u32_t id);
+
+void z_sys_tlsf_stats_get(struct sys_tlsf *h, struct sys_tlsf_stats *stats);
+
+#endif /* ZEPHYR_INCLUDE_SYS_TLSF_H_ */
@@ -139,6 +139,10 @@ struct _timeout {
 	sys_dnode_t node;
 	s32_t dticks;
 	_timeout_func_t fn;
+#ifdef CONFIG_TIMEOUT_WHEEL
+	/* absolute tick at which the timeout expires */
+	u64_t expiry;
+#endif
 };
 
 #ifdef __cplusplus
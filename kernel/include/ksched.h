@@ -134,7 +134,12 @@ static inline bool z_is_thread_state_set(struct k_thread *thread, u32_t state)
 
 static inline bool z_is_thread_queued(struct k_thread *thread)
 {
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* Tracked under the run queue locks, not in thread_state */
+	return thread->base.runq_cpu != 0U;
+#else
 	return z_is_thread_state_set(thread, _THREAD_QUEUED);
+#endif
 }
 
 static inline void z_mark_thread_as_suspended(struct k_thread *thread)
@@ -173,14 +178,19 @@ static inline void z_reset_thread_states(struct k_thread *thread,
 	thread->base.thread_state &= ~states;
 }
 
+/* With SCHED_PERCPU_RUNQ, the run queue code sets runq_cpu instead */
 static inline void z_mark_thread_as_queued(struct k_thread *thread)
 {
+#ifndef CONFIG_SCHED_PERCPU_RUNQ
 	z_set_thread_states(thread, _THREAD_QUEUED);
+#endif
 }
 
 static inline void z_mark_thread_as_not_queued(struct k_thread *thread)
 {
+#ifndef CONFIG_SCHED_PERCPU_RUNQ
 	z_reset_thread_states(thread, _THREAD_QUEUED);
+#endif
 }
 
 static inline bool z_is_under_prio_ceiling(int prio)
@@ -13,6 +13,7 @@
 #include <sys/dlist.h>
 #include <ksched.h>
 #include <init.h>
+#include <string.h>
 
 static struct k_spinlock lock;
 
@@ -70,6 +71,164 @@ static int init_mem_slab_module(struct device *dev)
 SYS_INIT(init_mem_slab_module, PRE_KERNEL_1,
 	 CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+
+#define MAG_BATCH ((CONFIG_MEM_SLAB_MAGAZINE_SIZE + 1) / 2)
+
+/*
+ * Each CPU owns one magazine per slab.  The owner pins itself with a
+ * local irq lock and only ever contends on the magazine lock with the
+ * rare slow path of another CPU draining it (mag_reclaim()), so the
+ * fast paths never touch the global slab lock.  Blocks held by a
+ * magazine are accounted in num_used, like blocks handed out to users.
+ */
+static bool mag_get(struct k_mem_slab *slab, void **mem)
+{
+	unsigned int irq = arch_irq_lock();
+	struct k_mem_slab_magazine *m = &slab->mag[_current_cpu->id];
+	k_spinlock_key_t key = k_spin_lock(&m->lock);
+	bool hit = m->count > 0U;
+
+	if (hit) {
+		*mem = m->blocks[--m->count];
+		m->stats.alloc_hits++;
+	} else {
+		m->stats.alloc_misses++;
+	}
+
+	k_spin_unlock(&m->lock, key);
+	arch_irq_unlock(irq);
+
+	return hit;
+}
+
+static bool mag_put(struct k_mem_slab *slab, void *mem)
+{
+	unsigned int irq = arch_irq_lock();
+	struct k_mem_slab_magazine *m = &slab->mag[_current_cpu->id];
+	k_spinlock_key_t key = k_spin_lock(&m->lock);
+	bool hit = !slab->mag_bypass &&
+		m->count < CONFIG_MEM_SLAB_MAGAZINE_SIZE;
+
+	if (hit) {
+		m->blocks[m->count++] = mem;
+		m->stats.free_hits++;
+	} else {
+		m->stats.free_misses++;
+	}
+
+	k_spin_unlock(&m->lock, key);
+	arch_irq_unlock(irq);
+
+	return hit;
+}
+
+/* Called with the slab lock held: move a batch of free blocks from the
+ * shared free list into the local magazine.
+ */
+static void mag_refill(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_magazine *m = &slab->mag[_current_cpu->id];
+	k_spinlock_key_t key;
+
+	if (slab->mag_bypass) {
+		return;
+	}
+
+	key = k_spin_lock(&m->lock);
+	while (slab->free_list != NULL && m->count < MAG_BATCH) {
+		m->blocks[m->count++] = slab->free_list;
+		slab->free_list = *(char **)(slab->free_list);
+		slab->num_used++;
+	}
+	k_spin_unlock(&m->lock, key);
+}
+
+/* Called with the slab lock held: return a batch of blocks from the
+ * local magazine to the shared free list.
+ */
+static void mag_flush(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_magazine *m = &slab->mag[_current_cpu->id];
+	k_spinlock_key_t key = k_spin_lock(&m->lock);
+
+	while (m->count > CONFIG_MEM_SLAB_MAGAZINE_SIZE - MAG_BATCH) {
+		char *p = m->blocks[--m->count];
+
+		*(char **)p = slab->free_list;
+		slab->free_list = p;
+		slab->num_used--;
+	}
+	k_spin_unlock(&m->lock, key);
+}
+
+/* Called with the slab lock held when the shared free list is empty:
+ * stop filling the magazines and pull back every block they hold, so
+ * nothing is stranded on another CPU while a thread waits.  Bypass is
+ * set before draining so that a racing mag_put() either lands before
+ * the drain of its magazine or sees the flag and takes the slow path.
+ */
+static void mag_reclaim(struct k_mem_slab *slab)
+{
+	slab->mag_bypass = true;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct k_mem_slab_magazine *m = &slab->mag[i];
+		k_spinlock_key_t key = k_spin_lock(&m->lock);
+
+		while (m->count > 0U) {
+			char *p = m->blocks[--m->count];
+
+			*(char **)p = slab->free_list;
+			slab->free_list = p;
+			slab->num_used--;
+		}
+		k_spin_unlock(&m->lock, key);
+	}
+}
+
+int k_mem_slab_magazine_stats_get(struct k_mem_slab *slab,
+				  struct k_mem_slab_magazine_stats *stats)
+{
+	(void)memset(stats, 0, sizeof(*stats));
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct k_mem_slab_magazine *m = &slab->mag[i];
+		k_spinlock_key_t key = k_spin_lock(&m->lock);
+
+		stats->alloc_hits += m->stats.alloc_hits;
+		stats->alloc_misses += m->stats.alloc_misses;
+		stats->free_hits += m->stats.free_hits;
+		stats->free_misses += m->stats.free_misses;
+		k_spin_unlock(&m->lock, key);
+	}
+
+	return 0;
+}
+
+#else
+
+static inline bool mag_get(struct k_mem_slab *slab, void **mem)
+{
+	return false;
+}
+
+static inline bool mag_put(struct k_mem_slab *slab, void *mem)
+{
+	return false;
+}
+
+int k_mem_slab_magazine_stats_get(struct k_mem_slab *slab,
+				  struct k_mem_slab_magazine_stats *stats)
+{
+	ARG_UNUSED(slab);
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_MEM_SLAB_MAGAZINE */
+
 void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 		    size_t block_size, u32_t num_blocks)
 {
@@ -77,6 +236,10 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	slab->block_size = block_size;
 	slab->buffer = buffer;
 	slab->num_used = 0U;
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	(void)memset(slab->mag, 0, sizeof(slab->mag));
+	slab->mag_bypass = false;
+#endif
 	create_free_list(slab);
 	z_waitq_init(&slab->wait_q);
 	SYS_TRACING_OBJ_INIT(k_mem_slab, slab);
@@ -86,9 +249,21 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 
 int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
+	k_spinlock_key_t key;
 	int result;
 
+	if (mag_get(slab, mem)) {
+		return 0;
+	}
+
+	key = k_spin_lock(&lock);
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	if (slab->free_list == NULL) {
+		mag_reclaim(slab);
+	}
+#endif
+
 	if (slab->free_list != NULL) {
 		/* take a free block */
 		*mem = slab->free_list;
@@ -100,7 +275,9 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 		*mem = NULL;
 		result = -ENOMEM;
 	} else {
-		/* wait for a free block or timeout */
+		/* wait for a free block or timeout; mag_reclaim() left
+		 * the magazines bypassed so every free reaches us
+		 */
 		result = z_pend_curr(&lock, key, &slab->wait_q, timeout);
 		if (result == 0) {
 			*mem = _current->base.swap_data;
@@ -108,6 +285,13 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 		return result;
 	}
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	slab->mag_bypass = z_waitq_head(&slab->wait_q) != NULL;
+	if (result == 0) {
+		mag_refill(slab);
+	}
+#endif
+
 	k_spin_unlock(&lock, key);
 
 	return result;
@@ -115,8 +299,15 @@ int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 
 void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
-	struct k_thread *pending_thread = z_unpend_first_thread(&slab->wait_q);
+	k_spinlock_key_t key;
+	struct k_thread *pending_thread;
+
+	if (mag_put(slab, *mem)) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	pending_thread = z_unpend_first_thread(&slab->wait_q);
 
 	if (pending_thread != NULL) {
 		z_thread_return_value_set_with_data(pending_thread, 0, *mem);
@@ -126,6 +317,10 @@ void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 		**(char ***)mem = slab->free_list;
 		slab->free_list = *(char **)mem;
 		slab->num_used--;
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+		slab->mag_bypass = false;
+		mag_flush(slab);
+#endif
 		k_spin_unlock(&lock, key);
 	}
 }
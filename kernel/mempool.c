@@ -27,10 +27,108 @@ static int pool_id(struct k_mem_pool *pool)
 	return pool - &_k_mem_pool_list_start[0];
 }
 
+#ifdef CONFIG_MEM_POOL_TLSF
+
+/* The TLSF heap is not synchronized itself, so it runs under the pool
+ * lock.  Blocks are identified by their unit index, split across the
+ * level and block fields of the block id.
+ */
+#define BLOCK_ID_BITS 20
+
+static void pool_base_init(struct k_mem_pool *p)
+{
+	z_sys_tlsf_init(&p->base);
+}
+
+static int pool_block_alloc(struct k_mem_pool *p, struct k_mem_block *block,
+			    size_t size)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	void *mem = z_sys_tlsf_alloc(&p->base, MAX(size, 1));
+	u32_t id;
+
+	k_spin_unlock(&lock, key);
+
+	block->data = mem;
+	block->id.pool = pool_id(p);
+	if (mem == NULL) {
+		return -ENOMEM;
+	}
+
+	id = z_sys_tlsf_block_id(&p->base, mem);
+	block->id.level = id >> BLOCK_ID_BITS;
+	block->id.block = id & BIT_MASK(BLOCK_ID_BITS);
+
+	return 0;
+}
+
+static void pool_block_free(struct k_mem_pool *p, struct k_mem_block_id *id)
+{
+	u32_t bn = (id->level << BLOCK_ID_BITS) | id->block;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	z_sys_tlsf_free(&p->base, z_sys_tlsf_block_mem(&p->base, bn));
+	k_spin_unlock(&lock, key);
+}
+
+int k_mem_pool_stats_get(struct k_mem_pool *p, struct k_mem_pool_stats *stats)
+{
+	struct sys_tlsf_stats tlsf;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	z_sys_tlsf_stats_get(&p->base, &tlsf);
+	k_spin_unlock(&lock, key);
+
+	stats->free_bytes = tlsf.free_bytes;
+	stats->allocated_bytes = tlsf.allocated_bytes;
+	stats->max_allocated_bytes = tlsf.max_allocated_bytes;
+	stats->largest_free_block = tlsf.largest_free;
+
+	return 0;
+}
+
+#else
+
+static void pool_base_init(struct k_mem_pool *p)
+{
+	z_sys_mem_pool_base_init(&p->base);
+}
+
+static int pool_block_alloc(struct k_mem_pool *p, struct k_mem_block *block,
+			    size_t size)
+{
+	u32_t level_num, block_num;
+	int ret;
+
+	ret = z_sys_mem_pool_block_alloc(&p->base, size,
+					 &level_num, &block_num,
+					 &block->data);
+	block->id.pool = pool_id(p);
+	block->id.level = level_num;
+	block->id.block = block_num;
+
+	return ret;
+}
+
+static void pool_block_free(struct k_mem_pool *p, struct k_mem_block_id *id)
+{
+	z_sys_mem_pool_block_free(&p->base, id->level, id->block);
+}
+
+int k_mem_pool_stats_get(struct k_mem_pool *p, struct k_mem_pool_stats *stats)
+{
+	ARG_UNUSED(p);
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_MEM_POOL_TLSF */
+
 static void k_mem_pool_init(struct k_mem_pool *p)
 {
 	z_waitq_init(&p->wait_q);
-	z_sys_mem_pool_base_init(&p->base);
+	pool_base_init(p);
 }
 
 int init_static_pools(struct device *unused)
@@ -59,14 +157,7 @@ int k_mem_pool_alloc(struct k_mem_pool *p, struct k_mem_block *block,
 	}
 
 	while (true) {
-		u32_t level_num, block_num;
-
-		ret = z_sys_mem_pool_block_alloc(&p->base, size,
-						 &level_num, &block_num,
-						 &block->data);
-		block->id.pool = pool_id(p);
-		block->id.level = level_num;
-		block->id.block = block_num;
+		ret = pool_block_alloc(p, block, size);
 
 		if (ret == 0 || timeout == K_NO_WAIT ||
 		    ret != -ENOMEM) {
@@ -91,7 +182,7 @@ void k_mem_pool_free_id(struct k_mem_block_id *id)
 	int need_sched = 0;
 	struct k_mem_pool *p = get_pool(id->pool);
 
-	z_sys_mem_pool_block_free(&p->base, id->level, id->block);
+	pool_block_free(p, id);
 
 	/* Wake up anyone blocked on this pool and let them repeat
 	 * their allocation attempts
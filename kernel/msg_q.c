@@ -57,6 +57,7 @@ void k_msgq_init(struct k_msgq *msgq, char *buffer, size_t msg_size,
 	msgq->used_msgs = 0;
 	msgq->flags = 0;
 	z_waitq_init(&msgq->wait_q);
+	z_waitq_init(&msgq->claim_wait_q);
 	msgq->lock = (struct k_spinlock) {};
 
 	SYS_TRACING_OBJ_INIT(k_msgq, msgq);
@@ -101,6 +102,7 @@ int z_vrfy_k_msgq_alloc_init(struct k_msgq *q, size_t msg_size,
 void k_msgq_cleanup(struct k_msgq *msgq)
 {
 	__ASSERT_NO_MSG(z_waitq_head(&msgq->wait_q) == NULL);
+	__ASSERT_NO_MSG(z_waitq_head(&msgq->claim_wait_q) == NULL);
 
 	if ((msgq->flags & K_MSGQ_FLAG_ALLOC) != 0) {
 		k_free(msgq->buffer_start);
@@ -109,17 +111,85 @@ void k_msgq_cleanup(struct k_msgq *msgq)
 }
 
 
+static void unlock_reschedule(struct k_msgq *msgq, k_spinlock_key_t key,
+			      bool woken)
+{
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+}
+
+/* Threads that cannot go on while a claim is outstanding, or that want
+ * to claim an entry, wait on claim_wait_q.  They are woken whenever a
+ * claim is committed or an entry is added or freed, and check again.
+ */
+static bool wake_claim_waiters(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+	bool woken = false;
+
+	while ((pending_thread = z_unpend_first_thread(&msgq->claim_wait_q))
+	       != NULL) {
+		arch_thread_return_value_set(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		woken = true;
+	}
+
+	return woken;
+}
+
+/* Wait on claim_wait_q with the lock held, and take the lock again.
+ * The time waited is taken off *timeout.  Returns -EAGAIN if the
+ * waiting period ran out, with the lock released.
+ */
+static int claim_wait(struct k_msgq *msgq, k_spinlock_key_t *key,
+		      s32_t *timeout)
+{
+	u32_t start = k_uptime_get_32();
+	int ret;
+
+	ret = z_pend_curr(&msgq->lock, *key, &msgq->claim_wait_q, *timeout);
+	if (ret != 0) {
+		return ret;
+	}
+
+	if (*timeout != K_FOREVER) {
+		*timeout = MAX(*timeout - (s32_t)(k_uptime_get_32() - start),
+			       K_NO_WAIT);
+	}
+
+	*key = k_spin_lock(&msgq->lock);
+
+	return 0;
+}
+
 int z_impl_k_msgq_put(struct k_msgq *msgq, void *data, s32_t timeout)
 {
 	__ASSERT(!arch_is_in_isr() || timeout == K_NO_WAIT, "");
 
 	struct k_thread *pending_thread;
 	k_spinlock_key_t key;
+	bool waited = false;
+	bool woken = false;
 	int result;
 
 	key = k_spin_lock(&msgq->lock);
 
-	if (msgq->used_msgs < msgq->max_msgs) {
+	/* the write slot is being filled in place, wait for the commit */
+	while ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIM) != 0 &&
+	       timeout != K_NO_WAIT) {
+		result = claim_wait(msgq, &key, &timeout);
+		if (result != 0) {
+			return result;
+		}
+		waited = true;
+	}
+
+	if ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIM) != 0) {
+		result = waited ? -EAGAIN : -ENOMSG;
+	} else if (msgq->used_msgs < msgq->max_msgs) {
 		/* message queue isn't full */
 		pending_thread = z_unpend_first_thread(&msgq->wait_q);
 		if (pending_thread != NULL) {
@@ -139,18 +209,19 @@ int z_impl_k_msgq_put(struct k_msgq *msgq, void *data, s32_t timeout)
 				msgq->write_ptr = msgq->buffer_start;
 			}
 			msgq->used_msgs++;
+			woken = wake_claim_waiters(msgq);
 		}
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
 		/* don't wait for message space to become available */
-		result = -ENOMSG;
+		result = waited ? -EAGAIN : -ENOMSG;
 	} else {
 		/* wait for put message success, failure, or timeout */
 		_current->base.swap_data = data;
 		return z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
 	}
 
-	k_spin_unlock(&msgq->lock, key);
+	unlock_reschedule(msgq, key, woken);
 
 	return result;
 }
@@ -190,11 +261,25 @@ int z_impl_k_msgq_get(struct k_msgq *msgq, void *data, s32_t timeout)
 
 	k_spinlock_key_t key;
 	struct k_thread *pending_thread;
+	bool waited = false;
+	bool woken;
 	int result;
 
 	key = k_spin_lock(&msgq->lock);
 
-	if (msgq->used_msgs > 0) {
+	/* the read slot is being read in place, wait for the commit */
+	while ((msgq->flags & K_MSGQ_FLAG_GET_CLAIM) != 0 &&
+	       timeout != K_NO_WAIT) {
+		result = claim_wait(msgq, &key, &timeout);
+		if (result != 0) {
+			return result;
+		}
+		waited = true;
+	}
+
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIM) != 0) {
+		result = waited ? -EAGAIN : -ENOMSG;
+	} else if (msgq->used_msgs > 0) {
 		/* take first available message from queue */
 		(void)memcpy(data, msgq->read_ptr, msgq->msg_size);
 		msgq->read_ptr += msgq->msg_size;
@@ -221,10 +306,14 @@ int z_impl_k_msgq_get(struct k_msgq *msgq, void *data, s32_t timeout)
 			z_reschedule(&msgq->lock, key);
 			return 0;
 		}
-		result = 0;
+
+		/* the freed entry can be claimed */
+		woken = wake_claim_waiters(msgq);
+		unlock_reschedule(msgq, key, woken);
+		return 0;
 	} else if (timeout == K_NO_WAIT) {
 		/* don't wait for a message to become available */
-		result = -ENOMSG;
+		result = waited ? -EAGAIN : -ENOMSG;
 	} else {
 		/* wait for get message success or timeout */
 		_current->base.swap_data = data;
@@ -279,6 +368,312 @@ static inline int z_vrfy_k_msgq_peek(struct k_msgq *q, void *data)
 #include <syscalls/k_msgq_peek_mrsh.c>
 #endif
 
+/* Copy n messages into the ring buffer at write_ptr, wrapping at most
+ * once.  The caller checked there is room for them.
+ */
+static void ring_write(struct k_msgq *msgq, const char *src, u32_t n)
+{
+	size_t len = n * msgq->msg_size;
+	size_t first = MIN(len, (size_t)(msgq->buffer_end - msgq->write_ptr));
+
+	(void)memcpy(msgq->write_ptr, src, first);
+	(void)memcpy(msgq->buffer_start, src + first, len - first);
+
+	if (len > first) {
+		msgq->write_ptr = msgq->buffer_start + (len - first);
+	} else {
+		msgq->write_ptr += first;
+	}
+	if (msgq->write_ptr == msgq->buffer_end) {
+		msgq->write_ptr = msgq->buffer_start;
+	}
+	msgq->used_msgs += n;
+}
+
+/* Copy n messages out of the ring buffer from read_ptr, wrapping at
+ * most once.  The caller checked there are that many.
+ */
+static void ring_read(struct k_msgq *msgq, char *dst, u32_t n)
+{
+	size_t len = n * msgq->msg_size;
+	size_t first = MIN(len, (size_t)(msgq->buffer_end - msgq->read_ptr));
+
+	(void)memcpy(dst, msgq->read_ptr, first);
+	(void)memcpy(dst + first, msgq->buffer_start, len - first);
+
+	if (len > first) {
+		msgq->read_ptr = msgq->buffer_start + (len - first);
+	} else {
+		msgq->read_ptr += first;
+	}
+	if (msgq->read_ptr == msgq->buffer_end) {
+		msgq->read_ptr = msgq->buffer_start;
+	}
+	msgq->used_msgs -= n;
+}
+
+/* Receivers only ever wait on an empty queue and senders on a full
+ * one, so which kind of thread heads the wait queue is known from
+ * used_msgs.
+ */
+static bool wake_sender(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+
+	if (msgq->used_msgs >= msgq->max_msgs) {
+		return false;
+	}
+
+	pending_thread = z_unpend_first_thread(&msgq->wait_q);
+	if (pending_thread == NULL) {
+		return false;
+	}
+
+	/* add thread's message to queue */
+	ring_write(msgq, pending_thread->base.swap_data, 1);
+	arch_thread_return_value_set(pending_thread, 0);
+	z_ready_thread(pending_thread);
+
+	return true;
+}
+
+static bool wake_receiver(struct k_msgq *msgq, const void *data)
+{
+	struct k_thread *pending_thread;
+
+	if (msgq->used_msgs != 0U) {
+		return false;
+	}
+
+	pending_thread = z_unpend_first_thread(&msgq->wait_q);
+	if (pending_thread == NULL) {
+		return false;
+	}
+
+	/* give message to waiting thread */
+	(void)memcpy(pending_thread->base.swap_data, data, msgq->msg_size);
+	arch_thread_return_value_set(pending_thread, 0);
+	z_ready_thread(pending_thread);
+
+	return true;
+}
+
+int z_impl_k_msgq_put_batch(struct k_msgq *msgq, const void *data,
+			    u32_t num_msgs)
+{
+	const char *src = data;
+	k_spinlock_key_t key;
+	bool woken = false;
+	u32_t n = 0U, room;
+
+	key = k_spin_lock(&msgq->lock);
+
+	/* nothing can be sent without waiting for the claim */
+	if ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIM) != 0) {
+		k_spin_unlock(&msgq->lock, key);
+		return 0;
+	}
+
+	while (n < num_msgs && wake_receiver(msgq, src)) {
+		src += msgq->msg_size;
+		n++;
+		woken = true;
+	}
+
+	room = MIN(num_msgs - n, msgq->max_msgs - msgq->used_msgs);
+	ring_write(msgq, src, room);
+	n += room;
+
+	if (room > 0U && wake_claim_waiters(msgq)) {
+		woken = true;
+	}
+
+	unlock_reschedule(msgq, key, woken);
+
+	return n;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_put_batch(struct k_msgq *q, const void *data,
+					  u32_t num_msgs)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_READ(data, num_msgs, q->msg_size));
+
+	return z_impl_k_msgq_put_batch(q, data, num_msgs);
+}
+#include <syscalls/k_msgq_put_batch_mrsh.c>
+#endif
+
+int z_impl_k_msgq_get_batch(struct k_msgq *msgq, void *data, u32_t max_msgs)
+{
+	k_spinlock_key_t key;
+	bool woken = false;
+	u32_t n;
+
+	key = k_spin_lock(&msgq->lock);
+
+	/* nothing can be received without waiting for the claim */
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIM) != 0) {
+		k_spin_unlock(&msgq->lock, key);
+		return 0;
+	}
+
+	n = MIN(max_msgs, msgq->used_msgs);
+	ring_read(msgq, data, n);
+
+	/* refill the freed entries from waiting senders, if any, and let
+	 * claims have the rest
+	 */
+	if (n > 0U) {
+		while (wake_sender(msgq)) {
+			woken = true;
+		}
+
+		if (msgq->used_msgs < msgq->max_msgs &&
+		    wake_claim_waiters(msgq)) {
+			woken = true;
+		}
+	}
+
+	unlock_reschedule(msgq, key, woken);
+
+	return n;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_k_msgq_get_batch(struct k_msgq *q, void *data,
+					  u32_t max_msgs)
+{
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(data, max_msgs, q->msg_size));
+
+	return z_impl_k_msgq_get_batch(q, data, max_msgs);
+}
+#include <syscalls/k_msgq_get_batch_mrsh.c>
+#endif
+
+int k_msgq_put_claim(struct k_msgq *msgq, void **data, s32_t timeout)
+{
+	__ASSERT(!arch_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	k_spinlock_key_t key = k_spin_lock(&msgq->lock);
+	bool waited = false;
+	int result;
+
+	/* wait for the other claim to be committed and for a free entry */
+	while ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIM) != 0 ||
+	       msgq->used_msgs >= msgq->max_msgs) {
+		if (timeout == K_NO_WAIT) {
+			k_spin_unlock(&msgq->lock, key);
+			return waited ? -EAGAIN : -ENOMSG;
+		}
+
+		result = claim_wait(msgq, &key, &timeout);
+		if (result != 0) {
+			return result;
+		}
+		waited = true;
+	}
+
+	*data = msgq->write_ptr;
+	msgq->flags |= K_MSGQ_FLAG_PUT_CLAIM;
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return 0;
+}
+
+int k_msgq_put_commit(struct k_msgq *msgq)
+{
+	k_spinlock_key_t key = k_spin_lock(&msgq->lock);
+	bool woken;
+
+	if ((msgq->flags & K_MSGQ_FLAG_PUT_CLAIM) == 0) {
+		k_spin_unlock(&msgq->lock, key);
+		return -EINVAL;
+	}
+
+	msgq->flags &= ~K_MSGQ_FLAG_PUT_CLAIM;
+
+	woken = wake_receiver(msgq, msgq->write_ptr);
+	if (!woken) {
+		/* the message is already in place */
+		msgq->write_ptr += msgq->msg_size;
+		if (msgq->write_ptr == msgq->buffer_end) {
+			msgq->write_ptr = msgq->buffer_start;
+		}
+		msgq->used_msgs++;
+	}
+
+	if (wake_claim_waiters(msgq)) {
+		woken = true;
+	}
+
+	unlock_reschedule(msgq, key, woken);
+
+	return 0;
+}
+
+int k_msgq_get_claim(struct k_msgq *msgq, void **data, s32_t timeout)
+{
+	__ASSERT(!arch_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	k_spinlock_key_t key = k_spin_lock(&msgq->lock);
+	bool waited = false;
+	int result;
+
+	/* wait for the other claim to be committed and for a message */
+	while ((msgq->flags & K_MSGQ_FLAG_GET_CLAIM) != 0 ||
+	       msgq->used_msgs == 0U) {
+		if (timeout == K_NO_WAIT) {
+			k_spin_unlock(&msgq->lock, key);
+			return waited ? -EAGAIN : -ENOMSG;
+		}
+
+		result = claim_wait(msgq, &key, &timeout);
+		if (result != 0) {
+			return result;
+		}
+		waited = true;
+	}
+
+	*data = msgq->read_ptr;
+	msgq->flags |= K_MSGQ_FLAG_GET_CLAIM;
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return 0;
+}
+
+int k_msgq_get_commit(struct k_msgq *msgq)
+{
+	k_spinlock_key_t key = k_spin_lock(&msgq->lock);
+	bool woken;
+
+	if ((msgq->flags & K_MSGQ_FLAG_GET_CLAIM) == 0) {
+		k_spin_unlock(&msgq->lock, key);
+		return -EINVAL;
+	}
+
+	msgq->flags &= ~K_MSGQ_FLAG_GET_CLAIM;
+
+	msgq->read_ptr += msgq->msg_size;
+	if (msgq->read_ptr == msgq->buffer_end) {
+		msgq->read_ptr = msgq->buffer_start;
+	}
+	msgq->used_msgs--;
+
+	woken = wake_sender(msgq);
+	if (wake_claim_waiters(msgq)) {
+		woken = true;
+	}
+
+	unlock_reschedule(msgq, key, woken);
+
+	return 0;
+}
+
 void z_impl_k_msgq_purge(struct k_msgq *msgq)
 {
 	k_spinlock_key_t key;
@@ -294,6 +689,10 @@ void z_impl_k_msgq_purge(struct k_msgq *msgq)
 
 	msgq->used_msgs = 0;
 	msgq->read_ptr = msgq->write_ptr;
+	msgq->flags &= ~K_MSGQ_FLAG_GET_CLAIM;
+
+	/* the receive claim is gone and every entry is free */
+	(void)wake_claim_waiters(msgq);
 
 	z_reschedule(&msgq->lock, key);
 }
@@ -37,12 +37,22 @@
 #define z_priq_wait_add		z_priq_rb_add
 #define _priq_wait_remove	z_priq_rb_remove
 #define _priq_wait_best		z_priq_rb_best
+#elif defined(CONFIG_WAITQ_MULTIQ)
+#define z_priq_wait_add		z_priq_mq_add
+#define _priq_wait_remove	z_priq_mq_remove
+#define _priq_wait_best		z_priq_mq_best
 #elif defined(CONFIG_WAITQ_DUMB)
 #define z_priq_wait_add		z_priq_dumb_add
 #define _priq_wait_remove	z_priq_dumb_remove
 #define _priq_wait_best		z_priq_dumb_best
 #endif
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+#define RUNQ(cpu)	(&_kernel.ready_q.runq[(cpu)])
+#else
+#define RUNQ(cpu)	(&_kernel.ready_q.runq)
+#endif
+
 /* the only struct z_kernel instance */
 struct z_kernel _kernel;
 
@@ -167,9 +177,267 @@ static ALWAYS_INLINE struct k_thread *_priq_dumb_mask_best(sys_dlist_t *pq)
 }
 #endif
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+/* Each CPU's ready queue has its own lock.  It covers the queue and
+ * the runq_cpu field of the threads on it, which is what marks them
+ * as queued.  Context switches only take the local queue lock.  Paths
+ * changing thread state hold sched_spinlock and take the lock of the
+ * queue they touch under it.  Only runq_steal() holds two queue
+ * locks, taken in CPU index order.
+ */
+static struct k_spinlock runq_lock[CONFIG_MP_NUM_CPUS];
+
+static ALWAYS_INLINE bool cpu_allowed(struct k_thread *thread, int cpu)
+{
+#ifdef CONFIG_SCHED_CPU_MASK
+	return (thread->base.cpu_mask & BIT(cpu)) != 0;
+#else
+	return true;
+#endif
+}
+
+static ALWAYS_INLINE bool cpu_is_idle(int cpu)
+{
+	struct k_thread *curr = _kernel.cpus[cpu].current;
+
+	/* CPUs not started yet have no current thread */
+	return curr != NULL && z_is_idle_thread_object(curr);
+}
+
+/* True if the CPU would switch to the thread from what it runs now */
+static ALWAYS_INLINE bool cpu_is_preemptible_by(int cpu,
+						struct k_thread *thread)
+{
+	struct k_thread *curr = _kernel.cpus[cpu].current;
+
+	return curr != NULL && z_is_t1_higher_prio_than_t2(thread, curr) &&
+		(is_preempt(curr) || is_metairq(thread));
+}
+
+/* Pick the CPU whose queue a newly runnable thread goes on.  The
+ * running thread stays local.  Anything else goes where it can run
+ * right away: the CPU it last ran on (cache affinity) if that is idle,
+ * another idle CPU, its last CPU if it preempts the thread there, or
+ * else the CPU running the lowest priority thread it preempts.  If
+ * there is none it waits on its last CPU.
+ */
+static int runq_cpu_for(struct k_thread *thread)
+{
+	int cpu = thread->base.cpu;
+	int target = -1;
+
+	if (thread == _current) {
+		return _current_cpu->id;
+	}
+
+	if (!cpu_allowed(thread, cpu)) {
+		for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+			if (cpu_allowed(thread, i)) {
+				cpu = i;
+				break;
+			}
+		}
+	}
+
+	if (cpu_is_idle(cpu)) {
+		return cpu;
+	}
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (cpu_allowed(thread, i) && cpu_is_idle(i)) {
+			return i;
+		}
+	}
+
+	if (cpu_is_preemptible_by(cpu, thread)) {
+		return cpu;
+	}
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (!cpu_allowed(thread, i) ||
+		    !cpu_is_preemptible_by(i, thread)) {
+			continue;
+		}
+
+		if (target < 0 ||
+		    z_is_t1_higher_prio_than_t2(_kernel.cpus[target].current,
+						_kernel.cpus[i].current)) {
+			target = i;
+		}
+	}
+
+	return target < 0 ? cpu : target;
+}
+
+/* Make another CPU reschedule if the thread just queued there can run
+ * on it now.  Without IPI support it notices on its next interrupt.
+ */
+static ALWAYS_INLINE void runq_kick(int cpu, struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_IPI_SUPPORTED
+	if (cpu != _current_cpu->id &&
+	    (cpu_is_idle(cpu) || cpu_is_preemptible_by(cpu, thread))) {
+		arch_sched_ipi_cpu(cpu);
+	}
+#endif
+}
+
+/* Wake one idle CPU allowed to run the thread, so that it steals it */
+static ALWAYS_INLINE void runq_kick_idle(struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_IPI_SUPPORTED
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if (i != _current_cpu->id && cpu_allowed(thread, i) &&
+		    cpu_is_idle(i)) {
+			arch_sched_ipi_cpu(i);
+			break;
+		}
+	}
+#endif
+}
+
+/* runq_push() and runq_pop() are called with the queue lock held */
+static ALWAYS_INLINE void runq_push(int cpu, struct k_thread *thread)
+{
+	_priq_run_add(RUNQ(cpu), thread);
+	thread->base.runq_cpu = cpu + 1;
+}
+
+static ALWAYS_INLINE void runq_pop(int cpu, struct k_thread *thread)
+{
+	_priq_run_remove(RUNQ(cpu), thread);
+	thread->base.runq_cpu = 0U;
+}
+
+static ALWAYS_INLINE bool runq_is_local(struct k_thread *thread)
+{
+	return thread->base.runq_cpu == _current_cpu->id + 1;
+}
+
+/* Move the best thread this CPU may run from another CPU's queue to
+ * the local one.  Only a CPU with nothing to run calls this, so busy
+ * CPUs never look at the other queues.
+ */
+static void runq_steal(void)
+{
+	int self = _current_cpu->id;
+	struct k_thread *best = NULL;
+	k_spinlock_key_t key, key2;
+	int from = -1;
+	int lo, hi;
+
+	for (int n = 1; n < CONFIG_MP_NUM_CPUS; n++) {
+		int i = (self + n) % CONFIG_MP_NUM_CPUS;
+		struct k_thread *t;
+
+		key = k_spin_lock(&runq_lock[i]);
+		t = _priq_run_best(RUNQ(i));
+		if (t != NULL &&
+		    (best == NULL || z_is_t1_higher_prio_than_t2(t, best))) {
+			best = t;
+			from = i;
+		}
+		k_spin_unlock(&runq_lock[i], key);
+	}
+
+	if (from < 0) {
+		return;
+	}
+
+	lo = MIN(self, from);
+	hi = MAX(self, from);
+	key = k_spin_lock(&runq_lock[lo]);
+	key2 = k_spin_lock(&runq_lock[hi]);
+
+	/* The queue may have changed since the scan, take its best now */
+	best = _priq_run_best(RUNQ(from));
+	if (best != NULL) {
+		runq_pop(from, best);
+		runq_push(self, best);
+	}
+
+	k_spin_unlock(&runq_lock[hi], key2);
+	k_spin_unlock(&runq_lock[lo], key);
+}
+#else
+static ALWAYS_INLINE bool runq_is_local(struct k_thread *thread)
+{
+	return true;
+}
+#endif /* CONFIG_SCHED_PERCPU_RUNQ */
+
+static ALWAYS_INLINE void runq_add(struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	int cpu = runq_cpu_for(thread);
+	k_spinlock_key_t key = k_spin_lock(&runq_lock[cpu]);
+
+	runq_push(cpu, thread);
+	k_spin_unlock(&runq_lock[cpu], key);
+
+	runq_kick(cpu, thread);
+#else
+	_priq_run_add(RUNQ(0), thread);
+#endif
+}
+
+/* Returns false if the thread was not queued (anymore) */
+static ALWAYS_INLINE bool runq_remove(struct k_thread *thread)
+{
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	for (;;) {
+		int cpu = (int)thread->base.runq_cpu - 1;
+		k_spinlock_key_t key;
+
+		if (cpu < 0) {
+			return false;
+		}
+
+		key = k_spin_lock(&runq_lock[cpu]);
+		if (thread->base.runq_cpu == cpu + 1) {
+			runq_pop(cpu, thread);
+			k_spin_unlock(&runq_lock[cpu], key);
+			return true;
+		}
+
+		/* Stolen by another CPU meanwhile, look again */
+		k_spin_unlock(&runq_lock[cpu], key);
+	}
+#else
+	_priq_run_remove(RUNQ(0), thread);
+	return true;
+#endif
+}
+
+/* With SCHED_PERCPU_RUNQ, called with the local queue lock held */
+static ALWAYS_INLINE struct k_thread *runq_best(void)
+{
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	return _priq_run_best(RUNQ(_current_cpu->id));
+#else
+	return _priq_run_best(RUNQ(0));
+#endif
+}
+
 static ALWAYS_INLINE struct k_thread *next_up(void)
 {
-	struct k_thread *th = _priq_run_best(&_kernel.ready_q.runq);
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	int self = _current_cpu->id;
+	k_spinlock_key_t key = k_spin_lock(&runq_lock[self]);
+	bool requeued = false;
+#endif
+	struct k_thread *th = runq_best();
+
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* Other queues are only looked at when this CPU would idle */
+	if (th == NULL && (z_is_idle_thread_object(_current) ||
+			   z_is_thread_prevented_from_running(_current))) {
+		k_spin_unlock(&runq_lock[self], key);
+		runq_steal();
+		key = k_spin_lock(&runq_lock[self]);
+		th = runq_best();
+	}
+#endif
 
 #if (CONFIG_NUM_METAIRQ_PRIORITIES > 0) && (CONFIG_NUM_COOP_PRIORITIES > 0)
 	/* MetaIRQs must always attempt to return back to a
@@ -180,7 +448,9 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	struct k_thread *mirqp = _current_cpu->metairq_preempted;
 
 	if (mirqp != NULL && (th == NULL || !is_metairq(th))) {
-		if (!z_is_thread_prevented_from_running(mirqp)) {
+		/* With per-CPU queues, another CPU may have taken it */
+		if (!z_is_thread_prevented_from_running(mirqp) &&
+		    runq_is_local(mirqp)) {
 			th = mirqp;
 		} else {
 			_current_cpu->metairq_preempted = NULL;
@@ -229,15 +499,31 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	/* Put _current back into the queue */
 	if (th != _current && active && !z_is_idle_thread_object(_current) &&
 	    !queued) {
-		_priq_run_add(&_kernel.ready_q.runq, _current);
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+		runq_push(self, _current);
+		requeued = true;
+#else
+		runq_add(_current);
 		z_mark_thread_as_queued(_current);
+#endif
 	}
 
 	/* Take the new _current out of the queue */
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	if (runq_is_local(th)) {
+		runq_pop(self, th);
+	}
+	k_spin_unlock(&runq_lock[self], key);
+
+	if (requeued) {
+		runq_kick_idle(_current);
+	}
+#else
 	if (z_is_thread_queued(th)) {
-		_priq_run_remove(&_kernel.ready_q.runq, th);
+		(void)runq_remove(th);
 	}
 	z_mark_thread_as_not_queued(th);
+#endif
 
 	return th;
 #endif
@@ -359,10 +645,11 @@ static void update_cache(int preempt_ok)
 void z_add_thread_to_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
-		_priq_run_add(&_kernel.ready_q.runq, thread);
+		runq_add(thread);
 		z_mark_thread_as_queued(thread);
 		update_cache(0);
-#if defined(CONFIG_SMP) &&  defined(CONFIG_SCHED_IPI_SUPPORTED)
+#if defined(CONFIG_SMP) && defined(CONFIG_SCHED_IPI_SUPPORTED) && \
+	!defined(CONFIG_SCHED_PERCPU_RUNQ)
 		arch_sched_ipi();
 #endif
 	}
@@ -372,9 +659,9 @@ void z_move_thread_to_end_of_prio_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
 		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
+			(void)runq_remove(thread);
 		}
-		_priq_run_add(&_kernel.ready_q.runq, thread);
+		runq_add(thread);
 		z_mark_thread_as_queued(thread);
 		update_cache(thread == _current);
 	}
@@ -384,7 +671,7 @@ void z_remove_thread_from_ready_q(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
 		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
+			(void)runq_remove(thread);
 			z_mark_thread_as_not_queued(thread);
 		}
 		update_cache(thread == _current);
@@ -528,15 +815,25 @@ bool z_set_prio(struct k_thread *thread, int prio)
 		need_sched = z_is_thread_ready(thread);
 
 		if (need_sched) {
-			/* Don't requeue on SMP if it's the running thread */
-			if (!IS_ENABLED(CONFIG_SMP) || z_is_thread_queued(thread)) {
-				_priq_run_remove(&_kernel.ready_q.runq, thread);
+			/* Don't requeue on SMP if it's the running thread,
+			 * or if a CPU took it out of the queue to run it
+			 */
+			if ((!IS_ENABLED(CONFIG_SMP) ||
+			     z_is_thread_queued(thread)) &&
+			    runq_remove(thread)) {
 				thread->base.prio = prio;
-				_priq_run_add(&_kernel.ready_q.runq, thread);
+				runq_add(thread);
 			} else {
 				thread->base.prio = prio;
 			}
 			update_cache(1);
+		} else if (IS_ENABLED(CONFIG_WAITQ_MULTIQ) &&
+			   z_is_thread_pending(thread) &&
+			   thread->base.pended_on != NULL) {
+			/* Multi-queue wait_q lists are picked by priority */
+			_priq_wait_remove(&pended_on(thread)->waitq, thread);
+			thread->base.prio = prio;
+			z_priq_wait_add(&pended_on(thread)->waitq, thread);
 		} else {
 			thread->base.prio = prio;
 		}
@@ -617,9 +914,14 @@ struct k_thread *z_get_next_ready_thread(void)
 {
 	struct k_thread *ret = 0;
 
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* next_up() takes the queue locks it needs itself */
+	ret = next_up();
+#else
 	LOCKED(&sched_spinlock) {
 		ret = next_up();
 	}
+#endif
 
 	return ret;
 }
@@ -639,7 +941,17 @@ void *z_get_next_switch_handle(void *interrupted)
 	z_check_stack_sentinel();
 
 #ifdef CONFIG_SMP
-	LOCKED(&sched_spinlock) {
+#ifdef CONFIG_SCHED_PERCPU_RUNQ
+	/* next_up() takes the queue locks it needs itself, this one
+	 * is purely for local interrupt locking
+	 */
+	struct k_spinlock local_lock = {};
+	struct k_spinlock *lock = &local_lock;
+#else
+	struct k_spinlock *lock = &sched_spinlock;
+#endif
+
+	LOCKED(lock) {
 		struct k_thread *th = next_up();
 
 		if (_current != th) {
@@ -656,7 +968,7 @@ void *z_get_next_switch_handle(void *interrupted)
 			 * confused when the "wrong" thread tries to
 			 * release the lock.
 			 */
-			z_spin_lock_set_owner(&sched_spinlock);
+			z_spin_lock_set_owner(lock);
 #endif
 		}
 	}
@@ -785,7 +1097,7 @@ struct k_thread *z_priq_rb_best(struct _priq_rb *pq)
 	return t;
 }
 
-#ifdef CONFIG_SCHED_MULTIQ
+#if defined(CONFIG_SCHED_MULTIQ) || defined(CONFIG_WAITQ_MULTIQ)
 # if (K_LOWEST_THREAD_PRIO - K_HIGHEST_THREAD_PRIO) > 31
 # error Too many priorities for multiqueue scheduler (max 32)
 # endif
@@ -795,6 +1107,13 @@ ALWAYS_INLINE void z_priq_mq_add(struct _priq_mq *pq, struct k_thread *thread)
 {
 	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
 
+	/* Lists are only valid while their bit is set, so statically
+	 * initialized wait_qs don't need 32 self-referencing heads.
+	 */
+	if ((pq->bitmask & BIT(priority_bit)) == 0U) {
+		sys_dlist_init(&pq->queues[priority_bit]);
+	}
+
 	sys_dlist_append(&pq->queues[priority_bit], &thread->base.qnode_dlist);
 	pq->bitmask |= BIT(priority_bit);
 }
@@ -831,6 +1150,27 @@ struct k_thread *z_priq_mq_best(struct _priq_mq *pq)
 	return t;
 }
 
+/* Iteration in priority order, for _WAIT_Q_FOR_EACH() */
+struct k_thread *z_priq_mq_next(struct _priq_mq *pq, struct k_thread *thread)
+{
+	int priority_bit = thread->base.prio - K_HIGHEST_THREAD_PRIO;
+	sys_dnode_t *n = sys_dlist_peek_next(&pq->queues[priority_bit],
+					     &thread->base.qnode_dlist);
+
+	if (n == NULL) {
+		/* Move on to the next non-empty lower priority list */
+		unsigned int rest = (priority_bit == 31) ? 0U :
+			pq->bitmask & ~(BIT(priority_bit + 1) - 1);
+
+		if (rest == 0U) {
+			return NULL;
+		}
+		n = sys_dlist_peek_head(&pq->queues[__builtin_ctz(rest)]);
+	}
+
+	return CONTAINER_OF(n, struct k_thread, base.qnode_dlist);
+}
+
 int z_unpend_all(_wait_q_t *wait_q)
 {
 	int need_sched = 0;
@@ -847,23 +1187,27 @@ int z_unpend_all(_wait_q_t *wait_q)
 
 void z_sched_init(void)
 {
+	int nq = IS_ENABLED(CONFIG_SCHED_PERCPU_RUNQ) ? CONFIG_MP_NUM_CPUS : 1;
+
+	for (int q = 0; q < nq; q++) {
 #ifdef CONFIG_SCHED_DUMB
-	sys_dlist_init(&_kernel.ready_q.runq);
+		sys_dlist_init(RUNQ(q));
 #endif
 
 #ifdef CONFIG_SCHED_SCALABLE
-	_kernel.ready_q.runq = (struct _priq_rb) {
-		.tree = {
-			.lessthan_fn = z_priq_rb_lessthan,
-		}
-	};
+		*RUNQ(q) = (struct _priq_rb) {
+			.tree = {
+				.lessthan_fn = z_priq_rb_lessthan,
+			}
+		};
 #endif
 
 #ifdef CONFIG_SCHED_MULTIQ
-	for (int i = 0; i < ARRAY_SIZE(_kernel.ready_q.runq.queues); i++) {
-		sys_dlist_init(&_kernel.ready_q.runq.queues[i]);
-	}
+		for (int i = 0; i < ARRAY_SIZE(RUNQ(q)->queues); i++) {
+			sys_dlist_init(&RUNQ(q)->queues[i]);
+		}
 #endif
+	}
 
 #ifdef CONFIG_TIMESLICING
 	k_sched_time_slice_set(CONFIG_TIMESLICE_SIZE,
@@ -921,9 +1265,8 @@ void z_impl_k_thread_deadline_set(k_tid_t tid, int deadline)
 
 	LOCKED(&sched_spinlock) {
 		th->base.prio_deadline = k_cycle_get_32() + deadline;
-		if (z_is_thread_queued(th)) {
-			_priq_run_remove(&_kernel.ready_q.runq, th);
-			_priq_run_add(&_kernel.ready_q.runq, th);
+		if (z_is_thread_queued(th) && runq_remove(th)) {
+			runq_add(th);
 		}
 	}
 }
@@ -952,10 +1295,9 @@ void z_impl_k_yield(void)
 		LOCKED(&sched_spinlock) {
 			if (!IS_ENABLED(CONFIG_SMP) ||
 			    z_is_thread_queued(_current)) {
-				_priq_run_remove(&_kernel.ready_q.runq,
-						 _current);
+				(void)runq_remove(_current);
 			}
-			_priq_run_add(&_kernel.ready_q.runq, _current);
+			runq_add(_current);
 			z_mark_thread_as_queued(_current);
 			update_cache(1);
 		}
@@ -1127,8 +1469,7 @@ void z_sched_abort(struct k_thread *thread)
 			__ASSERT(!z_is_thread_queued(thread), "");
 			thread->base.thread_state |= _THREAD_DEAD;
 			k_spin_unlock(&sched_spinlock, key);
-		} else if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
+		} else if (z_is_thread_queued(thread) && runq_remove(thread)) {
 			z_mark_thread_as_not_queued(thread);
 			thread->base.thread_state |= _THREAD_DEAD;
 			k_spin_unlock(&sched_spinlock, key);
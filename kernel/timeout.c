@@ -19,7 +19,9 @@
 
 static u64_t curr_tick;
 
+#ifndef CONFIG_TIMEOUT_WHEEL
 static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
+#endif
 
 static struct k_spinlock timeout_lock;
 
@@ -41,6 +43,153 @@ static inline int z_vrfy_z_clock_hw_cycles_per_sec_runtime_get(void)
 #endif /* CONFIG_USERSPACE */
 #endif /* CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME */
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+
+/* Hierarchical timing wheel.  Level N has WHEEL_SLOTS slots, each
+ * covering WHEEL_SLOTS^N ticks, and timeouts are filed by absolute
+ * expiry tick.  Timeouts in a higher level slot are re-filed
+ * ("cascaded") into the lower levels when curr_tick reaches the start
+ * of that slot, so insertion and removal are O(1) and each timeout is
+ * moved at most WHEEL_LEVELS - 1 times over its lifetime.
+ */
+#define WHEEL_BITS	5
+#define WHEEL_SLOTS	BIT(WHEEL_BITS)
+#define WHEEL_MASK	(WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS	CONFIG_TIMEOUT_WHEEL_LEVELS
+#define WHEEL_SHIFT(l)	((l) * WHEEL_BITS)
+#define WHEEL_RANGE	BIT64(WHEEL_SHIFT(WHEEL_LEVELS))
+#define WHEEL_NONE	UINT64_MAX
+
+/* A slot list is only valid while its bit is set in wheel_map */
+static sys_dlist_t wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static u32_t wheel_map[WHEEL_LEVELS];
+
+static void wheel_file(struct _timeout *t)
+{
+	u64_t when = t->expiry;
+	u64_t delta = when - curr_tick;
+	int lvl = 0;
+
+	while (lvl < (WHEEL_LEVELS - 1) &&
+	       delta >= BIT64(WHEEL_SHIFT(lvl + 1))) {
+		lvl++;
+	}
+
+	/* Out of range: park it in the furthest top level slot, it
+	 * gets re-filed from there when that slot cascades.
+	 */
+	if (delta >= WHEEL_RANGE) {
+		when = curr_tick + WHEEL_RANGE - 1;
+	}
+
+	int idx = (when >> WHEEL_SHIFT(lvl)) & WHEEL_MASK;
+	sys_dlist_t *slot = &wheel[lvl][idx];
+
+	if ((wheel_map[lvl] & BIT(idx)) == 0U) {
+		sys_dlist_init(slot);
+		wheel_map[lvl] |= BIT(idx);
+	}
+	sys_dlist_append(slot, &t->node);
+}
+
+static void remove_timeout(struct _timeout *t)
+{
+	/* Both neighbours being the same node means this is the last
+	 * timeout in its slot, and that neighbour is the slot head.
+	 */
+	if (t->node.next == t->node.prev) {
+		int n = (sys_dlist_t *)t->node.next - &wheel[0][0];
+
+		wheel_map[n / WHEEL_SLOTS] &= ~BIT(n % WHEEL_SLOTS);
+	}
+
+	sys_dlist_remove(&t->node);
+}
+
+/* Earliest tick after curr_tick at which the wheel has work to do:
+ * either a level 0 slot expiring or a non-empty slot cascading.  The
+ * latter is a lower bound of the real expiry, the timer driver may
+ * then wake up once for nothing, which is bounded by the number of
+ * levels a timeout crosses.
+ */
+static u64_t wheel_next_event(void)
+{
+	u64_t ret = WHEEL_NONE;
+
+	for (int lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+		u32_t map = wheel_map[lvl];
+		u64_t blk = (curr_tick >> WHEEL_SHIFT(lvl)) + 1;
+		int idx = blk & WHEEL_MASK;
+
+		if (map == 0U) {
+			continue;
+		}
+
+		if (idx != 0) {
+			map = (map >> idx) | (map << (WHEEL_SLOTS - idx));
+		}
+
+		blk += __builtin_ctz(map);
+		ret = MIN(ret, blk << WHEEL_SHIFT(lvl));
+	}
+
+	return ret;
+}
+
+static void wheel_cascade(u64_t tick)
+{
+	for (int lvl = 1; lvl < WHEEL_LEVELS; lvl++) {
+		if ((tick & (BIT64(WHEEL_SHIFT(lvl)) - 1)) != 0U) {
+			break;
+		}
+
+		int idx = (tick >> WHEEL_SHIFT(lvl)) & WHEEL_MASK;
+		sys_dlist_t pending;
+		sys_dnode_t *node;
+
+		if ((wheel_map[lvl] & BIT(idx)) == 0U) {
+			continue;
+		}
+
+		/* Entries may be filed back into this very slot */
+		sys_dlist_init(&pending);
+		while ((node = sys_dlist_get(&wheel[lvl][idx])) != NULL) {
+			sys_dlist_append(&pending, node);
+		}
+		wheel_map[lvl] &= ~BIT(idx);
+
+		while ((node = sys_dlist_get(&pending)) != NULL) {
+			wheel_file(CONTAINER_OF(node, struct _timeout, node));
+		}
+	}
+}
+
+static s32_t first_ticks(void)
+{
+	u64_t when = wheel_next_event();
+
+	return when == WHEEL_NONE ? K_FOREVER
+		: (s32_t)MIN(when - curr_tick, INT_MAX);
+}
+
+static bool insert_timeout(struct _timeout *to, s32_t ticks)
+{
+	u64_t prev = wheel_next_event();
+
+	to->dticks = ticks;
+	to->expiry = curr_tick + ticks;
+	wheel_file(to);
+
+	return wheel_next_event() < prev;
+}
+
+static s32_t timeout_ticks(struct _timeout *timeout)
+{
+	return (s32_t)(timeout->expiry - curr_tick);
+}
+
+#else
+
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -64,6 +213,52 @@ static void remove_timeout(struct _timeout *t)
 	sys_dlist_remove(&t->node);
 }
 
+static s32_t first_ticks(void)
+{
+	struct _timeout *to = first();
+
+	return to == NULL ? K_FOREVER : to->dticks;
+}
+
+static bool insert_timeout(struct _timeout *to, s32_t ticks)
+{
+	struct _timeout *t;
+
+	to->dticks = ticks;
+	for (t = first(); t != NULL; t = next(t)) {
+		__ASSERT(t->dticks >= 0, "");
+
+		if (t->dticks > to->dticks) {
+			t->dticks -= to->dticks;
+			sys_dlist_insert(&t->node, &to->node);
+			break;
+		}
+		to->dticks -= t->dticks;
+	}
+
+	if (t == NULL) {
+		sys_dlist_append(&timeout_list, &to->node);
+	}
+
+	return to == first();
+}
+
+static s32_t timeout_ticks(struct _timeout *timeout)
+{
+	s32_t ticks = 0;
+
+	for (struct _timeout *t = first(); t != NULL; t = next(t)) {
+		ticks += t->dticks;
+		if (timeout == t) {
+			break;
+		}
+	}
+
+	return ticks;
+}
+
+#endif /* CONFIG_TIMEOUT_WHEEL */
+
 static s32_t elapsed(void)
 {
 	return announce_remaining == 0 ? z_clock_elapsed() : 0;
@@ -71,9 +266,10 @@ static s32_t elapsed(void)
 
 static s32_t next_timeout(void)
 {
-	struct _timeout *to = first();
+	s32_t ticks = first_ticks();
 	s32_t ticks_elapsed = elapsed();
-	s32_t ret = to == NULL ? MAX_WAIT : MAX(0, to->dticks - ticks_elapsed);
+	s32_t ret = ticks == K_FOREVER ? MAX_WAIT
+		: MAX(0, ticks - ticks_elapsed);
 
 #ifdef CONFIG_TIMESLICING
 	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
@@ -90,25 +286,7 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn, s32_t ticks)
 	ticks = MAX(1, ticks);
 
 	LOCKED(&timeout_lock) {
-		struct _timeout *t;
-
-		to->dticks = ticks + elapsed();
-		for (t = first(); t != NULL; t = next(t)) {
-			__ASSERT(t->dticks >= 0, "");
-
-			if (t->dticks > to->dticks) {
-				t->dticks -= to->dticks;
-				sys_dlist_insert(&t->node, &to->node);
-				break;
-			}
-			to->dticks -= t->dticks;
-		}
-
-		if (t == NULL) {
-			sys_dlist_append(&timeout_list, &to->node);
-		}
-
-		if (to == first()) {
+		if (insert_timeout(to, ticks + elapsed())) {
 			z_clock_set_timeout(next_timeout(), false);
 		}
 	}
@@ -137,15 +315,10 @@ s32_t z_timeout_remaining(struct _timeout *timeout)
 	}
 
 	LOCKED(&timeout_lock) {
-		for (struct _timeout *t = first(); t != NULL; t = next(t)) {
-			ticks += t->dticks;
-			if (timeout == t) {
-				break;
-			}
-		}
+		ticks = timeout_ticks(timeout) - elapsed();
 	}
 
-	return ticks - elapsed();
+	return ticks;
 }
 
 s32_t z_get_next_timeout_expiry(void)
@@ -189,6 +362,37 @@ void z_clock_announce(s32_t ticks)
 
 	k_spinlock_key_t key = k_spin_lock(&timeout_lock);
 
+#ifdef CONFIG_TIMEOUT_WHEEL
+	u64_t target = curr_tick + ticks;
+
+	announce_remaining = ticks;
+
+	for (u64_t t = wheel_next_event(); t <= target;
+	     t = wheel_next_event()) {
+		int idx = t & WHEEL_MASK;
+
+		curr_tick = t;
+		announce_remaining = target - t;
+		wheel_cascade(t);
+
+		/* Level 0 slot idx now holds exactly the timeouts due at t */
+		while ((wheel_map[0] & BIT(idx)) != 0U) {
+			sys_dnode_t *node = sys_dlist_peek_head(&wheel[0][idx]);
+			struct _timeout *to = CONTAINER_OF(node,
+							   struct _timeout,
+							   node);
+
+			to->dticks = 0;
+			remove_timeout(to);
+
+			k_spin_unlock(&timeout_lock, key);
+			to->fn(to);
+			key = k_spin_lock(&timeout_lock);
+		}
+	}
+
+	curr_tick = target;
+#else
 	announce_remaining = ticks;
 
 	while (first() != NULL && first()->dticks <= announce_remaining) {
@@ -210,6 +414,7 @@ void z_clock_announce(s32_t ticks)
 	}
 
 	curr_tick += announce_remaining;
+#endif
 	announce_remaining = 0;
 
 	z_clock_set_timeout(next_timeout(), false);
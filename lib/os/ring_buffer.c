@@ -106,11 +106,28 @@ static inline u32_t wrap(u32_t val, u32_t max)
 	return val >= max ? (val - max) : val;
 }
 
+/* In byte mode the producer only ever writes tail (and its private
+ * tmp_tail) and the consumer only head (and tmp_head).  Publishing
+ * each index with an atomic store after the data, and reading the
+ * other side's index with an atomic load before touching the data,
+ * lets one producer and one consumer run concurrently, e.g. an ISR
+ * and a thread, with no lock and no interrupt masking.
+ */
+static inline u32_t load_idx(u32_t *idx)
+{
+	return (u32_t)atomic_get((atomic_t *)idx);
+}
+
+static inline void store_idx(u32_t *idx, u32_t val)
+{
+	(void)atomic_set((atomic_t *)idx, (atomic_val_t)val);
+}
+
 u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 {
 	u32_t space, trail_size, allocated;
 
-	space = z_ring_buf_custom_space_get(buf->size, buf->head,
+	space = z_ring_buf_custom_space_get(buf->size, load_idx(&buf->head),
 					    buf->misc.byte_mode.tmp_tail);
 
 	/* Limit requested size to available size. */
@@ -129,12 +146,13 @@ u32_t ring_buf_put_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 
 int ring_buf_put_finish(struct ring_buf *buf, u32_t size)
 {
-	if (size > ring_buf_space_get(buf)) {
+	if (size > z_ring_buf_custom_space_get(buf->size, load_idx(&buf->head),
+					       buf->tail)) {
 		return -EINVAL;
 	}
 
-	buf->tail = wrap(buf->tail + size, buf->size);
-	buf->misc.byte_mode.tmp_tail = buf->tail;
+	buf->misc.byte_mode.tmp_tail = wrap(buf->tail + size, buf->size);
+	store_idx(&buf->tail, buf->misc.byte_mode.tmp_tail);
 
 	return 0;
 }
@@ -167,7 +185,7 @@ u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 	space = (buf->size - 1) -
 		z_ring_buf_custom_space_get(buf->size,
 					    buf->misc.byte_mode.tmp_head,
-					    buf->tail);
+					    load_idx(&buf->tail));
 	trail_size = buf->size - buf->misc.byte_mode.tmp_head;
 
 	/* Limit requested size to available size. */
@@ -185,14 +203,16 @@ u32_t ring_buf_get_claim(struct ring_buf *buf, u8_t **data, u32_t size)
 
 int ring_buf_get_finish(struct ring_buf *buf, u32_t size)
 {
-	u32_t allocated = (buf->size - 1) - ring_buf_space_get(buf);
+	u32_t allocated = (buf->size - 1) -
+		z_ring_buf_custom_space_get(buf->size, buf->head,
+					    load_idx(&buf->tail));
 
 	if (size > allocated) {
 		return -EINVAL;
 	}
 
-	buf->head = wrap(buf->head + size, buf->size);
-	buf->misc.byte_mode.tmp_head = buf->head;
+	buf->misc.byte_mode.tmp_head = wrap(buf->head + size, buf->size);
+	store_idx(&buf->head, buf->misc.byte_mode.tmp_head);
 
 	return 0;
 }
@@ -217,3 +237,57 @@ u32_t ring_buf_get(struct ring_buf *buf, u8_t *data, u32_t size)
 
 	return total_size;
 }
+
+/* Multi-producer puts share one atomic reservation word: the index up
+ * to which space has been handed out in the low bits and the number
+ * of producers still copying into their reservation in the top bits.
+ * A producer reserves and counts itself in with one CAS, copies, and
+ * counts itself out with another.  A producer that sees it is the only
+ * one left knows every reservation up to the index in the word is
+ * complete, and publishes that index as the new tail before its CAS.
+ * If the CAS fails because another producer reserved meanwhile, it
+ * tries again with the new word.  Publishing only while counted in
+ * means a producer that is done can never publish after a later one,
+ * so the tail only moves forward.  A producer interrupted while
+ * copying only delays publication of later data, it never blocks the
+ * producers that interrupted it.
+ */
+#define MPSC_IDX_BITS 24
+#define MPSC_IDX_MASK BIT_MASK(MPSC_IDX_BITS)
+#define MPSC_WRITERS(w) ((u32_t)(w) >> MPSC_IDX_BITS)
+#define MPSC_MAX_WRITERS BIT_MASK(32 - MPSC_IDX_BITS)
+
+u32_t ring_buf_mpsc_put(struct ring_buf *buf, const u8_t *data, u32_t size)
+{
+	atomic_t *reserve = &buf->misc.mpsc_mode.reserve;
+	u32_t w, nw, start, end, first;
+
+	__ASSERT(buf->size <= MPSC_IDX_MASK, "ring buffer too large");
+
+	do {
+		w = atomic_get(reserve);
+		start = w & MPSC_IDX_MASK;
+		if (size == 0U || MPSC_WRITERS(w) == MPSC_MAX_WRITERS ||
+		    size > z_ring_buf_custom_space_get(buf->size,
+						       load_idx(&buf->head),
+						       start)) {
+			return 0;
+		}
+		end = wrap(start + size, buf->size);
+		nw = ((MPSC_WRITERS(w) + 1U) << MPSC_IDX_BITS) | end;
+	} while (!atomic_cas(reserve, w, nw));
+
+	first = MIN(size, buf->size - start);
+	memcpy(&buf->buf.buf8[start], data, first);
+	memcpy(buf->buf.buf8, data + first, size - first);
+
+	do {
+		w = atomic_get(reserve);
+		if (MPSC_WRITERS(w) == 1U) {
+			store_idx(&buf->tail, w & MPSC_IDX_MASK);
+		}
+		nw = w - BIT(MPSC_IDX_BITS);
+	} while (!atomic_cas(reserve, w, nw));
+
+	return size;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <sys/__assert.h>
+#include <sys/tlsf.h>
+
+/*
+ * The buffer is handled in Z_TLSF_UNIT sized units and every block
+ * is named by the index of its first unit.  The list heads live at the
+ * start of the buffer, so index 0 is never a block and doubles as the
+ * list terminator.  A block starts with a two word header:
+ *
+ *   hdr[0]  size in units << 1 | used bit
+ *   hdr[1]  size in units of the physically preceding block, 0 if none
+ *
+ * and a free block keeps its next/prev free list indices in the two
+ * words that follow.  A used zero-sized block marks the end of the
+ * buffer so coalescing never runs past it.
+ */
+
+static inline u32_t *hdr(struct sys_tlsf *h, u32_t b)
+{
+	return (u32_t *)((u8_t *)h->buf + (size_t)b * Z_TLSF_UNIT);
+}
+
+static inline u32_t block_size(struct sys_tlsf *h, u32_t b)
+{
+	return hdr(h, b)[0] >> 1;
+}
+
+static inline bool block_used(struct sys_tlsf *h, u32_t b)
+{
+	return (hdr(h, b)[0] & 1U) != 0U;
+}
+
+static inline void set_block(struct sys_tlsf *h, u32_t b, u32_t size,
+			     bool used)
+{
+	hdr(h, b)[0] = (size << 1) | (used ? 1U : 0U);
+}
+
+static inline u32_t *next_free(struct sys_tlsf *h, u32_t b)
+{
+	return &hdr(h, b)[2];
+}
+
+static inline u32_t *prev_free(struct sys_tlsf *h, u32_t b)
+{
+	return &hdr(h, b)[3];
+}
+
+static inline int msb(u32_t v)
+{
+	return 31 - __builtin_clz(v);
+}
+
+static void mapping(u32_t units, int *fl, int *sl)
+{
+	if (units < Z_TLSF_SL_COUNT) {
+		*fl = 0;
+		*sl = units;
+	} else {
+		int m = msb(units);
+
+		*fl = m - Z_TLSF_SL_BITS + 1;
+		*sl = (units >> (m - Z_TLSF_SL_BITS)) & (Z_TLSF_SL_COUNT - 1);
+	}
+}
+
+static inline u32_t *head(struct sys_tlsf *h, int fl, int sl)
+{
+	return &h->heads[fl * Z_TLSF_SL_COUNT + sl];
+}
+
+static void free_list_add(struct sys_tlsf *h, u32_t b)
+{
+	int fl, sl;
+	u32_t *first;
+
+	mapping(block_size(h, b), &fl, &sl);
+	first = head(h, fl, sl);
+
+	*next_free(h, b) = *first;
+	*prev_free(h, b) = 0U;
+	if (*first != 0U) {
+		*prev_free(h, *first) = b;
+	}
+	*first = b;
+
+	h->fl_bitmap |= BIT(fl);
+	h->sl_bitmap[fl] |= BIT(sl);
+}
+
+static void free_list_remove(struct sys_tlsf *h, u32_t b)
+{
+	int fl, sl;
+	u32_t next = *next_free(h, b), prev = *prev_free(h, b);
+
+	mapping(block_size(h, b), &fl, &sl);
+
+	if (prev != 0U) {
+		*next_free(h, prev) = next;
+	} else {
+		*head(h, fl, sl) = next;
+	}
+	if (next != 0U) {
+		*prev_free(h, next) = prev;
+	}
+
+	if (*head(h, fl, sl) == 0U) {
+		h->sl_bitmap[fl] &= ~BIT(sl);
+		if (h->sl_bitmap[fl] == 0U) {
+			h->fl_bitmap &= ~BIT(fl);
+		}
+	}
+}
+
+/* First block of the first non-empty list at or above (fl, sl) */
+static u32_t find_list(struct sys_tlsf *h, int fl, int sl)
+{
+	u32_t slmap, flmap;
+
+	if (fl >= h->fl_count) {
+		return 0U;
+	}
+
+	slmap = h->sl_bitmap[fl] & (~0U << sl);
+	if (slmap == 0U) {
+		flmap = h->fl_bitmap & (~0U << (fl + 1));
+		if (flmap == 0U) {
+			return 0U;
+		}
+		fl = __builtin_ctz(flmap);
+		slmap = h->sl_bitmap[fl];
+	}
+
+	return *head(h, fl, __builtin_ctz(slmap));
+}
+
+static u32_t find_block(struct sys_tlsf *h, u32_t units)
+{
+	int fl, sl;
+	u32_t b;
+
+	/* Look up with the request rounded to the next list boundary,
+	 * so that any block found fits without walking the list.
+	 */
+	if (units >= Z_TLSF_SL_COUNT) {
+		mapping(units + BIT(msb(units) - Z_TLSF_SL_BITS) - 1U,
+			&fl, &sl);
+	} else {
+		mapping(units, &fl, &sl);
+	}
+
+	b = find_list(h, fl, sl);
+	if (b != 0U) {
+		return b;
+	}
+
+	/* Nothing larger: the list holding the exact size may still
+	 * have a block that fits.  Only reached close to exhaustion.
+	 */
+	mapping(units, &fl, &sl);
+	if (fl >= h->fl_count) {
+		return 0U;
+	}
+	for (b = *head(h, fl, sl); b != 0U; b = *next_free(h, b)) {
+		if (block_size(h, b) >= units) {
+			break;
+		}
+	}
+
+	return b;
+}
+
+void z_sys_tlsf_init(struct sys_tlsf *h)
+{
+	u32_t units = h->size / Z_TLSF_UNIT;
+	u32_t ctl_units, first;
+
+	__ASSERT(((uintptr_t)h->buf & (Z_TLSF_UNIT - 1)) == 0,
+		 "heap buffer %p not aligned", h->buf);
+	__ASSERT(units < Z_TLSF_MAX_UNITS, "heap too large");
+
+	h->fl_count = units < Z_TLSF_SL_COUNT ? 1 :
+		msb(units) - Z_TLSF_SL_BITS + 2;
+	h->heads = h->buf;
+	ctl_units = ceiling_fraction(h->fl_count * Z_TLSF_SL_COUNT *
+				     sizeof(u32_t), Z_TLSF_UNIT);
+
+	__ASSERT(units >= ctl_units + 3, "heap buffer too small");
+
+	(void)memset(h->heads, 0, (size_t)ctl_units * Z_TLSF_UNIT);
+	(void)memset(h->sl_bitmap, 0, sizeof(h->sl_bitmap));
+	h->fl_bitmap = 0U;
+	h->used_units = 0U;
+	h->max_used_units = 0U;
+
+	first = ctl_units;
+	h->end = units - 1U;
+
+	h->block_units = h->end - first;
+
+	set_block(h, first, h->block_units, false);
+	hdr(h, first)[1] = 0U;
+	set_block(h, h->end, 0U, true);
+	hdr(h, h->end)[1] = h->block_units;
+
+	free_list_add(h, first);
+}
+
+void *z_sys_tlsf_alloc(struct sys_tlsf *h, size_t bytes)
+{
+	u32_t units, b, size;
+
+	if (bytes == 0U || bytes >= h->size) {
+		return NULL;
+	}
+
+	/* one unit of header, two units at least so it can be freed */
+	units = MAX(ceiling_fraction(bytes, Z_TLSF_UNIT) + 1U, 2U);
+
+	b = find_block(h, units);
+	if (b == 0U) {
+		return NULL;
+	}
+
+	free_list_remove(h, b);
+	size = block_size(h, b);
+
+	if (size - units >= 2U) {
+		u32_t rest = b + units;
+
+		set_block(h, rest, size - units, false);
+		hdr(h, rest)[1] = units;
+		hdr(h, rest + size - units)[1] = size - units;
+		free_list_add(h, rest);
+		size = units;
+	}
+
+	set_block(h, b, size, true);
+
+	h->used_units += size;
+	if (h->used_units > h->max_used_units) {
+		h->max_used_units = h->used_units;
+	}
+
+	return hdr(h, b + 1U);
+}
+
+void z_sys_tlsf_free(struct sys_tlsf *h, void *mem)
+{
+	u32_t b, size, next, prev;
+
+	if (mem == NULL) {
+		return;
+	}
+
+	b = z_sys_tlsf_block_id(h, mem);
+	__ASSERT(block_used(h, b), "double free of %p", mem);
+
+	size = block_size(h, b);
+	h->used_units -= size;
+
+	next = b + size;
+	if (!block_used(h, next)) {
+		free_list_remove(h, next);
+		size += block_size(h, next);
+	}
+
+	prev = hdr(h, b)[1];
+	if (prev != 0U && !block_used(h, b - prev)) {
+		b -= prev;
+		free_list_remove(h, b);
+		size += block_size(h, b);
+	}
+
+	set_block(h, b, size, false);
+	hdr(h, b + size)[1] = size;
+	free_list_add(h, b);
+}
+
+u32_t z_sys_tlsf_block_id(struct sys_tlsf *h, void *mem)
+{
+	return ((u8_t *)mem - (u8_t *)h->buf) / Z_TLSF_UNIT - 1U;
+}
+
+void *z_sys_tlsf_block_mem(struct sys_tlsf *h, u32_t id)
+{
+	return hdr(h, id + 1U);
+}
+
+void z_sys_tlsf_stats_get(struct sys_tlsf *h, struct sys_tlsf_stats *stats)
+{
+	u32_t largest = 0U;
+
+	/* Only the highest non-empty list can hold the largest block */
+	if (h->fl_bitmap != 0U) {
+		int fl = msb(h->fl_bitmap);
+		int sl = msb(h->sl_bitmap[fl]);
+
+		for (u32_t b = *head(h, fl, sl); b != 0U;
+		     b = *next_free(h, b)) {
+			largest = MAX(largest, block_size(h, b));
+		}
+	}
+
+	stats->allocated_bytes = (size_t)h->used_units * Z_TLSF_UNIT;
+	stats->max_allocated_bytes = (size_t)h->max_used_units * Z_TLSF_UNIT;
+	stats->free_bytes = (size_t)(h->block_units - h->used_units) *
+		Z_TLSF_UNIT;
+	stats->largest_free = largest > 0U ?
+		(size_t)(largest - 1U) * Z_TLSF_UNIT : 0;
+}
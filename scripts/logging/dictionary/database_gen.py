@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Generate the dictionary logging database from a Zephyr ELF file.
+
+With CONFIG_LOG_DICTIONARY_ENABLE, backends send format and metadata
+strings as addresses. The database holds what log_parser.py needs to
+turn the records back into text:
+
+- target byte order and word size,
+- log source names, in source ID order,
+- the NUL terminated strings of the read only data, where format
+  strings and string arguments in read only memory are looked up by
+  address. Code, debug information and writable data are left out.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+DB_VERSION = 2
+
+# Bounds of the region z_log_is_rodata() treats as read only, the first
+# pair found in the image is used
+RODATA_SYMBOLS = [
+    ('_image_rodata_start', '_image_rodata_end'),
+    ('_image_rom_start', '_image_rom_end'),
+    ('_rodata_start', '_rodata_end'),
+]
+
+# Runs of text bytes followed by a NUL, candidate C strings
+STRING = re.compile(rb'[\t\n\r\x20-\x7e\x80-\xff]+(?=\x00)')
+
+
+class Memory:
+    """Allocated sections of the image, addressable like target memory."""
+
+    def __init__(self, elf):
+        self.sections = []
+        for section in elf.iter_sections():
+            if section['sh_type'] != 'SHT_PROGBITS':
+                continue
+            if not section['sh_flags'] & SH_FLAGS.SHF_ALLOC:
+                continue
+            self.sections.append(section)
+
+        self.little_endian = elf.little_endian
+        self.word_size = elf.elfclass // 8
+
+    def read(self, addr, size):
+        for section in self.sections:
+            start = section['sh_addr']
+            if start <= addr and addr + size <= start + section['sh_size']:
+                offset = addr - start
+                return section.data()[offset:offset + size]
+        return None
+
+    def read_word(self, addr):
+        data = self.read(addr, self.word_size)
+        if data is None:
+            return None
+        return int.from_bytes(data, 'little' if self.little_endian
+                              else 'big')
+
+    def read_str(self, addr):
+        for section in self.sections:
+            start = section['sh_addr']
+            if start <= addr < start + section['sh_size']:
+                data = section.data()[addr - start:]
+                return data[:data.find(b'\0')].decode('utf-8', 'replace')
+        return None
+
+
+def symbols(elf):
+    syms = {}
+    for section in elf.iter_sections():
+        if isinstance(section, SymbolTableSection):
+            for sym in section.iter_symbols():
+                syms[sym.name] = sym['st_value']
+    return syms
+
+
+def log_sources(elf, mem):
+    """Names of the log sources, indexed by source ID.
+
+    Source ID is the index of the log_const_* entry between
+    __log_const_start and __log_const_end, which the linker sorts by
+    name.
+    """
+    syms = symbols(elf)
+    start = syms.get('__log_const_start')
+    end = syms.get('__log_const_end')
+    if start is None or end is None:
+        sys.exit("log_const section not found, is logging enabled?")
+
+    entries = sorted({addr for name, addr in syms.items()
+                      if name.startswith('log_const_')
+                      and start <= addr < end})
+
+    return [mem.read_str(mem.read_word(addr)) for addr in entries]
+
+
+def ro_strings(elf, mem):
+    """Strings of the read only data which may be passed by address."""
+    syms = symbols(elf)
+    lo, hi = 0, None
+    for start, end in RODATA_SYMBOLS:
+        if start in syms and end in syms:
+            lo, hi = syms[start], syms[end]
+            break
+
+    strings = []
+    for section in mem.sections:
+        flags = section['sh_flags']
+        if flags & (SH_FLAGS.SHF_WRITE | SH_FLAGS.SHF_EXECINSTR):
+            continue
+
+        start = section['sh_addr']
+        data = section.data()
+        for m in STRING.finditer(data):
+            addr = start + m.start()
+            if addr < lo or (hi is not None and addr >= hi):
+                continue
+            strings.append({
+                'start': addr,
+                'data': m.group().hex(),
+            })
+    return strings
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+
+    parser.add_argument("elffile", help="Zephyr ELF file")
+    parser.add_argument("dbfile", help="Output database file (JSON)")
+
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+
+    with open(args.elffile, 'rb') as f:
+        elf = ELFFile(f)
+        mem = Memory(elf)
+
+        db = {
+            'version': DB_VERSION,
+            'little_endian': mem.little_endian,
+            'word_size': mem.word_size,
+            'sources': log_sources(elf, mem),
+            'strings': ro_strings(elf, mem),
+        }
+
+    with open(args.dbfile, 'w') as f:
+        json.dump(db, f)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,295 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Decode dictionary based log output into text.
+
+Reads the binary stream produced by a backend with its *_DICT_ENABLE
+option set, e.g. captured from a UART, and prints the log messages the
+way the text backends would, using the database generated by
+database_gen.py for the same build.
+"""
+
+import argparse
+import bisect
+import json
+import re
+import struct
+import sys
+
+DB_VERSION = 2
+
+LOG_DICT_MAGIC = 0xA5
+TYPE_STD = 0
+TYPE_HEXDUMP = 1
+TYPE_DROPPED = 2
+
+LEVELS = ["", "err", "wrn", "inf", "dbg"]
+
+HEXDUMP_BYTES_IN_LINE = 16
+
+# Conversion specifier, one log argument each as counted on the target
+SPEC = re.compile(r"%(?P<flags>[-+ #0]*)(?P<width>\d+)?(?:\.(?P<prec>\d+))?"
+                  r"(?P<len>hh|h|ll|l|j|z|t|L)?(?P<conv>[diouxXcspfFeEgGaA%])")
+
+
+class Truncated(Exception):
+    pass
+
+
+class Database:
+    def __init__(self, path):
+        with open(path) as f:
+            db = json.load(f)
+
+        if db.get('version') != DB_VERSION:
+            sys.exit("Unsupported database version")
+
+        self.order = '<' if db['little_endian'] else '>'
+        self.word_size = db['word_size']
+        self.sources = db['sources']
+        self.strings = sorted((s['start'], bytes.fromhex(s['data']))
+                              for s in db['strings'])
+        self.starts = [start for start, _ in self.strings]
+
+    def string(self, addr):
+        # The linker merges strings, so addr may point into the tail of
+        # a longer one
+        i = bisect.bisect_right(self.starts, addr) - 1
+        if i >= 0:
+            start, data = self.strings[i]
+            if addr < start + len(data):
+                return data[addr - start:].decode('utf-8', 'replace')
+        return "<unknown string 0x%x>" % addr
+
+    def source(self, source_id):
+        if source_id < len(self.sources):
+            return self.sources[source_id]
+        return "<unknown source %d>" % source_id
+
+
+class Reader:
+    def __init__(self, data, pos, db):
+        self.data = data
+        self.pos = pos
+        self.db = db
+
+    def take(self, size):
+        if self.pos + size > len(self.data):
+            raise Truncated()
+        chunk = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return chunk
+
+    def unpack(self, fmt):
+        fmt = self.db.order + fmt
+        return struct.unpack(fmt, self.take(struct.calcsize(fmt)))
+
+    def word(self):
+        return int.from_bytes(self.take(self.db.word_size),
+                              'little' if self.db.order == '<' else 'big')
+
+    def cstr(self):
+        end = self.data.find(b'\0', self.pos)
+        if end < 0:
+            raise Truncated()
+        s = self.data[self.pos:end].decode('utf-8', 'replace')
+        self.pos = end + 1
+        return s
+
+
+def format_args(db, fmt, args, strings):
+    """Apply C style format string fmt to raw log arguments."""
+    bits = db.word_size * 8
+    idx = 0
+
+    def convert(m):
+        nonlocal idx
+
+        conv = m.group('conv')
+        if conv == '%':
+            return '%'
+        if idx >= len(args):
+            return m.group(0)
+
+        arg = args[idx]
+        spec = '%' + m.group('flags') + (m.group('width') or '')
+        if m.group('prec') is not None:
+            spec += '.' + m.group('prec')
+
+        if conv in 'di':
+            if arg & (1 << (bits - 1)):
+                arg -= 1 << bits
+            out = (spec + 'd') % arg
+        elif conv == 'u':
+            out = (spec + 'd') % arg
+        elif conv in 'oxX':
+            out = (spec + conv) % arg
+        elif conv == 'c':
+            out = (spec + 'c') % chr(arg & 0xff)
+        elif conv == 's':
+            s = strings[idx] if idx in strings else db.string(arg)
+            out = (spec + 's') % s
+        elif conv == 'p':
+            out = '0x%0*x' % (db.word_size * 2, arg)
+        else:
+            # No floating point in log arguments, print raw value
+            out = '0x%x' % arg
+
+        idx += 1
+        return out
+
+    return SPEC.sub(convert, fmt)
+
+
+def timestamp(ts, freq):
+    if not freq:
+        return "[%08u] " % ts
+
+    seconds = ts // freq
+    remainder = ts % freq
+    us = remainder * 1000000 // freq
+    return "[%02u:%02u:%02u.%03u,%03u] " % (seconds // 3600,
+                                           seconds // 60 % 60,
+                                           seconds % 60, us // 1000,
+                                           us % 1000)
+
+
+def hexdump(data, indent):
+    """Same layout as hexdump_line_print() in subsys/logging/log_output.c"""
+    lines = []
+    for i in range(0, len(data), HEXDUMP_BYTES_IN_LINE):
+        part = data[i:i + HEXDUMP_BYTES_IN_LINE]
+        hexs = ""
+        text = ""
+        for j in range(HEXDUMP_BYTES_IN_LINE):
+            if j > 0 and j % 8 == 0:
+                hexs += " "
+                text += " "
+            if j < len(part):
+                hexs += "%02x " % part[j]
+                text += chr(part[j]) if 32 <= part[j] < 127 else "."
+            else:
+                hexs += "   "
+                text += " "
+        lines.append(' ' * indent + hexs + "|" + text)
+    return lines
+
+
+def decode_record(r, freq):
+    """Decode one record at the reader position, return text lines."""
+    db = r.db
+    magic, ids, source_id, ts = r.unpack('BBHI')
+    assert magic == LOG_DICT_MAGIC
+    rtype = ids & 0x3
+    level = (ids >> 2) & 0x7
+
+    if rtype == TYPE_DROPPED:
+        cnt, = r.unpack('I')
+        return ["--- %d messages dropped ---" % cnt]
+
+    prefix = ""
+    if level != 0:
+        prefix = "%s<%s> %s: " % (timestamp(ts, freq),
+                                  LEVELS[level] if level < len(LEVELS)
+                                  else level, db.source(source_id))
+
+    if rtype == TYPE_STD:
+        fmt = db.string(r.word())
+        nargs, = r.unpack('B')
+        args = [r.word() for _ in range(nargs)]
+        nstr, = r.unpack('B')
+        strings = {}
+        for _ in range(nstr):
+            idx, = r.unpack('B')
+            strings[idx] = r.cstr()
+
+        return (prefix + format_args(db, fmt, args, strings)).splitlines()
+
+    if rtype == TYPE_HEXDUMP:
+        inline, = r.unpack('B')
+        if inline:
+            metadata = r.cstr()
+        else:
+            addr = r.word()
+            metadata = db.string(addr) if addr else None
+        length, = r.unpack('H')
+        data = r.take(length)
+
+        if level == 0:
+            # printk redirected to the logger
+            return data.decode('utf-8', 'replace').splitlines()
+
+        return [prefix + (metadata or "")] + hexdump(data, len(prefix))
+
+    raise ValueError("unknown record type %d" % rtype)
+
+
+def decode(data, db, freq, out):
+    pos = 0
+    skipped = 0
+
+    while pos < len(data):
+        if data[pos] != LOG_DICT_MAGIC:
+            pos += 1
+            skipped += 1
+            continue
+
+        r = Reader(data, pos, db)
+        try:
+            lines = decode_record(r, freq)
+        except Truncated:
+            break
+        except (ValueError, IndexError, UnicodeError):
+            pos += 1
+            skipped += 1
+            continue
+
+        if skipped:
+            out.write("--- %d bytes skipped ---\n" % skipped)
+            skipped = 0
+
+        for line in lines:
+            out.write(line + "\n")
+        pos = r.pos
+
+    return pos
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+
+    parser.add_argument("dbfile", help="Dictionary database (JSON) "
+                        "generated by database_gen.py")
+    parser.add_argument("logfile", help="Binary log data, - for stdin")
+    parser.add_argument("--hex", action="store_true",
+                        help="Log data is hexadecimal text")
+    parser.add_argument("--freq", type=int, default=0,
+                        help="Timestamp frequency in Hz, to print "
+                        "timestamps as time")
+
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    db = Database(args.dbfile)
+
+    if args.logfile == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.logfile, 'rb') as f:
+            data = f.read()
+
+    if args.hex:
+        data = bytes.fromhex(data.decode('ascii'))
+
+    decode(data, db, args.freq, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,8 @@
 # SPDX-License-Identifier: Apache-2.0
+import os
 import re
+import subprocess
+import sys
 from collections import OrderedDict
 
 result_re = re.compile("(PASS|FAIL|SKIP) - (test_)?(.*)")
@@ -71,8 +74,38 @@ class Console(Harness):
             self.patterns = []
             for r in self.regex:
                 self.patterns.append(re.compile(r))
+        elif self.type == "log_dictionary":
+            self.build_dir = instance.build_dir
+            self.checker = os.path.join(instance.testcase.source_dir,
+                                        "roundtrip.py")
+            self.console = []
+
+    def log_dictionary_check(self):
+        """Run roundtrip.py of the test on the captured output, which
+        decodes the dictionary records with the database of the build
+        and compares them with the text output."""
+        console = os.path.join(self.build_dir, "log_dictionary_console.txt")
+        with open(console, "w") as f:
+            f.write("\n".join(self.console) + "\n")
+
+        with open(os.path.join(self.build_dir,
+                               "log_dictionary_check.log"), "w") as log:
+            ret = subprocess.call([sys.executable, self.checker,
+                                   "--build-dir", self.build_dir,
+                                   "--console", console],
+                                  stdout=log, stderr=subprocess.STDOUT)
+
+        return "passed" if ret == 0 else "failed"
 
     def handle(self, line):
+        if self.type == "log_dictionary":
+            self.console.append(line)
+            if self.RUN_PASSED in line and not self.fault:
+                self.state = self.log_dictionary_check()
+                self.tests[self.id] = ("PASS" if self.state == "passed"
+                                       else "FAIL")
+                return
+
         if self.type == "one_line":
             if self.pattern.search(line):
                 self.state = "passed"
@@ -16,18 +16,54 @@
 
 #define SECTOR_SIZE 512
 
+#define BLOCK_SECTORS (CONFIG_DISK_ERASE_BLOCK_SIZE / SECTOR_SIZE)
+
+/* Without cache, a single entry is still needed to update a block */
+#define CACHE_ENTRIES MAX(CONFIG_DISK_FLASH_CACHE_BLOCKS, 1)
+
 static struct device *flash_dev;
 
-/* flash read-copy-erase-write operation */
-static u8_t read_copy_buf[CONFIG_DISK_ERASE_BLOCK_SIZE];
-static u8_t *fs_buff = read_copy_buf;
+/* Erase block cached for writing, see flash_cache_flush() */
+struct flash_cache_entry {
+	/* Erase-aligned address of the block */
+	off_t addr;
+	/* Sectors written since the block was last written back */
+	u32_t dirty[ceiling_fraction(BLOCK_SECTORS, 32)];
+	/* Sectors of buf holding the data of the block */
+	u32_t valid[ceiling_fraction(BLOCK_SECTORS, 32)];
+	/* Value of cache_stamp when the block was last written */
+	u32_t stamp;
+	bool used;
+	u8_t buf[CONFIG_DISK_ERASE_BLOCK_SIZE];
+};
+
+static struct flash_cache_entry cache[CACHE_ENTRIES];
+static u32_t cache_stamp;
 
 /* calculate number of blocks required for a given size */
 #define GET_NUM_BLOCK(total_size, block_size) \
 	((total_size + block_size - 1) / block_size)
 
-#define GET_SIZE_TO_BOUNDARY(start, block_size) \
-	(block_size - (start & (block_size - 1)))
+static inline bool sector_test(const u32_t *map, u32_t sector)
+{
+	return (map[sector / 32] & BIT(sector % 32)) != 0;
+}
+
+static inline void sector_set(u32_t *map, u32_t sector)
+{
+	map[sector / 32] |= BIT(sector % 32);
+}
+
+static bool sectors_any(const u32_t *map)
+{
+	for (int i = 0; i < ceiling_fraction(BLOCK_SECTORS, 32); i++) {
+		if (map[i]) {
+			return true;
+		}
+	}
+
+	return false;
+}
 
 static off_t lba_to_address(u32_t sector_num)
 {
@@ -64,23 +100,16 @@ static int disk_flash_access_init(struct disk_info *disk)
 	return 0;
 }
 
-static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
-				u32_t start_sector, u32_t sector_count)
+static int read_flash(off_t fl_addr, u8_t *buff, u32_t size)
 {
-	off_t fl_addr;
-	u32_t remaining;
-	u32_t len;
+	u32_t len = CONFIG_DISK_FLASH_MAX_RW_SIZE;
 	u32_t num_read;
 
-	fl_addr = lba_to_address(start_sector);
-	remaining = (sector_count * SECTOR_SIZE);
-	len = CONFIG_DISK_FLASH_MAX_RW_SIZE;
-
-	num_read = GET_NUM_BLOCK(remaining, CONFIG_DISK_FLASH_MAX_RW_SIZE);
+	num_read = GET_NUM_BLOCK(size, CONFIG_DISK_FLASH_MAX_RW_SIZE);
 
 	for (u32_t i = 0; i < num_read; i++) {
-		if (remaining < CONFIG_DISK_FLASH_MAX_RW_SIZE) {
-			len = remaining;
+		if (size < CONFIG_DISK_FLASH_MAX_RW_SIZE) {
+			len = size;
 		}
 
 		if (flash_read(flash_dev, fl_addr, buff, len) != 0) {
@@ -89,75 +118,50 @@ static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
 
 		fl_addr += len;
 		buff += len;
-		remaining -= len;
+		size -= len;
 	}
 
 	return 0;
 }
 
-/* This performs read-copy into an output buffer */
-static int read_copy_flash_block(off_t start_addr, u32_t size,
-				 const void *src_buff,
-				 u8_t *dest_buff)
+/*
+ * Write a cached block back to flash: read the sectors of the block that
+ * were not written, erase the block and write it in full. Writes to any
+ * number of sectors of the block take a single erase.
+ */
+static int flash_cache_flush(struct flash_cache_entry *entry)
 {
-	off_t fl_addr;
-	u32_t num_read;
-	u32_t offset = 0U;
+	off_t fl_addr = entry->addr;
+	u8_t *src = entry->buf;
+	u32_t num_write;
+	u32_t start;
+	u32_t end;
 
-	/* adjust offset if starting address is not erase-aligned address */
-	if (start_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1)) {
-		offset = start_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1);
+	if (!entry->used || !sectors_any(entry->dirty)) {
+		return 0;
 	}
 
-	/* align starting address to an aligned address for flash erase-write */
-	fl_addr = ROUND_DOWN(start_addr, CONFIG_DISK_FLASH_ERASE_ALIGNMENT);
-
-	num_read = GET_NUM_BLOCK(CONFIG_DISK_ERASE_BLOCK_SIZE,
-				 CONFIG_DISK_FLASH_MAX_RW_SIZE);
-
-	/* read one block from flash */
-	for (u32_t i = 0; i < num_read; i++) {
-		int rc;
-
-		rc = flash_read(flash_dev,
-				fl_addr + (CONFIG_DISK_FLASH_MAX_RW_SIZE * i),
-				dest_buff + (CONFIG_DISK_FLASH_MAX_RW_SIZE * i),
-				CONFIG_DISK_FLASH_MAX_RW_SIZE);
-		if (rc != 0) {
-			return -EIO;
+	/* read-copy the sectors that were not written, a run at a time */
+	for (start = 0U; start < BLOCK_SECTORS; start = end) {
+		if (sector_test(entry->valid, start)) {
+			end = start + 1;
+			continue;
 		}
-	}
-
-	/* overwrite with user data */
-	memcpy(dest_buff + offset, src_buff, size);
-
-	return 0;
-}
-
-/* input size is either less or equal to a block size,
- * CONFIG_DISK_ERASE_BLOCK_SIZE.
- */
-static int update_flash_block(off_t start_addr, u32_t size, const void *buff)
-{
-	off_t fl_addr;
-	u8_t *src = (u8_t *)buff;
-	u32_t num_write;
 
-	/* if size is a partial block, perform read-copy with user data */
-	if (size < CONFIG_DISK_ERASE_BLOCK_SIZE) {
-		int rc;
+		for (end = start + 1; end < BLOCK_SECTORS; end++) {
+			if (sector_test(entry->valid, end)) {
+				break;
+			}
+		}
 
-		rc = read_copy_flash_block(start_addr, size, buff, fs_buff);
-		if (rc != 0) {
+		if (read_flash(fl_addr + start * SECTOR_SIZE,
+			       &entry->buf[start * SECTOR_SIZE],
+			       (end - start) * SECTOR_SIZE) != 0) {
 			return -EIO;
 		}
-
-		/* now use the local buffer as the source */
-		src = (u8_t *)fs_buff;
 	}
 
-	/* always align starting address for flash write operation */
-	fl_addr = ROUND_DOWN(start_addr, CONFIG_DISK_FLASH_ERASE_ALIGNMENT);
+	memset(entry->valid, 0xff, sizeof(entry->valid));
 
 	/* disable write-protection first before erase */
 	flash_write_protection_set(flash_dev, false);
@@ -183,73 +187,130 @@ static int update_flash_block(off_t start_addr, u32_t size, const void *buff)
 		src += CONFIG_DISK_FLASH_MAX_RW_SIZE;
 	}
 
+	memset(entry->dirty, 0, sizeof(entry->dirty));
+
+	return 0;
+}
+
+static int flash_cache_sync(void)
+{
+	int rc = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (flash_cache_flush(&cache[i]) != 0) {
+			rc = -EIO;
+		}
+	}
+
+	return rc;
+}
+
+/* Get the entry of a block, evicting the least recently written one if
+ * the block is not cached.
+ */
+static struct flash_cache_entry *flash_cache_get(off_t addr)
+{
+	struct flash_cache_entry *entry = NULL;
+
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		if (cache[i].used && cache[i].addr == addr) {
+			return &cache[i];
+		}
+
+		if (!entry || (entry->used &&
+			       (!cache[i].used ||
+				(s32_t)(cache[i].stamp - entry->stamp) < 0))) {
+			entry = &cache[i];
+		}
+	}
+
+	if (flash_cache_flush(entry) != 0) {
+		return NULL;
+	}
+
+	entry->addr = addr;
+	entry->used = true;
+	memset(entry->dirty, 0, sizeof(entry->dirty));
+	memset(entry->valid, 0, sizeof(entry->valid));
+
+	return entry;
+}
+
+static int disk_flash_access_read(struct disk_info *disk, u8_t *buff,
+				u32_t start_sector, u32_t sector_count)
+{
+	off_t fl_addr;
+	u32_t size;
+
+	fl_addr = lba_to_address(start_sector);
+	size = (sector_count * SECTOR_SIZE);
+
+	if (read_flash(fl_addr, buff, size) != 0) {
+		return -EIO;
+	}
+
+	/* sectors that were written but not synced yet are in the cache */
+	for (int i = 0; i < ARRAY_SIZE(cache); i++) {
+		struct flash_cache_entry *entry = &cache[i];
+		off_t start = MAX(fl_addr, entry->addr);
+		off_t end = MIN(fl_addr + size,
+				entry->addr + CONFIG_DISK_ERASE_BLOCK_SIZE);
+
+		if (!entry->used) {
+			continue;
+		}
+
+		for (; start < end; start += SECTOR_SIZE) {
+			if (sector_test(entry->dirty,
+					(start - entry->addr) / SECTOR_SIZE)) {
+				memcpy(&buff[start - fl_addr],
+				       &entry->buf[start - entry->addr],
+				       SECTOR_SIZE);
+			}
+		}
+	}
+
 	return 0;
 }
 
 static int disk_flash_access_write(struct disk_info *disk, const u8_t *buff,
 				 u32_t start_sector, u32_t sector_count)
 {
+	struct flash_cache_entry *entry;
 	off_t fl_addr;
 	u32_t remaining;
+	u32_t offset;
 	u32_t size;
 
 	fl_addr = lba_to_address(start_sector);
 	remaining = (sector_count * SECTOR_SIZE);
 
-	/* check if start address is erased-aligned address  */
-	if (fl_addr & (CONFIG_DISK_FLASH_ERASE_ALIGNMENT - 1)) {
-		off_t block_bnd;
-
-		/* not aligned */
-		/* check if the size goes over flash block boundary */
-		block_bnd = fl_addr + CONFIG_DISK_ERASE_BLOCK_SIZE;
-		block_bnd = block_bnd & ~(CONFIG_DISK_ERASE_BLOCK_SIZE - 1);
-		if ((fl_addr + remaining) < block_bnd) {
-			/* not over block boundary (a partial block also) */
-			if (update_flash_block(fl_addr, remaining, buff) != 0) {
-				return -EIO;
-			}
-			return 0;
+	while (remaining) {
+		entry = flash_cache_get(ROUND_DOWN(fl_addr,
+					CONFIG_DISK_FLASH_ERASE_ALIGNMENT));
+		if (!entry) {
+			return -EIO;
 		}
 
-		/* write goes over block boundary */
-		size = GET_SIZE_TO_BOUNDARY(fl_addr,
-						CONFIG_DISK_ERASE_BLOCK_SIZE);
+		/* copy up to the end of the block */
+		offset = fl_addr - entry->addr;
+		size = MIN(remaining, CONFIG_DISK_ERASE_BLOCK_SIZE - offset);
+		memcpy(&entry->buf[offset], buff, size);
 
-		/* write first partial block */
-		if (update_flash_block(fl_addr, size, buff) != 0) {
-			return -EIO;
+		for (u32_t sector = offset / SECTOR_SIZE;
+		     sector < (offset + size) / SECTOR_SIZE; sector++) {
+			sector_set(entry->dirty, sector);
+			sector_set(entry->valid, sector);
 		}
+		entry->stamp = ++cache_stamp;
 
 		fl_addr += size;
 		remaining -= size;
 		buff += size;
 	}
 
-	/* start is an erase-aligned address */
-	while (remaining) {
-		int rc;
-
-		if (remaining < CONFIG_DISK_ERASE_BLOCK_SIZE) {
-			break;
-		}
-
-		rc = update_flash_block(fl_addr, CONFIG_DISK_ERASE_BLOCK_SIZE,
-					 buff);
-		if (rc != 0) {
-			return -EIO;
-		}
-
-		fl_addr += CONFIG_DISK_ERASE_BLOCK_SIZE;
-		remaining -= CONFIG_DISK_ERASE_BLOCK_SIZE;
-		buff += CONFIG_DISK_ERASE_BLOCK_SIZE;
-	}
-
-	/* remaining partial block */
-	if (remaining) {
-		if (update_flash_block(fl_addr, remaining, buff) != 0) {
-			return -EIO;
-		}
+	if (CONFIG_DISK_FLASH_CACHE_BLOCKS == 0) {
+		return flash_cache_sync();
 	}
 
 	return 0;
@@ -259,7 +320,7 @@ static int disk_flash_access_ioctl(struct disk_info *disk, u8_t cmd, void *buff)
 {
 	switch (cmd) {
 	case DISK_IOCTL_CTRL_SYNC:
-		return 0;
+		return flash_cache_sync();
 	case DISK_IOCTL_GET_SECTOR_COUNT:
 		*(u32_t *)buff = CONFIG_DISK_VOLUME_SIZE / SECTOR_SIZE;
 		return 0;
@@ -26,6 +26,34 @@ static inline size_t nvs_al_size(struct nvs_fs *fs, size_t len)
 	}
 	return (len + (fs->write_block_size - 1U)) & ~(fs->write_block_size - 1U);
 }
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* nvs_lookup_cache_pos returns the lookup cache entry of id */
+static inline size_t nvs_lookup_cache_pos(u16_t id)
+{
+	u32_t hash = id;
+
+	/* mix the bits so that ids with a common stride spread evenly */
+	hash ^= hash >> 8;
+	hash *= 0x88b5U;
+	hash ^= (hash & 0xffff) >> 7;
+
+	return (hash & 0xffff) % CONFIG_NVS_LOOKUP_CACHE_SIZE;
+}
+
+/* drop the cache entries pointing into a sector that has been erased */
+static void nvs_lookup_cache_invalidate(struct nvs_fs *fs, u32_t sector)
+{
+	u32_t *cache_entry = fs->lookup_cache;
+	u32_t *const cache_end = &fs->lookup_cache[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+
+	for (; cache_entry < cache_end; ++cache_entry) {
+		if ((*cache_entry >> ADDR_SECT_SHIFT) == sector) {
+			*cache_entry = NVS_LOOKUP_CACHE_NO_ADDR;
+		}
+	}
+}
+#endif
 /* end basic routines */
 
 /* flash routines */
@@ -103,6 +131,12 @@ static int nvs_flash_ate_wrt(struct nvs_fs *fs, const struct nvs_ate *entry)
 
 	rc = nvs_flash_al_wrt(fs, fs->ate_wra, entry,
 			       sizeof(struct nvs_ate));
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	/* 0xFFFF is the id of the sector close ate, it is not cached */
+	if (entry->id != 0xFFFF) {
+		fs->lookup_cache[nvs_lookup_cache_pos(entry->id)] = fs->ate_wra;
+	}
+#endif
 	fs->ate_wra -= nvs_al_size(fs, sizeof(struct nvs_ate));
 
 	return rc;
@@ -242,6 +276,9 @@ static int nvs_flash_erase_sector(struct nvs_fs *fs, u32_t addr)
 		/* flash erase error */
 		return rc;
 	}
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	nvs_lookup_cache_invalidate(fs, addr >> ADDR_SECT_SHIFT);
+#endif
 	(void) flash_write_protection_set(fs->flash_device, 1);
 	return 0;
 }
@@ -397,6 +434,55 @@ static int nvs_prev_ate(struct nvs_fs *fs, u32_t *addr, struct nvs_ate *ate)
 	return 0;
 }
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+/* build the lookup cache by walking all ate's from newest to oldest, the
+ * first valid ate found for a cache entry is the most recent one.
+ */
+static int nvs_lookup_cache_rebuild(struct nvs_fs *fs)
+{
+	int rc;
+	u32_t addr, ate_addr, *cache_entry;
+	struct nvs_ate ate;
+
+	(void)memset(fs->lookup_cache, 0xff, sizeof(fs->lookup_cache));
+	addr = fs->ate_wra;
+
+	while (1) {
+		ate_addr = addr;
+		rc = nvs_prev_ate(fs, &addr, &ate);
+		if (rc) {
+			return rc;
+		}
+
+		cache_entry = &fs->lookup_cache[nvs_lookup_cache_pos(ate.id)];
+		if ((ate.id != 0xFFFF) &&
+		    (*cache_entry == NVS_LOOKUP_CACHE_NO_ADDR) &&
+		    (!nvs_ate_crc8_check(&ate))) {
+			*cache_entry = ate_addr;
+		}
+
+		if (addr == fs->ate_wra) {
+			break;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+/* nvs_find_start returns the address from which to walk back to find
+ * the most recent ate of id, or NVS_LOOKUP_CACHE_NO_ADDR when the id
+ * is known not to be stored.
+ */
+static u32_t nvs_find_start(struct nvs_fs *fs, u16_t id)
+{
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	return fs->lookup_cache[nvs_lookup_cache_pos(id)];
+#else
+	return fs->ate_wra;
+#endif
+}
+
 static void nvs_sector_advance(struct nvs_fs *fs, u32_t *addr)
 {
 	*addr += (1 << ADDR_SECT_SHIFT);
@@ -664,6 +750,10 @@ static int nvs_startup(struct nvs_fs *fs)
 		}
 	}
 
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	rc = nvs_lookup_cache_rebuild(fs);
+#endif
+
 end:
 	k_mutex_unlock(&fs->nvs_lock);
 	return rc;
@@ -774,10 +864,10 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 	}
 
 	/* find latest entry with same id */
-	wlk_addr = fs->ate_wra;
+	wlk_addr = nvs_find_start(fs, id);
 	rd_addr = wlk_addr;
 
-	while (1) {
+	while (wlk_addr != NVS_LOOKUP_CACHE_NO_ADDR) {
 		rd_addr = wlk_addr;
 		rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
 		if (rc) {
@@ -892,7 +982,11 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 
 	cnt_his = 0U;
 
-	wlk_addr = fs->ate_wra;
+	wlk_addr = nvs_find_start(fs, id);
+	if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+		return -ENOENT;
+	}
+
 	rd_addr = wlk_addr;
 
 	while (cnt_his <= cnt) {
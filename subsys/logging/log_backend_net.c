@@ -187,7 +187,9 @@ static void send_output(const struct log_backend *const backend,
 			       LOG_OUTPUT_FLAG_FORMAT_SYSLOG |
 			       LOG_OUTPUT_FLAG_TIMESTAMP |
 			(IS_ENABLED(CONFIG_LOG_BACKEND_NET_SYST_ENABLE) ?
-			LOG_OUTPUT_FLAG_FORMAT_SYST : 0));
+			LOG_OUTPUT_FLAG_FORMAT_SYST : 0) |
+			(IS_ENABLED(CONFIG_LOG_BACKEND_NET_DICT_ENABLE) ?
+			LOG_OUTPUT_FLAG_FORMAT_DICT : 0));
 
 	log_msg_put(msg);
 }
@@ -221,7 +223,9 @@ static void sync_string(const struct log_backend *const backend,
 	u32_t flags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_FORMAT_SYSLOG |
 		LOG_OUTPUT_FLAG_TIMESTAMP |
 		(IS_ENABLED(CONFIG_LOG_BACKEND_NET_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0);
+		LOG_OUTPUT_FLAG_FORMAT_SYST : 0) |
+		(IS_ENABLED(CONFIG_LOG_BACKEND_NET_DICT_ENABLE) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0);
 	u32_t key;
 
 	if (!net_init_done && do_net_init() == 0) {
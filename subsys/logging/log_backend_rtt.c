@@ -8,6 +8,7 @@
 #include <logging/log_core.h>
 #include <logging/log_msg.h>
 #include <logging/log_output.h>
+#include <logging/log_output_dict.h>
 #include "log_backend_std.h"
 #include <SEGGER_RTT.h>
 
@@ -224,6 +225,9 @@ static void put(const struct log_backend *const backend,
 	u32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_RTT_SYST_ENABLE) ?
 		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
 
+	flag |= IS_ENABLED(CONFIG_LOG_BACKEND_RTT_DICT_ENABLE) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0;
+
 	log_backend_std_put(&log_output, flag, msg);
 }
 
@@ -255,7 +259,11 @@ static void dropped(const struct log_backend *const backend, u32_t cnt)
 {
 	ARG_UNUSED(backend);
 
-	log_backend_std_dropped(&log_output, cnt);
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_RTT_DICT_ENABLE)) {
+		log_output_dropped_dict_process(&log_output, cnt);
+	} else {
+		log_backend_std_dropped(&log_output, cnt);
+	}
 }
 
 static void sync_string(const struct log_backend *const backend,
@@ -265,6 +273,9 @@ static void sync_string(const struct log_backend *const backend,
 	u32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_RTT_SYST_ENABLE) ?
 		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
 
+	flag |= IS_ENABLED(CONFIG_LOG_BACKEND_RTT_DICT_ENABLE) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0;
+
 	log_backend_std_sync_string(&log_output, flag, src_level,
 				    timestamp, fmt, ap);
 }
@@ -276,6 +287,9 @@ static void sync_hexdump(const struct log_backend *const backend,
 	u32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_RTT_SYST_ENABLE) ?
 		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
 
+	flag |= IS_ENABLED(CONFIG_LOG_BACKEND_RTT_DICT_ENABLE) ?
+		LOG_OUTPUT_FLAG_FORMAT_DICT : 0;
+
 	log_backend_std_sync_hexdump(&log_output, flag, src_level,
 				     timestamp, metadata, data, length);
 }
@@ -40,10 +40,266 @@ BUILD_ASSERT_MSG((sizeof(union log_msg_head_data) ==
 #define MSG_SIZE sizeof(union log_msg_chunk)
 #define NUM_OF_MSGS (CONFIG_LOG_BUFFER_SIZE / MSG_SIZE)
 
-struct k_mem_slab log_msg_pool;
 static u8_t __noinit __aligned(sizeof(void *))
 		log_msg_pool_buf[CONFIG_LOG_BUFFER_SIZE];
 
+#ifdef CONFIG_LOG_MSG_PACKED
+
+/* Messages are variable length records allocated in order from
+ * log_msg_pool_buf used as a byte ring. A record starts with a word
+ * holding its length in bytes and a busy bit, followed by the message:
+ * arguments and then the strings duplicated with log_strdup() for a
+ * standard message, data and then the metadata string for a hexdump.
+ * A record freed out of order is only marked free; its space is
+ * reclaimed once all older records are free. When a record does not
+ * fit before the end of the buffer, the rest of the buffer becomes a
+ * free padding record.
+ */
+#define REC_HDR_SIZE sizeof(uintptr_t)
+#define REC_BUSY BIT(0)
+#define POOL_SIZE ROUND_DOWN(CONFIG_LOG_BUFFER_SIZE, REC_HDR_SIZE)
+
+static struct k_spinlock pool_lock;
+static u32_t pool_wr;
+static u32_t pool_rd;
+static u32_t pool_used;
+
+static inline uintptr_t *rec_hdr(u32_t off)
+{
+	return (uintptr_t *)&log_msg_pool_buf[off];
+}
+
+static inline log_arg_t *packed_args(struct log_msg *msg)
+{
+	return (log_arg_t *)&msg->payload;
+}
+
+static inline u8_t *packed_bytes(struct log_msg *msg)
+{
+	return (u8_t *)&msg->payload;
+}
+
+static struct log_msg *rec_alloc(size_t size)
+{
+	u32_t len = ROUND_UP(REC_HDR_SIZE + size, REC_HDR_SIZE);
+	k_spinlock_key_t key = k_spin_lock(&pool_lock);
+	struct log_msg *msg = NULL;
+	u32_t off;
+
+	if (pool_used == 0U) {
+		pool_wr = 0U;
+		pool_rd = 0U;
+	}
+	off = pool_wr;
+
+	if ((pool_used < POOL_SIZE) && (off >= pool_rd)) {
+		if (len > (POOL_SIZE - off)) {
+			if (len > pool_rd) {
+				goto out;
+			}
+			*rec_hdr(off) = POOL_SIZE - off;
+			pool_used += POOL_SIZE - off;
+			off = 0U;
+		}
+	} else if (len > (pool_rd - off)) {
+		goto out;
+	}
+
+	*rec_hdr(off) = len | REC_BUSY;
+	pool_used += len;
+	pool_wr = off + len;
+	if (pool_wr == POOL_SIZE) {
+		pool_wr = 0U;
+	}
+	msg = (struct log_msg *)&log_msg_pool_buf[off + REC_HDR_SIZE];
+out:
+	k_spin_unlock(&pool_lock, key);
+
+	return msg;
+}
+
+static void rec_free(struct log_msg *msg)
+{
+	uintptr_t *hdr = (uintptr_t *)((u8_t *)msg - REC_HDR_SIZE);
+	k_spinlock_key_t key = k_spin_lock(&pool_lock);
+
+	*hdr &= ~REC_BUSY;
+
+	while ((pool_used > 0U) && ((*rec_hdr(pool_rd) & REC_BUSY) == 0U)) {
+		u32_t len = *rec_hdr(pool_rd);
+
+		pool_used -= len;
+		pool_rd += len;
+		if (pool_rd == POOL_SIZE) {
+			pool_rd = 0U;
+		}
+	}
+
+	k_spin_unlock(&pool_lock, key);
+}
+
+static struct log_msg *msg_alloc(size_t size)
+{
+	struct log_msg *msg = rec_alloc(size);
+	bool more;
+
+	if (msg == NULL) {
+		if (IS_ENABLED(CONFIG_LOG_MODE_OVERFLOW)) {
+			do {
+				more = log_process(true);
+				log_dropped();
+				msg = rec_alloc(size);
+			} while ((msg == NULL) && more);
+		} else {
+			log_dropped();
+		}
+	}
+
+	if (msg != NULL) {
+		/* all fields reset to 0, reference counter to 1 */
+		msg->hdr.ref_cnt = 1;
+		msg->hdr.params.raw = 0U;
+	}
+
+	return msg;
+}
+
+void log_msg_pool_init(void)
+{
+	pool_wr = 0U;
+	pool_rd = 0U;
+	pool_used = 0U;
+}
+
+static void msg_free(struct log_msg *msg)
+{
+	/* Transient strings were copied into the record on creation. */
+	rec_free(msg);
+}
+
+log_arg_t log_msg_arg_get(struct log_msg *msg, u32_t arg_idx)
+{
+	/* Return early if requested argument not present in the message. */
+	if (arg_idx >= msg->hdr.params.std.nargs) {
+		return 0;
+	}
+
+	return packed_args(msg)[arg_idx];
+}
+
+struct log_msg *log_msg_create_n(const char *str, log_arg_t *args, u32_t nargs)
+{
+	size_t size = offsetof(struct log_msg, payload) +
+		      nargs * sizeof(log_arg_t);
+	struct log_msg *msg;
+	char *tail;
+
+	__ASSERT_NO_MSG(nargs < LOG_MAX_NARGS);
+
+	for (int i = 0; i < nargs; i++) {
+		if (log_is_strdup((void *)args[i])) {
+			size += strlen((const char *)args[i]) + 1;
+		}
+	}
+
+	msg = msg_alloc(size);
+	if (msg != NULL) {
+		msg->str = str;
+		msg->hdr.params.std.nargs = nargs;
+		tail = (char *)&packed_args(msg)[nargs];
+	}
+
+	/* Inline duplicated strings, so their buffers are released right
+	 * away instead of when the message is processed.
+	 */
+	for (int i = 0; i < nargs; i++) {
+		log_arg_t arg = args[i];
+
+		if (log_is_strdup((void *)arg)) {
+			if (msg != NULL) {
+				size_t len = strlen((const char *)arg) + 1;
+
+				(void)memcpy(tail, (const char *)arg, len);
+				arg = (log_arg_t)tail;
+				tail += len;
+			}
+			log_free((void *)args[i]);
+		}
+
+		if (msg != NULL) {
+			packed_args(msg)[i] = arg;
+		}
+	}
+
+	return msg;
+}
+
+struct log_msg *log_msg_hexdump_create(const char *str,
+				       const u8_t *data,
+				       u32_t length)
+{
+	size_t str_len = 0;
+	struct log_msg *msg;
+
+	/* Saturate length. */
+	length = (length > LOG_MSG_HEXDUMP_MAX_LENGTH) ?
+		 LOG_MSG_HEXDUMP_MAX_LENGTH : length;
+
+	/* Metadata comes from log_strdup() for user mode hexdumps. */
+	if (log_is_strdup(str)) {
+		str_len = strlen(str) + 1;
+	}
+
+	msg = msg_alloc(offsetof(struct log_msg, payload) + length + str_len);
+	if (msg != NULL) {
+		msg->hdr.params.hexdump.type = LOG_MSG_TYPE_HEXDUMP;
+		msg->hdr.params.hexdump.length = length;
+		(void)memcpy(packed_bytes(msg), data, length);
+		msg->str = str;
+
+		if (str_len != 0) {
+			char *dup = (char *)&packed_bytes(msg)[length];
+
+			(void)memcpy(dup, str, str_len);
+			msg->str = dup;
+		}
+	}
+
+	if (str_len != 0) {
+		log_free((void *)str);
+	}
+
+	return msg;
+}
+
+static void log_msg_hexdump_data_op(struct log_msg *msg,
+				    u8_t *data,
+				    size_t *length,
+				    size_t offset,
+				    bool put_op)
+{
+	u32_t available_len = msg->hdr.params.hexdump.length;
+
+	if (offset >= available_len) {
+		*length = 0;
+		return;
+	}
+
+	if ((offset + *length) > available_len) {
+		*length = available_len - offset;
+	}
+
+	if (put_op) {
+		(void)memcpy(&packed_bytes(msg)[offset], data, *length);
+	} else {
+		(void)memcpy(data, &packed_bytes(msg)[offset], *length);
+	}
+}
+
+#else /* !CONFIG_LOG_MSG_PACKED */
+
+struct k_mem_slab log_msg_pool;
+
 void log_msg_pool_init(void)
 {
 	k_mem_slab_init(&log_msg_pool, log_msg_pool_buf, MSG_SIZE, NUM_OF_MSGS);
@@ -85,11 +341,6 @@ union log_msg_chunk *log_msg_chunk_alloc(void)
 	return msg;
 }
 
-void log_msg_get(struct log_msg *msg)
-{
-	atomic_inc(&msg->hdr.ref_cnt);
-}
-
 static void cont_free(struct log_msg_cont *cont)
 {
 	struct log_msg_cont *next;
@@ -156,19 +407,6 @@ union log_msg_chunk *log_msg_no_space_handle(void)
 	return msg;
 
 }
-void log_msg_put(struct log_msg *msg)
-{
-	atomic_dec(&msg->hdr.ref_cnt);
-
-	if (msg->hdr.ref_cnt == 0) {
-		msg_free(msg);
-	}
-}
-
-u32_t log_msg_nargs_get(struct log_msg *msg)
-{
-	return msg->hdr.params.std.nargs;
-}
 
 static log_arg_t cont_arg_get(struct log_msg *msg, u32_t arg_idx)
 {
@@ -178,7 +416,6 @@ static log_arg_t cont_arg_get(struct log_msg *msg, u32_t arg_idx)
 		return msg->payload.ext.data.args[arg_idx];
 	}
 
-
 	cont = msg->payload.ext.next;
 	arg_idx -= LOG_MSG_NARGS_HEAD_CHUNK;
 
@@ -208,11 +445,6 @@ log_arg_t log_msg_arg_get(struct log_msg *msg, u32_t arg_idx)
 	return arg;
 }
 
-const char *log_msg_str_get(struct log_msg *msg)
-{
-	return msg->str;
-}
-
 /** @brief Allocate chunk for extended standard log message.
  *
  *  @details Extended standard log message is used when number of arguments
@@ -324,7 +556,6 @@ struct log_msg *log_msg_hexdump_create(const char *str,
 	msg->hdr.params.hexdump.length = length;
 	msg->str = str;
 
-
 	if (length > LOG_MSG_HEXDUMP_BYTES_SINGLE_CHUNK) {
 		(void)memcpy(msg->payload.ext.data.bytes,
 		       data,
@@ -441,6 +672,37 @@ static void log_msg_hexdump_data_op(struct log_msg *msg,
 	}
 }
 
+#endif /* CONFIG_LOG_MSG_PACKED */
+
+bool log_msg_pool_contains(const void *buf)
+{
+	return PART_OF_ARRAY(log_msg_pool_buf, (u8_t *)buf);
+}
+
+void log_msg_get(struct log_msg *msg)
+{
+	atomic_inc(&msg->hdr.ref_cnt);
+}
+
+void log_msg_put(struct log_msg *msg)
+{
+	atomic_dec(&msg->hdr.ref_cnt);
+
+	if (msg->hdr.ref_cnt == 0) {
+		msg_free(msg);
+	}
+}
+
+u32_t log_msg_nargs_get(struct log_msg *msg)
+{
+	return msg->hdr.params.std.nargs;
+}
+
+const char *log_msg_str_get(struct log_msg *msg)
+{
+	return msg->str;
+}
+
 void log_msg_hexdump_data_put(struct log_msg *msg,
 			      u8_t *data,
 			      size_t *length,
@@ -5,6 +5,7 @@
  */
 
 #include <logging/log_output.h>
+#include <logging/log_output_dict.h>
 #include <logging/log_ctrl.h>
 #include <logging/log.h>
 #include <assert.h>
@@ -528,6 +529,12 @@ void log_output_msg_process(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_msg_dict_process(log_output, msg, flags);
+		return;
+	}
+
 	prefix_offset = raw_string ?
 			0 : prefix_print(log_output, flags, std_msg, timestamp,
 					 level, domain_id, source_id);
@@ -576,6 +583,13 @@ void log_output_string(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_string_dict_process(log_output, src_level,
+				timestamp, fmt, ap, flags);
+		return;
+	}
+
 	if (!raw_string) {
 		prefix_print(log_output, flags, true, timestamp,
 				level, domain_id, source_id);
@@ -619,6 +633,13 @@ void log_output_hexdump(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_hexdump_dict_process(log_output, src_level,
+				timestamp, metadata, data, length, flags);
+		return;
+	}
+
 	prefix_offset = prefix_print(log_output, flags, true, timestamp,
 				     level, domain_id, source_id);
 
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+#include <logging/log_ctrl.h>
+#include <logging/log_output.h>
+#include <logging/log_output_dict.h>
+#include <string.h>
+
+/* Dictionary output writes records of raw binary values in target byte
+ * order. Format and metadata strings are sent as their addresses and
+ * resolved on the host from the database generated from the ELF file,
+ * see scripts/logging/dictionary. Only %s arguments which are not in
+ * read only memory are sent as strings.
+ */
+
+static void dict_write(const struct log_output *log_output,
+		       const void *data, size_t len)
+{
+	const u8_t *src = data;
+
+	while (len > 0) {
+		size_t offset = log_output->control_block->offset;
+		size_t part = MIN(len, log_output->size - offset);
+
+		(void)memcpy(&log_output->buf[offset], src, part);
+		log_output->control_block->offset += part;
+		src += part;
+		len -= part;
+
+		if (log_output->control_block->offset == log_output->size) {
+			log_output_flush(log_output);
+		}
+	}
+}
+
+static void dict_write_str(const struct log_output *log_output,
+			   const char *str)
+{
+	dict_write(log_output, str, strlen(str) + 1);
+}
+
+static void hdr_write(const struct log_output *log_output, u8_t type,
+		      struct log_msg_ids src_level, u32_t timestamp)
+{
+	struct log_dict_hdr hdr = {
+		.magic = LOG_DICT_MAGIC,
+		.ids = LOG_DICT_IDS(type, src_level.level, src_level.domain_id),
+		.source_id = src_level.source_id,
+		.timestamp = timestamp,
+	};
+
+	dict_write(log_output, &hdr, sizeof(hdr));
+}
+
+static void args_write(const struct log_output *log_output, const char *fmt,
+		       log_arg_t *args, u32_t nargs)
+{
+	u32_t mask = z_log_get_s_mask(fmt, nargs);
+	u8_t nstr = 0U;
+	u8_t n = nargs;
+
+	dict_write(log_output, &fmt, sizeof(fmt));
+	dict_write(log_output, &n, sizeof(n));
+	dict_write(log_output, args, nargs * sizeof(log_arg_t));
+
+	for (u32_t m = mask; m != 0U; m &= m - 1U) {
+		const char *str = (const char *)args[__builtin_ctz(m)];
+
+		if (!z_log_is_rodata(str)) {
+			nstr++;
+		}
+	}
+
+	dict_write(log_output, &nstr, sizeof(nstr));
+
+	for (; mask != 0U; mask &= mask - 1U) {
+		u8_t idx = __builtin_ctz(mask);
+		const char *str = (const char *)args[idx];
+
+		if (!z_log_is_rodata(str)) {
+			dict_write(log_output, &idx, sizeof(idx));
+			dict_write_str(log_output, str);
+		}
+	}
+}
+
+static void hexdump_write(const struct log_output *log_output,
+			  const char *metadata, u32_t length)
+{
+	u8_t inline_str = (metadata != NULL) && !z_log_is_rodata(metadata);
+	u16_t len = length;
+
+	dict_write(log_output, &inline_str, sizeof(inline_str));
+	if (inline_str) {
+		dict_write_str(log_output, metadata);
+	} else {
+		dict_write(log_output, &metadata, sizeof(metadata));
+	}
+	dict_write(log_output, &len, sizeof(len));
+}
+
+void log_output_msg_dict_process(const struct log_output *log_output,
+				 struct log_msg *msg, u32_t flags)
+{
+	struct log_msg_ids src_level = {
+		.level = log_msg_level_get(msg),
+		.domain_id = log_msg_domain_id_get(msg),
+		.source_id = log_msg_source_id_get(msg),
+	};
+
+	if (log_msg_is_std(msg)) {
+		log_arg_t args[LOG_MAX_NARGS];
+		u32_t nargs = log_msg_nargs_get(msg);
+
+		for (int i = 0; i < nargs; i++) {
+			args[i] = log_msg_arg_get(msg, i);
+		}
+
+		hdr_write(log_output, LOG_DICT_TYPE_STD, src_level,
+			  log_msg_timestamp_get(msg));
+		args_write(log_output, log_msg_str_get(msg), args, nargs);
+	} else {
+		u8_t buf[16];
+		size_t offset = 0;
+		size_t len;
+
+		hdr_write(log_output, LOG_DICT_TYPE_HEXDUMP, src_level,
+			  log_msg_timestamp_get(msg));
+		hexdump_write(log_output, log_msg_str_get(msg),
+			      msg->hdr.params.hexdump.length);
+
+		do {
+			len = sizeof(buf);
+			log_msg_hexdump_data_get(msg, buf, &len, offset);
+			dict_write(log_output, buf, len);
+			offset += len;
+		} while (len > 0);
+	}
+
+	log_output_flush(log_output);
+}
+
+void log_output_string_dict_process(const struct log_output *log_output,
+				    struct log_msg_ids src_level,
+				    u32_t timestamp, const char *fmt,
+				    va_list ap, u32_t flags)
+{
+	log_arg_t args[LOG_MAX_NARGS];
+	u32_t nargs = 0U;
+	bool arm = false;
+
+	/* Same argument count as log_generic() uses for deferred mode */
+	for (const char *c = fmt; *c != '\0'; c++) {
+		if (*c == '%') {
+			arm = !arm;
+		} else if (arm) {
+			arm = false;
+			if (nargs < LOG_MAX_NARGS) {
+				args[nargs++] = va_arg(ap, log_arg_t);
+			}
+		}
+	}
+
+	hdr_write(log_output, LOG_DICT_TYPE_STD, src_level, timestamp);
+	args_write(log_output, fmt, args, nargs);
+	log_output_flush(log_output);
+}
+
+void log_output_hexdump_dict_process(const struct log_output *log_output,
+				     struct log_msg_ids src_level,
+				     u32_t timestamp, const char *metadata,
+				     const u8_t *data, u32_t length,
+				     u32_t flags)
+{
+	length = MIN(length, LOG_MSG_HEXDUMP_MAX_LENGTH);
+
+	hdr_write(log_output, LOG_DICT_TYPE_HEXDUMP, src_level, timestamp);
+	hexdump_write(log_output, metadata, length);
+	dict_write(log_output, data, length);
+	log_output_flush(log_output);
+}
+
+void log_output_dropped_dict_process(const struct log_output *log_output,
+				     u32_t cnt)
+{
+	struct log_msg_ids src_level = { 0 };
+
+	hdr_write(log_output, LOG_DICT_TYPE_DROPPED, src_level, 0);
+	dict_write(log_output, &cnt, sizeof(cnt));
+	log_output_flush(log_output);
+}
@@ -59,6 +59,92 @@ static struct net_conn conns[CONFIG_NET_MAX_CONN];
 static sys_slist_t conn_unused;
 static sys_slist_t conn_used;
 
+/* Lookup tables for net_conn_input(). A connection is in exactly one of:
+ * - conn_connected, hashed by protocol, remote address, remote port and
+ *   local port, if all of these are specified,
+ * - conn_listen, hashed by protocol and local port, if the local port is
+ *   specified,
+ * - conn_wildcard otherwise.
+ */
+static sys_slist_t conn_connected[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_listen[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_wildcard;
+
+static u32_t conn_hash_addr(u8_t family, const void *addr)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
+		const struct in6_addr *addr6 = addr;
+
+		return UNALIGNED_GET(&addr6->s6_addr32[0]) ^
+		       UNALIGNED_GET(&addr6->s6_addr32[1]) ^
+		       UNALIGNED_GET(&addr6->s6_addr32[2]) ^
+		       UNALIGNED_GET(&addr6->s6_addr32[3]);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+		const struct in_addr *addr4 = addr;
+
+		return UNALIGNED_GET(&addr4->s_addr);
+	}
+
+	return 0;
+}
+
+/* Ports are in network byte order. */
+static inline u32_t conn_hash(u16_t proto, u32_t addr_hash,
+			      u16_t remote_port, u16_t local_port)
+{
+	u32_t h = addr_hash ^ ((u32_t)remote_port << 16 | local_port) ^ proto;
+
+	/* Fibonacci hashing, to spread nearby ports and addresses */
+	h *= 0x9e3779b1U;
+
+	return (h >> 16) % CONFIG_NET_CONN_HASH_SIZE;
+}
+
+static sys_slist_t *conn_listen_bucket(u16_t proto, u16_t local_port)
+{
+	return &conn_listen[conn_hash(proto, 0, 0, local_port)];
+}
+
+static sys_slist_t *conn_connected_bucket(u16_t proto, u8_t family,
+					  const void *remote_addr,
+					  u16_t remote_port,
+					  u16_t local_port)
+{
+	return &conn_connected[conn_hash(proto,
+					 conn_hash_addr(family, remote_addr),
+					 remote_port, local_port)];
+}
+
+static sys_slist_t *conn_bucket(struct net_conn *conn)
+{
+	const u8_t connected = NET_CONN_REMOTE_ADDR_SPEC |
+			       NET_CONN_REMOTE_PORT_SPEC |
+			       NET_CONN_LOCAL_PORT_SPEC;
+
+	if ((conn->flags & connected) == connected) {
+		const void *addr;
+
+		if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		    conn->remote_addr.sa_family == AF_INET6) {
+			addr = &net_sin6(&conn->remote_addr)->sin6_addr;
+		} else {
+			addr = &net_sin(&conn->remote_addr)->sin_addr;
+		}
+
+		return conn_connected_bucket(
+				conn->proto, conn->remote_addr.sa_family, addr,
+				net_sin(&conn->remote_addr)->sin_port,
+				net_sin(&conn->local_addr)->sin_port);
+	}
+
+	if (conn->flags & NET_CONN_LOCAL_PORT_SPEC) {
+		return conn_listen_bucket(conn->proto,
+					  net_sin(&conn->local_addr)->sin_port);
+	}
+
+	return &conn_wildcard;
+}
+
 #if (CONFIG_NET_CONN_LOG_LEVEL >= LOG_LEVEL_DBG)
 static inline
 void conn_register_debug(struct net_conn *conn,
@@ -132,6 +218,7 @@ static void conn_set_used(struct net_conn *conn)
 	conn->flags |= NET_CONN_IN_USE;
 
 	sys_slist_prepend(&conn_used, &conn->node);
+	sys_slist_prepend(conn_bucket(conn), &conn->hash_node);
 }
 
 static void conn_set_unused(struct net_conn *conn)
@@ -149,8 +236,32 @@ static struct net_conn *conn_find_handler(u16_t proto, u8_t family,
 					  u16_t local_port)
 {
 	struct net_conn *conn;
+	sys_slist_t *bucket;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
+	/* An identical handler has the same flags, so it is in the bucket
+	 * these parameters select.
+	 */
+	if (remote_addr && remote_port && local_port &&
+	    IS_ENABLED(CONFIG_NET_IPV6) &&
+	    remote_addr->sa_family == AF_INET6 &&
+	    !net_ipv6_is_addr_unspecified(&net_sin6(remote_addr)->sin6_addr)) {
+		bucket = conn_connected_bucket(proto, AF_INET6,
+					&net_sin6(remote_addr)->sin6_addr,
+					htons(remote_port), htons(local_port));
+	} else if (remote_addr && remote_port && local_port &&
+		   IS_ENABLED(CONFIG_NET_IPV4) &&
+		   remote_addr->sa_family == AF_INET &&
+		   net_sin(remote_addr)->sin_addr.s_addr) {
+		bucket = conn_connected_bucket(proto, AF_INET,
+					&net_sin(remote_addr)->sin_addr,
+					htons(remote_port), htons(local_port));
+	} else if (local_port) {
+		bucket = conn_listen_bucket(proto, htons(local_port));
+	} else {
+		bucket = &conn_wildcard;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, conn, hash_node) {
 		if (conn->proto != proto) {
 			continue;
 		}
@@ -373,6 +484,7 @@ int net_conn_unregister(struct net_conn_handle *handle)
 	NET_DBG("Connection handler %p removed", conn);
 
 	sys_slist_find_and_remove(&conn_used, &conn->node);
+	sys_slist_find_and_remove(conn_bucket(conn), &conn->hash_node);
 
 	conn_set_unused(conn);
 
@@ -500,6 +612,56 @@ static bool conn_are_end_points_valid(struct net_pkt *pkt,
 	return !(my_src_addr && (src_port == dst_port));
 }
 
+/* Check if the end points of conn accept pkt. */
+static bool conn_is_match(struct net_conn *conn, struct net_pkt *pkt,
+			  union net_ip_header *ip_hdr, u8_t proto,
+			  u16_t src_port, u16_t dst_port)
+{
+	if (conn->proto != proto) {
+		return false;
+	}
+
+	if (conn->family != AF_UNSPEC &&
+	    conn->family != net_pkt_family(pkt)) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_UDP) ||
+	    IS_ENABLED(CONFIG_NET_TCP)) {
+		if (net_sin(&conn->remote_addr)->sin_port) {
+			if (net_sin(&conn->remote_addr)->sin_port !=
+			    src_port) {
+				return false;
+			}
+		}
+
+		if (net_sin(&conn->local_addr)->sin_port) {
+			if (net_sin(&conn->local_addr)->sin_port !=
+			    dst_port) {
+				return false;
+			}
+		}
+
+		if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
+			if (!conn_addr_cmp(pkt, ip_hdr,
+					   &conn->remote_addr,
+					   true)) {
+				return false;
+			}
+		}
+
+		if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
+			if (!conn_addr_cmp(pkt, ip_hdr,
+					   &conn->local_addr,
+					   false)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 enum net_verdict net_conn_input(struct net_pkt *pkt,
 				union net_ip_header *ip_hdr,
 				u8_t proto,
@@ -510,8 +672,11 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 	bool is_mcast_pkt = false, mcast_pkt_delivered = false;
 	s16_t best_rank = -1;
 	struct net_conn *conn;
+	sys_slist_t *lists[3];
+	int nlists = 0;
 	u16_t src_port;
 	u16_t dst_port;
+	int i;
 
 	if (IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) {
 		src_port = proto_hdr->udp->src_port;
@@ -564,99 +729,103 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		}
 	}
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
-		if (conn->proto != proto) {
-			continue;
-		}
-
-		if (conn->family != AF_UNSPEC &&
-		    conn->family != net_pkt_family(pkt)) {
-			continue;
+	/* Candidates are the connected handlers for the exact end points,
+	 * then the listeners on the destination port, then the handlers
+	 * without local port. Once a handler with remote port is matched,
+	 * nothing can override it, so the later lists are not walked.
+	 */
+	if ((IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) ||
+	    (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP)) {
+		if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		    net_pkt_family(pkt) == AF_INET6) {
+			lists[nlists++] = conn_connected_bucket(
+				proto, AF_INET6, &ip_hdr->ipv6->src,
+				src_port, dst_port);
+		} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+			   net_pkt_family(pkt) == AF_INET) {
+			lists[nlists++] = conn_connected_bucket(
+				proto, AF_INET, &ip_hdr->ipv4->src,
+				src_port, dst_port);
 		}
 
-		if (IS_ENABLED(CONFIG_NET_UDP) ||
-		    IS_ENABLED(CONFIG_NET_TCP)) {
-			if (net_sin(&conn->remote_addr)->sin_port) {
-				if (net_sin(&conn->remote_addr)->sin_port !=
-				    src_port) {
-					continue;
-				}
-			}
+		lists[nlists++] = conn_listen_bucket(proto, dst_port);
+	}
 
-			if (net_sin(&conn->local_addr)->sin_port) {
-				if (net_sin(&conn->local_addr)->sin_port !=
-				    dst_port) {
-					continue;
-				}
-			}
+	lists[nlists++] = &conn_wildcard;
 
-			if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
-				if (!conn_addr_cmp(pkt, ip_hdr,
-						   &conn->remote_addr,
-						   true)) {
-					continue;
-				}
-			}
-
-			if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
-				if (!conn_addr_cmp(pkt, ip_hdr,
-						   &conn->local_addr,
-						   false)) {
-					continue;
-				}
-			}
+	for (i = 0; i < nlists; i++) {
+		if (best_match != NULL &&
+		    best_match->flags & NET_CONN_REMOTE_PORT_SPEC) {
+			break;
+		}
 
-			/* If we have an existing best_match, and that one
-			 * specifies a remote port, then we've matched to a
-			 * LISTENING connection that should not override.
-			 */
-			if (best_match != NULL &&
-			    best_match->flags & NET_CONN_REMOTE_PORT_SPEC) {
+		SYS_SLIST_FOR_EACH_CONTAINER(lists[i], conn, hash_node) {
+			if (!conn_is_match(conn, pkt, ip_hdr, proto,
+					   src_port, dst_port)) {
 				continue;
 			}
 
-			if (best_rank < NET_CONN_RANK(conn->flags)) {
-				struct net_pkt *mcast_pkt;
-
-				if (!is_mcast_pkt) {
-					best_rank = NET_CONN_RANK(conn->flags);
-					best_match = conn;
-
-					continue;
-				}
-
-				/* If we have a multicast packet, and we found
-				 * a match, then deliver the packet immediately
-				 * to the handler. As there might be several
-				 * sockets interested about these, we need to
-				 * clone the received pkt.
+			if (IS_ENABLED(CONFIG_NET_UDP) ||
+			    IS_ENABLED(CONFIG_NET_TCP)) {
+				/* If we have an existing best_match, and that
+				 * one specifies a remote port, then we've
+				 * matched to a LISTENING connection that should
+				 * not override.
 				 */
-
-				NET_DBG("[%p] mcast match found cb %p ud %p",
-					conn, conn->cb,	conn->user_data);
-
-				mcast_pkt = net_pkt_clone(pkt, CLONE_TIMEOUT);
-				if (!mcast_pkt) {
-					goto drop;
+				if (best_match != NULL &&
+				    best_match->flags &
+				    NET_CONN_REMOTE_PORT_SPEC) {
+					continue;
 				}
 
-				if (conn->cb(conn, mcast_pkt, ip_hdr,
-					     proto_hdr, conn->user_data) ==
+				if (best_rank < NET_CONN_RANK(conn->flags)) {
+					struct net_pkt *mcast_pkt;
+
+					if (!is_mcast_pkt) {
+						best_rank = NET_CONN_RANK(
+								conn->flags);
+						best_match = conn;
+
+						continue;
+					}
+
+					/* If we have a multicast packet, and
+					 * we found a match, then deliver the
+					 * packet immediately to the handler.
+					 * As there might be several sockets
+					 * interested about these, we need to
+					 * clone the received pkt.
+					 */
+
+					NET_DBG("[%p] mcast match found cb %p "
+						"ud %p", conn, conn->cb,
+						conn->user_data);
+
+					mcast_pkt = net_pkt_clone(
+							pkt, CLONE_TIMEOUT);
+					if (!mcast_pkt) {
+						goto drop;
+					}
+
+					if (conn->cb(conn, mcast_pkt, ip_hdr,
+						     proto_hdr,
+						     conn->user_data) ==
 								NET_DROP) {
-					net_stats_update_per_proto_drop(
+						net_stats_update_per_proto_drop(
 							pkt_iface, proto);
-					net_pkt_unref(mcast_pkt);
-				} else {
-					net_stats_update_per_proto_recv(
-						pkt_iface, proto);
-				}
+						net_pkt_unref(mcast_pkt);
+					} else {
+						net_stats_update_per_proto_recv(
+							pkt_iface, proto);
+					}
 
-				mcast_pkt_delivered = true;
+					mcast_pkt_delivered = true;
+				}
+			} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) ||
+				   IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
+				best_rank = 0;
+				best_match = conn;
 			}
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) ||
-			   IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
-			best_rank = 0;
-			best_match = conn;
 		}
 	}
 
@@ -728,6 +897,12 @@ void net_conn_init(void)
 
 	sys_slist_init(&conn_unused);
 	sys_slist_init(&conn_used);
+	sys_slist_init(&conn_wildcard);
+
+	for (i = 0; i < CONFIG_NET_CONN_HASH_SIZE; i++) {
+		sys_slist_init(&conn_connected[i]);
+		sys_slist_init(&conn_listen[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
 		sys_slist_prepend(&conn_unused, &conns[i].node);
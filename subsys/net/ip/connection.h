@@ -50,6 +50,9 @@ struct net_conn {
 	/** Internal slist node */
 	sys_snode_t node;
 
+	/** Internal slist node for the lookup tables */
+	sys_snode_t hash_node;
+
 	/** Remote IP address */
 	struct sockaddr remote_addr;
 
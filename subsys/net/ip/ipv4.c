@@ -303,6 +303,25 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 		log_strdup(net_sprint_ipv4_addr(&hdr->src)),
 		log_strdup(net_sprint_ipv4_addr(&hdr->dst)));
 
+	if (sys_get_be16(hdr->offset) &
+	    (NET_IPV4_MORE_FRAG_MASK | NET_IPV4_FRAGH_OFFSET_MASK)) {
+		if (!IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT)) {
+			NET_DBG("DROP: fragmented packet");
+			net_stats_update_ip_errors_fragerr(net_pkt_iface(pkt));
+			goto drop;
+		}
+
+		/* The fragment is kept until the whole packet can be
+		 * reassembled and fed again to the IP stack.
+		 */
+		verdict = net_ipv4_handle_fragment_hdr(pkt, hdr);
+		if (verdict == NET_DROP) {
+			goto drop;
+		}
+
+		return verdict;
+	}
+
 	switch (hdr->proto) {
 	case IPPROTO_ICMP:
 		verdict = net_icmpv4_input(pkt, hdr);
@@ -0,0 +1,663 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ *
+ * Pending reassemblies are kept in a small cache. They are found through
+ * a hash of the source and destination addresses, the identification and
+ * the protocol of the fragments (RFC 791), and the fragments of each one
+ * are kept sorted by offset so that neither inserting a fragment nor
+ * checking for completion needs to walk all of them. The amount of
+ * fragment data held by the cache is bounded, the oldest reassemblies
+ * are discarded to make room for new fragments.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <sys/slist.h>
+#include <random/rand32.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/ethernet.h>
+#include "net_private.h"
+#include "ipv4.h"
+#include "net_stats.h"
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+/* Options with this bit set in their type are copied to every fragment */
+#define NET_IPV4_OPTS_COPIED 0x80
+
+#define REASSEMBLY_BUCKETS CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT
+
+static void reassembly_timeout(struct k_work *work);
+static bool reassembly_init_done;
+
+static struct net_ipv4_reassembly
+reassembly[CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT];
+
+static sys_slist_t buckets[REASSEMBLY_BUCKETS];
+
+/* Fragment payload bytes held by all the pending reassemblies */
+static size_t reassembly_bytes;
+
+static K_MUTEX_DEFINE(reassembly_lock);
+
+static u16_t fragment_id;
+
+static u32_t reassembly_hash(struct in_addr *src, struct in_addr *dst,
+			     u16_t id, u8_t proto)
+{
+	u32_t hash;
+
+	hash = UNALIGNED_GET(&src->s_addr) ^ UNALIGNED_GET(&dst->s_addr);
+	hash ^= ((u32_t)id << 16) | proto;
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return hash % REASSEMBLY_BUCKETS;
+}
+
+static inline sys_slist_t *reassembly_bucket(struct net_ipv4_reassembly *reass)
+{
+	return &buckets[reassembly_hash(&reass->src, &reass->dst,
+					reass->id, reass->proto)];
+}
+
+static void reassembly_info(char *str, struct net_ipv4_reassembly *reass)
+{
+	NET_DBG("%s id 0x%x src %s dst %s recv %u/%u remain %d ms", str,
+		reass->id,
+		log_strdup(net_sprint_ipv4_addr(&reass->src)),
+		log_strdup(net_sprint_ipv4_addr(&reass->dst)),
+		reass->received, reass->total,
+		k_delayed_work_remaining_get(&reass->timer));
+}
+
+/* Release a reassembly slot and the fragments that are still in it */
+static void reassembly_release(struct net_ipv4_reassembly *reass)
+{
+	int i;
+
+	sys_slist_find_and_remove(reassembly_bucket(reass), &reass->node);
+	k_delayed_work_cancel(&reass->timer);
+
+	for (i = 0; i < reass->count; i++) {
+		net_stats_update_ipv4_frag_drop(net_pkt_iface(reass->pkt[i]));
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+
+	reassembly_bytes -= reass->received;
+	reass->count = 0U;
+}
+
+static struct net_ipv4_reassembly *reassembly_oldest(
+					struct net_ipv4_reassembly *skip)
+{
+	struct net_ipv4_reassembly *oldest = NULL;
+	u32_t now = k_uptime_get_32();
+	int i;
+
+	for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!reassembly[i].count || &reassembly[i] == skip) {
+			continue;
+		}
+
+		if (!oldest ||
+		    now - reassembly[i].start > now - oldest->start) {
+			oldest = &reassembly[i];
+		}
+	}
+
+	return oldest;
+}
+
+static struct net_ipv4_reassembly *reassembly_get(struct net_ipv4_hdr *hdr,
+						  u16_t id)
+{
+	sys_slist_t *bucket = &buckets[reassembly_hash(&hdr->src, &hdr->dst,
+						       id, hdr->proto)];
+	struct net_ipv4_reassembly *reass;
+	int i;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, reass, node) {
+		if (reass->id == id && reass->proto == hdr->proto &&
+		    net_ipv4_addr_cmp(&reass->src, &hdr->src) &&
+		    net_ipv4_addr_cmp(&reass->dst, &hdr->dst)) {
+			return reass;
+		}
+	}
+
+	for (i = 0, reass = NULL; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!reassembly[i].count) {
+			reass = &reassembly[i];
+			break;
+		}
+	}
+
+	if (!reass) {
+		reass = reassembly_oldest(NULL);
+
+		reassembly_info("Reassembly evicted", reass);
+		reassembly_release(reass);
+	}
+
+	net_ipaddr_copy(&reass->src, &hdr->src);
+	net_ipaddr_copy(&reass->dst, &hdr->dst);
+	reass->id = id;
+	reass->proto = hdr->proto;
+	reass->start = k_uptime_get_32();
+	reass->received = 0U;
+	reass->total = 0U;
+
+	sys_slist_prepend(bucket, &reass->node);
+
+	k_delayed_work_submit(&reass->timer, IPV4_REASSEMBLY_TIMEOUT);
+
+	return reass;
+}
+
+static void reassembly_timeout(struct k_work *work)
+{
+	struct net_ipv4_reassembly *reass =
+		CONTAINER_OF(work, struct net_ipv4_reassembly, timer);
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	/* The slot might have been released or reused while we were
+	 * waiting for the lock.
+	 */
+	if (reass->count && !k_delayed_work_remaining_get(&reass->timer)) {
+		reassembly_info("Reassembly cancelled", reass);
+
+		net_stats_update_ipv4_frag_timeout(
+					net_pkt_iface(reass->pkt[0]));
+		reassembly_release(reass);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+/* Index where a fragment starting at the given offset goes. Fragments
+ * mostly arrive in order, so the end of the list is checked first.
+ */
+static int reassembly_pos(struct net_ipv4_reassembly *reass, u16_t offset)
+{
+	int low = 0, high = reass->count, mid;
+
+	if (!high || reass->offset[high - 1] < offset) {
+		return high;
+	}
+
+	while (low < high) {
+		mid = (low + high) / 2;
+
+		if (reass->offset[mid] < offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/* Chain the data of all the fragments after the first one, which still
+ * has the IPv4 header, and release the slot.
+ */
+static struct net_pkt *reassemble_packet(struct net_ipv4_reassembly *reass)
+{
+	struct net_pkt *pkt = reass->pkt[0];
+	struct net_buf *last;
+	int i;
+
+	NET_ASSERT(reass->offset[0] == 0U);
+
+	last = net_buf_frag_last(pkt->buffer);
+
+	for (i = 1; i < reass->count; i++) {
+		if (reass->pkt[i]->buffer) {
+			last->frags = reass->pkt[i]->buffer;
+			last = net_buf_frag_last(last->frags);
+			reass->pkt[i]->buffer = NULL;
+		}
+
+		net_pkt_unref(reass->pkt[i]);
+		reass->pkt[i] = NULL;
+	}
+
+	reass->pkt[0] = NULL;
+	reass->count = 0U;
+
+	reassembly_release(reass);
+
+	return pkt;
+}
+
+static void reassembly_deliver(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		goto error;
+	}
+
+	hdr->len = htons(net_pkt_get_len(pkt));
+	hdr->offset[0] = 0U;
+	hdr->offset[1] = 0U;
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	NET_DBG("New pkt %p IPv4 len is %d bytes", pkt, ntohs(hdr->len));
+
+	net_stats_update_ipv4_frag_reassembled(net_pkt_iface(pkt));
+
+	/* The packet is fed back through the RX queue so that we do not
+	 * run out of stack. It has no link layer header anymore, so tell
+	 * process_data() not to pass it to L2 again.
+	 */
+	net_pkt_set_l2_processed(pkt, true);
+
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	int i;
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	for (i = 0; reassembly_init_done &&
+		     i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+		if (!reassembly[i].count) {
+			continue;
+		}
+
+		cb(&reassembly[i], user_data);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	struct net_ipv4_reassembly *reass, *victim;
+	struct net_pkt *reassembled = NULL;
+	u16_t flag, hdr_len, offset, len;
+	int i, pos;
+
+	net_stats_update_ipv4_frag_recv(net_pkt_iface(pkt));
+
+	flag = sys_get_be16(hdr->offset);
+	hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv4_opts_len(pkt);
+	offset = (flag & NET_IPV4_FRAGH_OFFSET_MASK) * 8U;
+
+	if (ntohs(hdr->len) < hdr_len) {
+		goto drop;
+	}
+
+	len = ntohs(hdr->len) - hdr_len;
+
+	/* All but the last fragment carry a multiple of 8 bytes, and the
+	 * reassembled packet must fit into the IPv4 total length.
+	 */
+	if (((flag & NET_IPV4_MORE_FRAG_MASK) && (!len || len % 8U)) ||
+	    (u32_t)hdr_len + offset + len > 0xffff) {
+		NET_DBG("DROP: invalid fragment offset %u len %u",
+			offset, len);
+		goto drop;
+	}
+
+	k_mutex_lock(&reassembly_lock, K_FOREVER);
+
+	if (!reassembly_init_done) {
+		/* Static initializing does not work here because of the array
+		 * so we must do it at runtime.
+		 */
+		for (i = 0; i < CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT; i++) {
+			k_delayed_work_init(&reassembly[i].timer,
+					    reassembly_timeout);
+		}
+
+		reassembly_init_done = true;
+	}
+
+	reass = reassembly_get(hdr, sys_get_be16(hdr->id));
+
+	pos = reassembly_pos(reass, offset);
+
+	if (pos < reass->count && reass->offset[pos] == offset &&
+	    reass->len[pos] == len) {
+		NET_DBG("Duplicate fragment offset %u id 0x%x", offset,
+			reass->id);
+		k_mutex_unlock(&reassembly_lock);
+		goto drop;
+	}
+
+	/* Overlapping fragments are not accepted, as with IPv6 (RFC 5722) */
+	if ((pos > 0 &&
+	     reass->offset[pos - 1] + reass->len[pos - 1] > offset) ||
+	    (pos < reass->count && offset + len > reass->offset[pos])) {
+		NET_DBG("Overlapping fragment offset %u id 0x%x", offset,
+			reass->id);
+		goto cancel;
+	}
+
+	if (!(flag & NET_IPV4_MORE_FRAG_MASK)) {
+		if (reass->total || pos < reass->count) {
+			goto cancel;
+		}
+
+		reass->total = offset + len;
+	} else if (reass->total && offset + len > reass->total) {
+		goto cancel;
+	}
+
+	if (reass->count == CONFIG_NET_IPV4_FRAGMENT_MAX_PKT) {
+		NET_DBG("No slots available for 0x%x", reass->id);
+		goto cancel;
+	}
+
+	while (reassembly_bytes + len > CONFIG_NET_IPV4_FRAGMENT_MAX_BYTES) {
+		victim = reassembly_oldest(reass);
+		if (!victim) {
+			NET_DBG("No memory available for 0x%x", reass->id);
+			goto cancel;
+		}
+
+		reassembly_info("Reassembly evicted", victim);
+		reassembly_release(victim);
+	}
+
+	/* Only the first fragment keeps the IPv4 header */
+	if (offset) {
+		net_pkt_cursor_init(pkt);
+
+		if (net_pkt_pull(pkt, hdr_len)) {
+			goto cancel;
+		}
+	}
+
+	memmove(&reass->pkt[pos + 1], &reass->pkt[pos],
+		sizeof(reass->pkt[0]) * (reass->count - pos));
+	memmove(&reass->offset[pos + 1], &reass->offset[pos],
+		sizeof(reass->offset[0]) * (reass->count - pos));
+	memmove(&reass->len[pos + 1], &reass->len[pos],
+		sizeof(reass->len[0]) * (reass->count - pos));
+
+	NET_DBG("Storing pkt %p to slot %d offset %u", pkt, pos, offset);
+
+	reass->pkt[pos] = pkt;
+	reass->offset[pos] = offset;
+	reass->len[pos] = len;
+	reass->count++;
+	reass->received += len;
+	reassembly_bytes += len;
+
+	/* The fragments do not overlap, so they cover the whole packet
+	 * once their lengths add up to it.
+	 */
+	if (reass->total && reass->received == reass->total) {
+		reassembly_info("Reassembly last pkt", reass);
+		reassembled = reassemble_packet(reass);
+	} else {
+		reassembly_info("Reassembly nth pkt", reass);
+	}
+
+	k_mutex_unlock(&reassembly_lock);
+
+	if (reassembled) {
+		reassembly_deliver(reassembled);
+	}
+
+	return NET_OK;
+
+cancel:
+	reassembly_info("Reassembly dropped", reass);
+	reassembly_release(reass);
+	k_mutex_unlock(&reassembly_lock);
+drop:
+	net_stats_update_ipv4_frag_drop(net_pkt_iface(pkt));
+
+	return NET_DROP;
+}
+
+/* Options that are not copied to every fragment are replaced with no
+ * operation options after the first fragment, so that all the fragments
+ * have the same header length.
+ */
+static void fragment_strip_opts(u8_t *opts, u8_t opts_len)
+{
+	u8_t i = 0U, opt_len;
+
+	while (i < opts_len && opts[i] != NET_IPV4_OPTS_EO) {
+		if (opts[i] == NET_IPV4_OPTS_NOP) {
+			i++;
+			continue;
+		}
+
+		if (i + 1 >= opts_len) {
+			break;
+		}
+
+		opt_len = opts[i + 1];
+		if (opt_len < 2 || i + opt_len > opts_len) {
+			break;
+		}
+
+		if (!(opts[i] & NET_IPV4_OPTS_COPIED)) {
+			memset(&opts[i], NET_IPV4_OPTS_NOP, opt_len);
+		}
+
+		i += opt_len;
+	}
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, u8_t *hdr, u16_t hdr_len,
+			      u16_t fit_len, u16_t frag_offset, bool final)
+{
+	struct net_ipv4_hdr *ip = (struct net_ipv4_hdr *)hdr;
+	struct net_if *iface = net_pkt_iface(pkt);
+	struct net_pkt *frag_pkt;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(iface, hdr_len + fit_len,
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	ip->len = htons(hdr_len + fit_len);
+	sys_put_be16((frag_offset / 8U) |
+		     (final ? 0 : NET_IPV4_MORE_FRAG_MASK), ip->offset);
+	ip->chksum = 0U;
+
+	/* The cursor of the original packet is at the payload part of
+	 * this fragment.
+	 */
+	if (net_pkt_write(frag_pkt, hdr, hdr_len) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_set_ip_hdr_len(frag_pkt, NET_IPV4H_LEN);
+	net_pkt_set_ipv4_opts_len(frag_pkt, hdr_len - NET_IPV4H_LEN);
+	net_pkt_set_priority(frag_pkt, net_pkt_priority(pkt));
+	net_pkt_set_vlan_tci(frag_pkt, net_pkt_vlan_tci(pkt));
+
+	net_pkt_cursor_init(frag_pkt);
+
+	if (net_if_need_calc_tx_checksum(iface)) {
+		NET_IPV4_HDR(frag_pkt)->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	net_stats_update_ipv4_frag_sent(iface);
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+static int send_fragmented_pkt(struct net_pkt *pkt, u8_t *hdr, u16_t hdr_len,
+			       u16_t mtu)
+{
+	struct net_ipv4_hdr *ip = (struct net_ipv4_hdr *)hdr;
+	u16_t frag_offset = 0U;
+	size_t length;
+	int fit_len;
+	int ret;
+
+	/* All but the last fragment must carry a multiple of 8 bytes */
+	fit_len = ((mtu - hdr_len) / 8U) * 8U;
+	if (fit_len <= 0) {
+		NET_DBG("No room for IPv4 payload MTU %d hdr_len %d",
+			mtu, hdr_len);
+		return -EINVAL;
+	}
+
+	if (!fragment_id) {
+		fragment_id = sys_rand32_get();
+	}
+
+	sys_put_be16(fragment_id++, ip->id);
+
+	length = net_pkt_get_len(pkt) - hdr_len;
+	while (length) {
+		bool final = false;
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		ret = send_ipv4_fragment(pkt, hdr, hdr_len, fit_len,
+					 frag_offset, final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (!frag_offset) {
+			fragment_strip_opts(hdr + NET_IPV4H_LEN,
+					    hdr_len - NET_IPV4H_LEN);
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	u8_t hdr[NET_IPV4H_LEN + NET_IPV4_HDR_OPTNS_MAX_LEN];
+	struct net_ipv4_hdr *ip = (struct net_ipv4_hdr *)hdr;
+	struct net_if *iface = net_pkt_iface(pkt);
+	u16_t mtu = net_if_get_mtu(iface);
+	bool overwrite;
+	u16_t hdr_len;
+	int ret;
+
+	if (!mtu || net_pkt_get_len(pkt) <= mtu) {
+		return NET_OK;
+	}
+
+	overwrite = net_pkt_is_being_overwritten(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_read(pkt, hdr, NET_IPV4H_LEN)) {
+		goto ignore;
+	}
+
+	/* Larger TCP packets are split by segmentation offload */
+	if (ip->proto == IPPROTO_TCP && net_eth_get_gso_max_size(iface)) {
+		goto ignore;
+	}
+
+	if (sys_get_be16(ip->offset) & NET_IPV4_DO_NOT_FRAG_MASK) {
+		NET_DBG("DROP: pkt %p len %zu does not fit MTU %u and %s",
+			pkt, net_pkt_get_len(pkt), mtu, "DF is set");
+		net_pkt_set_overwrite(pkt, overwrite);
+		return NET_DROP;
+	}
+
+	hdr_len = (ip->vhl & NET_IPV4_IHL_MASK) * 4U;
+	if (hdr_len < NET_IPV4H_LEN ||
+	    net_pkt_read(pkt, hdr + NET_IPV4H_LEN, hdr_len - NET_IPV4H_LEN)) {
+		goto ignore;
+	}
+
+	ret = send_fragmented_pkt(pkt, hdr, hdr_len, mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+
+		if (ret == -ENOMEM) {
+			/* Try to send the packet if we could not allocate
+			 * enough network packets and hope the original large
+			 * packet can be sent ok.
+			 */
+			goto ignore;
+		}
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref count when
+	 * re-sending the packet.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* We need to unref here because we simulate the packet
+	 * sending.
+	 */
+	net_pkt_unref(pkt);
+
+	/* No need to continue with the sending as the packet is now split
+	 * and its fragments will be sent separately to network.
+	 */
+	return NET_CONTINUE;
+
+ignore:
+	net_pkt_set_overwrite(pkt, overwrite);
+	net_pkt_cursor_init(pkt);
+
+	return NET_OK;
+}
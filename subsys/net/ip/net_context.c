@@ -1575,6 +1575,9 @@ static int context_sendto(struct net_context *context,
 			goto fail;
 		}
 
+		/* The send window may take only part of the data */
+		len = ret;
+
 		net_pkt_unref(pkt);
 #else
 		ret = context_write_data(pkt, buf, len, msghdr);
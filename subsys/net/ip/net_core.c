@@ -75,9 +75,17 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 	int ret;
 	bool locally_routed = false;
 
-	ret = net_packet_socket_input(pkt);
-	if (ret != NET_CONTINUE) {
-		return ret;
+	/* A packet that L2 has coalesced from several received frames, or
+	 * that IPv4 has reassembled from fragments, and re-queued has
+	 * already been seen by packet sockets and L2.
+	 */
+	if (net_pkt_is_l2_processed(pkt)) {
+		locally_routed = true;
+	} else {
+		ret = net_packet_socket_input(pkt);
+		if (ret != NET_CONTINUE) {
+			return ret;
+		}
 	}
 
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
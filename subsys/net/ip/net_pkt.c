@@ -963,6 +963,18 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 
 		max_len = MAX(max_len, NET_IPV6_MTU);
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) && family == AF_INET) {
+		if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT) &&
+		    proto != IPPROTO_TCP && size > max_len) {
+			/* Larger packets are fragmented when they are sent */
+			max_len = size;
+		} else if (proto == IPPROTO_TCP && size > max_len) {
+			/* Segmentation offload splits larger TCP packets
+			 * before they reach the driver.
+			 */
+			max_len = MAX(max_len, net_eth_get_gso_max_size(
+					      net_pkt_iface(pkt)));
+		}
+
 		max_len = MAX(max_len, NET_IPV4_MTU);
 	} else { /* family == AF_UNSPEC */
 #if defined (CONFIG_NET_L2_ETHERNET)
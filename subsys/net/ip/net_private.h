@@ -149,6 +149,49 @@ extern char *net_sprint_ll_addr_buf(const u8_t *ll, u8_t ll_len,
 				    char *buf, int buflen);
 extern u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto);
 
+/**
+ * @brief Add the one's complement sum of a buffer to a running sum
+ *
+ * @param sum Running sum, in host byte order
+ * @param data Data, as big endian 16-bit words
+ * @param len Length of the data, odd only for the last part of a packet
+ *
+ * @return Updated running sum, in host byte order
+ */
+extern u16_t net_chksum_partial(u16_t sum, const void *data, size_t len);
+
+/**
+ * @brief Update a checksum for a change in the data it covers (RFC 1624)
+ *
+ * Used when a header field is rewritten, so that the whole checksum does
+ * not need to be calculated again.
+ *
+ * @param chksum Checksum field, in network byte order
+ * @param old Old contents of the changed data
+ * @param new New contents of the changed data
+ * @param len Length of the changed data, a multiple of two starting at
+ *        an even offset of the checksummed data
+ *
+ * @return Updated checksum field, in network byte order
+ */
+extern u16_t net_chksum_update(u16_t chksum, const void *old,
+			       const void *new, size_t len);
+
+/**
+ * @brief Update a checksum for a change of one 16-bit word (RFC 1624)
+ *
+ * All values are in network byte order.
+ */
+static inline u16_t net_chksum_update16(u16_t chksum, u16_t old, u16_t new)
+{
+	u32_t sum = (u16_t)~chksum + (u16_t)~old + new;
+
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum;
+}
+
 /**
  * @brief Deliver the incoming packet through the recv_cb of the net_context
  *        to the upper layers
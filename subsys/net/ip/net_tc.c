@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
+#include <net/ethernet.h>
 
 #include "net_private.h"
 #include "net_stats.h"
@@ -30,6 +31,26 @@ NET_STACK_ARRAY_DEFINE(RX, rx_stack,
 		       CONFIG_NET_RX_STACK_SIZE,
 		       NET_TC_RX_COUNT);
 
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+/* The RX queue of the steered traffic class is the first flow queue, so
+ * only the rest of them need a stack of their own.
+ */
+#define RX_FLOW_COUNT (CONFIG_NET_RX_FLOW_STEERING_QUEUES - 1)
+
+NET_STACK_ARRAY_DEFINE(RX_FLOW, rx_flow_stack,
+		       CONFIG_NET_RX_STACK_SIZE,
+		       CONFIG_NET_RX_STACK_SIZE,
+		       RX_FLOW_COUNT);
+
+static struct net_traffic_class rx_flow_classes[RX_FLOW_COUNT];
+static u8_t rx_flow_tc;
+
+/* The first flow queue runs on CPU 0, the other RX queues anywhere */
+#define RX_TC_CPU(tc) ((tc) == rx_flow_tc ? 0 : -1)
+#else
+#define RX_TC_CPU(tc) -1
+#endif
+
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
 static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
 
@@ -38,10 +59,115 @@ void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt)
 	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
 }
 
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+/* Hash of the addresses, protocol and ports of a received packet. Only
+ * the first buffer is looked at, and packets that cannot be parsed from
+ * it all get the same hash. Fragments of IPv4 packets are hashed without
+ * the ports, as only the first one carries them.
+ */
+static u32_t rx_flow_hash(struct net_pkt *pkt)
+{
+	struct net_buf *buf = pkt->frags;
+	u16_t type, hdr_len = 0U;
+	u8_t *data, proto;
+	u32_t hash = 0U;
+	int i;
+
+	if (!buf) {
+		return 0U;
+	}
+
+	data = buf->data;
+
+	if (net_pkt_is_l2_processed(pkt)) {
+		/* Re-queued packet which starts with the IP header */
+		type = (data[0] & 0xf0) == 0x60 ? NET_ETH_PTYPE_IPV6 :
+			NET_ETH_PTYPE_IP;
+#if defined(CONFIG_NET_L2_ETHERNET)
+	} else if (net_if_l2(net_pkt_iface(pkt)) ==
+		   &NET_L2_GET_NAME(ETHERNET) &&
+		   buf->len >= sizeof(struct net_eth_vlan_hdr)) {
+		struct net_eth_vlan_hdr *hdr = (struct net_eth_vlan_hdr *)data;
+
+		if (ntohs(hdr->vlan.tpid) == NET_ETH_PTYPE_VLAN) {
+			type = ntohs(hdr->type);
+			hdr_len = sizeof(struct net_eth_vlan_hdr);
+		} else {
+			type = ntohs(hdr->vlan.tpid);
+			hdr_len = sizeof(struct net_eth_hdr);
+		}
+#endif /* CONFIG_NET_L2_ETHERNET */
+	} else {
+		return 0U;
+	}
+
+	data += hdr_len;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && type == NET_ETH_PTYPE_IP &&
+	    buf->len >= hdr_len + NET_IPV4H_LEN) {
+		struct net_ipv4_hdr *hdr = (struct net_ipv4_hdr *)data;
+
+		hash = UNALIGNED_GET(&hdr->src.s_addr) ^
+			UNALIGNED_GET(&hdr->dst.s_addr);
+		proto = hdr->proto;
+		hdr_len += (hdr->vhl & 0x0f) * 4U;
+
+		/* Any MF flag or offset means a fragment */
+		if ((hdr->offset[0] & 0x3f) || hdr->offset[1]) {
+			proto = 0U;
+		}
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   type == NET_ETH_PTYPE_IPV6 &&
+		   buf->len >= hdr_len + NET_IPV6H_LEN) {
+		struct net_ipv6_hdr *hdr = (struct net_ipv6_hdr *)data;
+
+		for (i = 0; i < 4; i++) {
+			hash ^= UNALIGNED_GET(&hdr->src.s6_addr32[i]) ^
+				UNALIGNED_GET(&hdr->dst.s6_addr32[i]);
+		}
+
+		proto = hdr->nexthdr;
+		hdr_len += NET_IPV6H_LEN;
+	} else {
+		return 0U;
+	}
+
+	hash ^= proto;
+
+	/* Source and destination port are the first word in both */
+	if ((proto == IPPROTO_TCP || proto == IPPROTO_UDP) &&
+	    buf->len >= hdr_len + sizeof(u32_t)) {
+		hash ^= UNALIGNED_GET((u32_t *)(buf->data + hdr_len));
+	}
+
+	return hash * 0x9e3779b1U;
+}
+
+void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt)
+{
+	u8_t queue;
+
+	if (tc != rx_flow_tc) {
+		k_work_submit_to_queue(&rx_classes[tc].work_q,
+				       net_pkt_work(pkt));
+		return;
+	}
+
+	queue = (rx_flow_hash(pkt) >> 16) % CONFIG_NET_RX_FLOW_STEERING_QUEUES;
+	if (!queue) {
+		k_work_submit_to_queue(&rx_classes[tc].work_q,
+				       net_pkt_work(pkt));
+	} else {
+		k_work_submit_to_queue(&rx_flow_classes[queue - 1].work_q,
+				       net_pkt_work(pkt));
+	}
+}
+#else
 void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt)
 {
 	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
 }
+#endif
 
 int net_tx_priority2tc(enum net_priority prio)
 {
@@ -172,9 +298,12 @@ static u8_t rx_tc2thread(u8_t tc)
 #if defined(CONFIG_NET_SHELL)
 #define TX_STACK(idx) NET_STACK_GET_NAME(TX, tx_stack, 0)[idx].stack
 #define RX_STACK(idx) NET_STACK_GET_NAME(RX, rx_stack, 0)[idx].stack
+#define RX_FLOW_STACK(idx) \
+	NET_STACK_GET_NAME(RX_FLOW, rx_flow_stack, 0)[idx].stack
 #else
 #define TX_STACK(idx) NET_STACK_GET_NAME(TX, tx_stack, 0)[idx]
 #define RX_STACK(idx) NET_STACK_GET_NAME(RX, rx_stack, 0)[idx]
+#define RX_FLOW_STACK(idx) NET_STACK_GET_NAME(RX_FLOW, rx_flow_stack, 0)[idx]
 #endif
 
 #if defined(CONFIG_NET_STATISTICS)
@@ -218,6 +347,74 @@ static void net_tc_rx_stats_priority_setup(struct net_if *iface,
 }
 #endif
 
+#if defined(CONFIG_NET_RX_FLOW_STEERING) && defined(CONFIG_SCHED_CPU_MASK)
+extern void z_work_q_main(void *work_q_ptr, void *p2, void *p3);
+#endif
+
+/* Start an RX queue. With flow steering and CPU masks, a thread given a
+ * CPU is pinned to it. A CPU mask can only be changed while the thread
+ * is not runnable, so the thread is created without starting it.
+ */
+static void rx_queue_start(struct k_work_q *work_q, k_thread_stack_t *stack,
+			   size_t stack_size, int prio, int cpu)
+{
+#if defined(CONFIG_NET_RX_FLOW_STEERING) && defined(CONFIG_SCHED_CPU_MASK)
+	if (cpu >= 0) {
+		k_queue_init(&work_q->queue);
+		(void)k_thread_create(&work_q->thread, stack, stack_size,
+				      z_work_q_main, work_q, NULL, NULL, prio,
+				      0, K_FOREVER);
+		(void)k_thread_cpu_mask_clear(&work_q->thread);
+		(void)k_thread_cpu_mask_enable(&work_q->thread, cpu);
+		k_thread_start(&work_q->thread);
+		return;
+	}
+#else
+	ARG_UNUSED(cpu);
+#endif
+
+	k_work_q_start(work_q, stack, stack_size, prio);
+}
+
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+/* Start the extra queues of the best effort traffic class. They use the
+ * same thread priority as its first queue.
+ */
+static void rx_flow_init(void)
+{
+	u8_t thread_priority;
+	int i;
+
+	thread_priority = rx_classes[rx_flow_tc].tc;
+
+	for (i = 0; i < RX_FLOW_COUNT; i++) {
+		rx_flow_classes[i].tc = thread_priority;
+
+#if defined(CONFIG_NET_SHELL)
+		NET_STACK_GET_NAME(RX_FLOW, rx_flow_stack, 0)[i].stack =
+			rx_flow_stack[i];
+		NET_STACK_GET_NAME(RX_FLOW, rx_flow_stack, 0)[i].prio =
+			thread_priority;
+		NET_STACK_GET_NAME(RX_FLOW, rx_flow_stack, 0)[i].idx = i + 1;
+#endif
+
+		NET_DBG("[%d] Starting RX flow queue %p stack %p size %zd "
+			"prio %d (%d)", i + 1,
+			&rx_flow_classes[i].work_q.queue, RX_FLOW_STACK(i),
+			K_THREAD_STACK_SIZEOF(rx_flow_stack[i]),
+			thread_priority, K_PRIO_COOP(thread_priority));
+
+		rx_queue_start(&rx_flow_classes[i].work_q,
+			       rx_flow_stack[i],
+			       K_THREAD_STACK_SIZEOF(rx_flow_stack[i]),
+			       K_PRIO_COOP(thread_priority),
+			       (i + 1) % CONFIG_MP_NUM_CPUS);
+		k_thread_name_set(&rx_flow_classes[i].work_q.thread,
+				  "rx_flow_workq");
+	}
+}
+#endif /* CONFIG_NET_RX_FLOW_STEERING */
+
 /* Create workqueue for each traffic class we are using. All the network
  * traffic goes through these classes. There needs to be at least one traffic
  * class in the system.
@@ -267,6 +464,10 @@ void net_tc_rx_init(void)
 
 	BUILD_ASSERT(NET_TC_RX_COUNT > 0);
 
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+	rx_flow_tc = net_rx_priority2tc(NET_PRIORITY_BE);
+#endif
+
 #if defined(CONFIG_NET_STATISTICS)
 	net_if_foreach(net_tc_rx_stats_priority_setup, NULL);
 #endif
@@ -292,10 +493,14 @@ void net_tc_rx_init(void)
 			K_THREAD_STACK_SIZEOF(rx_stack[i]),
 			thread_priority, K_PRIO_COOP(thread_priority));
 
-		k_work_q_start(&rx_classes[i].work_q,
+		rx_queue_start(&rx_classes[i].work_q,
 			       rx_stack[i],
 			       K_THREAD_STACK_SIZEOF(rx_stack[i]),
-			       K_PRIO_COOP(thread_priority));
+			       K_PRIO_COOP(thread_priority), RX_TC_CPU(i));
 		k_thread_name_set(&rx_classes[i].work_q.thread, "rx_workq");
 	}
+
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+	rx_flow_init();
+#endif
 }
@@ -36,7 +36,46 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+/* Routes are looked up through a path compressed binary trie of their
+ * prefixes. A node exists for every prefix some route uses, and for
+ * every bit position where the prefixes below it branch, so following
+ * the destination address bits from the root visits each matching prefix
+ * once, shortest first.
+ */
+struct route_trie_node {
+	struct route_trie_node *child[2];
+	struct route_trie_node *parent;
+
+	/** Routes to exactly this prefix, on different interfaces */
+	sys_slist_t routes;
+
+	/** Prefix, with the bits after len cleared */
+	struct in6_addr prefix;
+	u8_t len;
+};
+
+/* Every route adds at most one prefix node and one branch node. */
+static struct route_trie_node trie_nodes[2 * CONFIG_NET_MAX_ROUTES];
+static struct route_trie_node *trie_free;
+static struct route_trie_node trie_root;
+
+#if CONFIG_NET_ROUTE_LOOKUP_CACHE_SIZE > 0
+struct route_cache_entry {
+	struct net_if *iface;
+	struct net_route_entry *route;
+	struct in6_addr dst;
+	u32_t gen;
+};
+
+static struct route_cache_entry route_cache[CONFIG_NET_ROUTE_LOOKUP_CACHE_SIZE];
+#endif
+
+/* Changed on every route add or delete, cache entries of other
+ * generations are stale.
+ */
+static u32_t route_gen = 1U;
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -237,6 +276,272 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 }
 
 
+static inline int prefix_bit(const struct in6_addr *addr, u8_t bit)
+{
+	return (addr->s6_addr[bit / 8U] >> (7U - bit % 8U)) & 1U;
+}
+
+/* Number of leading bits, up to max, that a and b have in common. */
+static u8_t prefix_common_len(const struct in6_addr *a,
+			      const struct in6_addr *b, u8_t max)
+{
+	u8_t len = 0U;
+	int i;
+
+	for (i = 0; i < 16 && len < max; i++) {
+		u8_t diff = a->s6_addr[i] ^ b->s6_addr[i];
+
+		if (diff) {
+			len += __builtin_clz(diff) - 24;
+			break;
+		}
+
+		len += 8U;
+	}
+
+	return MIN(len, max);
+}
+
+static struct route_trie_node *trie_node_alloc(const struct in6_addr *addr,
+					       u8_t len)
+{
+	struct route_trie_node *node = trie_free;
+
+	if (!node) {
+		return NULL;
+	}
+
+	trie_free = node->child[0];
+
+	(void)memset(node, 0, sizeof(*node));
+	sys_slist_init(&node->routes);
+
+	(void)memcpy(node->prefix.s6_addr, addr->s6_addr, len / 8U);
+	if (len % 8U) {
+		node->prefix.s6_addr[len / 8U] = addr->s6_addr[len / 8U] &
+						 (0xff << (8U - len % 8U));
+	}
+
+	node->len = len;
+
+	return node;
+}
+
+static void trie_node_free(struct route_trie_node *node)
+{
+	node->child[0] = trie_free;
+	trie_free = node;
+}
+
+static inline void trie_link(struct route_trie_node *parent, int bit,
+			     struct route_trie_node *child)
+{
+	parent->child[bit] = child;
+	child->parent = parent;
+}
+
+/* Return the node of prefix addr/len, creating it if needed. */
+static struct route_trie_node *trie_insert(const struct in6_addr *addr,
+					   u8_t len)
+{
+	struct route_trie_node *cur = &trie_root;
+
+	while (cur->len < len) {
+		int bit = prefix_bit(addr, cur->len);
+		struct route_trie_node *next = cur->child[bit];
+		struct route_trie_node *node, *branch;
+		u8_t common;
+
+		if (!next) {
+			node = trie_node_alloc(addr, len);
+			if (node) {
+				trie_link(cur, bit, node);
+			}
+
+			return node;
+		}
+
+		common = prefix_common_len(addr, &next->prefix,
+					   MIN(len, next->len));
+		if (common == next->len) {
+			cur = next;
+			continue;
+		}
+
+		/* The prefix ends within the path from cur to next */
+		if (common == len) {
+			node = trie_node_alloc(addr, len);
+			if (node) {
+				trie_link(node, prefix_bit(&next->prefix, len),
+					  next);
+				trie_link(cur, bit, node);
+			}
+
+			return node;
+		}
+
+		/* The prefix leaves the path from cur to next */
+		branch = trie_node_alloc(addr, common);
+		node = trie_node_alloc(addr, len);
+		if (!branch || !node) {
+			if (branch) {
+				trie_node_free(branch);
+			}
+
+			if (node) {
+				trie_node_free(node);
+			}
+
+			return NULL;
+		}
+
+		trie_link(branch, prefix_bit(&next->prefix, common), next);
+		trie_link(branch, prefix_bit(addr, common), node);
+		trie_link(cur, bit, branch);
+
+		return node;
+	}
+
+	return cur;
+}
+
+static struct route_trie_node *trie_find(const struct in6_addr *addr,
+					 u8_t len)
+{
+	struct route_trie_node *cur = &trie_root;
+
+	while (cur->len < len) {
+		cur = cur->child[prefix_bit(addr, cur->len)];
+		if (!cur || cur->len > len ||
+		    prefix_common_len(addr, &cur->prefix, cur->len) !=
+		    cur->len) {
+			return NULL;
+		}
+	}
+
+	return cur;
+}
+
+/* Remove nodes which no longer hold routes nor separate two subtries. */
+static void trie_prune(struct route_trie_node *node)
+{
+	while (node != &trie_root && sys_slist_is_empty(&node->routes)) {
+		struct route_trie_node *parent = node->parent;
+		struct route_trie_node *child;
+
+		if (node->child[0] && node->child[1]) {
+			return;
+		}
+
+		child = node->child[0] ? node->child[0] : node->child[1];
+		if (child) {
+			trie_link(parent, parent->child[1] == node, child);
+		} else {
+			parent->child[parent->child[1] == node] = NULL;
+		}
+
+		trie_node_free(node);
+
+		if (child) {
+			return;
+		}
+
+		/* Parent lost a child, it may not be needed anymore */
+		node = parent;
+	}
+}
+
+static struct net_route_entry *trie_lookup(struct net_if *iface,
+					   const struct in6_addr *dst)
+{
+	struct route_trie_node *cur = &trie_root;
+	struct net_route_entry *found = NULL;
+
+	while (cur &&
+	       prefix_common_len(dst, &cur->prefix, cur->len) == cur->len) {
+		struct net_route_entry *route;
+
+		SYS_SLIST_FOR_EACH_CONTAINER(&cur->routes, route,
+					     prefix_node) {
+			if (!iface || route->iface == iface) {
+				found = route;
+				break;
+			}
+		}
+
+		if (cur->len == 128U) {
+			break;
+		}
+
+		cur = cur->child[prefix_bit(dst, cur->len)];
+	}
+
+	return found;
+}
+
+static inline void route_table_changed(void)
+{
+	route_gen++;
+	if (route_gen == 0U) {
+		route_gen = 1U;
+	}
+}
+
+#if CONFIG_NET_ROUTE_LOOKUP_CACHE_SIZE > 0
+static struct route_cache_entry *route_cache_slot(struct net_if *iface,
+						  const struct in6_addr *dst)
+{
+	u32_t h = UNALIGNED_GET(&dst->s6_addr32[0]) ^
+		  UNALIGNED_GET(&dst->s6_addr32[1]) ^
+		  UNALIGNED_GET(&dst->s6_addr32[2]) ^
+		  UNALIGNED_GET(&dst->s6_addr32[3]) ^
+		  POINTER_TO_UINT(iface);
+
+	h *= 0x9e3779b1U;
+
+	return &route_cache[(h >> 16) % CONFIG_NET_ROUTE_LOOKUP_CACHE_SIZE];
+}
+
+static bool route_cache_get(struct net_if *iface, const struct in6_addr *dst,
+			    struct net_route_entry **route)
+{
+	struct route_cache_entry *entry = route_cache_slot(iface, dst);
+
+	if (entry->gen != route_gen || entry->iface != iface ||
+	    !net_ipv6_addr_cmp(&entry->dst, dst)) {
+		return false;
+	}
+
+	*route = entry->route;
+
+	return true;
+}
+
+static void route_cache_put(struct net_if *iface, const struct in6_addr *dst,
+			    struct net_route_entry *route)
+{
+	struct route_cache_entry *entry = route_cache_slot(iface, dst);
+
+	entry->iface = iface;
+	entry->route = route;
+	net_ipaddr_copy(&entry->dst, dst);
+	entry->gen = route_gen;
+}
+#else
+static inline bool route_cache_get(struct net_if *iface,
+				   const struct in6_addr *dst,
+				   struct net_route_entry **route)
+{
+	return false;
+}
+
+static inline void route_cache_put(struct net_if *iface,
+				   const struct in6_addr *dst,
+				   struct net_route_entry *route)
+{
+}
+#endif /* CONFIG_NET_ROUTE_LOOKUP_CACHE_SIZE > 0 */
+
 #define net_route_info(str, route, dst)					\
 	do {								\
 	if (CONFIG_NET_ROUTE_LOG_LEVEL >= LOG_LEVEL_DBG) {		\
@@ -253,37 +558,18 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
 struct net_route_entry *net_route_lookup(struct net_if *iface,
 					 struct in6_addr *dst)
 {
-	struct net_route_entry *route, *found = NULL;
-	u8_t longest_match = 0U;
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
-
-		if (!nbr->ref) {
-			continue;
-		}
-
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
-
-		route = net_route_data(nbr);
+	struct net_route_entry *found;
 
-		if (route->prefix_len >= longest_match &&
-		    net_ipv6_is_prefix((u8_t *)dst,
-				       (u8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
-		}
+	if (!route_cache_get(iface, dst, &found)) {
+		found = trie_lookup(iface, dst);
+		route_cache_put(iface, dst, found);
 	}
 
 	if (found) {
@@ -303,6 +589,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	struct net_linkaddr_storage *nexthop_lladdr;
 	struct net_nbr *nbr, *nbr_nexthop, *tmp;
 	struct net_route_nexthop *nexthop_route;
+	struct route_trie_node *prefix;
 	struct net_route_entry *route;
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
        struct net_event_ipv6_route info;
@@ -353,9 +640,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -401,7 +686,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_prepend(&routes, &route->node);
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -412,6 +697,16 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	sys_slist_init(&route->nexthop);
 	sys_slist_prepend(&route->nexthop, &nexthop_route->node);
 
+	prefix = trie_insert(addr, prefix_len);
+	if (!prefix) {
+		NET_ERR("No route lookup node available!");
+		net_route_del(route);
+		return NULL;
+	}
+
+	sys_slist_prepend(&prefix->routes, &route->prefix_node);
+	route_table_changed();
+
 	net_route_info("Added", route, addr);
 
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
@@ -431,6 +726,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 
 int net_route_del(struct net_route_entry *route)
 {
+	struct route_trie_node *prefix;
 	struct net_nbr *nbr;
 	struct net_route_nexthop *nexthop_route;
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
@@ -454,13 +750,23 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
-
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
 		return -ENOENT;
 	}
 
+	if (sys_dnode_is_linked(&route->node)) {
+		sys_dlist_remove(&route->node);
+	}
+
+	prefix = trie_find(&route->addr, route->prefix_len);
+	if (prefix &&
+	    sys_slist_find_and_remove(&prefix->routes, &route->prefix_node)) {
+		trie_prune(prefix);
+	}
+
+	route_table_changed();
+
 	net_route_info("Deleted", route, &route->addr);
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&route->nexthop, nexthop_route, node) {
@@ -827,6 +1133,16 @@ int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
 
 void net_route_init(void)
 {
+	int i;
+
+	trie_free = NULL;
+
+	for (i = ARRAY_SIZE(trie_nodes) - 1; i >= 0; i--) {
+		trie_node_free(&trie_nodes[i]);
+	}
+
+	sys_slist_init(&trie_root.routes);
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
@@ -24,6 +24,7 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #include <net/net_pkt.h>
 #include <net/net_ip.h>
 #include <net/net_context.h>
+#include <net/ethernet.h>
 #include <sys/byteorder.h>
 
 #include "connection.h"
@@ -861,7 +862,7 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
 	struct net_context *ctx = net_pkt_context(pkt);
 	struct net_tcp_hdr *tcp_hdr;
-	bool calc_chksum = false;
+	bool chksum;
 
 	if (!ctx || !ctx->tcp) {
 		NET_ERR("%scontext is not set on pkt %p",
@@ -883,10 +884,23 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 		return -EMSGSIZE;
 	}
 
+	/* The checksum is updated for the rewritten header fields only,
+	 * instead of being calculated again over the whole segment.
+	 */
+	chksum = net_if_need_calc_tx_checksum(net_pkt_iface(pkt));
+
 	if (sys_get_be32(tcp_hdr->ack) != ctx->tcp->send_ack) {
-		sys_put_be32(ctx->tcp->send_ack, tcp_hdr->ack);
-		tcp_hdr->chksum = 0U;
-		calc_chksum = true;
+		u8_t ack[sizeof(tcp_hdr->ack)];
+
+		sys_put_be32(ctx->tcp->send_ack, ack);
+
+		if (chksum) {
+			tcp_hdr->chksum = net_chksum_update(tcp_hdr->chksum,
+							    tcp_hdr->ack, ack,
+							    sizeof(ack));
+		}
+
+		memcpy(tcp_hdr->ack, ack, sizeof(ack));
 	}
 
 	/* The data stream code always sets this flag, because
@@ -896,26 +910,23 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 	 */
 	if (ctx->tcp->sent_ack != ctx->tcp->send_ack &&
 		(tcp_hdr->flags & NET_TCP_ACK) == 0U) {
+		/* The data offset and the flags form one 16-bit word */
+		u8_t word[2] = { tcp_hdr->offset,
+				 tcp_hdr->flags | NET_TCP_ACK };
+
+		if (chksum) {
+			tcp_hdr->chksum = net_chksum_update(tcp_hdr->chksum,
+							    &tcp_hdr->offset,
+							    word, sizeof(word));
+		}
+
 		tcp_hdr->flags |= NET_TCP_ACK;
-		tcp_hdr->chksum = 0U;
-		calc_chksum = true;
 	}
 
 	/* As we modified the header, we need to write it back.
 	 */
 	net_pkt_set_data(pkt, &tcp_access);
 
-	if (calc_chksum) {
-		net_pkt_cursor_init(pkt);
-		net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
-			     net_pkt_ip_opts_len(pkt));
-
-		/* No need to get tcp_hdr again */
-		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
-
-		net_pkt_set_data(pkt, &tcp_access);
-	}
-
 	if (tcp_hdr->flags & NET_TCP_FIN) {
 		ctx->tcp->fin_sent = 1U;
 	}
@@ -1294,7 +1305,13 @@ int net_tcp_finalize(struct net_pkt *pkt)
 
 	tcp_hdr->chksum = 0U;
 
-	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+	/* Packets longer than the MTU are left to segmentation offload,
+	 * which computes the checksum of every segment it builds.
+	 */
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    !(net_pkt_family(pkt) == AF_INET &&
+	      net_eth_get_gso_max_size(net_pkt_iface(pkt)) &&
+	      net_pkt_get_len(pkt) > net_if_get_mtu(net_pkt_iface(pkt)))) {
 		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
 	}
 
@@ -16,11 +16,12 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #include "connection.h"
 #include "net_stats.h"
 #include "net_private.h"
+#include "tcp2.h"
 #include "tcp2_priv.h"
 
-static int tcp_rto = 500; /* Retransmission timeout, msec */
+static int tcp_rto = 500; /* Initial retransmission timeout, msec */
 static int tcp_retries = 3;
-static int tcp_window = NET_IPV6_MTU;
+static int tcp_window = CONFIG_NET_TCP2_RECV_WINDOW;
 static bool tcp_echo;
 
 static sys_slist_t tcp_conns = SYS_SLIST_STATIC_INIT(&tcp_conns);
@@ -28,7 +29,8 @@ static sys_slist_t tcp_conns = SYS_SLIST_STATIC_INIT(&tcp_conns);
 static K_MEM_SLAB_DEFINE(tcp_conns_slab, sizeof(struct tcp),
 				CONFIG_NET_MAX_CONTEXTS, 4);
 
-NET_BUF_POOL_DEFINE(tcp_nbufs, 64/*count*/, 128/*size*/, 0, NULL);
+NET_BUF_POOL_DEFINE(tcp_nbufs, CONFIG_NET_TCP2_BUF_COUNT/*count*/,
+		    128/*size*/, 0, NULL);
 
 static void tcp_in(struct tcp *conn, struct net_pkt *pkt);
 
@@ -275,6 +277,17 @@ static void tcp_send_queue_flush(struct tcp *conn)
 	}
 }
 
+static void tcp_ooo_flush(struct tcp *conn)
+{
+	struct net_pkt *pkt;
+
+	while ((pkt = tcp_slist(&conn->ooo, get, struct net_pkt, next))) {
+		tcp_pkt_unref(pkt);
+	}
+
+	conn->ooo_num = 0U;
+}
+
 static void tcp_win_free(struct tcp_win *w, const char *name)
 {
 	struct net_buf *buf;
@@ -287,6 +300,13 @@ static void tcp_win_free(struct tcp_win *w, const char *name)
 	tcp_free(w);
 }
 
+static void tcp_conn_ref(struct tcp *conn)
+{
+	int ref_count = atomic_inc(&conn->ref_count) + 1;
+
+	NET_DBG("conn: %p, ref_count: %d", conn, ref_count);
+}
+
 static int tcp_conn_unref(struct tcp *conn)
 {
 	int ref_count = atomic_dec(&conn->ref_count) - 1;
@@ -294,6 +314,14 @@ static int tcp_conn_unref(struct tcp *conn)
 
 	NET_DBG("conn: %p, ref_count=%d", conn, ref_count);
 
+	if (ref_count == 1 &&
+	    atomic_cas(&conn->rexmit_state, TCP_REXMIT_ARMED,
+		       TCP_REXMIT_IDLE)) {
+		/* Only the retransmission timer is left, nobody needs it */
+		k_timer_stop(&conn->rexmit_timer);
+		ref_count = atomic_dec(&conn->ref_count) - 1;
+	}
+
 	if (ref_count) {
 		tp_out(conn->iface, "TP_TRACE", "event", "CONN_DELETE");
 		goto out;
@@ -317,6 +345,10 @@ static int tcp_conn_unref(struct tcp *conn)
 
 	tcp_send_queue_flush(conn);
 
+	k_timer_stop(&conn->rexmit_timer);
+
+	tcp_ooo_flush(conn);
+
 	tcp_win_free(conn->snd, "SND");
 	tcp_win_free(conn->rcv, "RCV");
 
@@ -334,6 +366,23 @@ out:
 	return ref_count;
 }
 
+/* The application, the RX thread and the retransmission timer all update
+ * the connection, the lock serializes them. The reference keeps the
+ * connection valid until the lock is released, should the holder drop
+ * the last other reference.
+ */
+static void tcp_conn_lock(struct tcp *conn)
+{
+	tcp_conn_ref(conn);
+	k_mutex_lock(&conn->lock, K_FOREVER);
+}
+
+static void tcp_conn_unlock(struct tcp *conn)
+{
+	k_mutex_unlock(&conn->lock);
+	tcp_conn_unref(conn);
+}
+
 int net_tcp_unref(struct net_context *context)
 {
 	int ref_count = 0;
@@ -439,48 +488,92 @@ out:
 	return prefix ? s : (s + 4);
 }
 
-static void tcp_win_append(struct tcp_win *w, const char *name,
+static size_t tcp_win_append(struct tcp_win *w, const char *name,
 				const void *data, size_t len)
 {
-	struct net_buf *buf = tcp_nbuf_alloc(&tcp_nbufs, len);
 	size_t prev_len = w->len;
 
 	NET_ASSERT_INFO(len, "Zero length data");
 
-	memcpy(net_buf_add(buf, len), data, len);
+	while (len) {
+		struct net_buf *buf = tcp_nbuf_alloc(&tcp_nbufs, len);
+		size_t chunk;
+
+		if (!buf) {
+			break;
+		}
+
+		chunk = MIN(len, net_buf_tailroom(buf));
+
+		memcpy(net_buf_add(buf, chunk), data, chunk);
 
-	sys_slist_append(&w->bufs, (void *)&buf->user_data);
+		sys_slist_append(&w->bufs, (void *)&buf->user_data);
 
-	w->len += len;
+		w->len += chunk;
+		data = (const u8_t *)data + chunk;
+		len -= chunk;
+	}
+
+	NET_DBG("%s %zu->%zu byte(s)", name, prev_len, w->len);
 
-	NET_DBG("%s %p %zu->%zu byte(s)", name, buf, prev_len, w->len);
+	return w->len - prev_len;
 }
 
-static struct net_buf *tcp_win_peek(struct tcp_win *w, const char *name,
-					size_t len)
+/* Copy len bytes starting at offset off of the window to data */
+static void tcp_win_read(struct tcp_win *w, size_t off, void *data,
+				size_t len)
 {
-	struct net_buf *out = tcp_nbuf_alloc(&tcp_nbufs, len);
 	struct net_buf *buf = tcp_slist(&w->bufs, peek_head, struct net_buf,
 					user_data);
-	while (buf) {
+	u8_t *out = data;
 
-		if (len <= 0) {
-			break;
-		}
+	while (buf && len) {
+		if (off < buf->len) {
+			size_t chunk = MIN(len, buf->len - off);
 
-		memcpy(net_buf_add(out, buf->len), buf->data, buf->len);
+			memcpy(out, buf->data + off, chunk);
 
-		len -= buf->len;
+			out += chunk;
+			len -= chunk;
+			off = 0;
+		} else {
+			off -= buf->len;
+		}
 
 		buf = tcp_slist((sys_snode_t *)&buf->user_data, peek_next,
 				struct net_buf, user_data);
 	}
 
 	NET_ASSERT_INFO(len == 0, "Unfulfilled request, len: %zu", len);
+}
 
-	NET_DBG("%s len=%zu", name, net_buf_frags_len(out));
+/* Drop len bytes from the head of the window */
+static void tcp_win_consume(struct tcp_win *w, const char *name, size_t len)
+{
+	size_t prev_len = w->len;
 
-	return out;
+	NET_ASSERT_INFO(len <= w->len, "Insufficient window length, "
+			"len: %zu, req: %zu", w->len, len);
+
+	while (len) {
+		struct net_buf *buf = tcp_slist(&w->bufs, peek_head,
+						struct net_buf, user_data);
+
+		if (buf->len > len) {
+			net_buf_pull(buf, len);
+			w->len -= len;
+			break;
+		}
+
+		sys_slist_get(&w->bufs);
+
+		w->len -= buf->len;
+		len -= buf->len;
+
+		tcp_nbuf_unref(buf);
+	}
+
+	NET_DBG("%s %zu->%zu byte(s)", name, prev_len, w->len);
 }
 
 static const char *tcp_conn_state(struct tcp *conn, struct net_pkt *pkt)
@@ -495,7 +588,8 @@ static const char *tcp_conn_state(struct tcp *conn, struct net_pkt *pkt)
 	return buf;
 }
 
-static bool tcp_options_check(void *buf, ssize_t len)
+static bool tcp_options_check(void *buf, ssize_t len,
+				struct tcp_options *recv_options)
 {
 	bool result = len > 0 && ((len % 4) == 0) ? true : false;
 	u8_t *options = buf, opt, opt_len;
@@ -523,12 +617,48 @@ static bool tcp_options_check(void *buf, ssize_t len)
 				result = false;
 				goto end;
 			}
+			if (recv_options) {
+				recv_options->mss =
+					sys_get_be16(&options[2]);
+			}
 			break;
 		case TCPOPT_WINDOW:
 			if (opt_len != 3) {
 				result = false;
 				goto end;
 			}
+			if (recv_options) {
+				recv_options->wscale = options[2];
+				recv_options->wscale_ok = true;
+			}
+			break;
+		case TCPOPT_SACK_PERM:
+			if (opt_len != 2) {
+				result = false;
+				goto end;
+			}
+			if (recv_options) {
+				recv_options->sack_perm = true;
+			}
+			break;
+		case TCPOPT_SACK:
+			if ((opt_len - 2) % 8 || opt_len < 10 ||
+			    (opt_len - 2) / 8 > TCP_SACK_MAX) {
+				result = false;
+				goto end;
+			}
+			if (recv_options) {
+				int i;
+
+				recv_options->sack_num = (opt_len - 2) / 8;
+
+				for (i = 0; i < recv_options->sack_num; i++) {
+					recv_options->sack[i].left =
+						sys_get_be32(&options[2 + 8 * i]);
+					recv_options->sack[i].right =
+						sys_get_be32(&options[6 + 8 * i]);
+				}
+			}
 			break;
 		default:
 			continue;
@@ -549,45 +679,63 @@ static size_t tcp_data_len(struct net_pkt *pkt)
 	u8_t off = th->th_off;
 	ssize_t data_len = ntohs(ip->len) - sizeof(*ip) - off * 4;
 
-	if (off > 5 && false == tcp_options_check((th + 1), (off - 5) * 4)) {
+	if (off > 5 && false == tcp_options_check((th + 1), (off - 5) * 4,
+							NULL)) {
 		data_len = 0;
 	}
 
 	return data_len > 0 ? data_len : 0;
 }
 
-static size_t tcp_data_get(struct tcp *conn, struct net_pkt *pkt)
+/* Pass the data of the segment, from offset off on, to the application */
+static size_t tcp_data_get(struct tcp *conn, struct net_pkt *pkt, size_t off)
 {
 	struct net_ipv4_hdr *ip = ip_get(pkt);
 	struct tcphdr *th = th_get(pkt);
-	ssize_t len = tcp_data_len(pkt);
+	size_t hdr_len = sizeof(*ip) + th->th_off * 4;
+	ssize_t len = tcp_data_len(pkt) - off;
+
+	if (len <= 0) {
+		return 0;
+	}
+
+	if (conn->context->recv_cb) {
+		struct net_pkt *up = net_pkt_clone(pkt, K_NO_WAIT);
 
-	if (len > 0) {
+		if (!up) {
+			return 0;
+		}
+
+		net_pkt_cursor_init(up);
+		net_pkt_set_overwrite(up, true);
+		net_pkt_skip(up, hdr_len + off);
+
+		net_context_packet_received(
+			(struct net_conn *)conn->context->conn_handler,
+			up, NULL, NULL, conn->recv_user_data);
+	} else if (!IS_ENABLED(CONFIG_NET_TEST_PROTOCOL)) {
+		/* Not accepted yet, let the peer retransmit */
+		return 0;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TEST_PROTOCOL) || tcp_echo) {
 		void *buf = tcp_malloc(len);
 
-		net_pkt_skip(pkt, sizeof(*ip) + th->th_off * 4);
+		net_pkt_cursor_init(pkt);
+		net_pkt_set_overwrite(pkt, true);
+		net_pkt_skip(pkt, hdr_len + off);
 
 		net_pkt_read(pkt, buf, len);
 
-		tcp_win_append(conn->rcv, "RCV", buf, len);
+		if (IS_ENABLED(CONFIG_NET_TEST_PROTOCOL)) {
+			tcp_win_append(conn->rcv, "RCV", buf, len);
+		}
 
 		if (tcp_echo) {
 			tcp_win_append(conn->snd, "SND", buf, len);
 		}
 
 		tcp_free(buf);
-
-		if (conn->context->recv_cb) {
-			struct net_pkt *up = net_pkt_clone(pkt, K_NO_WAIT);
-
-			net_pkt_cursor_init(up);
-			net_pkt_set_overwrite(up, true);
-			net_pkt_skip(up, 40);
-
-			net_context_packet_received(
-				(struct net_conn *)conn->context->conn_handler,
-				up, NULL, NULL, conn->recv_user_data);
-		}
 	}
 
 	return len;
@@ -601,12 +749,57 @@ static void tcp_adj(struct net_pkt *pkt, int req_len)
 	ip->len = htons(len);
 }
 
-static struct net_pkt *tcp_pkt_make(struct tcp *conn, u8_t flags)
+static u16_t tcp_mss_local(struct tcp *conn)
+{
+	u16_t mtu = conn->iface ? net_if_get_mtu(conn->iface) : 0U;
+
+	return mtu > 40U ? mtu - 40U : TCP_MSS_DEFAULT;
+}
+
+static size_t tcp_sack_blocks(struct tcp *conn, u8_t *opts);
+
+static size_t tcp_options_make(struct tcp *conn, u8_t flags, u8_t *opts)
 {
-	const size_t len = 40;
+	size_t len = 0;
+
+	if (SYN & flags) {
+		opts[len++] = TCPOPT_MAXSEG;
+		opts[len++] = 4U;
+		sys_put_be16(tcp_mss_local(conn), &opts[len]);
+		len += 2;
+
+		/* A SYN-ACK only carries the options offered in the SYN */
+		if (IS_ENABLED(CONFIG_NET_TCP2_WINDOW_SCALING) &&
+		    (!(ACK & flags) || conn->wscale_ok)) {
+			opts[len++] = TCPOPT_NOP;
+			opts[len++] = TCPOPT_WINDOW;
+			opts[len++] = 3U;
+			opts[len++] = conn->rcv_wscale;
+		}
+
+		if (IS_ENABLED(CONFIG_NET_TCP2_SACK) &&
+		    (!(ACK & flags) || conn->sack_ok)) {
+			opts[len++] = TCPOPT_NOP;
+			opts[len++] = TCPOPT_NOP;
+			opts[len++] = TCPOPT_SACK_PERM;
+			opts[len++] = 2U;
+		}
+	} else if ((ACK & flags) && conn->sack_ok) {
+		len = tcp_sack_blocks(conn, opts);
+	}
+
+	return len;
+}
+
+static struct net_pkt *tcp_pkt_make(struct tcp *conn, u8_t flags, u32_t seq)
+{
+	u8_t opts[40];
+	size_t opts_len = tcp_options_make(conn, flags, opts);
+	const size_t len = 40 + opts_len;
 	struct net_pkt *pkt = tcp_pkt_alloc(len);
 	struct net_ipv4_hdr *ip = ip_get(pkt);
 	struct tcphdr *th = (void *) (ip + 1);
+	u32_t win = conn->win;
 
 	memset(ip, 0, len);
 
@@ -621,146 +814,699 @@ static struct net_pkt *tcp_pkt_make(struct tcp *conn, u8_t flags)
 	th->th_sport = conn->src->sin.sin_port;
 	th->th_dport = conn->dst->sin.sin_port;
 
-	th->th_off = 5;
+	th->th_off = 5 + opts_len / 4;
 	th->th_flags = flags;
-	th->th_win = htons(conn->win);
-	th->th_seq = htonl(conn->seq);
+
+	/* The window of a SYN segment is never scaled, RFC 7323 */
+	if (!(SYN & flags)) {
+		win >>= conn->rcv_wscale;
+	}
+
+	th->th_win = htons(MIN(win, 0xffff));
+	th->th_seq = htonl(seq);
 
 	if (ACK & flags) {
 		th->th_ack = htonl(conn->ack);
 	}
 
+	memcpy(th + 1, opts, opts_len);
+
 	pkt->iface = conn->iface;
 
 	return pkt;
 }
 
-static u32_t sum(void *data, size_t len)
+static void tcp_csum(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *ip = ip_get(pkt);
+	struct tcphdr *th = (void *) (ip + 1);
+
+	net_pkt_set_ip_hdr_len(pkt, sizeof(*ip));
+
+	ip->chksum = 0U;
+	ip->chksum = net_calc_chksum_ipv4(pkt);
+
+	th->th_sum = 0U;
+	th->th_sum = net_calc_chksum_tcp(pkt);
+}
+
+static void tcp_out(struct tcp *conn, u8_t flags)
 {
-	u32_t s = 0;
+	struct net_pkt *pkt = tcp_pkt_make(conn, flags, conn->seq);
+
+	tcp_csum(pkt);
+
+	NET_DBG("%s", tcp_th(pkt));
 
-	for ( ; len > 1; len -= 2, data = (u8_t *)data + 2) {
-		s += *((u16_t *)data);
+	if (tcp_send_cb) {
+		tcp_send_cb(pkt);
+		goto out;
 	}
 
-	if (len) {
-		s += *((u8_t *)data);
+	sys_slist_append(&conn->send_queue, &pkt->next);
+
+	tcp_send_process(&conn->send_timer);
+out:
+	return;
+}
+
+/* Send len bytes of the send window starting at sequence number seq */
+static int tcp_out_data(struct tcp *conn, u32_t seq, size_t len)
+{
+	struct net_pkt *pkt = tcp_pkt_make(conn, PSH | ACK, seq);
+	size_t off = seq - conn->snd_una;
+
+	while (len) {
+		struct net_buf *buf = net_pkt_get_frag(pkt, K_NO_WAIT);
+		size_t chunk;
+
+		if (!buf) {
+			tcp_pkt_unref(pkt);
+			return -ENOBUFS;
+		}
+
+		chunk = MIN(len, net_buf_tailroom(buf));
+
+		tcp_win_read(conn->snd, off, net_buf_add(buf, chunk), chunk);
+
+		net_pkt_frag_add(pkt, buf);
+
+		tcp_adj(pkt, chunk);
+
+		off += chunk;
+		len -= chunk;
 	}
 
-	return s;
+	tcp_csum(pkt);
+
+	tcp_send(pkt);
+
+	return 0;
 }
 
-static uint16_t cs(int32_t s)
+/* Congestion control is NewReno, RFC 5681 and RFC 6582 */
+static void newreno_init(struct tcp *conn)
 {
-	return ~((s & 0xFFFF) + (s >> 16));
+	/* Initial window, RFC 5681 section 3.1 */
+	if (conn->mss > 2190U) {
+		conn->cwnd = 2U * conn->mss;
+	} else if (conn->mss > 1095U) {
+		conn->cwnd = 3U * conn->mss;
+	} else {
+		conn->cwnd = 4U * conn->mss;
+	}
+
+	conn->ssthresh = UINT32_MAX;
 }
 
-static void tcp_csum(struct net_pkt *pkt)
+static void newreno_ack(struct tcp *conn, u32_t acked)
 {
-	struct net_ipv4_hdr *ip = ip_get(pkt);
-	struct tcphdr *th = (void *) (ip + 1);
-	u16_t len = ntohs(ip->len) - 20;
-	u32_t s;
+	if (conn->cwnd < conn->ssthresh) {
+		/* Slow start */
+		conn->cwnd += MIN(acked, conn->mss);
+	} else {
+		/* Congestion avoidance */
+		conn->cwnd += MAX(1U, conn->mss * conn->mss / conn->cwnd);
+	}
+}
 
-	ip->chksum = cs(sum(ip, sizeof(*ip)));
+static void newreno_loss(struct tcp *conn, enum tcp_cc_event event)
+{
+	u32_t flight = conn->seq - conn->snd_una;
 
-	s = sum(&ip->src, sizeof(struct in_addr) * 2);
-	s += ntohs(ip->proto + len);
+	conn->ssthresh = MAX(flight / 2U, 2U * conn->mss);
 
-	th->th_sum = 0;
-	s += sum(th, len);
+	if (event == TCP_CC_EVENT_RTO) {
+		conn->cwnd = conn->mss;
+	} else {
+		conn->cwnd = conn->ssthresh + TCP_DUP_ACKS * conn->mss;
+	}
+}
 
-	th->th_sum = cs(s);
+static void newreno_recovered(struct tcp *conn)
+{
+	conn->cwnd = conn->ssthresh;
 }
 
-static struct net_pkt *tcp_pkt_linearize(struct net_pkt *pkt)
+static inline u32_t tcp_flight(struct tcp *conn)
 {
-	struct net_pkt *new = tcp_pkt_alloc(0);
-	struct net_buf *tmp, *buf = net_pkt_get_frag(new, K_NO_WAIT);
+	return conn->seq - conn->snd_una;
+}
+
+/* The retransmission timer holds a reference on the connection from the
+ * moment it is armed until either its handler has run or it is stopped
+ * before firing. Moving rexmit_state away from TCP_REXMIT_ARMED decides
+ * which of the two happens, so the reference is dropped exactly once and
+ * never while the handler may still look at the connection.
+ */
+static void tcp_rexmit_start(struct tcp *conn, s32_t timeout)
+{
+	tcp_conn_ref(conn);
 
-	for (tmp = pkt->frags; tmp; tmp = tmp->frags) {
-		memcpy(net_buf_add(buf, tmp->len), tmp->data, tmp->len);
+	if (!atomic_cas(&conn->rexmit_state, TCP_REXMIT_IDLE,
+			TCP_REXMIT_ARMED)) {
+		/* Already armed or queued, that reference is enough */
+		tcp_conn_unref(conn);
 	}
 
-	net_pkt_frag_add(new, buf);
+	k_timer_start(&conn->rexmit_timer, K_MSEC(timeout), K_NO_WAIT);
+}
 
-	new->iface = pkt->iface;
+static void tcp_rexmit_arm(struct tcp *conn)
+{
+	conn->rexmit_deadline = k_uptime_get_32() + conn->rto;
 
-	tcp_pkt_unref(pkt);
+	tcp_rexmit_start(conn, conn->rto);
+}
+
+static void tcp_rexmit_cancel(struct tcp *conn)
+{
+	k_timer_stop(&conn->rexmit_timer);
 
-	return new;
+	if (atomic_cas(&conn->rexmit_state, TCP_REXMIT_ARMED,
+		       TCP_REXMIT_IDLE)) {
+		tcp_conn_unref(conn);
+	}
 }
 
-static void tcp_chain_free(struct net_buf *head)
+static void tcp_rexmit_expired(struct k_timer *timer)
 {
-	struct net_buf *next;
+	struct tcp *conn = k_timer_user_data_get(timer);
 
-	for ( ; head; head = next) {
-		next = head->frags;
-		head->frags = NULL;
-		tcp_nbuf_unref(head);
+	if (atomic_cas(&conn->rexmit_state, TCP_REXMIT_ARMED,
+		       TCP_REXMIT_QUEUED)) {
+		k_work_submit(&conn->rexmit_work);
 	}
 }
 
-static void tcp_chain(struct net_pkt *pkt, struct net_buf *head)
+/* Update the retransmission timeout with a new RTT sample, RFC 6298 */
+static void tcp_rtt_update(struct tcp *conn, s32_t rtt)
 {
-	struct net_buf *buf;
+	if (conn->srtt == 0) {
+		conn->srtt = rtt << 3;
+		conn->rttvar = rtt << 1;
+	} else {
+		s32_t delta = rtt - (conn->srtt >> 3);
 
-	for ( ; head; head = head->frags) {
-		buf = net_pkt_get_frag(pkt, K_NO_WAIT);
-		memcpy(net_buf_add(buf, head->len), head->data, head->len);
-		net_pkt_frag_add(pkt, buf);
+		conn->srtt += delta;
+
+		if (delta < 0) {
+			delta = -delta;
+		}
+
+		conn->rttvar += delta - (conn->rttvar >> 2);
+	}
+
+	conn->rto = (conn->srtt >> 3) + MAX(1, conn->rttvar);
+	conn->rto = MAX(conn->rto, TCP_RTO_MIN);
+	conn->rto = MIN(conn->rto, TCP_RTO_MAX);
+
+	NET_DBG("rtt: %d, srtt: %d, rttvar: %d, rto: %d", rtt,
+		conn->srtt >> 3, conn->rttvar >> 2, conn->rto);
+}
+
+/* Merge a block acknowledged by the peer into the SACK scoreboard, which
+ * is kept sorted. If the scoreboard is full, the highest block is lost.
+ */
+static void tcp_sack_add(struct tcp *conn, u32_t left, u32_t right)
+{
+	struct tcp_sack_block *sacked = conn->sacked;
+	int i;
+
+	for (i = 0; i < conn->sacked_num && seq_lt(sacked[i].left, left);
+	     i++) {
+	}
+
+	if (conn->sacked_num == TCP_SACK_MAX) {
+		if (i == TCP_SACK_MAX) {
+			return;
+		}
+
+		conn->sacked_num--;
+	}
+
+	memmove(&sacked[i + 1], &sacked[i],
+		(conn->sacked_num - i) * sizeof(*sacked));
+
+	sacked[i].left = left;
+	sacked[i].right = right;
+	conn->sacked_num++;
+
+	for (i = 0; i + 1 < conn->sacked_num; ) {
+		if (seq_lt(sacked[i].right, sacked[i + 1].left)) {
+			i++;
+			continue;
+		}
+
+		if (seq_gt(sacked[i + 1].right, sacked[i].right)) {
+			sacked[i].right = sacked[i + 1].right;
+		}
+
+		memmove(&sacked[i + 1], &sacked[i + 2],
+			(conn->sacked_num - i - 2) * sizeof(*sacked));
+		conn->sacked_num--;
 	}
 }
 
-static void tcp_out(struct tcp *conn, u8_t flags, ...)
+/* Forget the scoreboard below the cumulative acknowledgment */
+static void tcp_sack_trim(struct tcp *conn)
 {
-	struct net_pkt *pkt = tcp_pkt_make(conn, flags);
+	struct tcp_sack_block *sacked = conn->sacked;
 
-	if (PSH & flags) {
-		size_t len = conn->snd->len;
-		struct net_buf *buf = tcp_win_peek(conn->snd, "SND", len);
+	while (conn->sacked_num && seq_le(sacked[0].right, conn->snd_una)) {
+		conn->sacked_num--;
+		memmove(&sacked[0], &sacked[1],
+			conn->sacked_num * sizeof(*sacked));
+	}
 
-		{
-			va_list ap;
-			ssize_t *out_len;
+	if (conn->sacked_num && seq_lt(sacked[0].left, conn->snd_una)) {
+		sacked[0].left = conn->snd_una;
+	}
+}
 
-			va_start(ap, flags);
-			out_len = va_arg(ap, ssize_t *);
-			*out_len = len;
-			va_end(ap);
+/* Build the SACK option describing the out of order data we hold */
+static size_t tcp_sack_blocks(struct tcp *conn, u8_t *opts)
+{
+	struct tcp_sack_block blocks[TCP_SACK_MAX];
+	struct net_pkt *pkt;
+	size_t len = 4;
+	int i, num = 0;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&conn->ooo, pkt, next) {
+		u32_t seq = th_seq(th_get(pkt));
+		u32_t end = seq + tcp_data_len(pkt);
+
+		if (num && seq_le(seq, blocks[num - 1].right)) {
+			if (seq_gt(end, blocks[num - 1].right)) {
+				blocks[num - 1].right = end;
+			}
+
+			continue;
 		}
 
-		tcp_chain(pkt, buf);
+		if (num == TCP_SACK_MAX) {
+			break;
+		}
 
-		tcp_chain_free(buf);
+		blocks[num].left = seq;
+		blocks[num].right = end;
+		num++;
+	}
 
-		tcp_adj(pkt, len);
+	if (num == 0) {
+		return 0;
 	}
 
-	pkt = tcp_pkt_linearize(pkt);
+	for (i = 0; i < num; i++, len += 8) {
+		sys_put_be32(blocks[i].left, &opts[len]);
+		sys_put_be32(blocks[i].right, &opts[len + 4]);
+	}
 
-	tcp_csum(pkt);
+	opts[0] = TCPOPT_NOP;
+	opts[1] = TCPOPT_NOP;
+	opts[2] = TCPOPT_SACK;
+	opts[3] = len - 2;
 
-	NET_DBG("%s", tcp_th(pkt));
+	return len;
+}
 
-	if (tcp_send_cb) {
-		tcp_send_cb(pkt);
+/* Retransmit the first segment from seq on that the peer has not
+ * selectively acknowledged. Return the sequence number following the
+ * retransmitted data, or seq if there was nothing to retransmit.
+ */
+static u32_t tcp_retransmit(struct tcp *conn, u32_t seq)
+{
+	u32_t end = conn->seq;
+	size_t len;
+	int i;
+
+	for (i = 0; i < conn->sacked_num; i++) {
+		struct tcp_sack_block *block = &conn->sacked[i];
+
+		if (seq_le(block->right, seq)) {
+			continue;
+		}
+
+		if (seq_le(block->left, seq)) {
+			seq = block->right;
+			continue;
+		}
+
+		end = block->left;
+		break;
+	}
+
+	if (seq_ge(seq, end)) {
+		return seq;
+	}
+
+	len = MIN(end - seq, conn->mss);
+
+	NET_DBG("seq: %u, len: %zu", seq, len);
+
+	/* Karn's algorithm, do not time retransmitted segments */
+	conn->rtt_pending = false;
+
+	if (tcp_out_data(conn, seq, len) < 0) {
+		return seq;
+	}
+
+	return seq + len;
+}
+
+/* Send as much new data as the congestion and peer windows allow */
+static void tcp_send_data(struct tcp *conn)
+{
+	u32_t wnd = MIN(conn->cwnd, conn->snd_wnd);
+	u32_t flight = tcp_flight(conn);
+
+	while (conn->snd->len > flight && wnd > flight) {
+		size_t len = MIN(conn->snd->len - flight, conn->mss);
+
+		len = MIN(len, wnd - flight);
+
+		if (tcp_out_data(conn, conn->seq, len) < 0) {
+			break;
+		}
+
+		if (!conn->rtt_pending) {
+			conn->rtt_pending = true;
+			conn->rtt_seq = conn->seq;
+			conn->rtt_start = k_uptime_get_32();
+		}
+
+		conn_seq(conn, + len);
+		flight += len;
+	}
+
+	/* Also covers probing a zero window */
+	if (conn->snd->len &&
+	    atomic_get(&conn->rexmit_state) == TCP_REXMIT_IDLE) {
+		tcp_rexmit_arm(conn);
+	}
+}
+
+static void tcp_rexmit_timeout(struct k_work *work)
+{
+	struct tcp *conn = CONTAINER_OF(work, struct tcp, rexmit_work);
+	s32_t left;
+
+	/* The reference the timer held is dropped on the way out */
+	k_mutex_lock(&conn->lock, K_FOREVER);
+
+	atomic_set(&conn->rexmit_state, TCP_REXMIT_IDLE);
+
+	if (atomic_get(&conn->ref_count) == 1) {
+		/* The connection was released while the handler was pending */
 		goto out;
 	}
 
-	sys_slist_append(&conn->send_queue, &pkt->next);
+	left = (s32_t)(conn->rexmit_deadline - k_uptime_get_32());
+	if (left > 0) {
+		/* Re-armed after it fired, before the handler got to run */
+		tcp_rexmit_start(conn, left);
+		goto out;
+	}
 
-	tcp_send_process(&conn->send_timer);
+	if (tcp_flight(conn) == 0) {
+		if (conn->snd->len) {
+			NET_DBG("Zero window probe");
+			tcp_out_data(conn, conn->seq, 1);
+			conn_seq(conn, + 1);
+			tcp_rexmit_arm(conn);
+		}
+
+		goto out;
+	}
+
+	if (conn->rexmit_count++ >= tcp_retries) {
+		NET_DBG("conn: %p, retransmission limit reached", conn);
+		tcp_conn_unref(conn);
+		goto out;
+	}
+
+	NET_DBG("conn: %p, rto: %d, flight: %u", conn, conn->rto,
+		tcp_flight(conn));
+
+	newreno_loss(conn, TCP_CC_EVENT_RTO);
+	conn->cc_state = TCP_CC_LOSS;
+	conn->recover = conn->seq;
+	conn->dup_acks = 0U;
+
+	/* Back off the timer, RFC 6298 section 5.5 */
+	conn->rto = MIN(conn->rto * 2, TCP_RTO_MAX);
+
+	conn->rexmit_nxt = tcp_retransmit(conn, conn->snd_una);
+
+	tcp_rexmit_arm(conn);
 out:
-	return;
+	k_mutex_unlock(&conn->lock);
+	tcp_conn_unref(conn);
 }
 
-static void tcp_conn_ref(struct tcp *conn)
+/* Process the acknowledgment and window of a segment */
+static void tcp_ack_in(struct tcp *conn, struct net_pkt *pkt,
+			struct tcp_options *opts)
 {
-	int ref_count = atomic_inc(&conn->ref_count) + 1;
+	struct tcphdr *th = th_get(pkt);
+	u32_t ack = th_ack(th);
+	u32_t wnd = ntohs(th->th_win) << conn->snd_wscale;
+	bool wnd_changed = wnd != conn->snd_wnd;
+	u32_t acked;
+	int i;
 
-	NET_DBG("conn: %p, ref_count: %d", conn, ref_count);
+	if (seq_lt(ack, conn->snd_una) || seq_gt(ack, conn->seq)) {
+		NET_DBG("ACK %u outside of %u..%u", ack, conn->snd_una,
+			conn->seq);
+		return;
+	}
+
+	conn->snd_wnd = wnd;
+
+	for (i = 0; conn->sack_ok && i < opts->sack_num; i++) {
+		struct tcp_sack_block *block = &opts->sack[i];
+
+		if (seq_lt(block->left, block->right) &&
+		    seq_gt(block->left, ack) &&
+		    seq_le(block->right, conn->seq)) {
+			tcp_sack_add(conn, block->left, block->right);
+		}
+	}
+
+	acked = ack - conn->snd_una;
+
+	if (acked) {
+		if (conn->rtt_pending && seq_gt(ack, conn->rtt_seq)) {
+			tcp_rtt_update(conn,
+				       k_uptime_get_32() - conn->rtt_start);
+			conn->rtt_pending = false;
+		}
+
+		tcp_win_consume(conn->snd, "SND", acked);
+
+		conn->snd_una = ack;
+		conn->dup_acks = 0U;
+		conn->rexmit_count = 0U;
+
+		tcp_sack_trim(conn);
+
+		switch (conn->cc_state) {
+		case TCP_CC_RECOVERY:
+			if (seq_ge(ack, conn->recover)) {
+				conn->cc_state = TCP_CC_OPEN;
+				newreno_recovered(conn);
+				break;
+			}
+
+			/* Partial ACK, RFC 6582 section 3.2 */
+			conn->cwnd -= MIN(conn->cwnd, acked);
+			conn->cwnd += conn->mss;
+			conn->rexmit_nxt = tcp_retransmit(conn, ack);
+			break;
+		case TCP_CC_LOSS:
+			newreno_ack(conn, acked);
+
+			if (seq_ge(ack, conn->recover)) {
+				conn->cc_state = TCP_CC_OPEN;
+				break;
+			}
+
+			conn->rexmit_nxt = tcp_retransmit(conn, ack);
+			break;
+		default:
+			newreno_ack(conn, acked);
+		}
+
+		if (tcp_flight(conn)) {
+			tcp_rexmit_arm(conn);
+		} else {
+			tcp_rexmit_cancel(conn);
+		}
+	} else if (tcp_flight(conn) && tcp_data_len(pkt) == 0 &&
+		   !wnd_changed) {
+		/* Duplicate ACK, RFC 5681 section 2 */
+		if (conn->dup_acks < UINT8_MAX) {
+			conn->dup_acks++;
+		}
+
+		if (conn->cc_state == TCP_CC_RECOVERY) {
+			conn->cwnd += conn->mss;
+
+			/* With SACK, retransmit the next hole below the
+			 * highest selectively acknowledged data.
+			 */
+			if (conn->sacked_num) {
+				u32_t seq = conn->rexmit_nxt;
+
+				if (seq_lt(seq, conn->snd_una)) {
+					seq = conn->snd_una;
+				}
+
+				if (seq_lt(seq, conn->sacked[
+					   conn->sacked_num - 1].left)) {
+					conn->rexmit_nxt =
+						tcp_retransmit(conn, seq);
+				}
+			}
+		} else if (conn->dup_acks == TCP_DUP_ACKS &&
+			   conn->cc_state == TCP_CC_OPEN) {
+			NET_DBG("conn: %p, fast retransmit %u", conn, ack);
+
+			newreno_loss(conn, TCP_CC_EVENT_DUP_ACKS);
+			conn->cc_state = TCP_CC_RECOVERY;
+			conn->recover = conn->seq;
+			conn->rexmit_nxt = tcp_retransmit(conn, ack);
+
+			tcp_rexmit_arm(conn);
+		}
+	}
+
+	tcp_send_data(conn);
+}
+
+/* Queue a segment beyond the next expected sequence number */
+static void tcp_ooo_add(struct tcp *conn, struct net_pkt *pkt)
+{
+	u32_t seq = th_seq(th_get(pkt));
+	struct net_pkt *prev = NULL, *tmp, *clone;
+
+	if (conn->ooo_num >= TCP_OOO_MAX ||
+	    seq_ge(seq, conn->ack + conn->win)) {
+		return;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&conn->ooo, tmp, next) {
+		u32_t tmp_seq = th_seq(th_get(tmp));
+
+		if (tmp_seq == seq) {
+			return;
+		}
+
+		if (seq_gt(tmp_seq, seq)) {
+			break;
+		}
+
+		prev = tmp;
+	}
+
+	clone = tcp_pkt_clone(pkt);
+	if (!clone) {
+		return;
+	}
+
+	sys_slist_insert(&conn->ooo, prev ? &prev->next : NULL, &clone->next);
+	conn->ooo_num++;
+}
+
+/* Pass the queued segments which have become in order */
+static void tcp_ooo_drain(struct tcp *conn)
+{
+	struct net_pkt *pkt;
+
+	while ((pkt = tcp_slist(&conn->ooo, peek_head, struct net_pkt,
+				next))) {
+		u32_t seq = th_seq(th_get(pkt));
+		u32_t end = seq + tcp_data_len(pkt);
+
+		if (seq_gt(seq, conn->ack)) {
+			break;
+		}
+
+		if (seq_gt(end, conn->ack)) {
+			size_t len = tcp_data_get(conn, pkt, conn->ack - seq);
+
+			if (len == 0) {
+				break;
+			}
+
+			conn_ack(conn, + len);
+		}
+
+		sys_slist_get(&conn->ooo);
+		conn->ooo_num--;
+		tcp_pkt_unref(pkt);
+	}
+}
+
+/* Receive the data of a segment and acknowledge it, return -EINVAL if
+ * the segment carries no data.
+ */
+static int tcp_data_in(struct tcp *conn, struct net_pkt *pkt)
+{
+	u32_t seq = th_seq(th_get(pkt));
+	size_t len = tcp_data_len(pkt);
+
+	if (len == 0) {
+		return -EINVAL;
+	}
+
+	if (seq_gt(seq, conn->ack)) {
+		tcp_ooo_add(conn, pkt);
+	} else if (seq_gt(seq + len, conn->ack)) {
+		len = tcp_data_get(conn, pkt, conn->ack - seq);
+		if (len) {
+			conn_ack(conn, + len);
+			tcp_ooo_drain(conn);
+		}
+	}
+
+	/* A segment out of order or already received is acknowledged
+	 * with the next expected sequence number.
+	 */
+	tcp_out(conn, ACK);
+
+	if (tcp_echo) {
+		tcp_send_data(conn);
+	}
+
+	return 0;
+}
+
+/* Apply the options of a SYN segment */
+static void tcp_syn_in(struct tcp *conn, struct tcphdr *th,
+			struct tcp_options *opts)
+{
+	u16_t mss = opts->mss ? opts->mss : TCP_MSS_DEFAULT;
+
+	conn->mss = MIN(mss, tcp_mss_local(conn));
+
+	conn->wscale_ok = IS_ENABLED(CONFIG_NET_TCP2_WINDOW_SCALING) &&
+		opts->wscale_ok;
+	if (conn->wscale_ok) {
+		conn->snd_wscale = MIN(opts->wscale, TCP_WSCALE_MAX);
+	} else {
+		conn->snd_wscale = 0U;
+		conn->rcv_wscale = 0U;
+	}
+
+	conn->sack_ok = IS_ENABLED(CONFIG_NET_TCP2_SACK) && opts->sack_perm;
+
+	conn->snd_wnd = ntohs(th->th_win);
+
+	newreno_init(conn);
+
+	NET_DBG("mss: %hu, wscale: %hu/%hu, sack: %d", conn->mss,
+		conn->snd_wscale, conn->rcv_wscale, conn->sack_ok);
 }
 
 static struct tcp *tcp_conn_alloc(void)
@@ -779,14 +1525,32 @@ static struct tcp *tcp_conn_alloc(void)
 
 	conn->win = tcp_window;
 
+	if (IS_ENABLED(CONFIG_NET_TCP2_WINDOW_SCALING)) {
+		while ((conn->win >> conn->rcv_wscale) > 0xffff &&
+		       conn->rcv_wscale < TCP_WSCALE_MAX) {
+			conn->rcv_wscale++;
+		}
+	}
+
 	conn->rcv = tcp_win_new();
 	conn->snd = tcp_win_new();
 
 	sys_slist_init(&conn->send_queue);
+	sys_slist_init(&conn->ooo);
 
 	k_timer_init(&conn->send_timer, tcp_send_process, NULL);
 	k_timer_user_data_set(&conn->send_timer, conn);
 
+	k_timer_init(&conn->rexmit_timer, tcp_rexmit_expired, NULL);
+	k_timer_user_data_set(&conn->rexmit_timer, conn);
+	k_work_init(&conn->rexmit_work, tcp_rexmit_timeout);
+
+	k_mutex_init(&conn->lock);
+
+	conn->rto = tcp_rto;
+	conn->mss = TCP_MSS_DEFAULT;
+	newreno_init(conn);
+
 	tcp_conn_ref(conn);
 
 	sys_slist_append(&tcp_conns, (sys_snode_t *)conn);
@@ -985,9 +1749,16 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 {
 	struct tcphdr *th = th_get(pkt);
 	u8_t next = 0, fl = th ? th->th_flags : 0;
+	struct tcp_options opts = { 0 };
+
+	tcp_conn_lock(conn);
 
 	NET_DBG("%s", tcp_conn_state(conn, pkt));
 
+	if (th && th->th_off > 5) {
+		tcp_options_check((th + 1), (th->th_off - 5) * 4, &opts);
+	}
+
 	if (th && th->th_off < 5) {
 		tcp_out(conn, RST);
 		conn_state(conn, TCP_CLOSED);
@@ -1002,6 +1773,7 @@ next_state:
 	case TCP_LISTEN:
 		if (FL(&fl, ==, SYN)) {
 			conn_ack(conn, th_seq(th) + 1); /* capture peer's isn */
+			tcp_syn_in(conn, th, &opts);
 			tcp_out(conn, SYN | ACK);
 			conn_seq(conn, + 1);
 			next = TCP_SYN_RECEIVED;
@@ -1014,9 +1786,11 @@ next_state:
 	case TCP_SYN_RECEIVED:
 		if (FL(&fl, &, ACK, th_ack(th) == conn->seq)) {
 			tcp_send_timer_cancel(conn);
+			conn->snd_una = conn->seq;
+			conn->snd_wnd = ntohs(th->th_win) << conn->snd_wscale;
 			next = TCP_ESTABLISHED;
 			if (FL(&fl, &, PSH)) {
-				tcp_data_get(conn, pkt);
+				tcp_data_in(conn, pkt);
 			}
 		}
 		break;
@@ -1025,25 +1799,24 @@ next_state:
 		 * ACK , shouldn't we go to SYN RECEIVED state? See Figure
 		 * 6 of RFC 793
 		 */
-		if (FL(&fl, &, ACK, th_seq(th) == conn->ack)) {
+		if (FL(&fl, &, ACK, th_ack(th) == conn->seq)) {
 			tcp_send_timer_cancel(conn);
+			conn->snd_una = conn->seq;
 			next = TCP_ESTABLISHED;
-			if (FL(&fl, &, PSH)) {
-				tcp_data_get(conn, pkt);
-			}
 			if (FL(&fl, &, SYN)) {
 				conn_ack(conn, th_seq(th) + 1);
+				tcp_syn_in(conn, th, &opts);
 				tcp_out(conn, ACK);
 			}
+			if (FL(&fl, &, PSH)) {
+				tcp_data_in(conn, pkt);
+			}
 		}
 		break;
 	case TCP_ESTABLISHED:
 		net_context_set_state(conn->context, NET_CONTEXT_CONNECTED);
-		if (!th && conn->snd->len) { /* TODO: Out of the loop */
-			ssize_t data_len;
-
-			tcp_out(conn, PSH, &data_len);
-			conn_seq(conn, + data_len);
+		if (!th) { /* TODO: Out of the loop */
+			tcp_send_data(conn);
 			break;
 		}
 		/* full-close */
@@ -1053,36 +1826,15 @@ next_state:
 			next = TCP_CLOSE_WAIT;
 			break;
 		}
-		if (FL(&fl, &, PSH, th_seq(th) < conn->ack)) {
-			tcp_out(conn, ACK); /* peer has resent */
-			break;
-		}
-		if (FL(&fl, &, PSH, th_seq(th) > conn->ack)) {
-			tcp_out(conn, RST);
-			next = TCP_CLOSED;
-			break;
-		}
-		/* Non piggybacking version for clarity now */
-		if (FL(&fl, &, PSH, th_seq(th) == conn->ack)) {
-			ssize_t len = tcp_data_get(conn, pkt);
-
-			if (len) {
-				conn_ack(conn, + len);
-				tcp_out(conn, ACK);
-
-				if (tcp_echo) { /* TODO: Out of the loop? */
-					tcp_out(conn, PSH, &len);
-					conn_seq(conn, + len);
-				}
-			} else {
+		if (FL(&fl, &, PSH) || tcp_data_len(pkt) > 0) {
+			if (tcp_data_in(conn, pkt) < 0) {
 				tcp_out(conn, RST);
 				next = TCP_CLOSED;
 				break;
 			}
 		}
-		if (FL(&fl, ==, ACK, th_ack(th) == conn->seq)) {
-			tcp_win_free(conn->snd, "SND");
-			conn->snd = tcp_win_new();
+		if (FL(&fl, &, ACK)) {
+			tcp_ack_in(conn, pkt, &opts);
 		}
 		break; /* TODO: Catch all the rest here */
 	case TCP_CLOSE_WAIT:
@@ -1126,16 +1878,30 @@ next_state:
 		next = 0;
 		goto next_state;
 	}
+
+	tcp_conn_unlock(conn);
 }
 
 static ssize_t _tcp_send(struct tcp *conn, const void *buf, size_t len,
 				int flags)
 {
-	tcp_win_append(conn->snd, "SND", buf, len);
+	ssize_t ret;
+
+	tcp_conn_lock(conn);
+
+	len = tcp_win_append(conn->snd, "SND", buf, len);
+	if (len == 0) {
+		ret = -ENOBUFS;
+		goto out;
+	}
 
 	tcp_in(conn, NULL);
 
-	return len;
+	ret = len;
+out:
+	tcp_conn_unlock(conn);
+
+	return ret;
 }
 
 /* close() has been called on the socket */
@@ -1146,8 +1912,10 @@ int net_tcp_put(struct net_context *context)
 	NET_DBG("%s", conn ? tcp_conn_state(conn, NULL) : "");
 
 	if (conn) {
+		tcp_conn_lock(conn);
 		conn->state = TCP_CLOSE_WAIT;
 		tcp_in(conn, NULL);
+		tcp_conn_unlock(conn);
 	}
 
 	net_context_unref(context);
@@ -1155,6 +1923,31 @@ int net_tcp_put(struct net_context *context)
 	return 0;
 }
 
+#if defined(CONFIG_NET_TEST)
+int net_tcp_get_info(struct net_context *context, struct net_tcp_info *info)
+{
+	struct tcp *conn = context->tcp;
+
+	if (!conn) {
+		return -ENOTCONN;
+	}
+
+	tcp_conn_lock(conn);
+
+	info->ssthresh = conn->ssthresh;
+	info->rto = conn->rto;
+	info->rexmit_count = conn->rexmit_count;
+	info->snd_wscale = conn->snd_wscale;
+	info->rcv_wscale = conn->rcv_wscale;
+	info->wscale_ok = conn->wscale_ok;
+	info->sack_ok = conn->sack_ok;
+
+	tcp_conn_unlock(conn);
+
+	return 0;
+}
+#endif
+
 int net_tcp_listen(struct net_context *context)
 {
 	/* when created, tcp connections are in state TCP_LISTEN */
@@ -1185,15 +1978,32 @@ int net_tcp_queue(struct net_context *context, const void *buf, size_t len,
 	}
 
 	if (msghdr && msghdr->msg_iovlen > 0) {
+		ssize_t total = 0;
 		int i;
 
 		for (i = 0; i < msghdr->msg_iovlen; i++) {
+			if (msghdr->msg_iov[i].iov_len == 0) {
+				continue;
+			}
+
 			ret = _tcp_send(conn, msghdr->msg_iov[i].iov_base,
 					msghdr->msg_iov[i].iov_len, 0);
-
 			if (ret < 0) {
 				break;
 			}
+
+			total += ret;
+
+			/* The send window is full, later buffers would leave
+			 * a hole in the stream
+			 */
+			if (ret < msghdr->msg_iov[i].iov_len) {
+				break;
+			}
+		}
+
+		if (total > 0) {
+			ret = total;
 		}
 	} else {
 		ret = _tcp_send(conn, buf, len, 0);
@@ -1237,6 +2047,16 @@ int net_tcp_connect(struct net_context *context,
 	struct tcp *conn = context->tcp;
 	int ret;
 
+	if (!conn->src) {
+		conn->src = tcp_calloc(1, sizeof(union tcp_endpoint));
+	}
+
+	if (!conn->dst) {
+		conn->dst = tcp_calloc(1, sizeof(union tcp_endpoint));
+	}
+
+	conn->iface = net_context_get_iface(context);
+
 	switch (net_context_get_family(context)) {
 	case AF_INET:
 		net_sin(&conn->src->sa)->sin_port = local_port;
@@ -1434,6 +2254,17 @@ static struct net_buf *tcp_win_pop(struct tcp_win *w, const char *name,
 	return out;
 }
 
+static void tcp_chain_free(struct net_buf *head)
+{
+	struct net_buf *next;
+
+	for ( ; head; head = next) {
+		next = head->frags;
+		head->frags = NULL;
+		tcp_nbuf_unref(head);
+	}
+}
+
 static ssize_t tcp_recv(int fd, void *buf, size_t len, int flags)
 {
 	struct tcp *conn = (void *)sys_slist_peek_head(&tcp_conns);
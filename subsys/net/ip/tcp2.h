@@ -91,7 +91,8 @@ int net_tcp_accept(struct net_context *context, net_tcp_accept_cb_t cb,
  * @param len		Number of bytes
  * @param msghdr	Data for a vector array operation
  *
- * @return 0 if ok, < 0 if error
+ * @return Number of bytes queued, which is less than requested when the
+ * send window is full, < 0 if error
  */
 int net_tcp_queue(struct net_context *context, const void *buf, size_t len,
 		  const struct msghdr *msghdr);
@@ -122,6 +123,32 @@ int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta);
 int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt);
 int net_tcp_finalize(struct net_pkt *pkt);
 
+#if defined(CONFIG_NET_TEST)
+/** Connection state reported to the unit tests */
+struct net_tcp_info {
+	u32_t ssthresh;		/* Slow start threshold, UINT32_MAX initially */
+	s32_t rto;		/* Retransmission timeout, msec */
+	u8_t rexmit_count;	/* Retransmission timeouts so far */
+	u8_t snd_wscale;	/* Shift of the windows the peer advertises */
+	u8_t rcv_wscale;	/* Shift of the windows we advertise */
+	bool wscale_ok;
+	bool sack_ok;
+};
+
+/**
+ * @brief Get the congestion control and option state of a connection
+ *
+ * This function is provided for the unit tests, which cannot look into
+ * the private struct tcp.
+ *
+ * @param context Network context
+ * @param info Filled in with the connection state
+ *
+ * @return 0 if successful, -ENOTCONN if the context has no connection
+ */
+int net_tcp_get_info(struct net_context *context, struct net_tcp_info *info);
+#endif
+
 #if defined(CONFIG_NET_TEST_PROTOCOL)
 /**
  * @brief Handle an incoming TCP packet
@@ -9,6 +9,12 @@
 #define is(_a, _b) (strcmp((_a), (_b)) == 0)
 #define is_timer_subscribed(_t) (k_timer_remaining_get(_t))
 
+/* Sequence number comparison, modulo 2^32 */
+#define seq_lt(_a, _b) ((s32_t)((u32_t)(_a) - (u32_t)(_b)) < 0)
+#define seq_le(_a, _b) ((s32_t)((u32_t)(_a) - (u32_t)(_b)) <= 0)
+#define seq_gt(_a, _b) seq_lt(_b, _a)
+#define seq_ge(_a, _b) seq_le(_b, _a)
+
 #define th_seq(_x) ntohl((_x)->th_seq)
 #define th_ack(_x) ntohl((_x)->th_ack)
 #define ip_get(_x) ((struct net_ipv4_hdr *) net_pkt_ip_data((_x)))
@@ -50,7 +56,7 @@
 #define tcp_pkt_clone(_pkt) tp_pkt_clone(_pkt, tp_basename(__FILE__), __LINE__)
 #define tcp_pkt_unref(_pkt) tp_pkt_unref(_pkt, tp_basename(__FILE__), __LINE__)
 #else
-static struct net_pkt *tcp_pkt_alloc(size_t len)
+static inline struct net_pkt *tcp_pkt_alloc(size_t len)
 {
 	struct net_pkt *pkt = net_pkt_alloc(K_NO_WAIT);
 
@@ -97,6 +103,16 @@ static struct net_pkt *tcp_pkt_alloc(size_t len)
 #define TCPOPT_NOP	1
 #define TCPOPT_MAXSEG	2
 #define TCPOPT_WINDOW	3
+#define TCPOPT_SACK_PERM	4
+#define TCPOPT_SACK	5
+
+#define TCP_MSS_DEFAULT	536	/* RFC 879 */
+#define TCP_WSCALE_MAX	14	/* RFC 7323 */
+#define TCP_SACK_MAX	4	/* Blocks that fit in the options space */
+#define TCP_OOO_MAX	8	/* Out of order segments held per connection */
+#define TCP_DUP_ACKS	3	/* Fast retransmit threshold, RFC 5681 */
+#define TCP_RTO_MIN	200	/* msec */
+#define TCP_RTO_MAX	60000	/* msec */
 
 enum pkt_addr {
 	SRC = 1,
@@ -145,6 +161,37 @@ enum tcp_state {
 	TCP_CLOSED
 };
 
+struct tcp_sack_block {
+	u32_t left;
+	u32_t right;
+};
+
+struct tcp_options { /* Options received in a segment */
+	u16_t mss;
+	u8_t wscale;
+	bool wscale_ok;
+	bool sack_perm;
+	u8_t sack_num;
+	struct tcp_sack_block sack[TCP_SACK_MAX];
+};
+
+enum tcp_cc_state {
+	TCP_CC_OPEN = 0,
+	TCP_CC_RECOVERY,	/* Fast recovery after duplicate ACKs */
+	TCP_CC_LOSS		/* Recovery after a retransmission timeout */
+};
+
+enum tcp_cc_event {
+	TCP_CC_EVENT_DUP_ACKS,
+	TCP_CC_EVENT_RTO
+};
+
+enum tcp_rexmit_state {
+	TCP_REXMIT_IDLE = 0,
+	TCP_REXMIT_ARMED,	/* The timer is running */
+	TCP_REXMIT_QUEUED	/* The timer fired, the handler is pending */
+};
+
 struct tcp_win { /* TCP window */
 	size_t len;
 	sys_slist_t bufs;
@@ -165,13 +212,42 @@ struct tcp { /* TCP connection */
 	u32_t ack;
 	union tcp_endpoint *src;
 	union tcp_endpoint *dst;
-	u16_t win;
+	u32_t win;
 	struct tcp_win *rcv;
 	struct tcp_win *snd;
 	struct k_timer send_timer;
 	sys_slist_t send_queue;
 	bool in_retransmission;
 	size_t send_retries;
+	u32_t snd_una;		/* Oldest unacknowledged sequence number */
+	u32_t snd_wnd;		/* Peer's receive window */
+	u16_t mss;		/* Peer's maximum segment size */
+	u8_t snd_wscale;	/* Shift of the windows the peer advertises */
+	u8_t rcv_wscale;	/* Shift of the windows we advertise */
+	bool wscale_ok;
+	bool sack_ok;
+	enum tcp_cc_state cc_state;
+	u32_t cwnd;
+	u32_t ssthresh;
+	u32_t recover;		/* Highest sequence sent when loss was seen */
+	u32_t rexmit_nxt;	/* Next sequence to retransmit in recovery */
+	u8_t dup_acks;
+	u8_t rexmit_count;
+	struct tcp_sack_block sacked[TCP_SACK_MAX]; /* Peer's SACK blocks */
+	u8_t sacked_num;
+	sys_slist_t ooo;	/* Out of order segments, by sequence number */
+	u8_t ooo_num;
+	s32_t srtt;		/* Smoothed RTT, msec << 3 */
+	s32_t rttvar;		/* RTT variation, msec << 2 */
+	s32_t rto;		/* Retransmission timeout, msec */
+	u32_t rtt_seq;		/* Sequence number being timed */
+	u32_t rtt_start;
+	bool rtt_pending;
+	struct k_timer rexmit_timer;
+	struct k_work rexmit_work;
+	atomic_t rexmit_state;	/* Holds a reference unless idle */
+	u32_t rexmit_deadline;
+	struct k_mutex lock;	/* Serializes application, RX and timer */
 	struct net_if *iface;
 	net_tcp_accept_cb_t accept_cb;
 	atomic_t ref_count;
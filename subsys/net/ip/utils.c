@@ -24,6 +24,9 @@ LOG_MODULE_REGISTER(net_utils, CONFIG_NET_UTILS_LOG_LEVEL);
 #include <net/net_pkt.h>
 #include <net/net_core.h>
 #include <net/socket_can.h>
+#include <sys/byteorder.h>
+
+#include "net_private.h"
 
 char *net_sprint_addr(sa_family_t af, const void *addr)
 {
@@ -489,34 +492,102 @@ int z_vrfy_net_addr_pton(sa_family_t family, const char *src,
 #include <syscalls/net_addr_pton_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
-static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+/* One's complement sum of data read as native 16-bit words. The words
+ * are added 32 bits at a time to a 64-bit accumulator, so the carries
+ * only need to be folded back in once at the end. A buffer starting at
+ * an odd address is summed as if it started one byte earlier, and the
+ * result is byte swapped to compensate (RFC 1071).
+ */
+static u16_t chksum_native(const u8_t *data, size_t len)
 {
-	const u8_t *end;
-	u16_t tmp;
+	bool odd = POINTER_TO_UINT(data) & 1;
+	u64_t acc = 0U;
 
-	end = data + len - 1;
+	if (odd && len) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		acc = *data << 8;
+#else
+		acc = *data;
+#endif
+		data++;
+		len--;
+	}
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	if ((POINTER_TO_UINT(data) & 2) && len >= 2) {
+		acc += *(const u16_t *)data;
+		data += 2;
+		len -= 2;
+	}
+
+	for (; len >= 16; data += 16, len -= 16) {
+		const u32_t *word = (const u32_t *)data;
 
+		acc += word[0];
+		acc += word[1];
+		acc += word[2];
+		acc += word[3];
+	}
+
+	for (; len >= 4; data += 4, len -= 4) {
+		acc += *(const u32_t *)data;
+	}
+
+	if (len >= 2) {
+		acc += *(const u16_t *)data;
 		data += 2;
+		len -= 2;
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	if (len) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		acc += *data;
+#else
+		acc += *data << 8;
+#endif
+	}
+
+	acc = (acc & 0xffffffff) + (acc >> 32);
+	acc = (acc & 0xffff) + (acc >> 16);
+	acc = (acc & 0xffff) + (acc >> 16);
+	acc = (acc & 0xffff) + (acc >> 16);
+
+	if (odd) {
+		acc = ((acc & 0xff) << 8) | (acc >> 8);
+	}
+
+	return acc;
+}
+
+u16_t net_chksum_partial(u16_t sum, const void *data, size_t len)
+{
+	u16_t tmp = sys_be16_to_cpu(chksum_native(data, len));
+
+	sum += tmp;
+	if (sum < tmp) {
+		sum++;
 	}
 
 	return sum;
 }
 
+u16_t net_chksum_update(u16_t chksum, const void *old, const void *new,
+			size_t len)
+{
+	const u8_t *o = old, *n = new;
+	u32_t sum = (u16_t)~chksum;
+
+	/* RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m') for every changed word */
+	for (; len >= 2; o += 2, n += 2, len -= 2) {
+		sum += (u16_t)~UNALIGNED_GET((const u16_t *)o);
+		sum += UNALIGNED_GET((const u16_t *)n);
+	}
+
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return ~sum;
+}
+
 static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
@@ -529,7 +600,7 @@ static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 	len = cur->buf->len - (cur->pos - cur->buf->data);
 
 	while (cur->buf) {
-		sum = calc_chksum(sum, cur->pos, len);
+		sum = net_chksum_partial(sum, cur->pos, len);
 
 		cur->buf = cur->buf->frags;
 		if (!cur->buf || !cur->buf->len) {
@@ -588,7 +659,7 @@ u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto)
 
 	net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) - len);
 
-	sum = calc_chksum(sum, pkt->cursor.pos, len);
+	sum = net_chksum_partial(sum, pkt->cursor.pos, len);
 	net_pkt_skip(pkt, len + net_pkt_ip_opts_len(pkt));
 
 	sum = pkt_calc_chksum(pkt, sum);
@@ -607,9 +678,9 @@ u16_t net_calc_chksum_ipv4(struct net_pkt *pkt)
 {
 	u16_t sum;
 
-	sum = calc_chksum(0, pkt->buffer->data,
-			  net_pkt_ip_hdr_len(pkt) +
-			  net_pkt_ipv4_opts_len(pkt));
+	sum = net_chksum_partial(0, pkt->buffer->data,
+				 net_pkt_ip_hdr_len(pkt) +
+				 net_pkt_ipv4_opts_len(pkt));
 
 	sum = (sum == 0U) ? 0xffff : htons(sum);
 
@@ -22,26 +22,55 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 #define ARP_REQUEST_TIMEOUT K_SECONDS(2)
+#define ARP_REACHABLE_TIME K_SECONDS(CONFIG_NET_ARP_REACHABLE_TIME)
+
+/* One hash bucket per entry keeps the chains short */
+#define ARP_HASH_SIZE CONFIG_NET_ARP_TABLE_SIZE
 
 static bool arp_cache_initialized;
 static struct arp_entry arp_entries[CONFIG_NET_ARP_TABLE_SIZE];
 
+/* Entries in use are in a hash bucket, and either in the LRU list if
+ * their address is known or in the pending list if it is being resolved.
+ * The LRU list has the most recently used entry first, the pending list
+ * is ordered by the time the request was sent.
+ */
+static sys_slist_t arp_hash[ARP_HASH_SIZE];
 static sys_slist_t arp_free_entries;
-static sys_slist_t arp_pending_entries;
-static sys_slist_t arp_table;
+static sys_dlist_t arp_pending_entries;
+static sys_dlist_t arp_lru;
+
+static K_MUTEX_DEFINE(arp_mutex);
 
 struct k_delayed_work arp_request_timer;
 
+static inline u32_t arp_hash_index(struct net_if *iface,
+				   struct in_addr *addr)
+{
+	u32_t h = UNALIGNED_GET(&addr->s_addr) ^ (u32_t)(uintptr_t)iface;
+
+	/* Fibonacci hashing, so that similar addresses are spread out */
+	h *= 0x9e3779b1U;
+
+	return (h >> 16) % ARP_HASH_SIZE;
+}
+
 static void arp_entry_cleanup(struct arp_entry *entry, bool pending)
 {
+	int i;
+
 	NET_DBG("%p", entry);
 
 	if (pending) {
-		NET_DBG("Releasing pending pkt %p (ref %d)",
-			entry->pending,
-			atomic_get(&entry->pending->atomic_ref) - 1);
-		net_pkt_unref(entry->pending);
-		entry->pending = NULL;
+		for (i = 0; i < entry->pending_count; i++) {
+			NET_DBG("Releasing pending pkt %p (ref %d)",
+				entry->pending[i],
+				atomic_get(&entry->pending[i]->atomic_ref) - 1);
+			net_pkt_unref(entry->pending[i]);
+			entry->pending[i] = NULL;
+		}
+
+		entry->pending_count = 0U;
 	}
 
 	entry->iface = NULL;
@@ -50,14 +79,13 @@ static void arp_entry_cleanup(struct arp_entry *entry, bool pending)
 	(void)memset(&entry->eth, 0, sizeof(struct net_eth_addr));
 }
 
-static struct arp_entry *arp_entry_find(sys_slist_t *list,
-					struct net_if *iface,
-					struct in_addr *dst,
-					sys_snode_t **previous)
+static struct arp_entry *arp_entry_find(struct net_if *iface,
+					struct in_addr *dst)
 {
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(list, entry, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(&arp_hash[arp_hash_index(iface, dst)],
+				     entry, node) {
 		NET_DBG("iface %p dst %s",
 			iface, log_strdup(net_sprint_ipv4_addr(&entry->ip)));
 
@@ -65,34 +93,88 @@ static struct arp_entry *arp_entry_find(sys_slist_t *list,
 		    net_ipv4_addr_cmp(&entry->ip, dst)) {
 			return entry;
 		}
-
-		if (previous) {
-			*previous = &entry->node;
-		}
 	}
 
 	return NULL;
 }
 
-static inline struct arp_entry *arp_entry_find_move_first(struct net_if *iface,
-							  struct in_addr *dst)
+static void arp_entry_add(struct arp_entry *entry, struct net_if *iface,
+			  struct in_addr *dst)
+{
+	entry->iface = iface;
+	net_ipaddr_copy(&entry->ip, dst);
+
+	sys_slist_prepend(&arp_hash[arp_hash_index(iface, dst)],
+			  &entry->node);
+}
+
+/* Take the entry out of the cache and put it back to the free list */
+static void arp_entry_release(struct arp_entry *entry)
+{
+	sys_slist_find_and_remove(&arp_hash[arp_hash_index(entry->iface,
+							   &entry->ip)],
+				  &entry->node);
+
+	if (sys_dnode_is_linked(&entry->lru)) {
+		sys_dlist_remove(&entry->lru);
+	}
+
+	arp_entry_cleanup(entry, entry->state == ARP_STATE_INCOMPLETE);
+
+	sys_slist_prepend(&arp_free_entries, &entry->node);
+}
+
+static void arp_entry_set_state(struct arp_entry *entry,
+				enum arp_state state)
+{
+	NET_DBG("dst %s state %d -> %d",
+		log_strdup(net_sprint_ipv4_addr(&entry->ip)),
+		entry->state, state);
+
+	entry->state = state;
+
+	if (state == ARP_STATE_REACHABLE) {
+		entry->confirmed = k_uptime_get_32();
+	}
+}
+
+/* Resolved entry that is looked up, with its state aged on the way */
+static struct arp_entry *arp_entry_find_resolved(struct net_if *iface,
+						 struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	entry = arp_entry_find(&arp_table, iface, dst, &prev);
-	if (entry) {
-		/* Let's assume the target is going to be accessed
-		 * more than once here in a short time frame. So we
-		 * place the entry first in position into the table
-		 * in order to reduce subsequent find.
+	entry = arp_entry_find(iface, dst);
+	if (!entry || entry->state == ARP_STATE_INCOMPLETE) {
+		return NULL;
+	}
+
+	if (entry->state == ARP_STATE_REACHABLE &&
+	    (s32_t)(k_uptime_get_32() - entry->confirmed) >=
+	    ARP_REACHABLE_TIME) {
+		arp_entry_set_state(entry, ARP_STATE_STALE);
+	}
+
+	if (entry->state == ARP_STATE_PROBE &&
+	    (s32_t)(k_uptime_get_32() - entry->req_start) >=
+	    ARP_REQUEST_TIMEOUT) {
+		/* The peer did not answer, so it has to be resolved
+		 * from scratch.
 		 */
-		if (&entry->node != sys_slist_peek_head(&arp_table)) {
-			sys_slist_remove(&arp_table, prev, &entry->node);
-			sys_slist_prepend(&arp_table, &entry->node);
-		}
+		NET_DBG("No answer to probe for %s",
+			log_strdup(net_sprint_ipv4_addr(dst)));
+		arp_entry_release(entry);
+		return NULL;
+	}
+
+	/* Let's assume the target is going to be accessed more than once
+	 * in a short time frame, so it is the last one to be evicted.
+	 */
+	if (!sys_dlist_is_head(&arp_lru, &entry->lru)) {
+		sys_dlist_remove(&entry->lru);
+		sys_dlist_prepend(&arp_lru, &entry->lru);
 	}
 
 	return entry;
@@ -102,26 +184,30 @@ static inline
 struct arp_entry *arp_entry_find_pending(struct net_if *iface,
 					 struct in_addr *dst)
 {
+	struct arp_entry *entry;
+
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	return arp_entry_find(&arp_pending_entries, iface, dst, NULL);
+	entry = arp_entry_find(iface, dst);
+	if (!entry || entry->state != ARP_STATE_INCOMPLETE) {
+		return NULL;
+	}
+
+	return entry;
 }
 
 static struct arp_entry *arp_entry_get_pending(struct net_if *iface,
 					       struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
-	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
-
-	entry = arp_entry_find(&arp_pending_entries, iface, dst, &prev);
+	entry = arp_entry_find_pending(iface, dst);
 	if (entry) {
 		/* We remove the entry from the pending list */
-		sys_slist_remove(&arp_pending_entries, prev, &entry->node);
+		sys_dlist_remove(&entry->lru);
 	}
 
-	if (sys_slist_is_empty(&arp_pending_entries)) {
+	if (sys_dlist_is_empty(&arp_pending_entries)) {
 		k_delayed_work_cancel(&arp_request_timer);
 	}
 
@@ -131,45 +217,56 @@ static struct arp_entry *arp_entry_get_pending(struct net_if *iface,
 static struct arp_entry *arp_entry_get_free(void)
 {
 	sys_snode_t *node;
+	sys_dnode_t *lru;
 
 	node = sys_slist_peek_head(&arp_free_entries);
-	if (!node) {
+	if (node) {
+		/* We remove the node from the free list */
+		sys_slist_remove(&arp_free_entries, NULL, node);
+
+		return CONTAINER_OF(node, struct arp_entry, node);
+	}
+
+	/* Then let's take the least recently used one from the table.
+	 * Entries being resolved are never evicted.
+	 */
+	lru = sys_dlist_peek_tail(&arp_lru);
+	if (!lru) {
 		return NULL;
 	}
 
-	/* We remove the node from the free list */
-	sys_slist_remove(&arp_free_entries, NULL, node);
+	arp_entry_release(CONTAINER_OF(lru, struct arp_entry, lru));
 
-	return CONTAINER_OF(node, struct arp_entry, node);
+	return arp_entry_get_free();
 }
 
-static struct arp_entry *arp_entry_get_last_from_table(void)
+/* Keep a packet until the address is resolved. If the queue of the entry
+ * is full, the oldest packet is dropped.
+ */
+static void arp_entry_queue(struct arp_entry *entry, struct net_pkt *pkt)
 {
-	sys_snode_t *node;
-
-	/* We assume last entry is the oldest one,
-	 * so is the preferred one to be taken out.
-	 */
+	if (entry->pending_count == CONFIG_NET_ARP_PENDING_COUNT) {
+		NET_DBG("Dropping pending pkt %p", entry->pending[0]);
 
-	node = sys_slist_peek_tail(&arp_table);
-	if (!node) {
-		return NULL;
+		net_pkt_unref(entry->pending[0]);
+		memmove(&entry->pending[0], &entry->pending[1],
+			(CONFIG_NET_ARP_PENDING_COUNT - 1) *
+			sizeof(entry->pending[0]));
+		entry->pending_count--;
 	}
 
-	sys_slist_find_and_remove(&arp_table, node);
-
-	return CONTAINER_OF(node, struct arp_entry, node);
+	entry->pending[entry->pending_count++] = net_pkt_ref(pkt);
 }
 
-
 static void arp_entry_register_pending(struct arp_entry *entry)
 {
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(&entry->ip)));
 
-	sys_slist_append(&arp_pending_entries, &entry->node);
-
+	entry->state = ARP_STATE_INCOMPLETE;
 	entry->req_start = k_uptime_get_32();
 
+	sys_dlist_append(&arp_pending_entries, &entry->lru);
+
 	/* Let's start the timer if necessary */
 	if (!k_delayed_work_remaining_get(&arp_request_timer)) {
 		k_delayed_work_submit(&arp_request_timer,
@@ -184,17 +281,16 @@ static void arp_request_timeout(struct k_work *work)
 
 	ARG_UNUSED(work);
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
-					  entry, next, node) {
+	k_mutex_lock(&arp_mutex, K_FOREVER);
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
+					  entry, next, lru) {
 		if ((s32_t)(entry->req_start +
 			    ARP_REQUEST_TIMEOUT - current) > 0) {
 			break;
 		}
 
-		arp_entry_cleanup(entry, true);
-
-		sys_slist_remove(&arp_pending_entries, NULL, &entry->node);
-		sys_slist_append(&arp_free_entries, &entry->node);
+		arp_entry_release(entry);
 
 		entry = NULL;
 	}
@@ -204,6 +300,8 @@ static void arp_request_timeout(struct k_work *work)
 				      entry->req_start +
 				      ARP_REQUEST_TIMEOUT - current);
 	}
+
+	k_mutex_unlock(&arp_mutex);
 }
 
 static inline struct in_addr *if_get_addr(struct net_if *iface,
@@ -230,14 +328,16 @@ static inline struct in_addr *if_get_addr(struct net_if *iface,
 	return NULL;
 }
 
+/* Build an ARP request. This may block on the allocation, so it is not
+ * done with arp_mutex held.
+ */
 static inline struct net_pkt *arp_prepare(struct net_if *iface,
 					  struct in_addr *next_addr,
-					  struct arp_entry *entry,
 					  struct net_pkt *pending,
-					  struct in_addr *current_ip)
+					  struct in_addr *current_ip,
+					  struct in_addr *my_addr)
 {
 	struct net_arp_hdr *hdr;
-	struct in_addr *my_addr;
 	struct net_pkt *pkt;
 
 	if (current_ip) {
@@ -260,26 +360,8 @@ static inline struct net_pkt *arp_prepare(struct net_if *iface,
 
 	hdr = NET_ARP_HDR(pkt);
 
-	/* If entry is not set, then we are just about to send
-	 * an ARP request using the data in pending net_pkt.
-	 * This can happen if there is already a pending ARP
-	 * request and we want to send it again.
-	 */
-	if (entry) {
-		entry->pending = net_pkt_ref(pending);
-		entry->iface = net_pkt_iface(pkt);
-
-		net_ipaddr_copy(&entry->ip, next_addr);
-
-		net_pkt_lladdr_src(pkt)->addr =
-			(u8_t *)net_if_get_link_addr(entry->iface)->addr;
-
-		arp_entry_register_pending(entry);
-	} else {
-		net_pkt_lladdr_src(pkt)->addr =
-			(u8_t *)net_if_get_link_addr(iface)->addr;
-	}
-
+	net_pkt_lladdr_src(pkt)->addr =
+		(u8_t *)net_if_get_link_addr(iface)->addr;
 	net_pkt_lladdr_src(pkt)->len = sizeof(struct net_eth_addr);
 
 	net_pkt_lladdr_dst(pkt)->addr = (u8_t *)net_eth_broadcast_addr();
@@ -298,12 +380,6 @@ static inline struct net_pkt *arp_prepare(struct net_if *iface,
 	memcpy(hdr->src_hwaddr.addr, net_pkt_lladdr_src(pkt)->addr,
 	       sizeof(struct net_eth_addr));
 
-	if (!entry || net_pkt_ipv4_auto(pkt)) {
-		my_addr = current_ip;
-	} else {
-		my_addr = if_get_addr(entry->iface, current_ip);
-	}
-
 	if (my_addr) {
 		net_ipaddr_copy(&hdr->src_ipaddr, my_addr);
 	} else {
@@ -313,29 +389,54 @@ static inline struct net_pkt *arp_prepare(struct net_if *iface,
 	return pkt;
 }
 
+/* Unicast request to the known address of a stale entry */
+static void arp_send_probe(struct net_if *iface, struct in_addr *addr,
+			   struct net_eth_addr *hwaddr)
+{
+	struct net_arp_hdr *hdr;
+	struct net_pkt *req;
+
+	req = arp_prepare(iface, addr, NULL, NULL, if_get_addr(iface, NULL));
+	if (!req) {
+		return;
+	}
+
+	hdr = NET_ARP_HDR(req);
+
+	memcpy(&hdr->dst_hwaddr, hwaddr, sizeof(struct net_eth_addr));
+	net_pkt_lladdr_dst(req)->addr = hdr->dst_hwaddr.addr;
+
+	NET_DBG("Probing %s", log_strdup(net_sprint_ipv4_addr(addr)));
+
+	net_if_queue_tx(iface, req);
+}
+
 struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 				struct in_addr *request_ip,
 				struct in_addr *current_ip)
 {
+	struct net_if *iface;
+	struct net_eth_addr probe_hwaddr;
 	struct arp_entry *entry;
 	struct in_addr *addr;
+	bool probe = false;
 
 	if (!pkt || !pkt->buffer) {
 		return NULL;
 	}
 
+	iface = net_pkt_iface(pkt);
+
 	/* Is the destination in the local network, if not route via
 	 * the gateway address.
 	 */
-	if (!current_ip &&
-	    !net_if_ipv4_addr_mask_cmp(net_pkt_iface(pkt), request_ip)) {
-		struct net_if_ipv4 *ipv4 = net_pkt_iface(pkt)->config.ip.ipv4;
+	if (!current_ip && !net_if_ipv4_addr_mask_cmp(iface, request_ip)) {
+		struct net_if_ipv4 *ipv4 = iface->config.ip.ipv4;
 
 		if (ipv4) {
 			addr = &ipv4->gw;
 			if (net_ipv4_is_addr_unspecified(addr)) {
-				NET_ERR("Gateway not set for iface %p",
-					net_pkt_iface(pkt));
+				NET_ERR("Gateway not set for iface %p", iface);
 
 				return NULL;
 			}
@@ -346,40 +447,77 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 		addr = request_ip;
 	}
 
+	k_mutex_lock(&arp_mutex, K_FOREVER);
+
 	/* If the destination address is already known, we do not need
 	 * to send any ARP packet.
 	 */
-	entry = arp_entry_find_move_first(net_pkt_iface(pkt), addr);
+	entry = arp_entry_find_resolved(iface, addr);
 	if (!entry) {
+		struct in_addr *my_addr;
 		struct net_pkt *req;
 
-		entry = arp_entry_find_pending(net_pkt_iface(pkt), addr);
+		entry = arp_entry_find_pending(iface, addr);
 		if (!entry) {
 			/* No pending, let's try to get a new entry */
 			entry = arp_entry_get_free();
-			if (!entry) {
-				/* Then let's take one from table? */
-				entry = arp_entry_get_last_from_table();
+			if (entry) {
+				arp_entry_add(entry, iface, addr);
+				arp_entry_queue(entry, pkt);
+				arp_entry_register_pending(entry);
 			}
 		} else {
-			/* There is a pending already */
+			if (!current_ip) {
+				/* There is a pending already, so the packet
+				 * just waits for the same reply.
+				 */
+				arp_entry_queue(entry, pkt);
+			}
+
 			entry = NULL;
 		}
 
-		req = arp_prepare(net_pkt_iface(pkt), addr, entry, pkt,
-				  current_ip);
+		k_mutex_unlock(&arp_mutex);
+
+		if (!entry || (current_ip && net_pkt_ipv4_auto(pkt))) {
+			my_addr = current_ip;
+		} else {
+			my_addr = if_get_addr(iface, current_ip);
+		}
+
+		req = arp_prepare(iface, addr, pkt, current_ip, my_addr);
 
 		if (!entry) {
-			/* We cannot send the packet, the ARP cache is full
-			 * or there is already a pending query to this IP
-			 * address, so this packet must be discarded.
+			/* We cannot store the packet, the ARP cache is full
+			 * of pending queries, or there is already a pending
+			 * query to this IP address.
 			 */
 			NET_DBG("Resending ARP %p", req);
+		} else if (!req) {
+			k_mutex_lock(&arp_mutex, K_FOREVER);
+
+			/* Unless a reply or the timeout got to it first */
+			if (arp_entry_find_pending(iface, addr) == entry) {
+				arp_entry_release(entry);
+			}
+
+			k_mutex_unlock(&arp_mutex);
 		}
 
 		return req;
 	}
 
+	if (entry->state == ARP_STATE_STALE) {
+		/* Keep using the old address while asking the peer
+		 * directly whether it is still valid.
+		 */
+		entry->req_start = k_uptime_get_32();
+		arp_entry_set_state(entry, ARP_STATE_PROBE);
+
+		memcpy(&probe_hwaddr, &entry->eth, sizeof(probe_hwaddr));
+		probe = true;
+	}
+
 	net_pkt_lladdr_src(pkt)->addr =
 		(u8_t *)net_if_get_link_addr(entry->iface)->addr;
 	net_pkt_lladdr_src(pkt)->len = sizeof(struct net_eth_addr);
@@ -392,28 +530,33 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 					      sizeof(struct net_eth_addr))),
 		log_strdup(net_sprint_ipv4_addr(&NET_IPV4_HDR(pkt)->dst)));
 
+	k_mutex_unlock(&arp_mutex);
+
+	if (probe) {
+		arp_send_probe(iface, addr, &probe_hwaddr);
+	}
+
 	return pkt;
 }
 
-static void arp_gratuitous(struct net_if *iface,
-			   struct in_addr *src,
-			   struct net_eth_addr *hwaddr)
+/* Set the hardware address of an entry found in the table. A new address
+ * is not confirmed until it is used, so the entry goes stale.
+ */
+static void arp_entry_update(struct arp_entry *entry,
+			     struct net_eth_addr *hwaddr)
 {
-	sys_snode_t *prev = NULL;
-	struct arp_entry *entry;
+	if (!memcmp(&entry->eth, hwaddr, sizeof(struct net_eth_addr))) {
+		return;
+	}
 
-	entry = arp_entry_find(&arp_table, iface, src, &prev);
-	if (entry) {
-		NET_DBG("Gratuitous ARP hwaddr %s -> %s",
-			log_strdup(net_sprint_ll_addr(
-					   (const u8_t *)&entry->eth,
-					   sizeof(struct net_eth_addr))),
-			log_strdup(net_sprint_ll_addr(
-					   (const u8_t *)hwaddr,
-					   sizeof(struct net_eth_addr))));
+	NET_DBG("ARP hwaddr %s -> %s",
+		log_strdup(net_sprint_ll_addr((const u8_t *)&entry->eth,
+					      sizeof(struct net_eth_addr))),
+		log_strdup(net_sprint_ll_addr((const u8_t *)hwaddr,
+					      sizeof(struct net_eth_addr))));
 
-		memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
-	}
+	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
+	arp_entry_set_state(entry, ARP_STATE_STALE);
 }
 
 static void arp_update(struct net_if *iface,
@@ -422,66 +565,71 @@ static void arp_update(struct net_if *iface,
 		       bool gratuitous,
 		       bool force)
 {
+	struct net_pkt *pending[CONFIG_NET_ARP_PENDING_COUNT];
 	struct arp_entry *entry;
-	struct net_pkt *pkt;
+	int i, count;
 
 	NET_DBG("src %s", log_strdup(net_sprint_ipv4_addr(src)));
 
+	k_mutex_lock(&arp_mutex, K_FOREVER);
+
 	entry = arp_entry_get_pending(iface, src);
 	if (!entry) {
-		if (IS_ENABLED(CONFIG_NET_ARP_GRATUITOUS) && gratuitous) {
-			arp_gratuitous(iface, src, hwaddr);
-		}
-
-		if (force) {
-			sys_snode_t *prev = NULL;
-			struct arp_entry *entry;
-
-			entry = arp_entry_find(&arp_table, iface, src, &prev);
+		entry = arp_entry_find(iface, src);
+
+		if (entry && !gratuitous && !force) {
+			/* Reply to our request, possibly a probe */
+			memcpy(&entry->eth, hwaddr,
+			       sizeof(struct net_eth_addr));
+			arp_entry_set_state(entry, ARP_STATE_REACHABLE);
+		} else if (entry && (force ||
+				     (IS_ENABLED(CONFIG_NET_ARP_GRATUITOUS) &&
+				      gratuitous))) {
+			arp_entry_update(entry, hwaddr);
+		} else if (!entry && force) {
+			/* Add new entry as it was not found and force
+			 * was set.
+			 */
+			entry = arp_entry_get_free();
 			if (entry) {
+				arp_entry_add(entry, iface, src);
 				memcpy(&entry->eth, hwaddr,
 				       sizeof(struct net_eth_addr));
-			} else {
-				/* Add new entry as it was not found and force
-				 * was set.
-				 */
-				entry = arp_entry_get_free();
-				if (!entry) {
-					/* Then let's take one from table? */
-					entry = arp_entry_get_last_from_table();
-				}
-
-				if (entry) {
-					entry->req_start = k_uptime_get_32();
-					entry->iface = iface;
-					net_ipaddr_copy(&entry->ip, src);
-					memcpy(&entry->eth, hwaddr, sizeof(entry->eth));
-					sys_slist_prepend(&arp_table, &entry->node);
-				}
+				arp_entry_set_state(entry, ARP_STATE_STALE);
+				sys_dlist_prepend(&arp_lru, &entry->lru);
 			}
 		}
 
+		k_mutex_unlock(&arp_mutex);
+
 		return;
 	}
 
-	/* Set the dst in the pending packet */
-	net_pkt_lladdr_dst(entry->pending)->len = sizeof(struct net_eth_addr);
-	net_pkt_lladdr_dst(entry->pending)->addr =
-		(u8_t *) &NET_ETH_HDR(entry->pending)->dst.addr;
+	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
+	arp_entry_set_state(entry, ARP_STATE_REACHABLE);
 
-	NET_DBG("dst %s pending %p frag %p",
-		log_strdup(net_sprint_ipv4_addr(&entry->ip)),
-		entry->pending, entry->pending->frags);
+	/* Inserting entry into the table */
+	sys_dlist_prepend(&arp_lru, &entry->lru);
 
-	pkt = entry->pending;
-	entry->pending = NULL;
+	count = entry->pending_count;
+	memcpy(pending, entry->pending, count * sizeof(pending[0]));
+	entry->pending_count = 0U;
 
-	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
+	k_mutex_unlock(&arp_mutex);
 
-	/* Inserting entry into the table */
-	sys_slist_prepend(&arp_table, &entry->node);
+	for (i = 0; i < count; i++) {
+		/* Set the dst in the pending packet */
+		net_pkt_lladdr_dst(pending[i])->len =
+			sizeof(struct net_eth_addr);
+		net_pkt_lladdr_dst(pending[i])->addr =
+			(u8_t *) &NET_ETH_HDR(pending[i])->dst.addr;
+
+		NET_DBG("dst %s pending %p frag %p",
+			log_strdup(net_sprint_ipv4_addr(src)),
+			pending[i], pending[i]->frags);
 
-	net_if_queue_tx(iface, pkt);
+		net_if_queue_tx(iface, pending[i]);
+	}
 }
 
 static inline struct net_pkt *arp_prepare_reply(struct net_if *iface,
@@ -669,43 +817,27 @@ enum net_verdict net_arp_input(struct net_pkt *pkt,
 
 void net_arp_clear_cache(struct net_if *iface)
 {
-	sys_snode_t *prev = NULL;
-	struct arp_entry *entry, *next;
-
-	NET_DBG("Flushing ARP table");
-
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
-		if (iface && iface != entry->iface) {
-			prev = &entry->node;
-			continue;
-		}
-
-		arp_entry_cleanup(entry, false);
+	int i;
 
-		sys_slist_remove(&arp_table, prev, &entry->node);
-		sys_slist_prepend(&arp_free_entries, &entry->node);
-	}
+	NET_DBG("Flushing ARP table and pending requests");
 
-	prev = NULL;
+	k_mutex_lock(&arp_mutex, K_FOREVER);
 
-	NET_DBG("Flushing ARP pending requests");
+	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
+		struct arp_entry *entry = &arp_entries[i];
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
-					  entry, next, node) {
-		if (iface && iface != entry->iface) {
-			prev = &entry->node;
+		if (!entry->iface || (iface && iface != entry->iface)) {
 			continue;
 		}
 
-		arp_entry_cleanup(entry, true);
-
-		sys_slist_remove(&arp_pending_entries, prev, &entry->node);
-		sys_slist_prepend(&arp_free_entries, &entry->node);
+		arp_entry_release(entry);
 	}
 
-	if (sys_slist_is_empty(&arp_pending_entries)) {
+	if (sys_dlist_is_empty(&arp_pending_entries)) {
 		k_delayed_work_cancel(&arp_request_timer);
 	}
+
+	k_mutex_unlock(&arp_mutex);
 }
 
 int net_arp_foreach(net_arp_cb_t cb, void *user_data)
@@ -713,11 +845,15 @@ int net_arp_foreach(net_arp_cb_t cb, void *user_data)
 	int ret = 0;
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
+	k_mutex_lock(&arp_mutex, K_FOREVER);
+
+	SYS_DLIST_FOR_EACH_CONTAINER(&arp_lru, entry, lru) {
 		ret++;
 		cb(entry, user_data);
 	}
 
+	k_mutex_unlock(&arp_mutex);
+
 	return ret;
 }
 
@@ -730,11 +866,16 @@ void net_arp_init(void)
 	}
 
 	sys_slist_init(&arp_free_entries);
-	sys_slist_init(&arp_pending_entries);
-	sys_slist_init(&arp_table);
+	sys_dlist_init(&arp_pending_entries);
+	sys_dlist_init(&arp_lru);
+
+	for (i = 0; i < ARP_HASH_SIZE; i++) {
+		sys_slist_init(&arp_hash[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
 		/* Inserting entry as free */
+		sys_dnode_init(&arp_entries[i].lru);
 		sys_slist_prepend(&arp_free_entries, &arp_entries[i].node);
 	}
 
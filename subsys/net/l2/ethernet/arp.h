@@ -10,6 +10,7 @@
 #if defined(CONFIG_NET_ARP) && defined(CONFIG_NET_NATIVE)
 
 #include <sys/slist.h>
+#include <sys/dlist.h>
 #include <net/ethernet.h>
 
 #ifdef __cplusplus
@@ -49,15 +50,29 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 enum net_verdict net_arp_input(struct net_pkt *pkt,
 			       struct net_eth_hdr *eth_hdr);
 
+/** State of an ARP cache entry, following the IPv6 neighbor states */
+enum arp_state {
+	/** Request sent, no reply yet */
+	ARP_STATE_INCOMPLETE,
+	/** Address confirmed within the reachable time */
+	ARP_STATE_REACHABLE,
+	/** Address not confirmed lately, but still used */
+	ARP_STATE_STALE,
+	/** Address still used, unicast request sent to confirm it */
+	ARP_STATE_PROBE,
+};
+
 struct arp_entry {
 	sys_snode_t node;
+	sys_dnode_t lru;
 	u32_t req_start;
+	u32_t confirmed;
 	struct net_if *iface;
 	struct in_addr ip;
-	union {
-		struct net_pkt *pending;
-		struct net_eth_addr eth;
-	};
+	struct net_eth_addr eth;
+	u8_t state;
+	u8_t pending_count;
+	struct net_pkt *pending[CONFIG_NET_ARP_PENDING_COUNT];
 };
 
 typedef void (*net_arp_cb_t)(struct arp_entry *entry,
@@ -29,6 +29,8 @@ LOG_MODULE_REGISTER(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
 #include "net_private.h"
 #include "ipv6.h"
 #include "ipv4_autoconf_internal.h"
+#include "gro.h"
+#include "gso.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 
@@ -298,6 +300,11 @@ static enum net_verdict ethernet_recv(struct net_if *iface,
 
 	ethernet_update_length(iface, pkt);
 
+	if (IS_ENABLED(CONFIG_NET_ETHERNET_GRO) &&
+	    type == NET_ETH_PTYPE_IP) {
+		return net_eth_gro_receive(ctx, pkt);
+	}
+
 	return NET_CONTINUE;
 drop:
 	eth_stats_update_errors_rx(iface);
@@ -554,6 +561,45 @@ static void ethernet_remove_l2_header(struct net_pkt *pkt)
 	net_pkt_frag_unref(buf);
 }
 
+#if defined(CONFIG_NET_ETHERNET_GSO)
+static int ethernet_send(struct net_if *iface, struct net_pkt *pkt);
+
+/* Split a TCP packet longer than the MTU and send the segments one by one.
+ * The original packet is kept intact so that TCP can retransmit it.
+ */
+static int ethernet_gso_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	struct net_eth_gso gso;
+	struct net_pkt *seg;
+	int ret, sent = 0;
+
+	ret = net_eth_gso_init(&gso, iface, pkt);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while ((seg = net_eth_gso_next(&gso))) {
+		ret = ethernet_send(iface, seg);
+		if (ret < 0) {
+			net_pkt_unref(seg);
+			return ret;
+		}
+
+		sent += ret;
+	}
+
+	if (gso.offset < gso.payload_len) {
+		return -ENOMEM;
+	}
+
+	net_pkt_unref(pkt);
+
+	return sent;
+}
+#else
+#define ethernet_gso_send(...) -ENOTSUP
+#endif /* CONFIG_NET_ETHERNET_GSO */
+
 static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 {
 	const struct ethernet_api *api = net_if_get_device(iface)->driver_api;
@@ -588,6 +634,13 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 				ptype = htons(NET_ETH_PTYPE_IP);
 			}
 		}
+
+		/* Segment in software unless the driver can do it */
+		if (ptype == htons(NET_ETH_PTYPE_IP) &&
+		    net_eth_gso_needed(iface, pkt) &&
+		    !(net_eth_get_hw_capabilities(iface) & ETHERNET_HW_TSO)) {
+			return ethernet_gso_send(iface, pkt);
+		}
 	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
 		   net_pkt_family(pkt) == AF_INET6) {
 		ptype = htons(NET_ETH_PTYPE_IPV6);
@@ -1069,6 +1122,10 @@ void ethernet_init(struct net_if *iface)
 
 	ctx->ethernet_l2_flags = NET_L2_MULTICAST;
 
+	if (!ctx->is_init) {
+		net_eth_gro_init(ctx);
+	}
+
 	if (net_eth_get_hw_capabilities(iface) & ETHERNET_PROMISC_MODE) {
 		ctx->ethernet_l2_flags |= NET_L2_PROMISC_MODE;
 	}
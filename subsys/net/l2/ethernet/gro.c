@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Generic receive offload for TCP over IPv4
+ *
+ * Consecutive in-order TCP segments of the same flow are chained into the
+ * first segment of the run, so that the IP and TCP layers see one large
+ * packet instead of many small ones. The rules for what can be merged
+ * follow the ones used by other stacks: only pure ACK segments with data,
+ * identical headers apart from the sequence number, and no IP fragments.
+ *
+ * The checksum of every merged segment is not verified here. Instead the
+ * payload sum of each segment is derived from its checksum field, and the
+ * coalesced packet gets a checksum built from those sums. A corrupted
+ * segment thus makes the whole coalesced packet fail the normal checksum
+ * verification in the TCP layer, and the data is retransmitted.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
+
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/ethernet.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "tcp_internal.h"
+#include "gro.h"
+
+/* Parsed headers of a received segment */
+struct gro_seg {
+	struct net_ipv4_hdr *ip;
+	struct net_tcp_hdr *tcp;
+	u16_t hdr_len;
+	u16_t len;
+};
+
+static u16_t gro_pseudo_sum(struct net_ipv4_hdr *ip, u16_t tcp_len)
+{
+	return net_chksum_partial(IPPROTO_TCP + tcp_len, &ip->src,
+				  2 * sizeof(struct in_addr));
+}
+
+/* One's complement sum of the payload of a segment, derived from the
+ * checksum in its header so that the payload itself is not read.
+ */
+static u16_t gro_payload_sum(struct gro_seg *seg)
+{
+	u16_t tcp_len = seg->hdr_len - NET_IPV4H_LEN;
+	u16_t sum;
+
+	sum = gro_pseudo_sum(seg->ip, tcp_len + seg->len);
+	sum = net_chksum_partial(sum, seg->tcp, tcp_len);
+
+	return ~sum;
+}
+
+static bool gro_parse(struct net_pkt *pkt, struct gro_seg *seg)
+{
+	struct net_buf *buf = pkt->frags;
+
+	if (!buf || buf->len < NET_IPV4TCPH_LEN) {
+		return false;
+	}
+
+	seg->ip = (struct net_ipv4_hdr *)buf->data;
+
+	/* IPv4 options and fragments are left to the IP layer */
+	if (seg->ip->vhl != 0x45 || seg->ip->proto != IPPROTO_TCP ||
+	    (seg->ip->offset[0] & 0x3f) || seg->ip->offset[1]) {
+		return false;
+	}
+
+	seg->tcp = (struct net_tcp_hdr *)(buf->data + NET_IPV4H_LEN);
+	seg->hdr_len = NET_IPV4H_LEN + NET_TCP_HDR_LEN(seg->tcp);
+
+	if (NET_TCP_HDR_LEN(seg->tcp) < NET_TCPH_LEN ||
+	    buf->len < seg->hdr_len ||
+	    ntohs(seg->ip->len) < seg->hdr_len ||
+	    ntohs(seg->ip->len) != net_pkt_get_len(pkt)) {
+		return false;
+	}
+
+	seg->len = ntohs(seg->ip->len) - seg->hdr_len;
+
+	return true;
+}
+
+/* Only segments carrying data and nothing but ACK (and PSH, which ends
+ * the run) can be merged.
+ */
+static inline bool gro_is_candidate(struct gro_seg *seg)
+{
+	return seg->len &&
+		(seg->tcp->flags & ~NET_TCP_PSH) == NET_TCP_ACK;
+}
+
+static inline bool gro_same_flow(struct ethernet_gro_flow *flow,
+				 struct net_pkt *pkt, struct gro_seg *seg)
+{
+	struct net_ipv4_hdr *ip = NET_IPV4_HDR(flow->pkt);
+
+	return net_pkt_iface(flow->pkt) == net_pkt_iface(pkt) &&
+		!memcmp(&ip->src, &seg->ip->src,
+			2 * sizeof(struct in_addr)) &&
+		!memcmp((u8_t *)ip + NET_IPV4H_LEN, seg->tcp,
+			2 * sizeof(u16_t));
+}
+
+static bool gro_can_merge(struct ethernet_gro_flow *flow,
+			  struct gro_seg *seg)
+{
+	struct net_ipv4_hdr *ip = NET_IPV4_HDR(flow->pkt);
+	struct net_tcp_hdr *tcp =
+		(struct net_tcp_hdr *)((u8_t *)ip + NET_IPV4H_LEN);
+
+	return gro_is_candidate(seg) &&
+		seg->hdr_len == flow->hdr_len &&
+		seg->len <= flow->mss &&
+		ntohs(ip->len) + seg->len <= CONFIG_NET_ETHERNET_GRO_MAX_SIZE &&
+		sys_get_be32(seg->tcp->seq) == flow->next_seq &&
+		seg->ip->tos == ip->tos && seg->ip->ttl == ip->ttl &&
+		!memcmp(seg->tcp->ack, tcp->ack, sizeof(tcp->ack)) &&
+		!memcmp(seg->tcp->wnd, tcp->wnd, sizeof(tcp->wnd)) &&
+		!memcmp(seg->tcp->optdata, tcp->optdata,
+			flow->hdr_len - NET_IPV4TCPH_LEN);
+}
+
+static void gro_hold(struct ethernet_gro_flow *flow, struct net_pkt *pkt,
+		     struct gro_seg *seg)
+{
+	flow->pkt = pkt;
+	flow->next_seq = sys_get_be32(seg->tcp->seq) + seg->len;
+	flow->payload_sum = gro_payload_sum(seg);
+	flow->mss = seg->len;
+	flow->hdr_len = seg->hdr_len;
+}
+
+static void gro_merge(struct ethernet_gro_flow *flow, struct net_pkt *pkt,
+		      struct gro_seg *seg)
+{
+	struct net_ipv4_hdr *ip = NET_IPV4_HDR(flow->pkt);
+	struct net_tcp_hdr *tcp =
+		(struct net_tcp_hdr *)((u8_t *)ip + NET_IPV4H_LEN);
+	u16_t held = ntohs(ip->len) - flow->hdr_len;
+	u16_t sum = gro_payload_sum(seg);
+
+	/* A payload starting at an odd offset contributes byte swapped */
+	if (held & 1) {
+		sum = (sum << 8) | (sum >> 8);
+	}
+
+	flow->payload_sum += sum;
+	if (flow->payload_sum < sum) {
+		flow->payload_sum++;
+	}
+	flow->next_seq += seg->len;
+
+	tcp->flags |= seg->tcp->flags & NET_TCP_PSH;
+	ip->len = htons(ntohs(ip->len) + seg->len);
+
+	net_buf_pull(pkt->frags, seg->hdr_len);
+
+	if (!pkt->frags->len) {
+		pkt->frags = net_buf_frag_del(NULL, pkt->frags);
+	}
+
+	if (pkt->frags) {
+		net_pkt_frag_add(flow->pkt, pkt->frags);
+		pkt->frags = NULL;
+	}
+
+	net_pkt_unref(pkt);
+}
+
+/* Release the packet of a flow, with the headers fixed to describe all
+ * the segments merged into it.
+ */
+static struct net_pkt *gro_take(struct ethernet_gro_flow *flow)
+{
+	struct net_pkt *pkt = flow->pkt;
+	struct net_ipv4_hdr *ip = NET_IPV4_HDR(pkt);
+	struct net_tcp_hdr *tcp =
+		(struct net_tcp_hdr *)((u8_t *)ip + NET_IPV4H_LEN);
+	u16_t tcp_len = ntohs(ip->len) - NET_IPV4H_LEN;
+	u16_t sum;
+
+	flow->pkt = NULL;
+
+	if (ntohs(ip->len) - flow->hdr_len == flow->mss) {
+		/* Nothing was merged */
+		return pkt;
+	}
+
+	/* Only the total length changed in the IPv4 header */
+	ip->chksum = net_chksum_update16(ip->chksum,
+					 htons(flow->hdr_len + flow->mss),
+					 ip->len);
+
+	tcp->chksum = 0U;
+	sum = gro_pseudo_sum(ip, tcp_len);
+	sum = net_chksum_partial(sum, tcp, flow->hdr_len - NET_IPV4H_LEN);
+	sum += flow->payload_sum;
+	if (sum < flow->payload_sum) {
+		sum++;
+	}
+
+	tcp->chksum = htons((u16_t)~sum);
+
+	NET_DBG("Coalesced %u bytes", tcp_len - (flow->hdr_len -
+						 NET_IPV4H_LEN));
+
+	return pkt;
+}
+
+/* Hand a released packet to the IP layer, from the RX thread that is
+ * processing the segment which ended the run.
+ */
+static void gro_deliver(struct net_pkt *pkt)
+{
+	if (!pkt) {
+		return;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_ipv4_input(pkt) == NET_DROP) {
+		net_pkt_unref(pkt);
+	}
+}
+
+static void gro_flush(struct k_work *work)
+{
+	struct ethernet_context *ctx =
+		CONTAINER_OF(work, struct ethernet_context, gro.flush);
+	struct net_pkt *pkt;
+	unsigned int key;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_ETHERNET_GRO_FLOWS; i++) {
+		key = irq_lock();
+		pkt = ctx->gro.flows[i].pkt ?
+			gro_take(&ctx->gro.flows[i]) : NULL;
+		irq_unlock(key);
+
+		if (!pkt) {
+			continue;
+		}
+
+		/* Queue the packet again for the RX thread, telling it
+		 * to skip L2 this time.
+		 */
+		net_pkt_set_l2_processed(pkt, true);
+
+		if (net_recv_data(net_pkt_iface(pkt), pkt) < 0) {
+			net_pkt_unref(pkt);
+		}
+	}
+}
+
+enum net_verdict net_eth_gro_receive(struct ethernet_context *ctx,
+				     struct net_pkt *pkt)
+{
+	struct ethernet_gro_flow *flow = NULL, *free = NULL;
+	struct net_pkt *taken = NULL;
+	struct gro_seg seg;
+	unsigned int key;
+	int i;
+
+	if (!gro_parse(pkt, &seg)) {
+		return NET_CONTINUE;
+	}
+
+	key = irq_lock();
+
+	for (i = 0; i < CONFIG_NET_ETHERNET_GRO_FLOWS; i++) {
+		if (!ctx->gro.flows[i].pkt) {
+			free = free ? free : &ctx->gro.flows[i];
+		} else if (gro_same_flow(&ctx->gro.flows[i], pkt, &seg)) {
+			flow = &ctx->gro.flows[i];
+		}
+	}
+
+	if (flow && gro_can_merge(flow, &seg)) {
+		gro_merge(flow, pkt, &seg);
+
+		/* A short segment or PSH ends the run */
+		if (seg.len < flow->mss || (seg.tcp->flags & NET_TCP_PSH)) {
+			taken = gro_take(flow);
+		}
+
+		irq_unlock(key);
+
+		gro_deliver(taken);
+
+		return NET_OK;
+	}
+
+	if (flow) {
+		/* Whatever was held must go up before this segment */
+		taken = gro_take(flow);
+		free = flow;
+	}
+
+	if (!gro_is_candidate(&seg) || (seg.tcp->flags & NET_TCP_PSH)) {
+		irq_unlock(key);
+
+		gro_deliver(taken);
+
+		return NET_CONTINUE;
+	}
+
+	if (!free) {
+		free = &ctx->gro.flows[ctx->gro.evict];
+		ctx->gro.evict = (ctx->gro.evict + 1) %
+			CONFIG_NET_ETHERNET_GRO_FLOWS;
+		taken = gro_take(free);
+	}
+
+	gro_hold(free, pkt, &seg);
+
+	irq_unlock(key);
+
+	gro_deliver(taken);
+
+	/* Leave a pending flush alone, so that it is not pushed further
+	 * away by every new flow.
+	 */
+	if (!k_delayed_work_remaining_get(&ctx->gro.flush)) {
+		k_delayed_work_submit(&ctx->gro.flush,
+				      K_MSEC(CONFIG_NET_ETHERNET_GRO_TIMEOUT));
+	}
+
+	return NET_OK;
+}
+
+void net_eth_gro_init(struct ethernet_context *ctx)
+{
+	k_delayed_work_init(&ctx->gro.flush, gro_flush);
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __GRO_H
+#define __GRO_H
+
+#include <net/ethernet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(CONFIG_NET_ETHERNET_GRO)
+
+void net_eth_gro_init(struct ethernet_context *ctx);
+enum net_verdict net_eth_gro_receive(struct ethernet_context *ctx,
+				     struct net_pkt *pkt);
+
+#else /* CONFIG_NET_ETHERNET_GRO */
+
+#define net_eth_gro_init(...)
+#define net_eth_gro_receive(...) NET_CONTINUE
+
+#endif /* CONFIG_NET_ETHERNET_GRO */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GRO_H */
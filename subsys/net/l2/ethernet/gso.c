@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Generic segmentation offload for TCP over IPv4
+ *
+ * The TCP stack may build packets up to CONFIG_NET_ETHERNET_GSO_MAX_SIZE
+ * long. If the driver cannot segment them itself, they are split here into
+ * MTU sized segments that share the original IPv4 and TCP headers.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
+
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/ethernet.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "tcp_internal.h"
+#include "gso.h"
+
+#define NET_BUF_TIMEOUT K_MSEC(100)
+
+size_t net_eth_get_gso_max_size(struct net_if *iface)
+{
+	if (!iface || net_if_l2(iface) != &NET_L2_GET_NAME(ETHERNET)) {
+		return 0;
+	}
+
+	return CONFIG_NET_ETHERNET_GSO_MAX_SIZE;
+}
+
+bool net_eth_gso_needed(struct net_if *iface, struct net_pkt *pkt)
+{
+	return net_pkt_family(pkt) == AF_INET &&
+		NET_IPV4_HDR(pkt)->proto == IPPROTO_TCP &&
+		net_pkt_get_len(pkt) > net_if_get_mtu(iface);
+}
+
+int net_eth_gso_init(struct net_eth_gso *gso, struct net_if *iface,
+		     struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *ip = (struct net_ipv4_hdr *)gso->hdr;
+	struct net_tcp_hdr *tcp;
+	size_t len = net_pkt_get_len(pkt);
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_read(pkt, gso->hdr, NET_IPV4H_LEN)) {
+		return -EINVAL;
+	}
+
+	gso->ip_hdr_len = (ip->vhl & NET_IPV4_IHL_MASK) * 4U;
+
+	if (gso->ip_hdr_len < NET_IPV4H_LEN ||
+	    net_pkt_read(pkt, gso->hdr + NET_IPV4H_LEN,
+			 gso->ip_hdr_len - NET_IPV4H_LEN + NET_TCPH_LEN)) {
+		return -EINVAL;
+	}
+
+	tcp = (struct net_tcp_hdr *)(gso->hdr + gso->ip_hdr_len);
+	gso->hdr_len = gso->ip_hdr_len + NET_TCP_HDR_LEN(tcp);
+
+	if (NET_TCP_HDR_LEN(tcp) < NET_TCPH_LEN ||
+	    net_pkt_read(pkt, gso->hdr + gso->ip_hdr_len + NET_TCPH_LEN,
+			 NET_TCP_HDR_LEN(tcp) - NET_TCPH_LEN) ||
+	    net_if_get_mtu(iface) <= gso->hdr_len) {
+		return -EINVAL;
+	}
+
+	gso->pkt = pkt;
+	gso->seq = sys_get_be32(tcp->seq);
+	gso->id = sys_get_be16(ip->id);
+	gso->mss = net_if_get_mtu(iface) - gso->hdr_len;
+	gso->payload_len = len - gso->hdr_len;
+	gso->offset = 0U;
+
+	NET_DBG("Segmenting %zu bytes into %u byte segments", len, gso->mss);
+
+	return 0;
+}
+
+/* Build the next segment, or return NULL when all data has been segmented
+ * or when the segment could not be allocated.
+ */
+struct net_pkt *net_eth_gso_next(struct net_eth_gso *gso)
+{
+	struct net_if *iface = net_pkt_iface(gso->pkt);
+	struct net_ipv4_hdr *ip = (struct net_ipv4_hdr *)gso->hdr;
+	struct net_tcp_hdr *tcp =
+		(struct net_tcp_hdr *)(gso->hdr + gso->ip_hdr_len);
+	u8_t flags = tcp->flags;
+	struct net_pkt *seg;
+	u16_t len, chksum;
+
+	if (gso->offset >= gso->payload_len) {
+		return NULL;
+	}
+
+	len = MIN(gso->mss, gso->payload_len - gso->offset);
+
+	seg = net_pkt_alloc_with_buffer(iface, len, AF_INET, IPPROTO_TCP,
+					NET_BUF_TIMEOUT);
+	if (!seg) {
+		return NULL;
+	}
+
+	ip->len = htons(gso->hdr_len + len);
+	sys_put_be16(gso->id++, ip->id);
+	ip->chksum = 0U;
+
+	sys_put_be32(gso->seq + gso->offset, tcp->seq);
+	tcp->chksum = 0U;
+
+	/* Only the last segment may carry PSH and FIN */
+	if (gso->offset + len < gso->payload_len) {
+		tcp->flags &= ~(NET_TCP_PSH | NET_TCP_FIN);
+	}
+
+	if (net_pkt_write(seg, gso->hdr, gso->hdr_len) ||
+	    net_pkt_copy(seg, gso->pkt, len)) {
+		tcp->flags = flags;
+		net_pkt_unref(seg);
+		return NULL;
+	}
+
+	tcp->flags = flags;
+	gso->offset += len;
+
+	net_pkt_set_ip_hdr_len(seg, NET_IPV4H_LEN);
+	net_pkt_set_ipv4_opts_len(seg, gso->ip_hdr_len - NET_IPV4H_LEN);
+	net_pkt_set_priority(seg, net_pkt_priority(gso->pkt));
+	net_pkt_set_vlan_tci(seg, net_pkt_vlan_tci(gso->pkt));
+	net_pkt_lladdr_src(seg)->addr = net_pkt_lladdr_src(gso->pkt)->addr;
+	net_pkt_lladdr_src(seg)->len = net_pkt_lladdr_src(gso->pkt)->len;
+
+	net_pkt_cursor_init(seg);
+
+	if (net_if_need_calc_tx_checksum(iface)) {
+		NET_IPV4_HDR(seg)->chksum = net_calc_chksum_ipv4(seg);
+
+		chksum = net_calc_chksum_tcp(seg);
+
+		net_pkt_set_overwrite(seg, true);
+		net_pkt_skip(seg, gso->ip_hdr_len +
+			     offsetof(struct net_tcp_hdr, chksum));
+		net_pkt_write(seg, &chksum, sizeof(chksum));
+		net_pkt_cursor_init(seg);
+	}
+
+	return seg;
+}
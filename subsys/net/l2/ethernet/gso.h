@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __GSO_H
+#define __GSO_H
+
+#include <net/ethernet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(CONFIG_NET_ETHERNET_GSO)
+
+/* Largest IPv4 and TCP header, options included */
+#define NET_ETH_GSO_HDR_MAX (2 * 60)
+
+/* State of a packet being split into MTU sized TCP segments */
+struct net_eth_gso {
+	struct net_pkt *pkt;
+	u8_t hdr[NET_ETH_GSO_HDR_MAX];
+	u32_t seq;
+	u16_t id;
+	u16_t mss;
+	u16_t payload_len;
+	u16_t offset;
+	u8_t ip_hdr_len;
+	u8_t hdr_len;
+};
+
+bool net_eth_gso_needed(struct net_if *iface, struct net_pkt *pkt);
+int net_eth_gso_init(struct net_eth_gso *gso, struct net_if *iface,
+		     struct net_pkt *pkt);
+struct net_pkt *net_eth_gso_next(struct net_eth_gso *gso);
+
+#else /* CONFIG_NET_ETHERNET_GSO */
+
+#define net_eth_gso_needed(...) false
+
+#endif /* CONFIG_NET_ETHERNET_GSO */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GSO_H */
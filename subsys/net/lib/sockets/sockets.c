@@ -194,6 +194,7 @@ int zsock_close_ctx(struct net_context *ctx)
 		(void)net_context_recv(ctx, NULL, K_NO_WAIT, NULL);
 	}
 
+	sock_epoll_detach(ctx);
 	zsock_flush_queue(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
@@ -261,6 +262,7 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 		k_fifo_init(&new_ctx->recv_q);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		sock_epoll_notify(parent);
 	}
 }
 
@@ -290,6 +292,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		sock_epoll_notify(ctx);
 		return;
 	}
 
@@ -301,6 +305,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	}
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	sock_epoll_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -601,13 +606,62 @@ ssize_t z_impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
 }
 
 #ifdef CONFIG_USERSPACE
+/* Send from a user message header. The header and the iovec array are
+ * copied so that they can not change under the send call, the buffers
+ * they point to are checked for read access.
+ */
+static ssize_t sock_sendmsg_user(int sock, const struct msghdr *umsg,
+				 int flags)
+{
+	struct msghdr msg;
+	struct iovec *iov = NULL;
+	size_t iov_size;
+	bool bad = false;
+	ssize_t ret;
+
+	Z_OOPS(z_user_from_copy(&msg, umsg, sizeof(msg)));
+	Z_OOPS(size_mul_overflow(msg.msg_iovlen, sizeof(struct iovec),
+				 &iov_size));
+
+	if (msg.msg_iovlen > 0) {
+		iov = z_user_alloc_from_copy(msg.msg_iov, iov_size);
+		Z_OOPS(!iov);
+
+		for (size_t i = 0; i < msg.msg_iovlen; i++) {
+			bad |= Z_SYSCALL_MEMORY_READ(iov[i].iov_base,
+						     iov[i].iov_len) != 0;
+		}
+
+		msg.msg_iov = iov;
+	}
+
+	if (msg.msg_name) {
+		bad |= Z_SYSCALL_MEMORY_READ(msg.msg_name,
+					     msg.msg_namelen) != 0;
+	}
+
+	if (msg.msg_control) {
+		bad |= Z_SYSCALL_MEMORY_READ(msg.msg_control,
+					     msg.msg_controllen) != 0;
+	}
+
+	if (bad) {
+		k_free(iov);
+		Z_OOPS(bad);
+	}
+
+	ret = z_impl_zsock_sendmsg(sock, &msg, flags);
+
+	k_free(iov);
+
+	return ret;
+}
+
 static inline ssize_t z_vrfy_zsock_sendmsg(int sock,
 					   const struct msghdr *msg,
 					   int flags)
 {
-	/* TODO: Create a copy of msg_buf and copy the data there */
-
-	return z_impl_zsock_sendmsg(sock, (const struct msghdr *)msg, flags);
+	return sock_sendmsg_user(sock, msg, flags);
 }
 #include <syscalls/zsock_sendmsg_mrsh.c>
 #endif /* CONFIG_USERSPACE */
@@ -715,16 +769,9 @@ error:
 	return ret;
 }
 
-static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
-				       void *buf,
-				       size_t max_len,
-				       int flags,
-				       struct sockaddr *src_addr,
-				       socklen_t *addrlen)
+static struct net_pkt *sock_dgram_pkt_get(struct net_context *ctx, int flags)
 {
 	s32_t timeout = K_FOREVER;
-	size_t recv_len = 0;
-	struct net_pkt_cursor backup;
 	struct net_pkt *pkt;
 
 	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
@@ -738,7 +785,7 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 		/* EAGAIN when timeout expired, EINTR when cancelled */
 		if (res && res != -EAGAIN && res != -EINTR) {
 			errno = -res;
-			return -1;
+			return NULL;
 		}
 
 		pkt = k_fifo_peek_head(&ctx->recv_q);
@@ -748,6 +795,123 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 
 	if (!pkt) {
 		errno = EAGAIN;
+	}
+
+	return pkt;
+}
+
+static int sock_dgram_src_addr(struct net_context *ctx, struct net_pkt *pkt,
+			       struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	int rv;
+
+	rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+				   src_addr, *addrlen);
+	if (rv < 0) {
+		return rv;
+	}
+
+	/* addrlen is a value-result argument, set to actual
+	 * size of source address
+	 */
+	if (src_addr->sa_family == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (src_addr->sa_family == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/* Store IP_PKTINFO or IPV6_PKTINFO control message of pkt in msg,
+ * return the length of control data stored.
+ */
+static size_t sock_put_pktinfo(struct net_pkt *pkt, struct msghdr *msg)
+{
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+	int ifindex = net_if_get_by_iface(net_pkt_iface(pkt));
+	struct net_pkt_cursor backup;
+	size_t len = 0;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) &&
+	    net_pkt_family(pkt) == AF_INET) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access,
+						      struct net_ipv4_hdr);
+		struct net_ipv4_hdr *ipv4_hdr;
+		struct in_pktinfo info;
+
+		if (!cmsg || msg->msg_controllen < CMSG_SPACE(sizeof(info))) {
+			msg->msg_flags |= ZSOCK_MSG_CTRUNC;
+			goto out;
+		}
+
+		ipv4_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(
+							pkt, &ipv4_access);
+		if (!ipv4_hdr) {
+			goto out;
+		}
+
+		info.ipi_ifindex = ifindex;
+		net_ipaddr_copy(&info.ipi_spec_dst, &ipv4_hdr->dst);
+		net_ipaddr_copy(&info.ipi_addr, &ipv4_hdr->dst);
+
+		cmsg->cmsg_len = CMSG_LEN(sizeof(info));
+		cmsg->cmsg_level = IPPROTO_IP;
+		cmsg->cmsg_type = IP_PKTINFO;
+		memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+		len = CMSG_SPACE(sizeof(info));
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv6_access,
+						      struct net_ipv6_hdr);
+		struct net_ipv6_hdr *ipv6_hdr;
+		struct in6_pktinfo info;
+
+		if (!cmsg || msg->msg_controllen < CMSG_SPACE(sizeof(info))) {
+			msg->msg_flags |= ZSOCK_MSG_CTRUNC;
+			goto out;
+		}
+
+		ipv6_hdr = (struct net_ipv6_hdr *)net_pkt_get_data(
+							pkt, &ipv6_access);
+		if (!ipv6_hdr) {
+			goto out;
+		}
+
+		info.ipi6_ifindex = ifindex;
+		net_ipaddr_copy(&info.ipi6_addr, &ipv6_hdr->dst);
+
+		cmsg->cmsg_len = CMSG_LEN(sizeof(info));
+		cmsg->cmsg_level = IPPROTO_IPV6;
+		cmsg->cmsg_type = IPV6_PKTINFO;
+		memcpy(CMSG_DATA(cmsg), &info, sizeof(info));
+		len = CMSG_SPACE(sizeof(info));
+	}
+
+out:
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return len;
+}
+
+static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
+				       void *buf,
+				       size_t max_len,
+				       int flags,
+				       struct sockaddr *src_addr,
+				       socklen_t *addrlen)
+{
+	size_t recv_len = 0;
+	struct net_pkt_cursor backup;
+	struct net_pkt *pkt;
+
+	pkt = sock_dgram_pkt_get(ctx, flags);
+	if (!pkt) {
 		return -1;
 	}
 
@@ -756,24 +920,11 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	if (src_addr && addrlen) {
 		int rv;
 
-		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-					   src_addr, *addrlen);
+		rv = sock_dgram_src_addr(ctx, pkt, src_addr, addrlen);
 		if (rv < 0) {
 			errno = -rv;
 			return -1;
 		}
-
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
-			return -1;
-		}
 	}
 
 	recv_len = net_pkt_remaining_data(pkt);
@@ -800,6 +951,75 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	return recv_len;
 }
 
+static ssize_t zsock_recv_dgram_msg(struct net_context *ctx,
+				    struct msghdr *msg, int flags)
+{
+	struct net_pkt_cursor backup;
+	struct net_pkt *pkt;
+	size_t recv_len = 0;
+	size_t data_len;
+	size_t ctrl_len = 0;
+	int ret = 0;
+
+	pkt = sock_dgram_pkt_get(ctx, flags);
+	if (!pkt) {
+		return -1;
+	}
+
+	net_pkt_cursor_backup(pkt, &backup);
+	msg->msg_flags = 0;
+
+	if (msg->msg_name) {
+		ret = sock_dgram_src_addr(ctx, pkt, msg->msg_name,
+					  &msg->msg_namelen);
+		if (ret < 0) {
+			goto out;
+		}
+	}
+
+	if (sock_is_pktinfo(ctx)) {
+		ctrl_len = sock_put_pktinfo(pkt, msg);
+	}
+
+	msg->msg_controllen = ctrl_len;
+
+	data_len = net_pkt_remaining_data(pkt);
+
+	for (size_t i = 0; i < msg->msg_iovlen && recv_len < data_len; i++) {
+		size_t len = MIN(msg->msg_iov[i].iov_len, data_len - recv_len);
+
+		if (net_pkt_read(pkt, msg->msg_iov[i].iov_base, len)) {
+			ret = -ENOBUFS;
+			goto out;
+		}
+
+		recv_len += len;
+	}
+
+	if (recv_len < data_len) {
+		msg->msg_flags |= ZSOCK_MSG_TRUNC;
+	}
+
+	net_stats_update_tc_rx_time(net_pkt_iface(pkt),
+				    net_pkt_priority(pkt),
+				    net_pkt_timestamp(pkt)->nanosecond,
+				    k_cycle_get_32());
+
+out:
+	if (!(flags & ZSOCK_MSG_PEEK)) {
+		net_pkt_unref(pkt);
+	} else {
+		net_pkt_cursor_restore(pkt, &backup);
+	}
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return recv_len;
+}
+
 static inline ssize_t zsock_recv_stream(struct net_context *ctx,
 					void *buf,
 					size_t max_len,
@@ -892,6 +1112,45 @@ static inline ssize_t zsock_recv_stream(struct net_context *ctx,
 	return recv_len;
 }
 
+static ssize_t zsock_recv_stream_msg(struct net_context *ctx,
+				     struct msghdr *msg, int flags)
+{
+	ssize_t total = 0;
+
+	msg->msg_flags = 0;
+	msg->msg_controllen = 0;
+	if (msg->msg_name) {
+		msg->msg_namelen = 0;
+	}
+
+	for (size_t i = 0; i < msg->msg_iovlen; i++) {
+		struct iovec *iov = &msg->msg_iov[i];
+		ssize_t len;
+
+		if (iov->iov_len == 0) {
+			continue;
+		}
+
+		len = zsock_recv_stream(ctx, iov->iov_base, iov->iov_len,
+					flags);
+		if (len < 0) {
+			return total > 0 ? total : -1;
+		}
+
+		total += len;
+
+		/* Peeking would return the same data for the next buffer */
+		if (len < iov->iov_len || (flags & ZSOCK_MSG_PEEK)) {
+			break;
+		}
+
+		/* Only wait for the first buffer, then take what is queued */
+		flags |= ZSOCK_MSG_DONTWAIT;
+	}
+
+	return total;
+}
+
 ssize_t zsock_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 			   int flags,
 			   struct sockaddr *src_addr, socklen_t *addrlen)
@@ -951,6 +1210,308 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #include <syscalls/zsock_recvfrom_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+ssize_t zsock_recvmsg_ctx(struct net_context *ctx, struct msghdr *msg,
+			  int flags)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+
+	if (msg == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sock_type == SOCK_DGRAM) {
+		return zsock_recv_dgram_msg(ctx, msg, flags);
+	} else if (sock_type == SOCK_STREAM) {
+		return zsock_recv_stream_msg(ctx, msg, flags);
+	} else {
+		__ASSERT(0, "Unknown socket type");
+	}
+
+	return 0;
+}
+
+ssize_t z_impl_zsock_recvmsg(int sock, struct msghdr *msg, int flags)
+{
+	VTABLE_CALL(recvmsg, sock, msg, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+/* Receive into a user message header. The header and the iovec array are
+ * copied so that they can not change under the receive call, the buffers
+ * they point to are checked for write access.
+ */
+static ssize_t sock_recvmsg_user(int sock, struct msghdr *umsg, int flags)
+{
+	struct msghdr msg;
+	struct iovec *iov = NULL;
+	size_t iov_size;
+	bool bad = false;
+	ssize_t ret;
+
+	Z_OOPS(z_user_from_copy(&msg, umsg, sizeof(msg)));
+	Z_OOPS(size_mul_overflow(msg.msg_iovlen, sizeof(struct iovec),
+				 &iov_size));
+
+	if (msg.msg_iovlen > 0) {
+		iov = z_user_alloc_from_copy(msg.msg_iov, iov_size);
+		Z_OOPS(!iov);
+
+		for (size_t i = 0; i < msg.msg_iovlen; i++) {
+			bad |= Z_SYSCALL_MEMORY_WRITE(iov[i].iov_base,
+						      iov[i].iov_len) != 0;
+		}
+
+		msg.msg_iov = iov;
+	}
+
+	if (msg.msg_name) {
+		bad |= Z_SYSCALL_MEMORY_WRITE(msg.msg_name,
+					      msg.msg_namelen) != 0;
+	}
+
+	if (msg.msg_control) {
+		bad |= Z_SYSCALL_MEMORY_WRITE(msg.msg_control,
+					      msg.msg_controllen) != 0;
+	}
+
+	if (bad) {
+		k_free(iov);
+		Z_OOPS(bad);
+	}
+
+	ret = z_impl_zsock_recvmsg(sock, &msg, flags);
+
+	k_free(iov);
+
+	Z_OOPS(z_user_to_copy(&umsg->msg_namelen, &msg.msg_namelen,
+			      sizeof(msg.msg_namelen)));
+	Z_OOPS(z_user_to_copy(&umsg->msg_controllen, &msg.msg_controllen,
+			      sizeof(msg.msg_controllen)));
+	Z_OOPS(z_user_to_copy(&umsg->msg_flags, &msg.msg_flags,
+			      sizeof(msg.msg_flags)));
+
+	return ret;
+}
+
+static inline ssize_t z_vrfy_zsock_recvmsg(int sock, struct msghdr *msg,
+					   int flags)
+{
+	return sock_recvmsg_user(sock, msg, flags);
+}
+#include <syscalls/zsock_recvmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (vtable->sendmsg == NULL) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = vtable->sendmsg(ctx, &msgvec[i].msg_hdr, flags);
+
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	/* Error is reported only if the first message failed */
+	return (i > 0 || vlen == 0) ? i : -1;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	unsigned int i;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(msgvec, vlen,
+					    sizeof(struct mmsghdr)));
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = sock_sendmsg_user(sock, &msgvec[i].msg_hdr,
+						flags);
+
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+	}
+
+	return (i > 0 || vlen == 0) ? i : -1;
+}
+#include <syscalls/zsock_sendmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+int z_impl_zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx = get_sock_vtable(sock, &vtable);
+	unsigned int i;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (vtable->recvmsg == NULL) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = vtable->recvmsg(ctx, &msgvec[i].msg_hdr, flags);
+
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	/* Error is reported only if the first message failed */
+	return (i > 0 || vlen == 0) ? i : -1;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	unsigned int i;
+
+	Z_OOPS(Z_SYSCALL_MEMORY_ARRAY_WRITE(msgvec, vlen,
+					    sizeof(struct mmsghdr)));
+
+	for (i = 0; i < vlen; i++) {
+		ssize_t len = sock_recvmsg_user(sock, &msgvec[i].msg_hdr,
+						flags);
+
+		if (len < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = len;
+
+		if (flags & ZSOCK_MSG_WAITFORONE) {
+			flags |= ZSOCK_MSG_DONTWAIT;
+		}
+	}
+
+	return (i > 0 || vlen == 0) ? i : -1;
+}
+#include <syscalls/zsock_recvmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+ssize_t zsock_recv_zc(int sock, struct msghdr *msg, int flags,
+		      void **handle)
+{
+	const struct socket_op_vtable *vtable;
+	struct net_context *ctx = get_sock_vtable(sock, &vtable);
+	struct net_pkt *pkt;
+	struct net_buf *buf;
+	size_t recv_len = 0;
+	size_t data_len;
+	size_t n = 0;
+	u8_t *pos;
+
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (vtable != &sock_fd_op_vtable ||
+	    net_context_get_type(ctx) != SOCK_DGRAM ||
+	    (flags & ZSOCK_MSG_PEEK)) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	pkt = sock_dgram_pkt_get(ctx, flags);
+	if (!pkt) {
+		return -1;
+	}
+
+	msg->msg_flags = 0;
+
+	if (msg->msg_name) {
+		int ret = sock_dgram_src_addr(ctx, pkt, msg->msg_name,
+					      &msg->msg_namelen);
+
+		if (ret < 0) {
+			net_pkt_unref(pkt);
+			errno = -ret;
+			return -1;
+		}
+	}
+
+	msg->msg_controllen = sock_is_pktinfo(ctx) ?
+			      sock_put_pktinfo(pkt, msg) : 0;
+
+	/* The cursor is at the start of the payload, hand out the rest
+	 * of the fragment it points to and the fragments after it.
+	 */
+	data_len = net_pkt_remaining_data(pkt);
+	buf = pkt->cursor.buf;
+	pos = pkt->cursor.pos;
+
+	while (buf && recv_len < data_len) {
+		size_t len = MIN(buf->len - (pos - buf->data),
+				 data_len - recv_len);
+
+		if (len > 0) {
+			if (n == msg->msg_iovlen) {
+				msg->msg_flags |= ZSOCK_MSG_TRUNC;
+				break;
+			}
+
+			msg->msg_iov[n].iov_base = pos;
+			msg->msg_iov[n].iov_len = len;
+			recv_len += len;
+			n++;
+		}
+
+		buf = buf->frags;
+		if (buf) {
+			pos = buf->data;
+		}
+	}
+
+	msg->msg_iovlen = n;
+
+	net_stats_update_tc_rx_time(net_pkt_iface(pkt),
+				    net_pkt_priority(pkt),
+				    net_pkt_timestamp(pkt)->nanosecond,
+				    k_cycle_get_32());
+
+	*handle = pkt;
+
+	return recv_len;
+}
+
+void zsock_recv_zc_release(void *handle)
+{
+	net_pkt_unref(handle);
+}
+#endif /* CONFIG_NET_SOCKETS_RECV_ZEROCOPY */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1374,6 +1935,20 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 		}
 		break;
 
+	case IPPROTO_IP:
+		switch (optname) {
+		case IP_PKTINFO:
+			if (optval == NULL || optlen != sizeof(int)) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			sock_set_flag(ctx, SOCK_PKTINFO,
+				      *(const int *)optval ? SOCK_PKTINFO : 0);
+			return 0;
+		}
+		break;
+
 	case IPPROTO_IPV6:
 		switch (optname) {
 		case IPV6_V6ONLY:
@@ -1381,6 +1956,16 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 * existing apps.
 			 */
 			return 0;
+
+		case IPV6_RECVPKTINFO:
+			if (optval == NULL || optlen != sizeof(int)) {
+				errno = EINVAL;
+				return -1;
+			}
+
+			sock_set_flag(ctx, SOCK_PKTINFO,
+				      *(const int *)optval ? SOCK_PKTINFO : 0);
+			return 0;
 		}
 		break;
 	}
@@ -1622,6 +2207,11 @@ static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				  src_addr, addrlen);
 }
 
+static ssize_t sock_recvmsg_vmeth(void *obj, struct msghdr *msg, int flags)
+{
+	return zsock_recvmsg_ctx(obj, msg, flags);
+}
+
 static int sock_getsockopt_vmeth(void *obj, int level, int optname,
 				 void *optval, socklen_t *optlen)
 {
@@ -1648,6 +2238,7 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.sendto = sock_sendto_vmeth,
 	.sendmsg = sock_sendmsg_vmeth,
 	.recvfrom = sock_recvfrom_vmeth,
+	.recvmsg = sock_recvmsg_vmeth,
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 };
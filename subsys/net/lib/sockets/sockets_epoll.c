@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_epoll, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <spinlock.h>
+#include <sys/dlist.h>
+#include <sys/fdtable.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+
+#include "sockets_internal.h"
+
+extern const struct socket_op_vtable sock_fd_op_vtable;
+
+struct zsock_epoll {
+	/* Items that may be ready, in the order they became ready */
+	sys_dlist_t ready;
+	/* Given when an item is added to the ready list */
+	struct k_sem ready_sem;
+	bool in_use;
+};
+
+struct zsock_epoll_item {
+	sys_dnode_t node;
+	struct zsock_epoll *ep;
+	struct net_context *ctx;
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
+static struct zsock_epoll epolls[CONFIG_NET_SOCKETS_EPOLL_MAX];
+static struct zsock_epoll_item epoll_items[CONFIG_NET_SOCKETS_EPOLL_FDS];
+
+/* Protects the interest sets and the epoll_item of the sockets */
+static struct k_spinlock epoll_lock;
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+static u32_t epoll_item_revents(struct zsock_epoll_item *item)
+{
+	struct net_context *ctx = item->ctx;
+	u32_t revents = 0U;
+
+	/* Same readiness rules as zsock_poll() */
+	if ((item->events & ZSOCK_EPOLLIN) &&
+	    (!k_fifo_is_empty(&ctx->recv_q) || sock_is_eof(ctx))) {
+		revents |= ZSOCK_EPOLLIN;
+	}
+
+	if (item->events & ZSOCK_EPOLLOUT) {
+		revents |= ZSOCK_EPOLLOUT;
+	}
+
+	return revents;
+}
+
+/* Put the item on the ready list if it is ready, return true if the
+ * waiter needs to be woken up.
+ */
+static bool epoll_item_wake(struct zsock_epoll_item *item)
+{
+	if (sys_dnode_is_linked(&item->node) || !epoll_item_revents(item)) {
+		return false;
+	}
+
+	sys_dlist_append(&item->ep->ready, &item->node);
+
+	return true;
+}
+
+static void epoll_item_free(struct zsock_epoll_item *item)
+{
+	if (sys_dnode_is_linked(&item->node)) {
+		sys_dlist_remove(&item->node);
+	}
+
+	item->ctx->epoll_item = NULL;
+	item->ctx = NULL;
+	item->ep = NULL;
+}
+
+void sock_epoll_notify(struct net_context *ctx)
+{
+	struct zsock_epoll *ep = NULL;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&epoll_lock);
+
+	if (ctx->epoll_item && epoll_item_wake(ctx->epoll_item)) {
+		ep = ctx->epoll_item->ep;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ep) {
+		k_sem_give(&ep->ready_sem);
+	}
+}
+
+void sock_epoll_detach(struct net_context *ctx)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&epoll_lock);
+
+	if (ctx->epoll_item) {
+		epoll_item_free(ctx->epoll_item);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+int zsock_epoll_create(int size)
+{
+	struct zsock_epoll *ep = NULL;
+	k_spinlock_key_t key;
+	int fd, i;
+
+	if (size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epolls); i++) {
+		if (!epolls[i].in_use) {
+			ep = &epolls[i];
+			ep->in_use = true;
+			break;
+		}
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (!ep) {
+		z_free_fd(fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	sys_dlist_init(&ep->ready);
+	k_sem_init(&ep->ready_sem, 0, 1);
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	return fd;
+}
+
+static int epoll_ctl_add(struct zsock_epoll *ep, struct net_context *ctx,
+			 struct zsock_epoll_event *event)
+{
+	struct zsock_epoll_item *item = NULL;
+	int i;
+
+	/* A socket can only be in one set, as it only has room for one
+	 * item.
+	 */
+	if (ctx->epoll_item) {
+		return -EEXIST;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (!epoll_items[i].ctx) {
+			item = &epoll_items[i];
+			break;
+		}
+	}
+
+	if (!item) {
+		return -ENOSPC;
+	}
+
+	sys_dnode_init(&item->node);
+	item->ep = ep;
+	item->ctx = ctx;
+	item->events = event->events;
+	item->data = event->data;
+	ctx->epoll_item = item;
+
+	return 0;
+}
+
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event)
+{
+	struct zsock_epoll_item *item;
+	struct zsock_epoll *ep;
+	struct net_context *ctx;
+	k_spinlock_key_t key;
+	bool wake = false;
+	int ret = 0;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (!ep) {
+		return -1;
+	}
+
+	ctx = z_get_fd_obj(fd, (const struct fd_op_vtable *)&sock_fd_op_vtable,
+			   EPERM);
+	if (!ctx) {
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && !event) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	item = ctx->epoll_item;
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		ret = epoll_ctl_add(ep, ctx, event);
+		if (ret == 0) {
+			wake = epoll_item_wake(ctx->epoll_item);
+		}
+
+		break;
+
+	case ZSOCK_EPOLL_CTL_MOD:
+		if (!item || item->ep != ep) {
+			ret = -ENOENT;
+			break;
+		}
+
+		item->events = event->events;
+		item->data = event->data;
+
+		/* Report the socket again if it is ready, also in edge
+		 * triggered mode, like Linux does.
+		 */
+		wake = epoll_item_wake(item);
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		if (!item || item->ep != ep) {
+			ret = -ENOENT;
+			break;
+		}
+
+		epoll_item_free(item);
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	if (wake) {
+		k_sem_give(&ep->ready_sem);
+	}
+
+	return 0;
+}
+
+/* Only the items on the ready list are looked at. Level triggered items
+ * that are still ready are moved to the end of the list, so that every
+ * ready socket gets its turn when there are more of them than maxevents.
+ */
+static int epoll_collect(struct zsock_epoll *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	struct zsock_epoll_item *item;
+	k_spinlock_key_t key;
+	sys_dlist_t again;
+	sys_dnode_t *node;
+	u32_t revents;
+	int count = 0;
+
+	sys_dlist_init(&again);
+
+	key = k_spin_lock(&epoll_lock);
+
+	while (count < maxevents &&
+	       (node = sys_dlist_get(&ep->ready)) != NULL) {
+		item = CONTAINER_OF(node, struct zsock_epoll_item, node);
+
+		revents = epoll_item_revents(item);
+		if (!revents) {
+			continue;
+		}
+
+		events[count].events = revents;
+		events[count].data = item->data;
+		count++;
+
+		if (!(item->events & ZSOCK_EPOLLET)) {
+			sys_dlist_append(&again, node);
+		}
+	}
+
+	while ((node = sys_dlist_get(&again)) != NULL) {
+		sys_dlist_append(&ep->ready, node);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return count;
+}
+
+static inline int time_left(u32_t start, u32_t timeout)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	return timeout - elapsed;
+}
+
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout)
+{
+	u32_t entry_time = k_uptime_get_32();
+	struct zsock_epoll *ep;
+	int remaining_time;
+	int count;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (!ep) {
+		return -1;
+	}
+
+	if (!events || maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+	}
+
+	remaining_time = timeout;
+
+	while (true) {
+		count = epoll_collect(ep, events, maxevents);
+		if (count || remaining_time == K_NO_WAIT) {
+			return count;
+		}
+
+		/* The semaphore may have been given for an item that was
+		 * already collected, in which case this is retried with the
+		 * time that is left.
+		 */
+		(void)k_sem_take(&ep->ready_sem, remaining_time);
+
+		if (timeout != K_FOREVER) {
+			remaining_time = MAX(time_left(entry_time, timeout),
+					     K_NO_WAIT);
+		}
+	}
+}
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	struct zsock_epoll *ep = obj;
+	k_spinlock_key_t key;
+	int i;
+
+	if (request != ZFD_IOCTL_CLOSE) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ctx && epoll_items[i].ep == ep) {
+			epoll_item_free(&epoll_items[i]);
+		}
+	}
+
+	ep->in_use = false;
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return 0;
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
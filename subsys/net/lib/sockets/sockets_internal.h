@@ -11,6 +11,7 @@
 
 #define SOCK_EOF 1
 #define SOCK_NONBLOCK 2
+#define SOCK_PKTINFO 4
 
 static inline void sock_set_flag(struct net_context *ctx, uintptr_t mask,
 				 uintptr_t flag)
@@ -29,6 +30,22 @@ static inline uintptr_t sock_get_flag(struct net_context *ctx, uintptr_t mask)
 #define sock_is_eof(ctx) sock_get_flag(ctx, SOCK_EOF)
 #define sock_set_eof(ctx) sock_set_flag(ctx, SOCK_EOF, SOCK_EOF)
 #define sock_is_nonblock(ctx) sock_get_flag(ctx, SOCK_NONBLOCK)
+#define sock_is_pktinfo(ctx) sock_get_flag(ctx, SOCK_PKTINFO)
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+void sock_epoll_notify(struct net_context *ctx);
+void sock_epoll_detach(struct net_context *ctx);
+#else
+static inline void sock_epoll_notify(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void sock_epoll_detach(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+#endif
 
 struct socket_op_vtable {
 	struct fd_op_vtable fd_vtable;
@@ -46,6 +63,7 @@ struct socket_op_vtable {
 	int (*setsockopt)(void *obj, int level, int optname,
 			  const void *optval, socklen_t optlen);
 	ssize_t (*sendmsg)(void *obj, const struct msghdr *msg, int flags);
+	ssize_t (*recvmsg)(void *obj, struct msghdr *msg, int flags);
 };
 
 #endif /* _SOCKETS_INTERNAL_H_ */
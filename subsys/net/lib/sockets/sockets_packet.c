@@ -16,7 +16,10 @@ LOG_MODULE_REGISTER(net_sock_packet, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <net/net_context.h>
 #include <net/net_pkt.h>
 #include <net/socket.h>
+#include <net/socket_packet_ring.h>
 #include <net/ethernet.h>
+#include <net/buf.h>
+#include <spinlock.h>
 #include <syscall_handler.h>
 #include <sys/fdtable.h>
 
@@ -36,6 +39,517 @@ static inline int k_fifo_wait_non_empty(struct k_fifo *fifo, int32_t timeout)
 	return k_poll(events, ARRAY_SIZE(events), timeout);
 }
 
+#if defined(CONFIG_NET_SOCKETS_PACKET_RING)
+struct packet_ring_ctx {
+	struct net_context *ctx;
+	struct net_packet_umem umem;
+	struct net_packet_ring *rx;
+	struct net_packet_ring *fill;
+	struct net_packet_ring *tx;
+	struct net_packet_ring *comp;
+	/* Received packets whose data is in the RX ring */
+	sys_slist_t held;
+	/* Frames sent but not yet in the completion ring */
+	u32_t tx_pending;
+	struct k_poll_signal rx_signal;
+	struct k_spinlock lock;
+};
+
+static struct packet_ring_ctx packet_rings[CONFIG_NET_SOCKETS_PACKET_RING_MAX];
+static struct k_spinlock packet_rings_lock;
+
+/* Frame sent from the buffer of the same index in packet_ring_tx_pool.
+ * The buffer data pointer is gone by the time the pool destroy callback
+ * runs, so the frame is looked up here to report its completion.
+ */
+struct packet_ring_tx_frame {
+	struct packet_ring_ctx *ring;
+	uintptr_t addr;
+	u16_t len;
+};
+
+static struct packet_ring_tx_frame
+	packet_ring_tx_frames[CONFIG_NET_SOCKETS_PACKET_RING_TX_BUFS];
+
+/* Fill ring descriptors looked up in one pass over the held list */
+#define PACKET_RING_REFILL_BATCH 8
+
+static void packet_ring_tx_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_HEAP_DEFINE(packet_ring_tx_pool,
+			 CONFIG_NET_SOCKETS_PACKET_RING_TX_BUFS,
+			 packet_ring_tx_destroy);
+
+/* The node of a received packet is free once it has left the socket
+ * queues, so it is reused to keep the packet in the held list.
+ */
+static inline sys_snode_t *packet_ring_node(struct net_pkt *pkt)
+{
+	return (sys_snode_t *)&pkt->sock_recv_fifo;
+}
+
+static inline struct net_pkt *packet_ring_pkt(sys_snode_t *node)
+{
+	return CONTAINER_OF(node, struct net_pkt, sock_recv_fifo);
+}
+
+static void packet_ring_unref_all(sys_slist_t *list)
+{
+	sys_snode_t *node;
+
+	while ((node = sys_slist_get(list)) != NULL) {
+		net_pkt_unref(packet_ring_pkt(node));
+	}
+}
+
+static struct packet_ring_ctx *packet_ring_find(struct net_context *ctx,
+						bool alloc)
+{
+	struct packet_ring_ctx *ring = NULL;
+	k_spinlock_key_t key;
+	int i;
+
+	key = k_spin_lock(&packet_rings_lock);
+
+	for (i = 0; i < ARRAY_SIZE(packet_rings); i++) {
+		if (packet_rings[i].ctx == ctx) {
+			ring = &packet_rings[i];
+			goto out;
+		}
+	}
+
+	if (!alloc) {
+		goto out;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(packet_rings); i++) {
+		if (!packet_rings[i].ctx) {
+			ring = &packet_rings[i];
+			ring->ctx = ctx;
+			sys_slist_init(&ring->held);
+			k_poll_signal_init(&ring->rx_signal);
+			break;
+		}
+	}
+
+out:
+	k_spin_unlock(&packet_rings_lock, key);
+
+	return ring;
+}
+
+static void packet_ring_free(struct packet_ring_ctx *ring)
+{
+	k_spinlock_key_t key;
+	sys_slist_t held;
+	int i;
+
+	key = k_spin_lock(&ring->lock);
+
+	held = ring->held;
+	sys_slist_init(&ring->held);
+
+	/* Frames still being sent are no longer reported */
+	for (i = 0; i < ARRAY_SIZE(packet_ring_tx_frames); i++) {
+		if (packet_ring_tx_frames[i].ring == ring) {
+			packet_ring_tx_frames[i].ring = NULL;
+		}
+	}
+
+	ring->umem.addr = NULL;
+	ring->umem.len = 0;
+	ring->rx = NULL;
+	ring->fill = NULL;
+	ring->tx = NULL;
+	ring->comp = NULL;
+	ring->tx_pending = 0U;
+
+	k_spin_unlock(&ring->lock, key);
+
+	packet_ring_unref_all(&held);
+
+	key = k_spin_lock(&packet_rings_lock);
+	ring->ctx = NULL;
+	k_spin_unlock(&packet_rings_lock, key);
+}
+
+static int packet_ring_setsockopt(struct net_context *ctx, int optname,
+				  const void *optval, socklen_t optlen)
+{
+	struct net_packet_ring *r = NULL, **slot;
+	struct packet_ring_ctx *ring;
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	if (!optval) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (optname == PACKET_RING_UMEM) {
+		if (optlen != sizeof(struct net_packet_umem)) {
+			errno = EINVAL;
+			return -1;
+		}
+	} else if (optname >= PACKET_RING_RX &&
+		   optname <= PACKET_RING_COMPLETION) {
+		if (optlen != sizeof(r)) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		r = *(struct net_packet_ring * const *)optval;
+		if (!r || !r->size || (r->size & (r->size - 1))) {
+			errno = EINVAL;
+			return -1;
+		}
+	} else {
+		errno = ENOPROTOOPT;
+		return -1;
+	}
+
+	ring = packet_ring_find(ctx, true);
+	if (!ring) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	key = k_spin_lock(&ring->lock);
+
+	switch (optname) {
+	case PACKET_RING_UMEM:
+		if (ring->umem.addr) {
+			ret = -EBUSY;
+		} else {
+			ring->umem = *(const struct net_packet_umem *)optval;
+		}
+
+		goto out;
+	case PACKET_RING_RX:
+		slot = &ring->rx;
+		break;
+	case PACKET_RING_FILL:
+		slot = &ring->fill;
+		break;
+	case PACKET_RING_TX:
+		slot = &ring->tx;
+		break;
+	default:
+		slot = &ring->comp;
+		break;
+	}
+
+	if (*slot) {
+		ret = -EBUSY;
+	} else {
+		*slot = r;
+	}
+
+out:
+	k_spin_unlock(&ring->lock, key);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Move the packets of up to PACKET_RING_REFILL_BATCH fill ring
+ * descriptors from the held list to the done list. Only packets that
+ * were handed out are trusted. Frames usually come back in the order
+ * they were received, so they are found at the head of the held list.
+ */
+static void packet_ring_refill_batch(struct packet_ring_ctx *ring,
+				     sys_slist_t *done)
+{
+	struct net_pkt *batch[PACKET_RING_REFILL_BATCH];
+	struct net_packet_desc *desc;
+	sys_snode_t *node, *next, *prev = NULL;
+	int count = 0, found = 0, i;
+
+	while (count < ARRAY_SIZE(batch) &&
+	       (desc = net_packet_ring_peek(ring->fill)) != NULL) {
+		if (desc->cookie) {
+			batch[count++] = desc->cookie;
+		}
+
+		net_packet_ring_release(ring->fill);
+	}
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&ring->held, node, next) {
+		for (i = 0; i < count; i++) {
+			if (batch[i] == packet_ring_pkt(node)) {
+				break;
+			}
+		}
+
+		if (i == count) {
+			prev = node;
+			continue;
+		}
+
+		batch[i] = NULL;
+		sys_slist_remove(&ring->held, prev, node);
+		sys_slist_append(done, node);
+
+		if (++found == count) {
+			break;
+		}
+	}
+}
+
+/* Release the received packets the application has given back */
+static void packet_ring_refill(struct packet_ring_ctx *ring)
+{
+	k_spinlock_key_t key;
+	sys_slist_t done;
+
+	if (!ring->fill) {
+		return;
+	}
+
+	sys_slist_init(&done);
+
+	key = k_spin_lock(&ring->lock);
+
+	while (ring->fill && net_packet_ring_count(ring->fill)) {
+		packet_ring_refill_batch(ring, &done);
+	}
+
+	k_spin_unlock(&ring->lock, key);
+
+	packet_ring_unref_all(&done);
+}
+
+static bool packet_ring_received(struct packet_ring_ctx *ring,
+				 struct net_pkt *pkt)
+{
+	struct net_packet_desc *desc;
+	struct net_buf *buf;
+	k_spinlock_key_t key;
+	u32_t count = 0U, idx;
+
+	if (!ring->rx) {
+		return false;
+	}
+
+	packet_ring_refill(ring);
+
+	for (buf = pkt->buffer; buf; buf = buf->frags) {
+		count++;
+	}
+
+	key = k_spin_lock(&ring->lock);
+
+	if (!ring->rx || net_packet_ring_space(ring->rx) < count) {
+		k_spin_unlock(&ring->lock, key);
+		NET_DBG("RX ring full, dropping pkt %p", pkt);
+		net_pkt_unref(pkt);
+		return true;
+	}
+
+	/* The consumer sees the frame only when the producer index is
+	 * moved past all of its descriptors.
+	 */
+	idx = atomic_get(&ring->rx->producer);
+
+	for (buf = pkt->buffer; buf; buf = buf->frags) {
+		desc = net_packet_ring_desc(ring->rx, idx++);
+		desc->addr = (uintptr_t)buf->data;
+		desc->len = buf->len;
+		desc->flags = buf->frags ? NET_PACKET_DESC_MORE : 0;
+		desc->cookie = pkt;
+	}
+
+	sys_slist_append(&ring->held, packet_ring_node(pkt));
+	atomic_set(&ring->rx->producer, idx);
+
+	k_spin_unlock(&ring->lock, key);
+
+	k_poll_signal_raise(&ring->rx_signal, 0);
+
+	return true;
+}
+
+static void packet_ring_tx_destroy(struct net_buf *buf)
+{
+	struct packet_ring_tx_frame *frame =
+		&packet_ring_tx_frames[net_buf_id(buf)];
+	struct packet_ring_ctx *ring = frame->ring;
+	struct net_packet_desc desc;
+	k_spinlock_key_t key;
+
+	if (ring) {
+		key = k_spin_lock(&ring->lock);
+
+		/* The socket may have been closed meanwhile */
+		if (frame->ring == ring) {
+			desc.addr = frame->addr;
+			desc.len = frame->len;
+			desc.flags = 0U;
+			desc.cookie = NULL;
+
+			(void)net_packet_ring_put(ring->comp, &desc);
+			ring->tx_pending--;
+			frame->ring = NULL;
+		}
+
+		k_spin_unlock(&ring->lock, key);
+	}
+
+	net_buf_destroy(buf);
+}
+
+static struct net_pkt *packet_ring_tx_pkt(struct packet_ring_ctx *ring,
+					  struct net_if *iface,
+					  struct net_packet_desc *desc)
+{
+	struct packet_ring_tx_frame *frame;
+	struct net_pkt *pkt;
+	struct net_buf *buf;
+
+	pkt = net_pkt_alloc_on_iface(iface, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	buf = net_buf_alloc_with_data(&packet_ring_tx_pool,
+				      (u8_t *)ring->umem.addr + desc->addr,
+				      desc->len, K_NO_WAIT);
+	if (!buf) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	frame = &packet_ring_tx_frames[net_buf_id(buf)];
+	frame->ring = ring;
+	frame->addr = desc->addr;
+	frame->len = desc->len;
+
+	net_pkt_set_family(pkt, AF_PACKET);
+	net_pkt_append_buffer(pkt, buf);
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+/* Send every frame of the TX ring, return the number of frames sent */
+static ssize_t packet_ring_send(struct packet_ring_ctx *ring,
+				struct net_context *ctx)
+{
+	struct net_if *iface = net_context_get_iface(ctx);
+	struct net_packet_desc *desc;
+	struct net_pkt *pkt;
+	k_spinlock_key_t key;
+	ssize_t sent = 0;
+
+	if (!iface) {
+		errno = EDESTADDRREQ;
+		return -1;
+	}
+
+	packet_ring_refill(ring);
+
+	key = k_spin_lock(&ring->lock);
+
+	if (!ring->umem.addr || !ring->comp) {
+		k_spin_unlock(&ring->lock, key);
+		errno = EINVAL;
+		return -1;
+	}
+
+	while ((desc = net_packet_ring_peek(ring->tx)) != NULL) {
+		if (desc->addr >= ring->umem.len ||
+		    desc->len > ring->umem.len - desc->addr) {
+			NET_DBG("Invalid TX descriptor %p", desc);
+			net_packet_ring_release(ring->tx);
+			continue;
+		}
+
+		/* Every frame sent needs room in the completion ring */
+		if (ring->tx_pending >= net_packet_ring_space(ring->comp)) {
+			break;
+		}
+
+		pkt = packet_ring_tx_pkt(ring, iface, desc);
+		if (!pkt) {
+			break;
+		}
+
+		ring->tx_pending++;
+		net_packet_ring_release(ring->tx);
+
+		k_spin_unlock(&ring->lock, key);
+
+		net_if_queue_tx(iface, pkt);
+		sent++;
+
+		key = k_spin_lock(&ring->lock);
+	}
+
+	k_spin_unlock(&ring->lock, key);
+
+	if (!sent && net_packet_ring_count(ring->tx)) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	return sent;
+}
+
+static int packet_ring_poll_prepare(struct packet_ring_ctx *ring,
+				    struct zsock_pollfd *pfd,
+				    struct k_poll_event **pev,
+				    struct k_poll_event *pev_end)
+{
+	packet_ring_refill(ring);
+
+	if (pfd->events & ZSOCK_POLLIN) {
+		if (*pev == pev_end) {
+			errno = ENOMEM;
+			return -1;
+		}
+
+		k_poll_signal_reset(&ring->rx_signal);
+
+		(*pev)->obj = &ring->rx_signal;
+		(*pev)->type = K_POLL_TYPE_SIGNAL;
+		(*pev)->mode = K_POLL_MODE_NOTIFY_ONLY;
+		(*pev)->state = K_POLL_STATE_NOT_READY;
+		(*pev)++;
+
+		if (net_packet_ring_count(ring->rx)) {
+			errno = EALREADY;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int packet_ring_poll_update(struct packet_ring_ctx *ring,
+				   struct zsock_pollfd *pfd,
+				   struct k_poll_event **pev)
+{
+	packet_ring_refill(ring);
+
+	if (pfd->events & ZSOCK_POLLOUT) {
+		pfd->revents |= ZSOCK_POLLOUT;
+	}
+
+	if (pfd->events & ZSOCK_POLLIN) {
+		if (net_packet_ring_count(ring->rx)) {
+			pfd->revents |= ZSOCK_POLLIN;
+		}
+		(*pev)++;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_NET_SOCKETS_PACKET_RING */
+
 static int zpacket_socket(int family, int type, int proto)
 {
 	struct net_context *ctx;
@@ -109,6 +623,14 @@ static void zpacket_received_cb(struct net_context *ctx,
 		return;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_PACKET_RING)
+	struct packet_ring_ctx *ring = packet_ring_find(ctx, false);
+
+	if (ring && packet_ring_received(ring, pkt)) {
+		return;
+	}
+#endif
+
 	/* Normal packet */
 	net_pkt_set_eof(pkt, false);
 
@@ -147,6 +669,15 @@ ssize_t zpacket_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 	s32_t timeout = K_FOREVER;
 	int status;
 
+#if defined(CONFIG_NET_SOCKETS_PACKET_RING)
+	struct packet_ring_ctx *ring = packet_ring_find(ctx, false);
+
+	/* Sending no data kicks the TX ring */
+	if (ring && ring->tx && !len) {
+		return packet_ring_send(ring, ctx);
+	}
+#endif
+
 	if (!dest_addr) {
 		errno = EDESTADDRREQ;
 		return -1;
@@ -185,6 +716,14 @@ ssize_t zpacket_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 	s32_t timeout = K_FOREVER;
 	struct net_pkt *pkt;
 
+#if defined(CONFIG_NET_SOCKETS_PACKET_RING)
+	struct packet_ring_ctx *ring = packet_ring_find(ctx, false);
+
+	if (ring) {
+		packet_ring_refill(ring);
+	}
+#endif
+
 	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
 		timeout = K_NO_WAIT;
 	}
@@ -246,6 +785,12 @@ int zpacket_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 int zpacket_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			const void *optval, socklen_t optlen)
 {
+#if defined(CONFIG_NET_SOCKETS_PACKET_RING)
+	if (level == SOL_PACKET) {
+		return packet_ring_setsockopt(ctx, optname, optval, optlen);
+	}
+#endif
+
 	return sock_fd_op_vtable.setsockopt(ctx, level, optname,
 					    optval, optlen);
 }
@@ -264,6 +809,44 @@ static ssize_t packet_sock_write_vmeth(void *obj, const void *buffer,
 static int packet_sock_ioctl_vmeth(void *obj, unsigned int request,
 				   va_list args)
 {
+#if defined(CONFIG_NET_SOCKETS_PACKET_RING)
+	struct packet_ring_ctx *ring = packet_ring_find(obj, false);
+
+	if (ring) {
+		struct zsock_pollfd *pfd;
+		struct k_poll_event **pev;
+		struct k_poll_event *pev_end;
+
+		switch (request) {
+		case ZFD_IOCTL_POLL_PREPARE:
+			if (!ring->rx) {
+				break;
+			}
+
+			pfd = va_arg(args, struct zsock_pollfd *);
+			pev = va_arg(args, struct k_poll_event **);
+			pev_end = va_arg(args, struct k_poll_event *);
+
+			return packet_ring_poll_prepare(ring, pfd, pev,
+							pev_end);
+
+		case ZFD_IOCTL_POLL_UPDATE:
+			if (!ring->rx) {
+				break;
+			}
+
+			pfd = va_arg(args, struct zsock_pollfd *);
+			pev = va_arg(args, struct k_poll_event **);
+
+			return packet_ring_poll_update(ring, pfd, pev);
+
+		case ZFD_IOCTL_CLOSE:
+			packet_ring_free(ring);
+			break;
+		}
+	}
+#endif
+
 	return sock_fd_op_vtable.fd_vtable.ioctl(obj, request, args);
 }
 
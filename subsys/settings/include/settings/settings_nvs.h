@@ -33,11 +33,45 @@ extern "C" {
 #define NVS_NAMECNT_ID 0x8000
 #define NVS_NAME_ID_OFFSET 0x4000
 
+/* Entry holding the records of a settings transaction while they are
+ * being saved.
+ */
+#define NVS_TXN_ID (NVS_NAMECNT_ID - 1)
+
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+#define SETTINGS_NVS_CACHE_BUCKETS \
+	ceiling_fraction(CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE, 4)
+
+/* Map of the setting names to their NVS entry IDs, for the name IDs
+ * NVS_NAMECNT_ID + 1 to NVS_NAMECNT_ID + CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE.
+ * The IDs are chained in buckets by the hash of their name, and a bitmap
+ * tells which IDs are in use.
+ */
+struct settings_nvs_cache {
+	u16_t name_hash[CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE];
+	/* Next ID in the bucket, as an offset from NVS_NAMECNT_ID, 0 ends
+	 * the chain.
+	 */
+	u16_t next[CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE];
+	u16_t bucket[SETTINGS_NVS_CACHE_BUCKETS];
+	u32_t used[ceiling_fraction(CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE, 32)];
+	/* All stored names are in the cache */
+	bool valid;
+};
+#endif
+
 struct settings_nvs {
 	struct settings_store cf_store;
 	struct nvs_fs cf_nvs;
 	u16_t last_name_id;
 	const char *flash_dev_name;
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+	struct settings_nvs_cache cache;
+#endif
+#if defined(CONFIG_SETTINGS_TXN)
+	/* The stored transaction is not completely saved yet */
+	bool txn_pending;
+#endif
 };
 
 /* register nvs to be a source of settings */
@@ -20,6 +20,12 @@ LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
 
 #define SETTINGS_FCB_VERS		1
 
+/*
+ * Name of the entries holding the records of a settings transaction,
+ * see settings_fcb_save_txn().
+ */
+#define SETTINGS_FCB_TXN_NAME		"\x7ftxn"
+
 int settings_backend_init(void);
 void settings_mount_fcb_backend(struct settings_fcb *cf);
 
@@ -27,10 +33,17 @@ static int settings_fcb_load(struct settings_store *cs,
 			     const struct settings_load_arg *arg);
 static int settings_fcb_save(struct settings_store *cs, const char *name,
 			     const char *value, size_t val_len);
+#if defined(CONFIG_SETTINGS_TXN)
+static int settings_fcb_save_txn(struct settings_store *cs,
+				 const struct settings_txn *txn);
+#endif
 
 static const struct settings_store_itf settings_fcb_itf = {
 	.csi_load = settings_fcb_load,
 	.csi_save = settings_fcb_save,
+#if defined(CONFIG_SETTINGS_TXN)
+	.csi_save_txn = settings_fcb_save_txn,
+#endif
 };
 
 int settings_fcb_src(struct settings_fcb *cf)
@@ -79,6 +92,86 @@ int settings_fcb_dst(struct settings_fcb *cf)
 	return 0;
 }
 
+static size_t settings_fcb_txn_align(struct settings_fcb *cf, size_t len)
+{
+	return ROUND_UP(len, cf->cf_fcb.f_align);
+}
+
+/**
+ * @brief Get the next record of a transaction entry
+ *
+ * The records are settings lines, which can be read through @p rec_ctx
+ * as if they were entries of their own.
+ *
+ * @param cf        FCB handler
+ * @param entry_ctx Transaction entry context
+ * @param off       Offset of the record in the entry, updated to the next one
+ * @param rec_ctx   Record context
+ *
+ * @retval 0 on success, -ENOENT after the last record, -EIO on read error
+ */
+static int settings_fcb_txn_next(struct settings_fcb *cf,
+				 const struct fcb_entry_ctx *entry_ctx,
+				 off_t *off, struct fcb_entry_ctx *rec_ctx)
+{
+	u16_t len;
+	int rc;
+
+	if (*off + sizeof(len) > entry_ctx->loc.fe_data_len) {
+		return -ENOENT;
+	}
+
+	rc = flash_area_read(entry_ctx->fap,
+			     FCB_ENTRY_FA_DATA_OFF(entry_ctx->loc) + *off,
+			     &len, sizeof(len));
+	if (rc) {
+		return -EIO;
+	}
+
+	*off += settings_fcb_txn_align(cf, sizeof(len));
+	if (len == 0 || *off + len > entry_ctx->loc.fe_data_len) {
+		return -ENOENT;
+	}
+
+	*rec_ctx = *entry_ctx;
+	rec_ctx->loc.fe_data_off += *off;
+	rec_ctx->loc.fe_data_len = len;
+
+	*off += settings_fcb_txn_align(cf, len);
+
+	return 0;
+}
+
+/* Offset of the first record of a transaction entry */
+static off_t settings_fcb_txn_start(struct settings_fcb *cf)
+{
+	return settings_fcb_txn_align(cf, sizeof(SETTINGS_FCB_TXN_NAME));
+}
+
+/* Check if a transaction entry has a record for the setting */
+static bool settings_fcb_txn_has(struct settings_fcb *cf,
+				 const struct fcb_entry_ctx *entry_ctx,
+				 const char * const name)
+{
+	struct fcb_entry_ctx rec_ctx;
+	off_t off = settings_fcb_txn_start(cf);
+
+	while (settings_fcb_txn_next(cf, entry_ctx, &off, &rec_ctx) == 0) {
+		char name2[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+		size_t name2_len;
+
+		if (settings_line_name_read(name2, sizeof(name2), &name2_len,
+					    &rec_ctx)) {
+			continue;
+		}
+		name2[name2_len] = '\0';
+		if (!strcmp(name, name2)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * @brief Check if there is any duplicate of the current setting
  *
@@ -107,6 +200,12 @@ static bool settings_fcb_check_duplicate(struct settings_fcb *cf,
 			continue;
 		}
 		name2[name2_len] = '\0';
+		if (!strcmp(name2, SETTINGS_FCB_TXN_NAME)) {
+			if (settings_fcb_txn_has(cf, &entry2_ctx, name)) {
+				return true;
+			}
+			continue;
+		}
 		if (!strcmp(name, name2)) {
 			return true;
 		}
@@ -122,6 +221,38 @@ static int read_entry_len(const struct fcb_entry_ctx *entry_ctx, off_t off)
 	return entry_ctx->loc.fe_data_len - off;
 }
 
+static void settings_fcb_load_txn(struct settings_fcb *cf,
+				  const struct fcb_entry_ctx *entry_ctx,
+				  line_load_cb cb,
+				  void *cb_arg,
+				  bool filter_duplicates)
+{
+	struct fcb_entry_ctx rec_ctx;
+	off_t off = settings_fcb_txn_start(cf);
+
+	while (settings_fcb_txn_next(cf, entry_ctx, &off, &rec_ctx) == 0) {
+		char name[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+		size_t name_len;
+
+		if (settings_line_name_read(name, sizeof(name), &name_len,
+					    &rec_ctx)) {
+			LOG_ERR("Failed to load transaction record name");
+			continue;
+		}
+		name[name_len] = '\0';
+
+		/* Records of a transaction are unique, only the later
+		 * entries can hold newer values.
+		 */
+		if (filter_duplicates &&
+		    (!read_entry_len(&rec_ctx, name_len+1) ||
+		     settings_fcb_check_duplicate(cf, entry_ctx, name))) {
+			continue;
+		}
+		cb(name, &rec_ctx, name_len + 1, cb_arg);
+	}
+}
+
 static int settings_fcb_load_priv(struct settings_store *cs,
 				  line_load_cb cb,
 				  void *cb_arg,
@@ -148,6 +279,12 @@ static int settings_fcb_load_priv(struct settings_store *cs,
 		}
 		name[name_len] = '\0';
 
+		if (!strcmp(name, SETTINGS_FCB_TXN_NAME)) {
+			settings_fcb_load_txn(cf, &entry_ctx, cb, cb_arg,
+					      filter_duplicates);
+			continue;
+		}
+
 		if (filter_duplicates &&
 		    (!read_entry_len(&entry_ctx, name_len+1) ||
 		     settings_fcb_check_duplicate(cf, &entry_ctx, name))) {
@@ -193,23 +330,73 @@ static int read_handler(void *ctx, off_t off, char *buf, size_t *len)
 			       *len);
 }
 
+/* Copy an entry, or a record of a transaction entry, to the active sector */
+static void settings_fcb_compress_copy(struct settings_fcb *cf,
+				       struct fcb_entry_ctx *src_ctx)
+{
+	struct fcb_entry_ctx dst_ctx = {
+		.fap = cf->cf_fcb.fap
+	};
+	int rc;
+
+	rc = fcb_append(&cf->cf_fcb, src_ctx->loc.fe_data_len, &dst_ctx.loc);
+	if (rc) {
+		return;
+	}
+
+	rc = settings_line_entry_copy(&dst_ctx, 0, src_ctx, 0,
+				      src_ctx->loc.fe_data_len);
+	if (rc) {
+		return;
+	}
+	rc = fcb_append_finish(&cf->cf_fcb, &dst_ctx.loc);
+
+	if (rc != 0) {
+		LOG_ERR("Failed to finish fcb_append (%d)", rc);
+	}
+}
+
+/*
+ * The records of a transaction entry are copied one by one, as entries of
+ * their own, since some of them may have been overwritten since.
+ */
+static void settings_fcb_compress_txn(struct settings_fcb *cf,
+				      const struct fcb_entry_ctx *entry_ctx)
+{
+	struct fcb_entry_ctx rec_ctx;
+	off_t off = settings_fcb_txn_start(cf);
+	char name[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+	size_t val_off;
+
+	while (settings_fcb_txn_next(cf, entry_ctx, &off, &rec_ctx) == 0) {
+		if (settings_line_name_read(name, sizeof(name), &val_off,
+					    &rec_ctx)) {
+			continue;
+		}
+		name[val_off] = '\0';
+
+		if (val_off + 1 == rec_ctx.loc.fe_data_len) {
+			/* Lack of a value so the record is a deletion-record */
+			continue;
+		}
+
+		if (!settings_fcb_check_duplicate(cf, entry_ctx, name)) {
+			settings_fcb_compress_copy(cf, &rec_ctx);
+		}
+	}
+}
+
 static void settings_fcb_compress(struct settings_fcb *cf)
 {
 	int rc;
 	struct fcb_entry_ctx loc1;
-	struct fcb_entry_ctx loc2;
-	char name1[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN];
-	char name2[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN];
-	int copy;
-	u8_t rbs;
+	char name1[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
 
 	rc = fcb_append_to_scratch(&cf->cf_fcb);
 	if (rc) {
 		return; /* XXX */
 	}
 
-	rbs = flash_area_align(cf->cf_fcb.fap);
-
 	loc1.fap = cf->cf_fcb.fap;
 
 	loc1.loc.fe_sector = NULL;
@@ -227,6 +414,12 @@ static void settings_fcb_compress(struct settings_fcb *cf)
 		if (rc) {
 			continue;
 		}
+		name1[val1_off] = '\0';
+
+		if (!strcmp(name1, SETTINGS_FCB_TXN_NAME)) {
+			settings_fcb_compress_txn(cf, &loc1);
+			continue;
+		}
 
 		if (val1_off + 1 == loc1.loc.fe_data_len) {
 			/* Lack of a value so the record is a deletion-record */
@@ -235,46 +428,14 @@ static void settings_fcb_compress(struct settings_fcb *cf)
 			continue;
 		}
 
-		loc2 = loc1;
-		copy = 1;
-
-		while (fcb_getnext(&cf->cf_fcb, &loc2.loc) == 0) {
-			size_t val2_off;
-
-			rc = settings_line_name_read(name2, sizeof(name2),
-						     &val2_off, &loc2);
-			if (rc) {
-				continue;
-			}
-
-			if ((val1_off == val2_off) &&
-			    !memcmp(name1, name2, val1_off)) {
-				copy = 0;
-				break;
-			}
-		}
-		if (!copy) {
+		if (settings_fcb_check_duplicate(cf, &loc1, name1)) {
 			continue;
 		}
 
 		/*
 		 * Can't find one. Must copy.
 		 */
-		rc = fcb_append(&cf->cf_fcb, loc1.loc.fe_data_len, &loc2.loc);
-		if (rc) {
-			continue;
-		}
-
-		rc = settings_line_entry_copy(&loc2, 0, &loc1, 0,
-					      loc1.loc.fe_data_len);
-		if (rc) {
-			continue;
-		}
-		rc = fcb_append_finish(&cf->cf_fcb, &loc2.loc);
-
-		if (rc != 0) {
-			LOG_ERR("Failed to finish fcb_append (%d)", rc);
-		}
+		settings_fcb_compress_copy(cf, &loc1);
 	}
 	rc = fcb_rotate(&cf->cf_fcb);
 
@@ -364,6 +525,84 @@ static int settings_fcb_save(struct settings_store *cs, const char *name,
 	return settings_fcb_save_priv(cs, name, (char *)value, val_len);
 }
 
+#if defined(CONFIG_SETTINGS_TXN)
+/*
+ * The records of a transaction are written in a single entry, which the
+ * FCB only takes as valid once all of it is written. It is laid out as
+ * SETTINGS_FCB_TXN_NAME followed by '=', then for each record the u16_t
+ * length of its settings line and the line, each part padded to the
+ * write block size.
+ */
+static int settings_fcb_save_txn(struct settings_store *cs,
+				 const struct settings_txn *txn)
+{
+	struct settings_fcb *cf = (struct settings_fcb *)cs;
+	struct settings_txn_rec rec;
+	struct fcb_entry_ctx loc;
+	char len_buf[16]; /* same write block size limit as settings_line */
+	size_t len_size;
+	size_t off;
+	off_t w_off;
+	u16_t rec_len;
+	int len;
+	int rc;
+	int i;
+
+	len_size = settings_fcb_txn_align(cf, sizeof(rec_len));
+	if (len_size > sizeof(len_buf)) {
+		return -EINVAL;
+	}
+
+	len = settings_fcb_txn_start(cf);
+	off = 0;
+	while (settings_txn_next(txn, &off, &rec) == 0) {
+		len += len_size + settings_fcb_txn_align(cf,
+			settings_line_len_calc(rec.name, rec.val_len));
+	}
+
+	for (i = 0; i < cf->cf_fcb.f_sector_cnt - 1; i++) {
+		rc = fcb_append(&cf->cf_fcb, len, &loc.loc);
+		if (rc != -ENOSPC) {
+			break;
+		}
+		settings_fcb_compress(cf);
+	}
+	if (rc) {
+		return -EINVAL;
+	}
+
+	loc.fap = cf->cf_fcb.fap;
+
+	rc = settings_line_write(SETTINGS_FCB_TXN_NAME, NULL, 0, 0,
+				 (void *)&loc);
+	w_off = settings_fcb_txn_start(cf);
+	off = 0;
+
+	while (rc == 0 && settings_txn_next(txn, &off, &rec) == 0) {
+		rec_len = settings_line_len_calc(rec.name, rec.val_len);
+		memset(len_buf, 0, len_size);
+		memcpy(len_buf, &rec_len, sizeof(rec_len));
+
+		rc = write_handler(&loc, w_off, len_buf, len_size);
+		w_off += len_size;
+
+		if (rc == 0) {
+			rc = settings_line_write(rec.name, rec.value,
+						 rec.val_len, w_off,
+						 (void *)&loc);
+		}
+		w_off += settings_fcb_txn_align(cf, rec_len);
+	}
+
+	/* An unfinished entry is skipped, with all of the records */
+	if (rc == 0) {
+		rc = fcb_append_finish(&cf->cf_fcb, &loc.loc);
+	}
+
+	return rc;
+}
+#endif /* CONFIG_SETTINGS_TXN */
+
 void settings_mount_fcb_backend(struct settings_fcb *cf)
 {
 	u8_t rbs;
@@ -26,10 +26,17 @@ static int settings_file_load(struct settings_store *cs,
 			      const struct settings_load_arg *arg);
 static int settings_file_save(struct settings_store *cs, const char *name,
 			      const char *value, size_t val_len);
+#if defined(CONFIG_SETTINGS_TXN)
+static int settings_file_save_txn(struct settings_store *cs,
+				  const struct settings_txn *txn);
+#endif
 
 static const struct settings_store_itf settings_file_itf = {
 	.csi_load = settings_file_load,
 	.csi_save = settings_file_save,
+#if defined(CONFIG_SETTINGS_TXN)
+	.csi_save_txn = settings_file_save_txn,
+#endif
 };
 
 /*
@@ -210,10 +217,30 @@ static int settings_file_create_or_replace(struct fs_file_t *zfp,
 	return fs_open(zfp, file_name);
 }
 
+#if defined(CONFIG_SETTINGS_TXN)
+/* Check if a transaction has a record for the setting */
+static bool settings_file_txn_has(const struct settings_txn *txn,
+				  const char *name, size_t name_len)
+{
+	struct settings_txn_rec rec;
+	size_t off = 0;
+
+	while (settings_txn_next(txn, &off, &rec) == 0) {
+		if (strlen(rec.name) == name_len &&
+		    !memcmp(rec.name, name, name_len)) {
+			return true;
+		}
+	}
+	return false;
+}
+#endif
+
 /*
  * Try to compress configuration file by keeping unique names only.
+ * The new value is either @p name or the records of @p txn.
  */
 static int settings_file_save_and_compress(struct settings_file *cf,
+			   const struct settings_txn *txn,
 			   const char *name, const char *value,
 			   size_t val_len)
 {
@@ -252,7 +279,7 @@ static int settings_file_save_and_compress(struct settings_file *cf,
 	}
 
 	lines = 0;
-	new_name_len = strlen(name);
+	new_name_len = name ? strlen(name) : 0;
 
 	while (1) {
 		rc = settings_next_line_ctx(&loc1);
@@ -277,11 +304,17 @@ static int settings_file_save_and_compress(struct settings_file *cf,
 		}
 
 		/* avoid copping value which will be overwritten by new value*/
-		if ((val1_off == new_name_len) &&
+		if (name && (val1_off == new_name_len) &&
 		    !memcmp(name1, name, val1_off)) {
 			continue;
 		}
 
+#if defined(CONFIG_SETTINGS_TXN)
+		if (txn && settings_file_txn_has(txn, name1, val1_off)) {
+			continue;
+		}
+#endif
+
 		loc2 = loc1;
 
 		copy = 1;
@@ -325,10 +358,30 @@ static int settings_file_save_and_compress(struct settings_file *cf,
 	}
 
 	/* at last store the new value */
-	rc = settings_line_write(name, value, val_len, 0, &loc3);
-	if (rc) {
-		/* compressed file might be corrupted */
-		goto end_rolback;
+#if defined(CONFIG_SETTINGS_TXN)
+	if (txn) {
+		struct settings_txn_rec rec;
+		size_t off = 0;
+
+		while (settings_txn_next(txn, &off, &rec) == 0) {
+			rc = settings_line_write(rec.name, rec.value,
+						 rec.val_len, 0, &loc3);
+			if (rc) {
+				/* compressed file might be corrupted */
+				goto end_rolback;
+			}
+			lines++;
+		}
+	}
+#endif
+
+	if (name) {
+		rc = settings_line_write(name, value, val_len, 0, &loc3);
+		if (rc) {
+			/* compressed file might be corrupted */
+			goto end_rolback;
+		}
+		lines++;
 	}
 
 	rc = fs_close(&wf);
@@ -337,7 +390,7 @@ static int settings_file_save_and_compress(struct settings_file *cf,
 		if (fs_rename(tmp_file, cf->cf_name)) {
 			return -ENOENT;
 		}
-		cf->cf_lines = lines + 1;
+		cf->cf_lines = lines;
 	} else {
 		rc = -EIO;
 	}
@@ -373,7 +426,7 @@ static int settings_file_save_priv(struct settings_store *cs, const char *name,
 		 * Compress before config file size exceeds
 		 * the max number of lines.
 		 */
-		return settings_file_save_and_compress(cf, name, value,
+		return settings_file_save_and_compress(cf, NULL, name, value,
 						       val_len);
 	}
 
@@ -428,6 +481,64 @@ static int settings_file_save(struct settings_store *cs, const char *name,
 	return settings_file_save_priv(cs, name, (char *)value, val_len);
 }
 
+#if defined(CONFIG_SETTINGS_TXN)
+/*
+ * The records of a transaction are appended while the file is open once,
+ * so that file systems which commit a file when it is closed, like
+ * LittleFS, store all of them or none. On errors, the file is truncated
+ * back to its old length.
+ */
+static int settings_file_save_txn(struct settings_store *cs,
+				  const struct settings_txn *txn)
+{
+	struct settings_file *cf = (struct settings_file *)cs;
+	struct line_entry_ctx entry_ctx;
+	struct settings_txn_rec rec;
+	struct fs_file_t file;
+	size_t off = 0;
+	off_t file_len;
+	int lines = 0;
+	int rc2;
+	int rc;
+
+	if (cf->cf_maxlines && (cf->cf_lines + txn->cnt >= cf->cf_maxlines)) {
+		/*
+		 * Compress before config file size exceeds
+		 * the max number of lines.
+		 */
+		return settings_file_save_and_compress(cf, txn, NULL, NULL, 0);
+	}
+
+	rc = fs_open(&file, cf->cf_name);
+	if (rc) {
+		return rc;
+	}
+
+	rc = fs_seek(&file, 0, FS_SEEK_END);
+	file_len = fs_tell(&file);
+	entry_ctx.stor_ctx = &file;
+
+	while (rc == 0 && settings_txn_next(txn, &off, &rec) == 0) {
+		rc = settings_line_write(rec.name, rec.value, rec.val_len, 0,
+					 (void *)&entry_ctx);
+		lines++;
+	}
+
+	if (rc == 0) {
+		cf->cf_lines += lines;
+	} else if (file_len >= 0) {
+		(void)fs_truncate(&file, file_len);
+	}
+
+	rc2 = fs_close(&file);
+	if (rc == 0) {
+		rc = rc2;
+	}
+
+	return rc;
+}
+#endif /* CONFIG_SETTINGS_TXN */
+
 static int read_handler(void *ctx, off_t off, char *buf, size_t *len)
 {
 	struct line_entry_ctx *entry_ctx = ctx;
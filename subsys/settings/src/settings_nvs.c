@@ -12,6 +12,7 @@
 #include "settings/settings_nvs.h"
 #include "settings_priv.h"
 #include <storage/flash_map.h>
+#include <sys/crc.h>
 
 #include <logging/log.h>
 LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
@@ -25,10 +26,17 @@ static int settings_nvs_load(struct settings_store *cs,
 			     const struct settings_load_arg *arg);
 static int settings_nvs_save(struct settings_store *cs, const char *name,
 			     const char *value, size_t val_len);
+#if defined(CONFIG_SETTINGS_TXN)
+static int settings_nvs_save_txn(struct settings_store *cs,
+				 const struct settings_txn *txn);
+#endif
 
 static struct settings_store_itf settings_nvs_itf = {
 	.csi_load = settings_nvs_load,
 	.csi_save = settings_nvs_save,
+#if defined(CONFIG_SETTINGS_TXN)
+	.csi_save_txn = settings_nvs_save_txn,
+#endif
 };
 
 static ssize_t settings_nvs_read_fn(void *back_end, void *data, size_t len)
@@ -48,6 +56,152 @@ static ssize_t settings_nvs_read_fn(void *back_end, void *data, size_t len)
 	return rc;
 }
 
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+static u16_t settings_nvs_name_hash(const char *name)
+{
+	return crc16_ccitt(0xffff, (const u8_t *)name, strlen(name));
+}
+
+static void settings_nvs_cache_clear(struct settings_nvs *cf)
+{
+	(void)memset(&cf->cache, 0, sizeof(cf->cache));
+}
+
+static bool settings_nvs_cache_has(struct settings_nvs *cf, u16_t name_id)
+{
+	u16_t slot = name_id - NVS_NAMECNT_ID - 1;
+
+	if (name_id <= NVS_NAMECNT_ID ||
+	    slot >= CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE) {
+		return false;
+	}
+
+	return cf->cache.used[slot / 32] & BIT(slot % 32);
+}
+
+/* returns false if the name ID is out of the range of the cache */
+static bool settings_nvs_cache_add(struct settings_nvs *cf, u16_t name_id,
+				   u16_t name_hash)
+{
+	u16_t slot = name_id - NVS_NAMECNT_ID - 1;
+	u16_t *bucket;
+
+	if (name_id <= NVS_NAMECNT_ID ||
+	    slot >= CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE) {
+		return false;
+	}
+
+	bucket = &cf->cache.bucket[name_hash % SETTINGS_NVS_CACHE_BUCKETS];
+
+	cf->cache.name_hash[slot] = name_hash;
+	cf->cache.next[slot] = *bucket;
+	*bucket = slot + 1;
+	cf->cache.used[slot / 32] |= BIT(slot % 32);
+
+	return true;
+}
+
+static void settings_nvs_cache_del(struct settings_nvs *cf, u16_t name_id)
+{
+	u16_t slot = name_id - NVS_NAMECNT_ID - 1;
+	u16_t *link;
+
+	if (!settings_nvs_cache_has(cf, name_id)) {
+		return;
+	}
+
+	link = &cf->cache.bucket[cf->cache.name_hash[slot] %
+				 SETTINGS_NVS_CACHE_BUCKETS];
+	while (*link != slot + 1) {
+		link = &cf->cache.next[*link - 1];
+	}
+
+	*link = cf->cache.next[slot];
+	cf->cache.used[slot / 32] &= ~BIT(slot % 32);
+}
+
+/* Find the name ID of name among the cached IDs with the same hash. Only
+ * these names are read from NVS. Returns the lowest unused name ID in
+ * free_id when the name is not found, and the error when a cached name
+ * can not be read.
+ */
+static int settings_nvs_cache_find(struct settings_nvs *cf, const char *name,
+				   u16_t *name_id, u16_t *free_id)
+{
+	char rdname[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+	u16_t name_hash = settings_nvs_name_hash(name);
+	u16_t slot, i;
+	ssize_t rc;
+
+	slot = cf->cache.bucket[name_hash % SETTINGS_NVS_CACHE_BUCKETS];
+	for (; slot; slot = cf->cache.next[slot - 1]) {
+		if (cf->cache.name_hash[slot - 1] != name_hash) {
+			continue;
+		}
+
+		rc = nvs_read(&cf->cf_nvs, NVS_NAMECNT_ID + slot, &rdname,
+			      sizeof(rdname));
+		if (rc < 0) {
+			/* A cached name must be readable, -ENOENT would be
+			 * taken for a name that is not stored yet.
+			 */
+			return (rc == -ENOENT) ? -EIO : rc;
+		}
+
+		rdname[MIN(rc, sizeof(rdname) - 1)] = '\0';
+		if (!strcmp(name, rdname)) {
+			*name_id = NVS_NAMECNT_ID + slot;
+			return 0;
+		}
+	}
+
+	*free_id = NVS_NAMECNT_ID + CONFIG_SETTINGS_NVS_NAME_CACHE_SIZE + 1;
+	for (i = 0; i < ARRAY_SIZE(cf->cache.used); i++) {
+		if (cf->cache.used[i] != 0xffffffff) {
+			slot = i * 32 + find_lsb_set(~cf->cache.used[i]);
+			*free_id = MIN(*free_id, NVS_NAMECNT_ID + slot);
+			break;
+		}
+	}
+
+	return -ENOENT;
+}
+#endif /* CONFIG_SETTINGS_NVS_NAME_CACHE */
+
+/* Find the name ID of name by reading all the names stored in NVS. Returns
+ * the lowest unused name ID in free_id when the name is not found.
+ */
+static int settings_nvs_scan(struct settings_nvs *cf, const char *name,
+			     u16_t *name_id, u16_t *free_id)
+{
+	char rdname[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
+	u16_t id;
+	ssize_t rc;
+
+	*free_id = cf->last_name_id + 1;
+
+	for (id = cf->last_name_id; id != NVS_NAMECNT_ID; id--) {
+		rc = nvs_read(&cf->cf_nvs, id, &rdname, sizeof(rdname));
+
+		if (rc < 0) {
+			/* Error or entry not found */
+			if (rc == -ENOENT) {
+				*free_id = id;
+			}
+			continue;
+		}
+
+		rdname[rc] = '\0';
+
+		if (!strcmp(name, rdname)) {
+			*name_id = id;
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
 int settings_nvs_src(struct settings_nvs *cf)
 {
 	cf->cf_store.cs_itf = &settings_nvs_itf;
@@ -74,6 +228,11 @@ static int settings_nvs_load(struct settings_store *cs,
 	char buf;
 	ssize_t rc1, rc2;
 	u16_t name_id = NVS_NAMECNT_ID;
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+	bool cache_valid = true;
+
+	settings_nvs_cache_clear(cf);
+#endif
 
 	name_id = cf->last_name_id + 1;
 
@@ -114,6 +273,13 @@ static int settings_nvs_load(struct settings_store *cs,
 
 		/* Found a name, this might not include a trailing \0 */
 		name[rc1] = '\0';
+
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+		if (!settings_nvs_cache_add(cf, name_id,
+					    settings_nvs_name_hash(name))) {
+			cache_valid = false;
+		}
+#endif
 		read_fn_arg.fs = &cf->cf_nvs;
 		read_fn_arg.id = name_id + NVS_NAME_ID_OFFSET;
 
@@ -125,6 +291,12 @@ static int settings_nvs_load(struct settings_store *cs,
 			break;
 		}
 	}
+
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+	/* Only a complete walk has seen all the names */
+	cf->cache.valid = cache_valid && !ret;
+#endif
+
 	return ret;
 }
 
@@ -132,7 +304,6 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 			     const char *value, size_t val_len)
 {
 	struct settings_nvs *cf = (struct settings_nvs *)cs;
-	char rdname[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
 	u16_t name_id, write_name_id;
 	bool delete, write_name;
 	int rc = 0;
@@ -141,35 +312,33 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_SETTINGS_TXN)
+	/* Recovery of the transaction would overwrite the value */
+	if (cf->txn_pending) {
+		return -EIO;
+	}
+#endif
+
 	/* Find out if we are doing a delete */
 	delete = ((value == NULL) || (val_len == 0));
 
-	name_id = cf->last_name_id + 1;
-	write_name_id = cf->last_name_id + 1;
-	write_name = true;
-
-	while (1) {
-		name_id--;
-		if (name_id == NVS_NAMECNT_ID) {
-			break;
-		}
-
-		rc = nvs_read(&cf->cf_nvs, name_id, &rdname, sizeof(rdname));
-
-		if (rc < 0) {
-			/* Error or entry not found */
-			if (rc == -ENOENT) {
-				write_name_id = name_id;
-			}
-			continue;
-		}
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+	if (cf->cache.valid) {
+		rc = settings_nvs_cache_find(cf, name, &name_id,
+					     &write_name_id);
+	} else
+#endif
+	{
+		rc = settings_nvs_scan(cf, name, &name_id, &write_name_id);
+	}
 
-		rdname[rc] = '\0';
+	if ((rc < 0) && (rc != -ENOENT)) {
+		return rc;
+	}
 
-		if (strcmp(name, rdname)) {
-			continue;
-		}
+	write_name = (rc == -ENOENT);
 
+	if (!write_name) {
 		if ((delete) && (name_id == cf->last_name_id)) {
 			cf->last_name_id--;
 			rc = nvs_write(&cf->cf_nvs, NVS_NAMECNT_ID,
@@ -194,11 +363,13 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 				return rc;
 			}
 
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+			settings_nvs_cache_del(cf, name_id);
+#endif
 			return 0;
 		}
+
 		write_name_id = name_id;
-		write_name = false;
-		break;
 	}
 
 	if (delete) {
@@ -220,6 +391,17 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 		if (rc < 0) {
 			return rc;
 		}
+
+#if defined(CONFIG_SETTINGS_NVS_NAME_CACHE)
+		/* Beyond its size the cache can no longer tell which
+		 * names are stored.
+		 */
+		if (cf->cache.valid &&
+		    !settings_nvs_cache_add(cf, write_name_id,
+					    settings_nvs_name_hash(name))) {
+			cf->cache.valid = false;
+		}
+#endif
 	}
 
 	/* update the last_name_id and write to flash if required*/
@@ -236,6 +418,98 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 	return 0;
 }
 
+#if defined(CONFIG_SETTINGS_TXN)
+static int settings_nvs_txn_apply(struct settings_nvs *cf,
+				  const struct settings_txn *txn)
+{
+	struct settings_txn_rec rec;
+	size_t off = 0;
+	int rc;
+
+	while ((rc = settings_txn_next(txn, &off, &rec)) == 0) {
+		rc = settings_nvs_save(&cf->cf_store, rec.name, rec.value,
+				       rec.val_len);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return (rc == -ENOENT) ? 0 : rc;
+}
+
+/*
+ * The records of a transaction are first written to a single NVS entry.
+ * If the device resets before they are all saved, they are saved again
+ * from that entry when the backend is initialized.
+ *
+ * The entry is also kept when saving the records fails, so that the
+ * transaction is completed when the backend is initialized again. Until
+ * then nothing else is saved, as it would be overwritten by the records
+ * of the transaction.
+ */
+static int settings_nvs_save_txn(struct settings_store *cs,
+				 const struct settings_txn *txn)
+{
+	struct settings_nvs *cf = (struct settings_nvs *)cs;
+	int rc;
+
+	if (cf->txn_pending) {
+		return -EIO;
+	}
+
+	rc = nvs_write(&cf->cf_nvs, NVS_TXN_ID, txn->buf, txn->len);
+	if (rc < 0) {
+		return rc;
+	}
+
+	rc = settings_nvs_txn_apply(cf, txn);
+	if (!rc) {
+		rc = nvs_delete(&cf->cf_nvs, NVS_TXN_ID);
+	}
+
+	if (rc) {
+		LOG_ERR("Transaction completed at next init (%d)", rc);
+		cf->txn_pending = true;
+	}
+
+	return rc;
+}
+
+static void settings_nvs_txn_recover(struct settings_nvs *cf)
+{
+	struct settings_txn txn = { 0 };
+	size_t size;
+	ssize_t len;
+	int rc;
+
+	txn.buf = settings_txn_buf_get(&size);
+
+	len = nvs_read(&cf->cf_nvs, NVS_TXN_ID, txn.buf, size);
+	if (len <= 0) {
+		return;
+	}
+
+	if (len > size) {
+		LOG_ERR("Transaction of %d bytes does not fit", (int)len);
+	} else {
+		txn.len = len;
+		rc = settings_nvs_txn_apply(cf, &txn);
+		if (rc == -EINVAL) {
+			LOG_ERR("Dropping malformed transaction");
+		} else if (rc) {
+			/* Kept for the next initialization */
+			LOG_ERR("Failed to complete transaction (%d)", rc);
+			cf->txn_pending = true;
+			return;
+		}
+	}
+
+	if (nvs_delete(&cf->cf_nvs, NVS_TXN_ID)) {
+		cf->txn_pending = true;
+	}
+}
+#endif /* CONFIG_SETTINGS_TXN */
+
 /* Initialize the nvs backend. */
 int settings_nvs_backend_init(struct settings_nvs *cf)
 {
@@ -255,6 +529,11 @@ int settings_nvs_backend_init(struct settings_nvs *cf)
 		cf->last_name_id = last_name_id;
 	}
 
+#if defined(CONFIG_SETTINGS_TXN)
+	cf->txn_pending = false;
+	settings_nvs_txn_recover(cf);
+#endif
+
 	LOG_DBG("Initialized");
 	return 0;
 }
@@ -121,6 +121,12 @@ void settings_line_io_init(int (*read_cb)(void *ctx, off_t off, char *buf,
 			  u8_t io_rwbs);
 
 
+/*
+ * Buffer holding the records of settings transactions, which the
+ * backends can use while no transaction is open, e.g. at init.
+ */
+char *settings_txn_buf_get(size_t *size);
+
 extern sys_slist_t settings_load_srcs;
 extern sys_slist_t settings_handlers;
 extern struct settings_store *settings_save_dst;
@@ -123,6 +123,178 @@ int settings_delete(const char *name)
 	return settings_save_one(name, NULL, 0);
 }
 
+#if defined(CONFIG_SETTINGS_TXN)
+/* Records are stored one after another as the name, its terminating
+ * NUL, the u16_t length of the value and the value.
+ */
+static char settings_txn_buf[CONFIG_SETTINGS_TXN_BUF_SIZE];
+static struct settings_txn settings_txn = {
+	.buf = settings_txn_buf,
+};
+static bool settings_txn_open;
+
+int settings_txn_next(const struct settings_txn *txn, size_t *off,
+		      struct settings_txn_rec *rec)
+{
+	size_t name_len, rem;
+	u16_t val_len;
+
+	if (*off >= txn->len) {
+		return -ENOENT;
+	}
+
+	rem = txn->len - *off;
+	name_len = strnlen(&txn->buf[*off], rem);
+	if (name_len + 1 + sizeof(val_len) > rem) {
+		return -EINVAL;
+	}
+
+	memcpy(&val_len, &txn->buf[*off + name_len + 1], sizeof(val_len));
+	if (name_len + 1 + sizeof(val_len) + val_len > rem) {
+		return -EINVAL;
+	}
+
+	rec->name = &txn->buf[*off];
+	rec->value = val_len ? &txn->buf[*off + name_len + 1 +
+					 sizeof(val_len)] : NULL;
+	rec->val_len = val_len;
+
+	*off += name_len + 1 + sizeof(val_len) + val_len;
+
+	return 0;
+}
+
+char *settings_txn_buf_get(size_t *size)
+{
+	*size = sizeof(settings_txn_buf);
+	return settings_txn_buf;
+}
+
+int settings_txn_begin(void)
+{
+	int rc = 0;
+
+	if (!settings_save_dst) {
+		return -ENOENT;
+	}
+
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	if (settings_txn_open) {
+		rc = -EBUSY;
+	} else {
+		settings_txn_open = true;
+		settings_txn.len = 0;
+		settings_txn.cnt = 0;
+	}
+
+	k_mutex_unlock(&settings_lock);
+
+	return rc;
+}
+
+int settings_txn_save_one(const char *name, const void *value,
+			  size_t val_len)
+{
+	struct settings_txn_rec rec;
+	size_t off, prev, rec_len;
+	size_t old_len = 0;
+	u16_t len = val_len;
+	int rc = 0;
+
+	if (!name || val_len > UINT16_MAX || (val_len > 0 && !value)) {
+		return -EINVAL;
+	}
+
+	rec_len = strlen(name) + 1 + sizeof(len) + val_len;
+
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	if (!settings_txn_open) {
+		rc = -EINVAL;
+		goto out;
+	}
+
+	/* Look for a value staged earlier for the same name */
+	off = 0;
+	do {
+		prev = off;
+		if (settings_txn_next(&settings_txn, &off, &rec)) {
+			break;
+		}
+
+		if (!strcmp(rec.name, name)) {
+			old_len = off - prev;
+		}
+	} while (!old_len);
+
+	if (settings_txn.len - old_len + rec_len > sizeof(settings_txn_buf)) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	if (old_len) {
+		memmove(&settings_txn_buf[prev], &settings_txn_buf[off],
+			settings_txn.len - off);
+		settings_txn.len -= old_len;
+		settings_txn.cnt--;
+	}
+
+	off = settings_txn.len;
+	strcpy(&settings_txn_buf[off], name);
+	off += strlen(name) + 1;
+	memcpy(&settings_txn_buf[off], &len, sizeof(len));
+	off += sizeof(len);
+	if (val_len) {
+		memcpy(&settings_txn_buf[off], value, val_len);
+	}
+
+	settings_txn.len += rec_len;
+	settings_txn.cnt++;
+
+out:
+	k_mutex_unlock(&settings_lock);
+
+	return rc;
+}
+
+int settings_txn_delete(const char *name)
+{
+	return settings_txn_save_one(name, NULL, 0);
+}
+
+int settings_txn_commit(void)
+{
+	struct settings_store *cs;
+	int rc = 0;
+
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	cs = settings_save_dst;
+
+	if (!settings_txn_open) {
+		rc = -EINVAL;
+	} else if (!cs->cs_itf->csi_save_txn) {
+		rc = -ENOTSUP;
+	} else if (settings_txn.cnt) {
+		rc = cs->cs_itf->csi_save_txn(cs, &settings_txn);
+	}
+
+	settings_txn_open = false;
+
+	k_mutex_unlock(&settings_lock);
+
+	return rc;
+}
+
+void settings_txn_abort(void)
+{
+	k_mutex_lock(&settings_lock, K_FOREVER);
+	settings_txn_open = false;
+	k_mutex_unlock(&settings_lock);
+}
+#endif /* CONFIG_SETTINGS_TXN */
+
 int settings_save(void)
 {
 	struct settings_store *cs;
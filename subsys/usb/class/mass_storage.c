@@ -733,6 +733,12 @@ static void thread_memory_write_done(void)
 
 
 	if ((!length) || (stage != MSC_PROCESS_CBW)) {
+		/* The disk may cache the written blocks */
+		if (disk_access_ioctl(disk_pdrv, DISK_IOCTL_CTRL_SYNC, NULL)) {
+			LOG_ERR("!!!!! Disk Sync Error !!!!!");
+			stage = MSC_ERROR;
+		}
+
 		csw.Status = (stage == MSC_ERROR) ? CSW_FAILED : CSW_PASSED;
 		sendCSW();
 	}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <stats/stats.h>
+#include <disk/disk_access.h>
+
+/* Flash disk write benchmark, see README.rst */
+
+#define SECTOR_SIZE 512
+#define SECTOR_COUNT 512
+/* Sectors written in turn with the data by the interleaved pattern */
+#define TABLE_SECTORS 4
+#define TABLE_START 0
+#define DATA_START 64
+
+static const char *disk_pdrv = CONFIG_DISK_FLASH_VOLUME_NAME;
+
+static u8_t sector_buf[SECTOR_SIZE];
+static u32_t *flash_erase_calls;
+
+static int erase_calls_find(struct stats_hdr *hdr, void *arg,
+			    const char *name, u16_t off)
+{
+	if (!strcmp(name, "flash_erase_calls")) {
+		flash_erase_calls = (u32_t *)((u8_t *)hdr + off);
+		return 1;
+	}
+
+	return 0;
+}
+
+static void fill(u32_t sector)
+{
+	memset(sector_buf, (u8_t)sector, sizeof(sector_buf));
+	memcpy(sector_buf, &sector, sizeof(sector));
+}
+
+static bool check(u32_t sector)
+{
+	u8_t buf[SECTOR_SIZE];
+
+	if (disk_access_read(disk_pdrv, buf, sector, 1)) {
+		return false;
+	}
+
+	fill(sector);
+
+	return !memcmp(buf, sector_buf, sizeof(buf));
+}
+
+static bool run(const char *name, bool interleaved)
+{
+	u32_t erases, cycles, t0, i;
+	bool ok = true;
+
+	erases = *flash_erase_calls;
+	t0 = k_cycle_get_32();
+
+	for (i = 0U; i < SECTOR_COUNT && ok; i++) {
+		fill(DATA_START + i);
+		ok = !disk_access_write(disk_pdrv, sector_buf, DATA_START + i,
+					1);
+
+		if (interleaved && ok) {
+			fill(TABLE_START + i % TABLE_SECTORS);
+			ok = !disk_access_write(disk_pdrv, sector_buf,
+						TABLE_START + i % TABLE_SECTORS,
+						1);
+		}
+	}
+
+	if (ok) {
+		ok = !disk_access_ioctl(disk_pdrv, DISK_IOCTL_CTRL_SYNC, NULL);
+	}
+
+	cycles = k_cycle_get_32() - t0;
+	erases = *flash_erase_calls - erases;
+
+	for (i = 0U; i < SECTOR_COUNT && ok; i++) {
+		ok = check(DATA_START + i);
+	}
+
+	printk("%12s cycles %8u erases %5u %s\n", name,
+	       cycles / SECTOR_COUNT, erases, ok ? "ok" : "MISMATCH");
+
+	return ok;
+}
+
+void main(void)
+{
+	struct stats_hdr *sim_stats = stats_group_find("flash_sim_stats");
+	bool ok;
+
+	if (!sim_stats) {
+		printk("No flash simulator statistics\n");
+		return;
+	}
+
+	stats_walk(sim_stats, erase_calls_find, NULL);
+	if (!flash_erase_calls) {
+		printk("No flash simulator erase count\n");
+		return;
+	}
+
+	if (disk_access_init(disk_pdrv)) {
+		printk("Disk init failed\n");
+		return;
+	}
+
+	printk("disk write, %d cached erase blocks, per sector\n",
+	       CONFIG_DISK_FLASH_CACHE_BLOCKS);
+
+	ok = run("sequential", false);
+	ok = run("interleaved", true) && ok;
+
+	/* The harness waits for "fin", so a failed row fails the test */
+	printk(ok ? "fin\n" : "FAILED\n");
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * @file measure wait queue pend/unpend time against the number of waiters
+ *
+ * This file contains the test that measures the time taken to pend a
+ * thread on a wait queue and to wake the highest priority waiter, as a
+ * function of how many threads are already waiting.  The waiters are
+ * dummy threads with pseudo-random priorities which never run, so only
+ * the wait queue backend (CONFIG_WAITQ_DUMB, CONFIG_WAITQ_SCALABLE or
+ * CONFIG_WAITQ_MULTIQ) is being measured.
+ */
+
+#include <zephyr.h>
+#include <ksched.h>
+#include <wait_q.h>
+
+#include "timestamp.h"
+#include "utils.h"
+
+#define MAX_WAITERS 64
+
+/* the number of pend/unpend cycles per waiter count */
+#define N_TEST_WAITQ 100
+
+static const int waiter_counts[] = { 1, 8, 32, MAX_WAITERS };
+
+static struct k_thread waiters[MAX_WAITERS + 1];
+static _wait_q_t bench_wait_q;
+
+static u32_t seed = 0x2545F491;
+
+static int rand_prio(void)
+{
+	seed = seed * 1664525U + 1013904223U;
+
+	return (seed >> 16) % (K_LOWEST_APPLICATION_THREAD_PRIO + 1);
+}
+
+static void pend_dummy(struct k_thread *thread)
+{
+	thread->base.prio = rand_prio();
+	z_pend_thread(thread, &bench_wait_q, K_FOREVER);
+}
+
+/**
+ *
+ * @brief Measure pend/unpend time for a growing number of waiters
+ *
+ * For each waiter count, pends that many dummy threads, then measures
+ * pending one more and waking the highest priority one, which keeps
+ * the number of waiters constant.
+ *
+ * @return 0 on success
+ */
+int waitq_scaling(void)
+{
+	PRINT_FORMAT(" 7 - Measure average time to pend on and wake up from"
+		     " a wait queue");
+
+	z_waitq_init(&bench_wait_q);
+
+	for (int i = 0; i < ARRAY_SIZE(waiters); i++) {
+		z_init_thread_base(&waiters[i].base, 0, _THREAD_DUMMY, 0);
+	}
+
+	for (int c = 0; c < ARRAY_SIZE(waiter_counts); c++) {
+		int count = waiter_counts[c];
+		struct k_thread *spare = &waiters[count];
+		u32_t pend_time = 0U, unpend_time = 0U;
+		u32_t t;
+
+		for (int i = 0; i < count; i++) {
+			pend_dummy(&waiters[i]);
+		}
+
+		bench_test_start();
+		for (int i = 0; i < N_TEST_WAITQ; i++) {
+			t = TIME_STAMP_DELTA_GET(0);
+			pend_dummy(spare);
+			pend_time += TIME_STAMP_DELTA_GET(t);
+
+			t = TIME_STAMP_DELTA_GET(0);
+			spare = z_unpend_first_thread(&bench_wait_q);
+			unpend_time += TIME_STAMP_DELTA_GET(t);
+		}
+
+		if (bench_test_end() == 0) {
+			PRINT_FORMAT(" %2d waiters: pend %u tcs = %u nsec,"
+				     " unpend %u tcs = %u nsec", count,
+				     pend_time / N_TEST_WAITQ,
+				     SYS_CLOCK_HW_CYCLES_TO_NS_AVG(pend_time,
+								   N_TEST_WAITQ),
+				     unpend_time / N_TEST_WAITQ,
+				     SYS_CLOCK_HW_CYCLES_TO_NS_AVG(unpend_time,
+								   N_TEST_WAITQ));
+		} else {
+			error_count++;
+			PRINT_OVERFLOW_ERROR();
+		}
+
+		while (z_unpend_first_thread(&bench_wait_q) != NULL) {
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <string.h>
+
+/* Memory pool allocator benchmark.  It runs the same pseudo-random
+ * sequence of allocations and frees, with request sizes drawn from a
+ * few realistic distributions, against a k_mem_pool and reports the
+ * cycles spent per operation, the failed allocations and how full the
+ * pool can be filled before the first failure.  Rebuild with
+ * CONFIG_MEM_POOL_BUDDY or CONFIG_MEM_POOL_TLSF to compare allocators.
+ */
+
+#define POOL_MAX_SZ 4096
+#define POOL_N_MAX 4
+#define POOL_SIZE (POOL_MAX_SZ * POOL_N_MAX)
+
+#define N_SLOTS 64
+#define N_OPS 20000
+
+K_MEM_POOL_DEFINE(bench_pool, 16, POOL_MAX_SZ, POOL_N_MAX, 8);
+
+struct dist {
+	const char *name;
+	size_t (*size)(void);
+};
+
+static struct k_mem_block blocks[N_SLOTS];
+static size_t sizes[N_SLOTS];
+static struct k_mem_block fill[POOL_SIZE / 16];
+
+static u32_t seed;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, good enough to pick sizes */
+	seed = seed * 1664525U + 1013904223U;
+	return seed >> 8;
+}
+
+static size_t range(size_t lo, size_t hi)
+{
+	return lo + next_rand() % (hi - lo + 1);
+}
+
+/* Packet headers and control blocks, one in five a full frame */
+static size_t net_size(void)
+{
+	u32_t r = next_rand() % 10;
+
+	if (r < 5) {
+		return range(16, 64);
+	} else if (r < 8) {
+		return range(65, 256);
+	}
+
+	return range(1280, 1518);
+}
+
+/* Short formatted messages, a few long ones */
+static size_t log_size(void)
+{
+	return next_rand() % 10 != 0 ? range(16, 48) : range(100, 256);
+}
+
+static size_t mixed_size(void)
+{
+	return range(1, 1024);
+}
+
+static const struct dist dists[] = {
+	{ "net", net_size },
+	{ "log", log_size },
+	{ "mixed", mixed_size },
+};
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+
+	return t;
+}
+
+static void run(const struct dist *d)
+{
+	u64_t alloc_tot = 0U, free_tot = 0U;
+	u32_t allocs = 0U, frees = 0U, failed = 0U;
+	size_t held = 0U;
+	int n;
+
+	seed = 0x12345678;
+	(void)memset(sizes, 0, sizeof(sizes));
+
+	/* Steady state: each step frees or refills a random slot */
+	for (int i = 0; i < N_OPS; i++) {
+		int slot = next_rand() % N_SLOTS;
+		u32_t t0;
+
+		if (sizes[slot] != 0U) {
+			t0 = stamp();
+			k_mem_pool_free(&blocks[slot]);
+			free_tot += stamp() - t0;
+			frees++;
+			sizes[slot] = 0U;
+			continue;
+		}
+
+		sizes[slot] = d->size();
+		t0 = stamp();
+		if (k_mem_pool_alloc(&bench_pool, &blocks[slot], sizes[slot],
+				     K_NO_WAIT) == 0) {
+			alloc_tot += stamp() - t0;
+			allocs++;
+		} else {
+			failed++;
+			sizes[slot] = 0U;
+		}
+	}
+
+	for (int i = 0; i < N_SLOTS; i++) {
+		if (sizes[i] != 0U) {
+			k_mem_pool_free(&blocks[i]);
+		}
+	}
+
+	/* Utilization: fill an empty pool until the first failure */
+	for (n = 0; n < ARRAY_SIZE(fill); n++) {
+		size_t sz = d->size();
+
+		if (k_mem_pool_alloc(&bench_pool, &fill[n], sz,
+				     K_NO_WAIT) != 0) {
+			break;
+		}
+		held += sz;
+	}
+
+	for (int i = 0; i < n; i++) {
+		k_mem_pool_free(&fill[i]);
+	}
+
+	printk("%-5s alloc %6u free %6u failed %5u fill %3u%%\n", d->name,
+	       allocs ? (u32_t)(alloc_tot / allocs) : 0U,
+	       frees ? (u32_t)(free_tot / frees) : 0U,
+	       failed, (u32_t)(held * 100U / POOL_SIZE));
+}
+
+void main(void)
+{
+	printk("Memory pool allocator: %s\n",
+	       IS_ENABLED(CONFIG_MEM_POOL_TLSF) ? "tlsf" : "buddy");
+
+	for (int i = 0; i < ARRAY_SIZE(dists); i++) {
+		run(&dists[i]);
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <drivers/flash.h>
+#include <storage/flash_map.h>
+#include <stats/stats.h>
+#include <fs/nvs.h>
+
+/* NVS read benchmark. It stores an increasing number of ids and prints
+ * the average cost of reading one of them back, see README.rst.
+ */
+
+#define SECTOR_SIZE 4096
+#define SECTOR_COUNT 16
+
+static const u16_t id_counts[] = { 16, 64, 256, 1024 };
+
+static struct nvs_fs fs;
+static u32_t *flash_read_calls;
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+
+	return t;
+}
+
+static int read_calls_find(struct stats_hdr *hdr, void *arg,
+			   const char *name, u16_t off)
+{
+	if (!strcmp(name, "flash_read_calls")) {
+		flash_read_calls = (u32_t *)((u8_t *)hdr + off);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int setup(void)
+{
+	const struct flash_area *fa;
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	if (rc) {
+		return rc;
+	}
+
+	/* Start over on erased flash */
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	flash_area_close(fa);
+	if (rc) {
+		return rc;
+	}
+
+	fs.offset = DT_FLASH_AREA_STORAGE_OFFSET;
+	fs.sector_size = SECTOR_SIZE;
+	fs.sector_count = SECTOR_COUNT;
+
+	return nvs_init(&fs, DT_FLASH_DEV_NAME);
+}
+
+static bool run(u16_t count)
+{
+	u64_t cycles = 0U;
+	u32_t reads, t0, val;
+	bool ok = true;
+	ssize_t len;
+	u16_t id;
+
+	if (setup()) {
+		printk("%5u ids setup failed\n", count);
+		return false;
+	}
+
+	for (id = 0U; id < count; id++) {
+		val = id;
+		len = nvs_write(&fs, id, &val, sizeof(val));
+		if (len != sizeof(val)) {
+			printk("%5u ids write failed\n", count);
+			return false;
+		}
+	}
+
+	reads = *flash_read_calls;
+
+	for (id = 0U; id < count; id++) {
+		t0 = stamp();
+		len = nvs_read(&fs, id, &val, sizeof(val));
+		cycles += stamp() - t0;
+
+		if (len != sizeof(val) || val != id) {
+			ok = false;
+		}
+	}
+
+	reads = *flash_read_calls - reads;
+
+	printk("%5u ids cycles %8u flash reads %5u %s\n", count,
+	       (u32_t)(cycles / count), reads / count,
+	       ok ? "ok" : "MISMATCH");
+
+	return ok;
+}
+
+void main(void)
+{
+	struct stats_hdr *sim_stats = stats_group_find("flash_sim_stats");
+	bool ok = true;
+
+	if (!sim_stats) {
+		printk("No flash simulator statistics\n");
+		return;
+	}
+
+	stats_walk(sim_stats, read_calls_find, NULL);
+	if (!flash_read_calls) {
+		printk("No flash simulator read count\n");
+		return;
+	}
+
+	printk("nvs_read(), lookup cache %s, per call\n",
+	       IS_ENABLED(CONFIG_NVS_LOOKUP_CACHE) ? "on" : "off");
+
+	for (int i = 0; i < ARRAY_SIZE(id_counts); i++) {
+		if (!run(id_counts[i])) {
+			ok = false;
+		}
+	}
+
+	/* The harness waits for "fin", so a failed row fails the test */
+	printk(ok ? "fin\n" : "FAILED\n");
+}
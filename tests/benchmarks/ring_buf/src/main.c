@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <sys/ring_buffer.h>
+
+/* Ring buffer byte mode benchmark.  It compares put and get with a
+ * lock held on both sides against the lock-free single producer and
+ * multiple producer calls, first per call with no contention and then
+ * as a stream from a producer thread to the main thread.
+ */
+
+#define REC_SIZE 16
+#define N_OPS 10000
+#define STREAM_BYTES (64 * 1024)
+#define STACK_SIZE 1024
+
+enum mode { LOCKED, SPSC, MPSC };
+
+static const char *const names[] = { "locked", "spsc", "mpsc" };
+
+RING_BUF_DECLARE(bench_buf, 256);
+static struct k_spinlock lock;
+
+K_THREAD_STACK_DEFINE(prod_stack, STACK_SIZE);
+static struct k_thread prod_thread;
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+
+	return t;
+}
+
+static u32_t put(enum mode m, const u8_t *data, u32_t size)
+{
+	k_spinlock_key_t key;
+	u32_t n;
+
+	switch (m) {
+	case LOCKED:
+		key = k_spin_lock(&lock);
+		n = ring_buf_put(&bench_buf, data, size);
+		k_spin_unlock(&lock, key);
+		return n;
+	case SPSC:
+		return ring_buf_put(&bench_buf, data, size);
+	default:
+		return ring_buf_mpsc_put(&bench_buf, data, size);
+	}
+}
+
+static u32_t get(enum mode m, u8_t *data, u32_t size)
+{
+	k_spinlock_key_t key;
+	u32_t n;
+
+	if (m != LOCKED) {
+		return ring_buf_get(&bench_buf, data, size);
+	}
+
+	key = k_spin_lock(&lock);
+	n = ring_buf_get(&bench_buf, data, size);
+	k_spin_unlock(&lock, key);
+
+	return n;
+}
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	enum mode m = POINTER_TO_UINT(p1);
+	u8_t rec[REC_SIZE] = { 0 };
+
+	for (u32_t sent = 0U; sent < STREAM_BYTES; ) {
+		if (put(m, rec, sizeof(rec)) == sizeof(rec)) {
+			sent += sizeof(rec);
+		} else {
+			k_yield();
+		}
+	}
+}
+
+static void run(enum mode m)
+{
+	u8_t rec[REC_SIZE] = { 0 };
+	u64_t put_tot = 0U, get_tot = 0U;
+	u32_t t0, received = 0U;
+
+	ring_buf_reset(&bench_buf);
+
+	for (int i = 0; i < N_OPS; i++) {
+		t0 = stamp();
+		put(m, rec, sizeof(rec));
+		put_tot += stamp() - t0;
+
+		t0 = stamp();
+		get(m, rec, sizeof(rec));
+		get_tot += stamp() - t0;
+	}
+
+	t0 = k_cycle_get_32();
+	k_thread_create(&prod_thread, prod_stack, STACK_SIZE, producer,
+			UINT_TO_POINTER(m), NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	while (received < STREAM_BYTES) {
+		u32_t n = get(m, rec, sizeof(rec));
+
+		received += n;
+		if (n == 0U) {
+			k_yield();
+		}
+	}
+	t0 = k_cycle_get_32() - t0;
+	k_thread_abort(&prod_thread);
+
+	printk("%-6s put %5u get %5u stream %6u\n", names[m],
+	       (u32_t)(put_tot / N_OPS), (u32_t)(get_tot / N_OPS),
+	       (u32_t)((u64_t)STREAM_BYTES * 1000U / MAX(t0, 1U)));
+}
+
+void main(void)
+{
+	printk("Ring buffer byte mode, %d CPU(s)\n", CONFIG_MP_NUM_CPUS);
+
+	for (int m = LOCKED; m <= MPSC; m++) {
+		run(m);
+	}
+
+	printk("fin\n");
+}
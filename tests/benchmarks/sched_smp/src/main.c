@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+
+/* SMP scheduler throughput benchmark.  For each number of active
+ * CPUs from 1 to CONFIG_MP_NUM_CPUS, two preemptible threads of equal
+ * priority are pinned to each active CPU and spin calling k_yield(),
+ * so every call is a context switch on that CPU.  The main thread
+ * sleeps for a fixed window and then reports the total number of
+ * yields per second.  With a single global ready queue every switch
+ * contends on the scheduler lock and shared queue, so the interesting
+ * number is how the rate scales with the CPU count, compared between
+ * builds with and without CONFIG_SCHED_PERCPU_RUNQ.
+ */
+
+#define THREADS_PER_CPU 2
+#define N_THREADS (CONFIG_MP_NUM_CPUS * THREADS_PER_CPU)
+#define STACK_SIZE 1024
+#define WINDOW_MS 1000
+#define WORKER_PRIO 4
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, N_THREADS, STACK_SIZE);
+static struct k_thread threads[N_THREADS];
+
+static volatile u32_t counts[N_THREADS];
+static volatile bool stop;
+
+static K_SEM_DEFINE(done_sem, 0, N_THREADS);
+
+static void worker_fn(void *arg1, void *arg2, void *arg3)
+{
+	volatile u32_t *count = arg1;
+
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
+
+	while (!stop) {
+		k_yield();
+		(*count)++;
+	}
+
+	k_sem_give(&done_sem);
+
+	/* Wait here to be aborted, so the thread is off its CPU before
+	 * the next run creates it again.
+	 */
+	k_sleep(K_FOREVER);
+}
+
+static void run(int ncpus)
+{
+	int nthreads = ncpus * THREADS_PER_CPU;
+	u64_t total = 0U;
+	s64_t start, ms;
+
+	stop = false;
+
+	for (int i = 0; i < nthreads; i++) {
+		counts[i] = 0U;
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				worker_fn, (void *)&counts[i], NULL, NULL,
+				WORKER_PRIO, 0, K_FOREVER);
+		k_thread_cpu_mask_clear(&threads[i]);
+		k_thread_cpu_mask_enable(&threads[i], i / THREADS_PER_CPU);
+	}
+
+	start = k_uptime_get();
+	for (int i = 0; i < nthreads; i++) {
+		k_thread_start(&threads[i]);
+	}
+
+	k_sleep(WINDOW_MS);
+	stop = true;
+	ms = k_uptime_get() - start;
+
+	for (int i = 0; i < nthreads; i++) {
+		k_sem_take(&done_sem, K_FOREVER);
+		total += counts[i];
+	}
+
+	for (int i = 0; i < nthreads; i++) {
+		k_thread_abort(&threads[i]);
+	}
+
+	printk("cpus %d switches/s %u\n", ncpus,
+	       (u32_t)(total * MSEC_PER_SEC / ms));
+}
+
+void main(void)
+{
+	printk("Ready queue: %s\n",
+	       IS_ENABLED(CONFIG_SCHED_PERCPU_RUNQ) ? "per-CPU" : "global");
+
+	for (int n = 1; n <= CONFIG_MP_NUM_CPUS; n++) {
+		run(n);
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <timeout_q.h>
+
+/* Timeout queue microbenchmark.  It arms a population of "background"
+ * timeouts at pseudo-random distances far enough in the future that
+ * none of them expires during the run, then measures the cost of
+ * z_add_timeout() and z_abort_timeout() of one more timeout against
+ * that population.  Rebuild with CONFIG_TIMEOUT_DUMB or
+ * CONFIG_TIMEOUT_WHEEL to compare backends.
+ *
+ * Like the scheduler benchmark this involves no timer interrupt on
+ * the measured path and gives stable numbers in qemu with -icount.
+ */
+
+#define MAX_ACTIVE 10000
+#define N_RUNS 200
+
+/* Far enough that nothing fires while measuring */
+#define MIN_TICKS 100000
+#define SPREAD_TICKS 1000000
+
+static const int populations[] = { 10, 100, 1000, 10000 };
+
+static struct _timeout background[MAX_ACTIVE];
+static struct _timeout probe[N_RUNS];
+
+static u32_t seed = 0x12345678;
+
+static u32_t next_rand(void)
+{
+	/* Numerical Recipes LCG, good enough to scatter expiries */
+	seed = seed * 1664525U + 1013904223U;
+	return seed;
+}
+
+static s32_t rand_ticks(void)
+{
+	return MIN_TICKS + (next_rand() >> 8) % SPREAD_TICKS;
+}
+
+static inline u32_t stamp(void)
+{
+	u32_t t;
+
+#ifdef CONFIG_X86
+	__asm__ volatile("rdtsc" : "=a"(t) : : "edx");
+#else
+	t = k_cycle_get_32();
+#endif
+
+	return t;
+}
+
+static void nop_fn(struct _timeout *to)
+{
+	ARG_UNUSED(to);
+}
+
+static void run(int active)
+{
+	u64_t add_tot = 0U, abort_tot = 0U;
+
+	for (int i = 0; i < active; i++) {
+		z_init_timeout(&background[i]);
+		z_add_timeout(&background[i], nop_fn, rand_ticks());
+	}
+
+	for (int i = 0; i < N_RUNS; i++) {
+		z_init_timeout(&probe[i]);
+	}
+
+	for (int i = 0; i < N_RUNS; i++) {
+		s32_t ticks = rand_ticks();
+		u32_t t0 = stamp();
+
+		z_add_timeout(&probe[i], nop_fn, ticks);
+		add_tot += stamp() - t0;
+	}
+
+	for (int i = 0; i < N_RUNS; i++) {
+		u32_t t0 = stamp();
+
+		z_abort_timeout(&probe[i]);
+		abort_tot += stamp() - t0;
+	}
+
+	for (int i = 0; i < active; i++) {
+		z_abort_timeout(&background[i]);
+	}
+
+	printk("active %5d add %6u abort %6u\n", active,
+	       (u32_t)(add_tot / N_RUNS), (u32_t)(abort_tot / N_RUNS));
+}
+
+void main(void)
+{
+	printk("Timeout queue backend: %s\n",
+	       IS_ENABLED(CONFIG_TIMEOUT_WHEEL) ? "wheel" : "dumb");
+
+	for (int i = 0; i < ARRAY_SIZE(populations); i++) {
+		run(populations[i]);
+	}
+
+	printk("fin\n");
+}
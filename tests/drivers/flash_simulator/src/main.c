@@ -260,6 +260,107 @@ static void test_double_write(void)
 	zassert_equal(-EIO, rc, "Unexpected error code (%d)", rc);
 }
 
+#if defined(CONFIG_FLASH_ASYNC)
+static void async_done(struct device *dev, struct flash_op *op)
+{
+	int *calls = op->user_data;
+
+	(*calls)++;
+}
+
+static void async_wait(struct k_poll_signal *signal, int *result)
+{
+	struct k_poll_event evt = K_POLL_EVENT_INITIALIZER(
+		K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, signal);
+	unsigned int signaled;
+	int rc;
+
+	rc = k_poll(&evt, 1, K_SECONDS(1));
+	zassert_equal(0, rc, "operation not completed");
+
+	k_poll_signal_check(signal, &signaled, result);
+	zassert_true(signaled, NULL);
+	k_poll_signal_reset(signal);
+}
+#endif
+
+static void test_async(void)
+{
+#if defined(CONFIG_FLASH_ASYNC)
+	const off_t unit = TEST_SIM_FLASH_END - FLASH_SIMULATOR_ERASE_UNIT;
+	struct flash_op erase_op, write_op, read_op;
+	struct k_poll_signal signal;
+	u32_t data[4] = { 1, 2, 3, 4 };
+	u32_t r_data[4];
+	int calls = 0;
+	int result;
+	int rc;
+
+	/* Do not depend on the state left by the previous tests */
+	rc = flash_write_protection_set(flash_dev, false);
+	zassert_equal(0, rc, NULL);
+
+	k_poll_signal_init(&signal);
+
+	/* Erase and write queued at once are done in order */
+	erase_op = (struct flash_op){
+		.type = FLASH_OP_ERASE,
+		.offset = unit,
+		.len = FLASH_SIMULATOR_ERASE_UNIT,
+		.callback = async_done,
+		.user_data = &calls,
+	};
+	write_op = (struct flash_op){
+		.type = FLASH_OP_WRITE,
+		.offset = unit,
+		.data = data,
+		.len = sizeof(data),
+		.callback = async_done,
+		.signal = &signal,
+		.user_data = &calls,
+	};
+
+	rc = flash_submit(flash_dev, &erase_op);
+	zassert_equal(0, rc, "flash_submit should succeed");
+	rc = flash_submit(flash_dev, &write_op);
+	zassert_equal(0, rc, "flash_submit should succeed");
+
+	async_wait(&signal, &result);
+	zassert_equal(0, result, "write failed (%d)", result);
+	zassert_equal(0, erase_op.result, "erase failed (%d)",
+		      erase_op.result);
+	zassert_equal(2, calls, "callbacks not called");
+
+	read_op = (struct flash_op){
+		.type = FLASH_OP_READ,
+		.offset = unit,
+		.data = r_data,
+		.len = sizeof(r_data),
+		.signal = &signal,
+	};
+
+	rc = flash_submit(flash_dev, &read_op);
+	zassert_equal(0, rc, "flash_submit should succeed");
+
+	async_wait(&signal, &result);
+	zassert_equal(0, result, "read failed (%d)", result);
+	zassert_mem_equal(data, r_data, sizeof(data), "invalid data read");
+
+	/* Errors are reported on completion */
+	rc = flash_submit(flash_dev, &write_op);
+	zassert_equal(0, rc, "flash_submit should succeed");
+
+	async_wait(&signal, &result);
+	zassert_equal(-EIO, result, "Unexpected error code (%d)", result);
+
+	read_op.type = FLASH_OP_ERASE + 1;
+	rc = flash_submit(flash_dev, &read_op);
+	zassert_equal(-EINVAL, rc, "Unexpected error code (%d)", rc);
+#else
+	ztest_test_skip();
+#endif
+}
+
 void test_main(void)
 {
 	ztest_test_suite(flash_sim_api,
@@ -269,7 +370,8 @@ void test_main(void)
 			 ztest_unit_test(test_access),
 			 ztest_unit_test(test_out_of_bounds),
 			 ztest_unit_test(test_align),
-			 ztest_unit_test(test_double_write));
+			 ztest_unit_test(test_double_write),
+			 ztest_unit_test(test_async));
 
 	ztest_run_test_suite(flash_sim_api);
 }
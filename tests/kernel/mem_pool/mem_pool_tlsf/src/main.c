@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+
+#define POOL_SIZE 1024
+#define ODD_SIZE 100
+#define ODD_NUM 8
+#define BLK_ALIGN sizeof(void *)
+
+K_MEM_POOL_DEFINE(tpool, 16, POOL_SIZE, 1, BLK_ALIGN);
+
+/**
+ * @brief Verify odd sized requests are not rounded up to a block size
+ *
+ * @details A buddy pool of 1024 bytes serves 100 byte requests with
+ * 256 byte blocks, so only 4 fit. The TLSF heap only adds a header to
+ * each request, so at least 8 must fit.
+ *
+ * @ingroup kernel_memory_pool_tests
+ */
+void test_tlsf_odd_sizes(void)
+{
+	struct k_mem_block block[ODD_NUM];
+
+	for (int i = 0; i < ODD_NUM; i++) {
+		zassert_equal(k_mem_pool_alloc(&tpool, &block[i], ODD_SIZE,
+					       K_NO_WAIT), 0, NULL);
+		zassert_true((uintptr_t)block[i].data % 8 == 0, NULL);
+		(void)memset(block[i].data, i, ODD_SIZE);
+	}
+
+	for (int i = 0; i < ODD_NUM; i++) {
+		for (int j = 0; j < ODD_SIZE; j++) {
+			zassert_equal(((u8_t *)block[i].data)[j], i, NULL);
+		}
+		k_mem_pool_free(&block[i]);
+	}
+}
+
+/**
+ * @brief Verify freed blocks are merged back together
+ *
+ * @details Allocate small blocks until the pool is exhausted, free
+ * every other one and then the rest, and check that the whole pool
+ * can be allocated again in one block.
+ *
+ * @ingroup kernel_memory_pool_tests
+ */
+void test_tlsf_coalesce(void)
+{
+	struct k_mem_block block[POOL_SIZE / 16], big;
+	int n;
+
+	for (n = 0; n < ARRAY_SIZE(block); n++) {
+		if (k_mem_pool_alloc(&tpool, &block[n], 16, K_NO_WAIT) != 0) {
+			break;
+		}
+	}
+	zassert_true(n > POOL_SIZE / 32, NULL);
+	zassert_equal(k_mem_pool_alloc(&tpool, &big, POOL_SIZE, K_NO_WAIT),
+		      -ENOMEM, NULL);
+
+	for (int i = 0; i < n; i += 2) {
+		k_mem_pool_free(&block[i]);
+	}
+	for (int i = 1; i < n; i += 2) {
+		k_mem_pool_free(&block[i]);
+	}
+
+	zassert_equal(k_mem_pool_alloc(&tpool, &big, POOL_SIZE, K_NO_WAIT),
+		      0, NULL);
+	k_mem_pool_free(&big);
+}
+
+/**
+ * @brief Verify the memory pool statistics
+ *
+ * @details The statistics are compared against the ones at the start
+ * of the test, so it does not depend on what earlier tests left.
+ *
+ * @see k_mem_pool_stats_get()
+ *
+ * @ingroup kernel_memory_pool_tests
+ */
+void test_tlsf_stats(void)
+{
+	struct k_mem_pool_stats before, stats;
+	struct k_mem_block block;
+	size_t max_allocated;
+
+	zassert_equal(k_mem_pool_stats_get(&tpool, &before), 0, NULL);
+	zassert_true(before.largest_free_block >= ODD_SIZE, NULL);
+	zassert_true(before.max_allocated_bytes >= before.allocated_bytes,
+		     NULL);
+
+	zassert_equal(k_mem_pool_alloc(&tpool, &block, ODD_SIZE, K_NO_WAIT),
+		      0, NULL);
+	zassert_equal(k_mem_pool_stats_get(&tpool, &stats), 0, NULL);
+	zassert_true(stats.allocated_bytes - before.allocated_bytes >
+		     ODD_SIZE, NULL);
+	zassert_equal(stats.free_bytes + stats.allocated_bytes,
+		      before.free_bytes + before.allocated_bytes, NULL);
+	zassert_true(stats.largest_free_block <= before.largest_free_block,
+		     NULL);
+	zassert_true(stats.max_allocated_bytes >= stats.allocated_bytes,
+		     NULL);
+	zassert_true(stats.max_allocated_bytes >= before.max_allocated_bytes,
+		     NULL);
+	max_allocated = stats.max_allocated_bytes;
+
+	k_mem_pool_free(&block);
+	zassert_equal(k_mem_pool_stats_get(&tpool, &stats), 0, NULL);
+	zassert_equal(stats.allocated_bytes, before.allocated_bytes, NULL);
+	zassert_equal(stats.free_bytes, before.free_bytes, NULL);
+	zassert_equal(stats.largest_free_block, before.largest_free_block,
+		      NULL);
+	zassert_equal(stats.max_allocated_bytes, max_allocated, NULL);
+}
+
+/**
+ * @brief Verify k_malloc() and k_calloc() on a TLSF heap
+ *
+ * @see k_malloc(), k_calloc(), k_free()
+ *
+ * @ingroup kernel_memory_pool_tests
+ */
+void test_tlsf_k_malloc(void)
+{
+	u8_t *ptr[3];
+
+	ptr[0] = k_malloc(1);
+	ptr[1] = k_malloc(ODD_SIZE);
+	ptr[2] = k_calloc(ODD_SIZE, 3);
+	for (int i = 0; i < ARRAY_SIZE(ptr); i++) {
+		zassert_not_null(ptr[i], NULL);
+	}
+	for (int i = 0; i < ODD_SIZE * 3; i++) {
+		zassert_equal(ptr[2][i], 0, NULL);
+	}
+	for (int i = 0; i < ARRAY_SIZE(ptr); i++) {
+		k_free(ptr[i]);
+	}
+
+	zassert_is_null(k_malloc(CONFIG_HEAP_MEM_POOL_SIZE * 2), NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(mpool_tlsf,
+			 ztest_unit_test(test_tlsf_odd_sizes),
+			 ztest_unit_test(test_tlsf_coalesce),
+			 ztest_unit_test(test_tlsf_stats),
+			 ztest_unit_test(test_tlsf_k_malloc));
+	ztest_run_test_suite(mpool_tlsf);
+}
@@ -222,3 +222,43 @@ void test_mslab_used_get(void)
 	tmslab_used_get(&mslab);
 	tmslab_used_get(&kmslab);
 }
+
+/**
+ * @brief Verify the per-CPU magazine statistics of a memory slab
+ *
+ * @details Allocate a block from a freshly initialized slab, which
+ * misses the empty magazine and refills it, then free the block and
+ * allocate it again, which are both served by the magazine. Check the
+ * hit and miss counters and that cached blocks are reported as free.
+ *
+ * @ingroup kernel_memory_slab_tests
+ */
+void test_mslab_magazine_stats(void)
+{
+	struct k_mem_slab_magazine_stats stats;
+	void *block;
+
+	if (!IS_ENABLED(CONFIG_MEM_SLAB_MAGAZINE)) {
+		zassert_equal(k_mem_slab_magazine_stats_get(&mslab, &stats),
+			      -ENOTSUP, NULL);
+		return;
+	}
+
+	k_mem_slab_init(&mslab, tslab, BLK_SIZE, BLK_NUM);
+
+	zassert_equal(k_mem_slab_alloc(&mslab, &block, K_NO_WAIT), 0, NULL);
+	zassert_equal(k_mem_slab_num_used_get(&mslab), 1, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab), BLK_NUM - 1, NULL);
+	k_mem_slab_free(&mslab, &block);
+	zassert_equal(k_mem_slab_alloc(&mslab, &block, K_NO_WAIT), 0, NULL);
+	k_mem_slab_free(&mslab, &block);
+
+	zassert_equal(k_mem_slab_num_used_get(&mslab), 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab), BLK_NUM, NULL);
+
+	zassert_equal(k_mem_slab_magazine_stats_get(&mslab, &stats), 0, NULL);
+	zassert_equal(stats.alloc_hits, 1, NULL);
+	zassert_equal(stats.alloc_misses, 1, NULL);
+	zassert_equal(stats.free_hits, 2, NULL);
+	zassert_equal(stats.free_misses, 0, NULL);
+}
@@ -21,6 +21,10 @@ extern void test_msgq_purge_when_put(void);
 extern void test_msgq_attrs_get(void);
 extern void test_msgq_alloc(void);
 extern void test_msgq_pend_thread(void);
+extern void test_msgq_batch(void);
+extern void test_msgq_batch_pend_thread(void);
+extern void test_msgq_claim(void);
+extern void test_msgq_claim_pend_thread(void);
 #ifdef CONFIG_USERSPACE
 extern void test_msgq_user_thread(void);
 extern void test_msgq_user_thread_overflow(void);
@@ -79,6 +83,10 @@ void test_main(void)
 			 ztest_1cpu_unit_test(test_msgq_purge_when_put),
 			 ztest_user_unit_test(test_msgq_user_purge_when_put),
 			 ztest_1cpu_unit_test(test_msgq_pend_thread),
+			 ztest_unit_test(test_msgq_batch),
+			 ztest_1cpu_unit_test(test_msgq_batch_pend_thread),
+			 ztest_unit_test(test_msgq_claim),
+			 ztest_1cpu_unit_test(test_msgq_claim_pend_thread),
 			 ztest_unit_test(test_msgq_alloc));
 	ztest_run_test_suite(msgq_api);
 }
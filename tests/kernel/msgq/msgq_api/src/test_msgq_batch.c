@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_msgq.h"
+
+#define BATCH_LEN 4
+
+K_THREAD_STACK_EXTERN(tstack);
+extern struct k_thread tdata;
+static struct k_msgq bmsgq;
+static char __aligned(4) bbuffer[MSG_SIZE * BATCH_LEN];
+static u32_t bdata[] = { 1, 2, 3, 4, 5, 6 };
+
+static void get_entry(void *p1, void *p2, void *p3)
+{
+	u32_t rx_data;
+
+	zassert_equal(k_msgq_get(&bmsgq, &rx_data, K_FOREVER), 0, NULL);
+	zassert_equal(rx_data, bdata[0], NULL);
+}
+
+/**
+ * @addtogroup kernel_message_queue_tests
+ * @{
+ */
+
+/**
+ * @brief Test batched put and get of messages
+ *
+ * @details Put more messages than fit and check only the free entries
+ * are filled, then get them back in FIFO order across the end of the
+ * ring buffer.
+ *
+ * @see k_msgq_put_batch(), k_msgq_get_batch()
+ */
+void test_msgq_batch(void)
+{
+	u32_t rx_data[ARRAY_SIZE(bdata)];
+
+	k_msgq_init(&bmsgq, bbuffer, MSG_SIZE, BATCH_LEN);
+
+	/**TESTPOINT: put only as many messages as there is room for*/
+	zassert_equal(k_msgq_put_batch(&bmsgq, bdata, ARRAY_SIZE(bdata)),
+		      BATCH_LEN, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), BATCH_LEN, NULL);
+
+	zassert_equal(k_msgq_get_batch(&bmsgq, rx_data, 3), 3, NULL);
+	for (int i = 0; i < 3; i++) {
+		zassert_equal(rx_data[i], bdata[i], NULL);
+	}
+
+	/**TESTPOINT: wrap around the end of the ring buffer*/
+	zassert_equal(k_msgq_put_batch(&bmsgq, &bdata[4], 2), 2, NULL);
+	zassert_equal(k_msgq_get_batch(&bmsgq, rx_data, ARRAY_SIZE(rx_data)),
+		      3, NULL);
+	for (int i = 0; i < 3; i++) {
+		zassert_equal(rx_data[i], bdata[i + 3], NULL);
+	}
+
+	zassert_equal(k_msgq_get_batch(&bmsgq, rx_data, 1), 0, NULL);
+}
+
+/**
+ * @brief Test batched put hands a message to a waiting receiver
+ *
+ * @see k_msgq_put_batch()
+ */
+void test_msgq_batch_pend_thread(void)
+{
+	u32_t rx_data;
+
+	k_msgq_init(&bmsgq, bbuffer, MSG_SIZE, BATCH_LEN);
+
+	k_thread_create(&tdata, tstack, STACK_SIZE, get_entry, NULL, NULL,
+			NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_sleep(TIMEOUT >> 1);
+
+	/**TESTPOINT: first message goes to the receiver, the rest queue*/
+	zassert_equal(k_msgq_put_batch(&bmsgq, bdata, 2), 2, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 1, NULL);
+	zassert_equal(k_msgq_get(&bmsgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, bdata[1], NULL);
+
+	k_thread_abort(&tdata);
+}
+
+/**
+ * @brief Test zero-copy put and get of messages
+ *
+ * @see k_msgq_put_claim(), k_msgq_put_commit(), k_msgq_get_claim(),
+ * k_msgq_get_commit()
+ */
+void test_msgq_claim(void)
+{
+	u32_t *slot, *slot2;
+
+	k_msgq_init(&bmsgq, bbuffer, MSG_SIZE, BATCH_LEN);
+
+	/**TESTPOINT: build a message in place*/
+	zassert_equal(k_msgq_put_claim(&bmsgq, (void **)&slot, K_NO_WAIT), 0,
+		      NULL);
+	*slot = MSG0;
+	zassert_equal(k_msgq_put_claim(&bmsgq, (void **)&slot2, K_NO_WAIT),
+		      -ENOMSG, NULL);
+	zassert_equal(k_msgq_put(&bmsgq, &bdata[0], K_NO_WAIT), -ENOMSG,
+		      NULL);
+	zassert_equal(k_msgq_put_batch(&bmsgq, bdata, 1), 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 0, NULL);
+	zassert_equal(k_msgq_put_commit(&bmsgq), 0, NULL);
+	zassert_equal(k_msgq_put_commit(&bmsgq), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 1, NULL);
+
+	/**TESTPOINT: read the message in place*/
+	zassert_equal(k_msgq_get_claim(&bmsgq, (void **)&slot2, K_NO_WAIT), 0,
+		      NULL);
+	zassert_equal(slot2, slot, NULL);
+	zassert_equal(*slot2, MSG0, NULL);
+	zassert_equal(k_msgq_get_batch(&bmsgq, bdata, 1), 0, NULL);
+	zassert_equal(k_msgq_get(&bmsgq, &bdata[0], TIMEOUT), -EAGAIN, NULL);
+	zassert_equal(k_msgq_get_commit(&bmsgq), 0, NULL);
+	zassert_equal(k_msgq_get_commit(&bmsgq), -EINVAL, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 0, NULL);
+
+	zassert_equal(k_msgq_get_claim(&bmsgq, (void **)&slot2, K_NO_WAIT),
+		      -ENOMSG, NULL);
+	zassert_equal(k_msgq_get_claim(&bmsgq, (void **)&slot2, TIMEOUT),
+		      -EAGAIN, NULL);
+}
+
+static void claim_entry(void *p1, void *p2, void *p3)
+{
+	u32_t *slot;
+
+	zassert_equal(k_msgq_put_claim(&bmsgq, (void **)&slot, K_NO_WAIT), 0,
+		      NULL);
+	*slot = MSG0;
+	k_sleep(TIMEOUT);
+	zassert_equal(k_msgq_put_commit(&bmsgq), 0, NULL);
+}
+
+/**
+ * @brief Test a send waits for an outstanding claim to be committed
+ *
+ * @see k_msgq_put_claim(), k_msgq_put()
+ */
+void test_msgq_claim_pend_thread(void)
+{
+	u32_t rx_data;
+
+	k_msgq_init(&bmsgq, bbuffer, MSG_SIZE, BATCH_LEN);
+
+	k_thread_create(&tdata, tstack, STACK_SIZE, claim_entry, NULL, NULL,
+			NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	k_sleep(TIMEOUT >> 1);
+
+	/**TESTPOINT: the send is done once the claim is committed*/
+	zassert_equal(k_msgq_put(&bmsgq, &bdata[0], K_FOREVER), 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 2, NULL);
+
+	zassert_equal(k_msgq_get(&bmsgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, MSG0, NULL);
+	zassert_equal(k_msgq_get(&bmsgq, &rx_data, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx_data, bdata[0], NULL);
+
+	k_thread_abort(&tdata);
+}
+
+/**
+ * @}
+ */
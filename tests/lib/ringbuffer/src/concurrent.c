@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <sys/ring_buffer.h>
+
+/* Concurrent access without locking: byte pattern streamed from one
+ * writer thread to the test thread, and records written by several
+ * threads and a timer ISR through ring_buf_mpsc_put().  On SMP targets
+ * the writers run on other CPUs than the reader.
+ */
+
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define N_WRITERS 3
+#define SPSC_BYTES 20000
+#define MPSC_RECORDS 2000
+#define ISR_RECORDS 100
+#define DEADLINE_MS 30000
+
+static K_THREAD_STACK_ARRAY_DEFINE(wstack, N_WRITERS, STACK_SIZE);
+static struct k_thread wthread[N_WRITERS];
+
+static u8_t cbuf_mem[157];
+static struct ring_buf cbuf;
+
+struct rec {
+	u16_t id;
+	u16_t check;
+	u32_t seq;
+};
+
+static u16_t rec_check(u16_t id, u32_t seq)
+{
+	return (u16_t)(id * 31U + seq * 7U);
+}
+
+static void spsc_writer(void *p1, void *p2, void *p3)
+{
+	u8_t chunk[11];
+	u8_t next = 0U;
+	u32_t sent = 0U;
+
+	while (sent < SPSC_BYTES) {
+		u32_t len = 1U + sent % sizeof(chunk), n;
+
+		for (int i = 0; i < len; i++) {
+			chunk[i] = next + i;
+		}
+
+		n = ring_buf_put(&cbuf, chunk, len);
+		next += n;
+		sent += n;
+		if (n == 0U) {
+			k_yield();
+		}
+	}
+}
+
+static void mpsc_writer(void *p1, void *p2, void *p3)
+{
+	u16_t id = POINTER_TO_UINT(p1);
+
+	for (u32_t seq = 0U; seq < MPSC_RECORDS; ) {
+		struct rec r = { id, rec_check(id, seq), seq };
+
+		if (ring_buf_mpsc_put(&cbuf, (u8_t *)&r, sizeof(r)) != 0U) {
+			seq++;
+		} else {
+			k_yield();
+		}
+	}
+}
+
+static u32_t isr_seq;
+
+static void isr_writer(struct k_timer *timer)
+{
+	struct rec r = { N_WRITERS, rec_check(N_WRITERS, isr_seq), isr_seq };
+
+	if (isr_seq < ISR_RECORDS &&
+	    ring_buf_mpsc_put(&cbuf, (u8_t *)&r, sizeof(r)) != 0U) {
+		isr_seq++;
+	}
+}
+
+K_TIMER_DEFINE(isr_timer, isr_writer, NULL);
+
+/**
+ * @brief Stream bytes from one writer thread to one reader
+ *
+ * @details The writer and the reader use the byte access calls
+ * concurrently with no lock, and the reader checks that every byte
+ * arrives once and in order.
+ */
+void test_ringbuffer_spsc_concurrent(void)
+{
+	u8_t chunk[13];
+	u8_t expect = 0U;
+	u32_t received = 0U;
+	s64_t start = k_uptime_get();
+
+	ring_buf_init(&cbuf, sizeof(cbuf_mem), cbuf_mem);
+
+	k_thread_create(&wthread[0], wstack[0], STACK_SIZE, spsc_writer,
+			NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	while (received < SPSC_BYTES) {
+		u32_t n = ring_buf_get(&cbuf, chunk, sizeof(chunk));
+
+		for (int i = 0; i < n; i++) {
+			zassert_equal(chunk[i], expect, "byte %u", received + i);
+			expect++;
+		}
+		received += n;
+		if (n == 0U) {
+			zassert_true(k_uptime_get() - start < DEADLINE_MS, NULL);
+			k_yield();
+		}
+	}
+
+	k_thread_abort(&wthread[0]);
+}
+
+/**
+ * @brief Write records from several threads and an ISR to one reader
+ *
+ * @details Each writer tags its records with its id and a sequence
+ * number. The reader checks every record is intact and that the
+ * records of each writer arrive once and in order.
+ */
+void test_ringbuffer_mpsc_concurrent(void)
+{
+	u32_t next[N_WRITERS + 1] = { 0 };
+	u32_t total = 0U;
+	s64_t start = k_uptime_get();
+	u8_t raw[sizeof(struct rec)];
+	u32_t have = 0U;
+
+	ring_buf_init(&cbuf, sizeof(cbuf_mem), cbuf_mem);
+	isr_seq = 0U;
+
+	for (int i = 0; i < N_WRITERS; i++) {
+		k_thread_create(&wthread[i], wstack[i], STACK_SIZE,
+				mpsc_writer, UINT_TO_POINTER(i), NULL, NULL,
+				k_thread_priority_get(k_current_get()), 0,
+				K_NO_WAIT);
+	}
+	k_timer_start(&isr_timer, K_MSEC(1), K_MSEC(1));
+
+	while (total < N_WRITERS * MPSC_RECORDS + ISR_RECORDS) {
+		u32_t n = ring_buf_get(&cbuf, &raw[have], sizeof(raw) - have);
+		struct rec r;
+
+		have += n;
+		if (have < sizeof(raw)) {
+			zassert_true(k_uptime_get() - start < DEADLINE_MS, NULL);
+			k_yield();
+			continue;
+		}
+
+		(void)memcpy(&r, raw, sizeof(r));
+		have = 0U;
+
+		zassert_true(r.id <= N_WRITERS, "bad id %u", r.id);
+		zassert_equal(r.seq, next[r.id], "writer %u", r.id);
+		zassert_equal(r.check, rec_check(r.id, r.seq), NULL);
+		next[r.id]++;
+		total++;
+	}
+
+	k_timer_stop(&isr_timer);
+	for (int i = 0; i < N_WRITERS; i++) {
+		k_thread_abort(&wthread[i]);
+	}
+
+	zassert_true(ring_buf_is_empty(&cbuf), NULL);
+}
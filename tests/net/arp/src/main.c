@@ -43,6 +43,13 @@ static struct net_pkt *pending_pkt;
 static struct net_eth_addr hwaddr = { { 0x42, 0x11, 0x69, 0xde, 0xfa, 0xec } };
 
 static int send_status = -EINVAL;
+static int sent_ip_count;
+
+/* ARP requests sent by the stack, and the last one of them */
+static bool probe_test;
+static int sent_req_count;
+static struct net_eth_addr sent_req_dst;
+static struct net_arp_hdr sent_req;
 
 struct net_arp_context {
 	u8_t mac_addr[sizeof(struct net_eth_addr)];
@@ -123,6 +130,12 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 				return send_status;
 			}
 
+		} else if (ntohs(arp_hdr->opcode) == NET_ARP_REQUEST &&
+			   probe_test) {
+			memcpy(&sent_req_dst, &hdr->dst,
+			       sizeof(struct net_eth_addr));
+			memcpy(&sent_req, arp_hdr, sizeof(struct net_arp_hdr));
+			sent_req_count++;
 		} else if (ntohs(arp_hdr->opcode) == NET_ARP_REQUEST) {
 			if (memcmp(&hdr->src, &hwaddr,
 				   sizeof(struct net_eth_addr))) {
@@ -143,6 +156,10 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 		}
 	}
 
+	if (ntohs(hdr->type) == NET_ETH_PTYPE_IP) {
+		sent_ip_count++;
+	}
+
 	send_status = 0;
 
 	return 0;
@@ -633,9 +650,241 @@ void test_arp(void)
 	}
 }
 
+static struct net_pkt *prepare_ipv4_pkt(struct net_if *iface,
+					struct in_addr *src,
+					struct in_addr *dst)
+{
+	struct net_ipv4_hdr *ipv4;
+	struct net_pkt *pkt;
+	int len = strlen(app_data);
+
+	pkt = net_pkt_alloc_with_buffer(iface, 0, AF_INET, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem");
+
+	ipv4 = (struct net_ipv4_hdr *)net_buf_add(pkt->buffer,
+						  sizeof(struct net_ipv4_hdr));
+	net_ipaddr_copy(&ipv4->src, src);
+	net_ipaddr_copy(&ipv4->dst, dst);
+
+	memcpy(net_buf_add(pkt->buffer, len), app_data, len);
+
+	return pkt;
+}
+
+void test_arp_pending_queue(void)
+{
+	struct in_addr dst = { { { 192, 168, 0, 3 } } };
+	struct in_addr src = { { { 192, 168, 0, 1 } } };
+	struct net_pkt *pkts[CONFIG_NET_ARP_PENDING_COUNT];
+	struct net_eth_hdr *eth_hdr = NULL;
+	struct net_pkt *pkt, *pkt2;
+	struct net_arp_hdr *arp_hdr;
+	struct net_if *iface;
+	int i;
+
+	iface = net_if_get_default();
+
+	/* All the packets sent before the reply must be kept */
+	for (i = 0; i < CONFIG_NET_ARP_PENDING_COUNT; i++) {
+		pkts[i] = prepare_ipv4_pkt(iface, &src, &dst);
+
+		pkt2 = net_arp_prepare(pkts[i], &dst, NULL);
+		zassert_not_null(pkt2, "ARP request %d not created", i);
+		zassert_not_equal((void *)pkt2, (void *)pkts[i],
+				  "Packet %d sent before ARP reply", i);
+
+		net_pkt_unref(pkt2);
+
+		zassert_equal(atomic_get(&pkts[i]->atomic_ref), 2,
+			      "ARP cache should own packet %d", i);
+
+		/* Like the Ethernet L2 does when it gets the request */
+		net_pkt_unref(pkts[i]);
+	}
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem reply");
+
+	arp_hdr = NET_ARP_HDR(pkt);
+	net_buf_add(pkt->buffer, sizeof(struct net_arp_hdr));
+
+	net_ipaddr_copy(&arp_hdr->dst_ipaddr, &dst);
+	net_ipaddr_copy(&arp_hdr->src_ipaddr, &src);
+
+	pkt2 = prepare_arp_reply(iface, pkt, &hwaddr, &eth_hdr);
+	zassert_not_null(pkt2, "ARP reply generation failed.");
+
+	sent_ip_count = 0;
+
+	zassert_equal(net_arp_input(pkt2, eth_hdr), NET_OK,
+		      "ARP reply not handled");
+
+	/* Let the TX thread send the released packets */
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(sent_ip_count, CONFIG_NET_ARP_PENDING_COUNT,
+		      "Pending packets were not sent");
+
+	net_pkt_unref(pkt);
+
+	/* The address is now known, so nothing is queued */
+	pkt = prepare_ipv4_pkt(iface, &src, &dst);
+
+	pkt2 = net_arp_prepare(pkt, &dst, NULL);
+	zassert_equal((void *)pkt2, (void *)pkt, "Entry not found");
+	zassert_true(!memcmp(net_pkt_lladdr_dst(pkt)->addr, &hwaddr,
+			     sizeof(struct net_eth_addr)),
+		     "Invalid ll address");
+
+	net_pkt_unref(pkt);
+}
+
+struct arp_state_query {
+	struct in_addr *addr;
+	int state;
+};
+
+static void arp_state_cb(struct arp_entry *entry, void *user_data)
+{
+	struct arp_state_query *query = user_data;
+
+	if (net_ipv4_addr_cmp(&entry->ip, query->addr)) {
+		query->state = entry->state;
+	}
+}
+
+/* State of a resolved entry, -1 if there is none */
+static int arp_entry_state(struct in_addr *addr)
+{
+	struct arp_state_query query = { .addr = addr, .state = -1 };
+
+	net_arp_foreach(arp_state_cb, &query);
+
+	return query.state;
+}
+
+void test_arp_stale_probe(void)
+{
+	struct in_addr dst = { { { 192, 168, 0, 3 } } };
+	struct in_addr src = { { { 192, 168, 0, 1 } } };
+	struct net_pkt *pkt, *pkt2;
+	struct net_if *iface;
+
+	iface = net_if_get_default();
+
+	/* Resolved by test_arp_pending_queue */
+	zassert_equal(arp_entry_state(&dst), ARP_STATE_REACHABLE,
+		      "Entry not reachable");
+
+	k_sleep(K_SECONDS(CONFIG_NET_ARP_REACHABLE_TIME) + K_MSEC(100));
+
+	probe_test = true;
+	sent_req_count = 0;
+
+	/* The stale address is still used, while the peer is asked
+	 * directly whether it is valid.
+	 */
+	pkt = prepare_ipv4_pkt(iface, &src, &dst);
+
+	pkt2 = net_arp_prepare(pkt, &dst, NULL);
+	zassert_equal((void *)pkt2, (void *)pkt, "Stale entry not used");
+	zassert_true(!memcmp(net_pkt_lladdr_dst(pkt)->addr, &hwaddr,
+			     sizeof(struct net_eth_addr)),
+		     "Invalid ll address");
+
+	net_pkt_unref(pkt);
+
+	zassert_equal(arp_entry_state(&dst), ARP_STATE_PROBE,
+		      "Entry not probed");
+
+	/* Let the TX thread send the probe */
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(sent_req_count, 1, "Probe not sent");
+	zassert_true(!memcmp(&sent_req_dst, &hwaddr,
+			     sizeof(struct net_eth_addr)),
+		     "Probe not sent to the known address");
+	zassert_true(!memcmp(&sent_req.dst_hwaddr, &hwaddr,
+			     sizeof(struct net_eth_addr)),
+		     "Invalid probe target hwaddr");
+	zassert_true(net_ipv4_addr_cmp(&sent_req.dst_ipaddr, &dst),
+		     "Invalid probe target address");
+	zassert_true(net_ipv4_addr_cmp(&sent_req.src_ipaddr, &src),
+		     "Invalid probe source address");
+
+	/* Only one probe is sent */
+	pkt = prepare_ipv4_pkt(iface, &src, &dst);
+
+	pkt2 = net_arp_prepare(pkt, &dst, NULL);
+	zassert_equal((void *)pkt2, (void *)pkt, "Probed entry not used");
+
+	net_pkt_unref(pkt);
+
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(sent_req_count, 1, "Probe sent again");
+
+	probe_test = false;
+}
+
+void test_arp_probe_timeout(void)
+{
+	struct in_addr dst = { { { 192, 168, 0, 3 } } };
+	struct in_addr src = { { { 192, 168, 0, 1 } } };
+	struct net_pkt *pkt, *pkt2;
+	struct net_arp_hdr *arp_hdr;
+	struct net_if *iface;
+
+	iface = net_if_get_default();
+
+	/* Probed by test_arp_stale_probe, and never answered */
+	zassert_equal(arp_entry_state(&dst), ARP_STATE_PROBE,
+		      "Entry not probed");
+
+	k_sleep(K_SECONDS(2) + K_MSEC(100));
+
+	/* The address has to be resolved again with a broadcast request */
+	pkt = prepare_ipv4_pkt(iface, &src, &dst);
+
+	pkt2 = net_arp_prepare(pkt, &dst, NULL);
+	zassert_not_null(pkt2, "ARP request not created");
+	zassert_not_equal((void *)pkt2, (void *)pkt,
+			  "Unanswered probe entry still used");
+
+	arp_hdr = NET_ARP_HDR(pkt2);
+
+	zassert_equal(arp_hdr->opcode, htons(NET_ARP_REQUEST),
+		      "Not an ARP request");
+	zassert_true(net_eth_is_addr_unspecified(&arp_hdr->dst_hwaddr),
+		     "Request to a stale address");
+	zassert_true(!memcmp(net_pkt_lladdr_dst(pkt2)->addr,
+			     net_eth_broadcast_addr(),
+			     sizeof(struct net_eth_addr)),
+		     "Request not broadcast");
+
+	net_pkt_unref(pkt2);
+
+	/* The entry is incomplete again, holding the packet */
+	zassert_equal(arp_entry_state(&dst), -1, "Entry still resolved");
+	zassert_equal(atomic_get(&pkt->atomic_ref), 2,
+		      "ARP cache should own the packet");
+
+	net_arp_clear_cache(iface);
+
+	zassert_equal(atomic_get(&pkt->atomic_ref), 1,
+		      "ARP cache should no longer own the packet");
+
+	net_pkt_unref(pkt);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_arp_fn,
-		ztest_unit_test(test_arp));
+		ztest_unit_test(test_arp),
+		ztest_unit_test(test_arp_pending_queue),
+		ztest_unit_test(test_arp_stale_probe),
+		ztest_unit_test(test_arp_probe_timeout));
 	ztest_run_test_suite(test_arp_fn);
 }
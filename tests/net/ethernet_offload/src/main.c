@@ -0,0 +1,421 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define NET_LOG_LEVEL CONFIG_NET_L2_ETHERNET_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, NET_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <random/rand32.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_l2.h>
+
+#include "ipv4.h"
+#include "tcp_internal.h"
+#include "connection.h"
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+#define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
+#else
+#define DBG(fmt, ...)
+#endif
+
+#define PORT 4242
+
+/* Amount of TCP payload in the large test packet */
+#define PAYLOAD_LEN 4000
+
+#define WAIT_TIME K_SECONDS(1)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static u8_t peer_mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0xff };
+
+struct eth_context {
+	struct net_if *iface;
+	u8_t mac_addr[6];
+};
+
+static struct eth_context eth_context_gso;
+static struct eth_context eth_context_tso;
+
+static K_SEM_DEFINE(wait_data, 0, UINT_MAX);
+
+static bool test_started;
+
+/* Transmit side bookkeeping */
+static int segments;
+static size_t sent_len;
+static bool segments_ok;
+
+/* Receive side bookkeeping */
+static int received_pkts;
+static size_t received_len;
+static bool pattern_ok;
+
+static inline u8_t pattern(size_t off)
+{
+	/* Prime period, so that misplaced data is detected */
+	return off % 251;
+}
+
+static void eth_iface_init(struct net_if *iface)
+{
+	struct device *dev = net_if_get_device(iface);
+	struct eth_context *context = dev->driver_data;
+
+	context->iface = iface;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr),
+			     NET_LINK_ETHERNET);
+
+	ethernet_init(iface);
+}
+
+/* Pass a sent segment back to the stack as if the peer had sent it. Like
+ * a real driver, the frame is received into freshly allocated buffers.
+ */
+static int loop_back(struct eth_context *context, struct net_pkt *pkt)
+{
+	size_t len = net_pkt_get_len(pkt);
+	struct net_eth_hdr *eth;
+	struct net_ipv4_hdr *ip;
+	struct net_pkt *rx;
+	struct in_addr addr;
+
+	rx = net_pkt_rx_alloc_with_buffer(context->iface, len, AF_UNSPEC, 0,
+					  K_NO_WAIT);
+	if (!rx) {
+		return -ENOMEM;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_copy(rx, pkt, len)) {
+		net_pkt_unref(rx);
+		return -ENOBUFS;
+	}
+
+	eth = (struct net_eth_hdr *)rx->frags->data;
+	memcpy(eth->dst.addr, context->mac_addr, sizeof(eth->dst.addr));
+	memcpy(eth->src.addr, peer_mac, sizeof(eth->src.addr));
+
+	/* Neither checksum changes when the addresses are swapped, and both
+	 * ports are the same.
+	 */
+	ip = (struct net_ipv4_hdr *)(rx->frags->data + sizeof(*eth));
+	net_ipaddr_copy(&addr, &ip->src);
+	net_ipaddr_copy(&ip->src, &ip->dst);
+	net_ipaddr_copy(&ip->dst, &addr);
+
+	if (net_recv_data(context->iface, rx) < 0) {
+		net_pkt_unref(rx);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int eth_tx_gso(struct device *dev, struct net_pkt *pkt)
+{
+	struct eth_context *context = dev->driver_data;
+	struct net_ipv4_hdr *ip;
+	struct net_tcp_hdr *tcp;
+	size_t len;
+
+	if (!test_started) {
+		return 0;
+	}
+
+	/* The Ethernet header is in a fragment of its own */
+	ip = (struct net_ipv4_hdr *)pkt->frags->frags->data;
+	tcp = (struct net_tcp_hdr *)((u8_t *)ip + NET_IPV4H_LEN);
+	len = ntohs(ip->len) - NET_IPV4TCPH_LEN;
+
+	DBG("Segment of %zu bytes, seq %u\n", len, sys_get_be32(tcp->seq));
+
+	if (ntohs(ip->len) > net_if_get_mtu(context->iface) ||
+	    sys_get_be32(tcp->seq) != sent_len) {
+		segments_ok = false;
+	}
+
+	sent_len += len;
+	segments++;
+
+	/* Only the last segment carries PSH */
+	if (!!(tcp->flags & NET_TCP_PSH) != (sent_len == PAYLOAD_LEN)) {
+		segments_ok = false;
+	}
+
+	return loop_back(context, pkt);
+}
+
+static int eth_tx_tso(struct device *dev, struct net_pkt *pkt)
+{
+	if (!test_started) {
+		return 0;
+	}
+
+	/* The hardware would do the segmentation */
+	segments++;
+	sent_len = net_pkt_get_len(pkt) - sizeof(struct net_eth_hdr) -
+		NET_IPV4TCPH_LEN;
+
+	k_sem_give(&wait_data);
+
+	return 0;
+}
+
+static enum ethernet_hw_caps eth_caps_gso(struct device *dev)
+{
+	return 0;
+}
+
+static enum ethernet_hw_caps eth_caps_tso(struct device *dev)
+{
+	return ETHERNET_HW_TSO;
+}
+
+static struct ethernet_api api_funcs_gso = {
+	.iface_api.init = eth_iface_init,
+
+	.get_capabilities = eth_caps_gso,
+	.send = eth_tx_gso,
+};
+
+static struct ethernet_api api_funcs_tso = {
+	.iface_api.init = eth_iface_init,
+
+	.get_capabilities = eth_caps_tso,
+	.send = eth_tx_tso,
+};
+
+static void generate_mac(u8_t *mac_addr)
+{
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	mac_addr[0] = 0x00;
+	mac_addr[1] = 0x00;
+	mac_addr[2] = 0x5E;
+	mac_addr[3] = 0x00;
+	mac_addr[4] = 0x53;
+	mac_addr[5] = sys_rand32_get();
+}
+
+static int eth_init(struct device *dev)
+{
+	struct eth_context *context = dev->driver_data;
+
+	generate_mac(context->mac_addr);
+
+	return 0;
+}
+
+ETH_NET_DEVICE_INIT(eth_gso_test, "eth_gso_test",
+		    eth_init, &eth_context_gso,
+		    NULL, CONFIG_ETH_INIT_PRIORITY,
+		    &api_funcs_gso, NET_ETH_MTU);
+
+ETH_NET_DEVICE_INIT(eth_tso_test, "eth_tso_test",
+		    eth_init, &eth_context_tso,
+		    NULL, CONFIG_ETH_INIT_PRIORITY,
+		    &api_funcs_tso, NET_ETH_MTU);
+
+static enum net_verdict tcp_received(struct net_conn *conn,
+				     struct net_pkt *pkt,
+				     union net_ip_header *ip_hdr,
+				     union net_proto_header *proto_hdr,
+				     void *user_data)
+{
+	u8_t buf[64];
+	size_t len, i;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, NET_IPV4TCPH_LEN)) {
+		return NET_DROP;
+	}
+
+	while ((len = MIN(net_pkt_remaining_data(pkt), sizeof(buf)))) {
+		if (net_pkt_read(pkt, buf, len)) {
+			return NET_DROP;
+		}
+
+		for (i = 0; i < len; i++) {
+			if (buf[i] != pattern(received_len + i)) {
+				pattern_ok = false;
+			}
+		}
+
+		received_len += len;
+	}
+
+	received_pkts++;
+
+	net_pkt_unref(pkt);
+
+	if (received_len >= PAYLOAD_LEN) {
+		k_sem_give(&wait_data);
+	}
+
+	return NET_OK;
+}
+
+static void test_init(void)
+{
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	zassert_not_null(eth_context_gso.iface, "No GSO interface");
+	zassert_not_null(eth_context_tso.iface, "No TSO interface");
+
+	ifaddr = net_if_ipv4_addr_add(eth_context_gso.iface, &my_addr,
+				      NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	ret = net_conn_register(IPPROTO_TCP, AF_INET, NULL, NULL, 0, PORT,
+				tcp_received, NULL, NULL);
+	zassert_equal(ret, 0, "Cannot register TCP handler (%d)", ret);
+
+	net_if_up(eth_context_gso.iface);
+	net_if_up(eth_context_tso.iface);
+}
+
+/* Build one TCP packet carrying PAYLOAD_LEN bytes, which is more than the
+ * MTU of the interface.
+ */
+static struct net_pkt *large_tcp_pkt(struct net_if *iface)
+{
+	struct net_tcp_hdr tcp = {
+		.src_port = htons(PORT),
+		.dst_port = htons(PORT),
+		.offset = NET_TCPH_LEN << 2,
+		.flags = NET_TCP_ACK | NET_TCP_PSH,
+	};
+	struct net_pkt *pkt;
+	u8_t buf[64];
+	size_t off, len, i;
+
+	sys_put_be16(8192, tcp.wnd);
+
+	pkt = net_pkt_alloc_with_buffer(iface, NET_TCPH_LEN + PAYLOAD_LEN,
+					AF_INET, IPPROTO_TCP, WAIT_TIME);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	zassert_equal(net_ipv4_create(pkt, &my_addr, &peer_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_pkt_write(pkt, &tcp, sizeof(tcp)), 0,
+		      "Cannot write TCP header");
+
+	for (off = 0; off < PAYLOAD_LEN; off += len) {
+		len = MIN(sizeof(buf), PAYLOAD_LEN - off);
+
+		for (i = 0; i < len; i++) {
+			buf[i] = pattern(off + i);
+		}
+
+		/* Fails if the allocation was clamped to the MTU */
+		zassert_equal(net_pkt_write(pkt, buf, len), 0,
+			      "Cannot write payload");
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	zassert_equal(net_ipv4_finalize(pkt, IPPROTO_TCP), 0,
+		      "Cannot finalize packet");
+
+	return pkt;
+}
+
+static void reset(void)
+{
+	segments = 0;
+	sent_len = 0;
+	segments_ok = true;
+	received_pkts = 0;
+	received_len = 0;
+	pattern_ok = true;
+	k_sem_reset(&wait_data);
+}
+
+static void test_gso_gro(void)
+{
+	struct net_pkt *pkt;
+
+	reset();
+	test_started = true;
+
+	pkt = large_tcp_pkt(eth_context_gso.iface);
+
+	zassert_equal(net_send_data(pkt), 0, "Cannot send packet");
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Data not received");
+
+	test_started = false;
+
+	zassert_true(segments_ok, "Invalid segments");
+	zassert_equal(segments, ceiling_fraction(PAYLOAD_LEN, NET_ETH_MTU -
+						 NET_IPV4TCPH_LEN),
+		      "Sent %d segments", segments);
+	zassert_equal(sent_len, PAYLOAD_LEN, "Sent %zu bytes", sent_len);
+
+	/* All segments are coalesced back, with a valid TCP checksum or the
+	 * packet would have been dropped.
+	 */
+	zassert_equal(received_pkts, 1, "Received %d packets", received_pkts);
+	zassert_equal(received_len, PAYLOAD_LEN, "Received %zu bytes",
+		      received_len);
+	zassert_true(pattern_ok, "Received data is corrupted");
+}
+
+static void test_tso(void)
+{
+	struct net_pkt *pkt;
+
+	reset();
+	test_started = true;
+
+	pkt = large_tcp_pkt(eth_context_tso.iface);
+
+	zassert_equal(net_send_data(pkt), 0, "Cannot send packet");
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Data not sent");
+
+	test_started = false;
+
+	zassert_equal(segments, 1, "Packet was segmented in software");
+	zassert_equal(sent_len, PAYLOAD_LEN, "Sent %zu bytes", sent_len);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ethernet_offload_test,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_gso_gro),
+			 ztest_unit_test(test_tso));
+
+	ztest_run_test_suite(net_ethernet_offload_test);
+}
@@ -0,0 +1,369 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/printk.h>
+#include <linker/sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "net_stats.h"
+
+#define TEST_MTU 300
+
+/* Fragments of this are 280, 280, 280 and 168 bytes long */
+#define TEST_DATA_LEN 1000
+#define TEST_FRAG_COUNT 4
+
+#define SRC_PORT 4242
+#define DST_PORT 4343
+
+#define WAIT_TIME K_SECONDS(1)
+
+#define ALLOC_TIMEOUT 500
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *iface1;
+
+static struct net_pkt *frags[TEST_FRAG_COUNT];
+static int frag_count;
+
+static struct k_sem wait_frag;
+static struct k_sem wait_data;
+static bool data_ok;
+
+struct net_if_test {
+	u8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static int net_iface_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static u8_t *net_iface_get_mac(struct device *dev)
+{
+	struct net_if_test *data = dev->driver_data;
+
+	if (data->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		data->mac_addr[0] = 0x00;
+		data->mac_addr[1] = 0x00;
+		data->mac_addr[2] = 0x5E;
+		data->mac_addr[3] = 0x00;
+		data->mac_addr[4] = 0x53;
+		data->mac_addr[5] = sys_rand32_get();
+	}
+
+	return data->mac_addr;
+}
+
+static void net_iface_init(struct net_if *iface)
+{
+	u8_t *mac = net_iface_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, sizeof(struct net_eth_addr),
+			     NET_LINK_ETHERNET);
+}
+
+/* Keep the sent fragments so that they can be verified and fed back */
+static int sender_iface(struct device *dev, struct net_pkt *pkt)
+{
+	if (!pkt->buffer) {
+		NET_DBG("No data to send!");
+		return -ENODATA;
+	}
+
+	if (frag_count < TEST_FRAG_COUNT) {
+		frags[frag_count++] = net_pkt_ref(pkt);
+	}
+
+	k_sem_give(&wait_frag);
+
+	return 0;
+}
+
+struct net_if_test net_iface1_data;
+
+static struct dummy_api net_iface_api = {
+	.iface_api.init = net_iface_init,
+	.send = sender_iface,
+};
+
+NET_DEVICE_INIT(net_iface1_test,
+		"iface1",
+		net_iface_dev_init,
+		&net_iface1_data,
+		NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_iface_api,
+		DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2),
+		TEST_MTU);
+
+static enum net_verdict udp_data_received(struct net_conn *conn,
+					  struct net_pkt *pkt,
+					  union net_ip_header *ip_hdr,
+					  union net_proto_header *proto_hdr,
+					  void *user_data)
+{
+	u8_t data;
+	int i;
+
+	NET_DBG("Data %p received", pkt);
+
+	data_ok = net_pkt_get_len(pkt) ==
+		NET_IPV4UDPH_LEN + TEST_DATA_LEN;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, NET_IPV4UDPH_LEN);
+
+	for (i = 0; data_ok && i < TEST_DATA_LEN; i++) {
+		if (net_pkt_read_u8(pkt, &data) || data != (u8_t)i) {
+			data_ok = false;
+		}
+	}
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+
+	return NET_OK;
+}
+
+static void test_setup(void)
+{
+	static struct net_conn_handle *handle;
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	k_sem_init(&wait_frag, 0, UINT_MAX);
+	k_sem_init(&wait_data, 0, UINT_MAX);
+
+	iface1 = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface1, "Interface 1");
+
+	ifaddr = net_if_ipv4_addr_add(iface1, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_up(iface1);
+
+	ret = net_udp_register(AF_INET, NULL, NULL, SRC_PORT, DST_PORT,
+			       udp_data_received, NULL, &handle);
+	zassert_equal(ret, 0, "Cannot register UDP handler");
+}
+
+/* Send a UDP packet that does not fit into the MTU, and wait until all
+ * of its fragments have reached the driver.
+ */
+static void send_large_pkt(void)
+{
+	struct net_pkt *pkt;
+	int i, ret;
+
+	frag_count = 0;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, TEST_DATA_LEN, AF_INET,
+					IPPROTO_UDP, ALLOC_TIMEOUT);
+	zassert_not_null(pkt, "packet");
+
+	ret = net_ipv4_create(pkt, &my_addr, &peer_addr);
+	zassert_equal(ret, 0, "Cannot create IPv4 header");
+
+	ret = net_udp_create(pkt, htons(SRC_PORT), htons(DST_PORT));
+	zassert_equal(ret, 0, "Cannot create UDP header");
+
+	for (i = 0; i < TEST_DATA_LEN; i++) {
+		ret = net_pkt_write_u8(pkt, i);
+		zassert_equal(ret, 0, "Cannot write data");
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_ipv4_finalize(pkt, IPPROTO_UDP);
+
+	ret = net_send_data(pkt);
+	zassert_equal(ret, 0, "Cannot send packet");
+
+	for (i = 0; i < TEST_FRAG_COUNT; i++) {
+		zassert_equal(k_sem_take(&wait_frag, WAIT_TIME), 0,
+			      "Timeout while waiting fragment %d", i);
+	}
+}
+
+/* Turn a sent fragment into one received from the peer */
+static void reverse_fragment(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+	struct in_addr addr;
+
+	net_ipaddr_copy(&addr, &hdr->src);
+	net_ipaddr_copy(&hdr->src, &hdr->dst);
+	net_ipaddr_copy(&hdr->dst, &addr);
+
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+}
+
+static void recv_fragment(int i)
+{
+	reverse_fragment(frags[i]);
+
+	zassert_equal(net_recv_data(iface1, frags[i]), 0,
+		      "Cannot receive fragment %d", i);
+
+	frags[i] = NULL;
+}
+
+static void test_send_ipv4_fragment(void)
+{
+	net_stats_t sent = GET_STAT(iface1, ipv4_frag.sent);
+	struct net_ipv4_hdr *hdr;
+	u16_t offset, expected = 0U;
+	int i;
+
+	send_large_pkt();
+
+	zassert_equal(frag_count, TEST_FRAG_COUNT, "Invalid fragment count");
+
+	for (i = 0; i < TEST_FRAG_COUNT; i++) {
+		hdr = NET_IPV4_HDR(frags[i]);
+		offset = sys_get_be16(hdr->offset);
+
+		zassert_true(net_pkt_get_len(frags[i]) <= TEST_MTU,
+			     "Fragment %d too long", i);
+		zassert_equal(ntohs(hdr->len), net_pkt_get_len(frags[i]),
+			      "Invalid length in fragment %d", i);
+		zassert_equal((offset & NET_IPV4_FRAGH_OFFSET_MASK) * 8U,
+			      expected, "Invalid offset in fragment %d", i);
+		zassert_equal(!!(offset & NET_IPV4_MORE_FRAG_MASK),
+			      i < TEST_FRAG_COUNT - 1,
+			      "Invalid MF flag in fragment %d", i);
+		zassert_equal(net_calc_chksum_ipv4(frags[i]), 0U,
+			      "Invalid checksum in fragment %d", i);
+		zassert_true(!memcmp(hdr->id, NET_IPV4_HDR(frags[0])->id,
+				     sizeof(hdr->id)),
+			     "Invalid id in fragment %d", i);
+
+		expected += ntohs(hdr->len) - NET_IPV4H_LEN;
+	}
+
+	zassert_equal(expected, NET_UDPH_LEN + TEST_DATA_LEN,
+		      "Invalid total length");
+	zassert_equal(GET_STAT(iface1, ipv4_frag.sent) - sent,
+		      TEST_FRAG_COUNT, "Invalid sent statistics");
+}
+
+static void test_recv_ipv4_fragment(void)
+{
+	net_stats_t reassembled = GET_STAT(iface1, ipv4_frag.reassembled);
+	net_stats_t drop = GET_STAT(iface1, ipv4_frag.drop);
+	struct net_pkt *dup;
+
+	/* Fragments of the previous test, out of order and with one of
+	 * them received twice.
+	 */
+	dup = net_pkt_clone(frags[1], ALLOC_TIMEOUT);
+	zassert_not_null(dup, "Cannot clone fragment");
+
+	recv_fragment(3);
+	recv_fragment(1);
+
+	reverse_fragment(dup);
+	zassert_equal(net_recv_data(iface1, dup), 0,
+		      "Cannot receive duplicate");
+
+	recv_fragment(0);
+
+	zassert_not_equal(k_sem_take(&wait_data, K_MSEC(100)), 0,
+			  "Packet reassembled too early");
+
+	recv_fragment(2);
+
+	zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+		      "Timeout while waiting reassembled packet");
+	zassert_true(data_ok, "Invalid reassembled packet");
+
+	zassert_equal(GET_STAT(iface1, ipv4_frag.reassembled) - reassembled,
+		      1, "Invalid reassembled statistics");
+	zassert_equal(GET_STAT(iface1, ipv4_frag.drop) - drop, 1,
+		      "Duplicate fragment not dropped");
+}
+
+static void frag_cb(struct net_ipv4_reassembly *reass, void *user_data)
+{
+	int *count = user_data;
+
+	zassert_equal(reass->count, 2, "Invalid pending fragment count");
+	zassert_equal(reass->received, 560, "Invalid pending length");
+
+	(*count)++;
+}
+
+static void test_recv_ipv4_fragment_timeout(void)
+{
+	net_stats_t timeout = GET_STAT(iface1, ipv4_frag.timeout);
+	int count = 0;
+
+	send_large_pkt();
+
+	recv_fragment(0);
+	recv_fragment(1);
+
+	net_pkt_unref(frags[2]);
+	net_pkt_unref(frags[3]);
+
+	/* Let the RX thread store the fragments */
+	k_sleep(K_MSEC(100));
+
+	net_ipv4_frag_foreach(frag_cb, &count);
+	zassert_equal(count, 1, "Reassembly is not pending");
+
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT) + K_MSEC(500));
+
+	count = 0;
+	net_ipv4_frag_foreach(frag_cb, &count);
+	zassert_equal(count, 0, "Reassembly did not time out");
+
+	zassert_equal(GET_STAT(iface1, ipv4_frag.timeout) - timeout, 1,
+		      "Invalid timeout statistics");
+	zassert_not_equal(k_sem_take(&wait_data, K_NO_WAIT), 0,
+			  "Incomplete packet was received");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment_test,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment),
+			 ztest_unit_test(test_recv_ipv4_fragment_timeout)
+			 );
+
+	ztest_run_test_suite(net_ipv4_fragment_test);
+}
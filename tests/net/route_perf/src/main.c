@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/printk.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "ipv6.h"
+#include "nbr.h"
+#include "route.h"
+
+/* Number of lookups timed for every measurement */
+#define LOOKUPS 1000
+
+static struct net_if *iface;
+
+static struct in6_addr router_addr = { { { 0xfe, 0x80, 0, 0, 0, 0, 0, 0,
+					   0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static u8_t router_mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+static struct net_linkaddr router_lladdr = {
+	.addr = router_mac,
+	.len = sizeof(router_mac),
+};
+
+static struct net_route_entry *routes[CONFIG_NET_MAX_ROUTES];
+static struct in6_addr dests[CONFIG_NET_MAX_ROUTES];
+static int route_count;
+
+static int route_perf_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void route_perf_iface_init(struct net_if *iface)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x00 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int route_perf_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api route_perf_if_api = {
+	.iface_api.init = route_perf_iface_init,
+	.send = route_perf_send,
+};
+
+NET_DEVICE_INIT(route_perf_test, "route_perf_test",
+		route_perf_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&route_perf_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+/* Even entries are host routes 2001:db8:1::<i>/128, odd entries are
+ * network routes 2001:db8:2:<i>::/64. dests[] holds an address that is
+ * routed by each entry.
+ */
+static void make_route(int i, struct in6_addr *addr, u8_t *prefix_len)
+{
+	(void)memset(addr, 0, sizeof(*addr));
+
+	addr->s6_addr[0] = 0x20;
+	addr->s6_addr[1] = 0x01;
+	addr->s6_addr[2] = 0x0d;
+	addr->s6_addr[3] = 0xb8;
+
+	if (i % 2) {
+		addr->s6_addr[5] = 0x02;
+		addr->s6_addr[6] = i >> 8;
+		addr->s6_addr[7] = i;
+		*prefix_len = 64U;
+
+		net_ipaddr_copy(&dests[i], addr);
+		dests[i].s6_addr[15] = 0x42;
+	} else {
+		addr->s6_addr[5] = 0x01;
+		addr->s6_addr[14] = i >> 8;
+		addr->s6_addr[15] = i;
+		*prefix_len = 128U;
+
+		net_ipaddr_copy(&dests[i], addr);
+	}
+}
+
+struct linear_lookup {
+	struct in6_addr *dst;
+	struct net_route_entry *found;
+};
+
+static void linear_lookup_cb(struct net_route_entry *entry, void *user_data)
+{
+	struct linear_lookup *lookup = user_data;
+
+	if (entry->iface != iface ||
+	    !net_ipv6_is_prefix(lookup->dst->s6_addr, entry->addr.s6_addr,
+				entry->prefix_len)) {
+		return;
+	}
+
+	if (!lookup->found ||
+	    entry->prefix_len > lookup->found->prefix_len) {
+		lookup->found = entry;
+	}
+}
+
+/* Reference lookup scanning every route entry */
+static struct net_route_entry *linear_lookup(struct in6_addr *dst)
+{
+	struct linear_lookup lookup = {
+		.dst = dst,
+	};
+
+	net_route_foreach(linear_lookup_cb, &lookup);
+
+	return lookup.found;
+}
+
+static void routes_fill(int count)
+{
+	struct in6_addr addr;
+	u8_t prefix_len;
+
+	for (; route_count < count; route_count++) {
+		make_route(route_count, &addr, &prefix_len);
+
+		routes[route_count] = net_route_add(iface, &addr, prefix_len,
+						    &router_addr);
+		zassert_not_null(routes[route_count], "Route %d add failed",
+				 route_count);
+	}
+}
+
+static void routes_check(void)
+{
+	struct in6_addr other = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0x03 } } };
+	int i;
+
+	for (i = 0; i < route_count; i++) {
+		zassert_equal_ptr(net_route_lookup(iface, &dests[i]),
+				  routes[i], "Wrong route for entry %d", i);
+		zassert_equal_ptr(linear_lookup(&dests[i]), routes[i],
+				  "Wrong reference route for entry %d", i);
+	}
+
+	zassert_is_null(net_route_lookup(iface, &other),
+			"Unrouted address found a route");
+}
+
+static u32_t time_lookups(bool linear, bool same_dst)
+{
+	struct net_route_entry *route;
+	u32_t start, cycles;
+	int i, j;
+
+	start = k_cycle_get_32();
+
+	for (i = 0, j = 0; i < LOOKUPS; i++) {
+		if (linear) {
+			route = linear_lookup(&dests[j]);
+		} else {
+			route = net_route_lookup(iface, &dests[j]);
+		}
+
+		if (!same_dst && ++j == route_count) {
+			j = 0;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	zassert_not_null(route, "Lookup failed");
+
+	return cycles / LOOKUPS;
+}
+
+static void test_init(void)
+{
+	struct net_nbr *nbr;
+
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface is NULL");
+
+	nbr = net_ipv6_nbr_add(iface, &router_addr, &router_lladdr, true,
+			       NET_IPV6_NBR_STATE_REACHABLE);
+	zassert_not_null(nbr, "Cannot add router to neighbor cache");
+}
+
+static void test_route_scaling(void)
+{
+	static const int counts[] = { 8, 32, 128, CONFIG_NET_MAX_ROUTES };
+	int i;
+
+	TC_PRINT("%8s %10s %10s %10s   (cycles per lookup, "
+		 "cache size %d)\n", "routes", "linear", "lookup",
+		 "same dst", CONFIG_NET_ROUTE_LOOKUP_CACHE_SIZE);
+
+	for (i = 0; i < ARRAY_SIZE(counts); i++) {
+		if (counts[i] > CONFIG_NET_MAX_ROUTES) {
+			break;
+		}
+
+		routes_fill(counts[i]);
+		routes_check();
+
+		TC_PRINT("%8d %10u %10u %10u\n", route_count,
+			 time_lookups(true, false),
+			 time_lookups(false, false),
+			 time_lookups(false, true));
+	}
+}
+
+static void test_route_del(void)
+{
+	int i;
+
+	/* Remove the host routes, their addresses are not covered by any
+	 * network route and must not be routed anymore.
+	 */
+	for (i = 0; i < route_count; i += 2) {
+		zassert_equal(net_route_del(routes[i]), 0,
+			      "Route %d del failed", i);
+	}
+
+	for (i = 0; i < route_count; i++) {
+		struct net_route_entry *route = net_route_lookup(iface,
+								 &dests[i]);
+
+		zassert_equal_ptr(route, i % 2 ? routes[i] : NULL,
+				  "Wrong route for entry %d", i);
+		zassert_equal_ptr(route, linear_lookup(&dests[i]),
+				  "Reference mismatch for entry %d", i);
+	}
+
+	for (i = 1; i < route_count; i += 2) {
+		zassert_equal(net_route_del(routes[i]), 0,
+			      "Route %d del failed", i);
+	}
+
+	route_count = 0;
+}
+
+void test_main(void)
+{
+	ztest_test_suite(route_perf,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_route_scaling),
+			 ztest_unit_test(test_route_del));
+
+	ztest_run_test_suite(route_perf);
+}
@@ -0,0 +1,334 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define NET_LOG_LEVEL CONFIG_NET_TC_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, NET_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <kernel_structs.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/net_ip.h>
+#include <net/net_l2.h>
+
+#include "ipv4.h"
+#include "udp_internal.h"
+#include "connection.h"
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+
+#define PORT 4242
+
+/* The flows only differ by their source port, PEER_PORT + flow */
+#define PEER_PORT 5000
+#define FLOWS 32
+
+/* Packets sent in every flow, each carrying its sequence number */
+#define ROUNDS 4
+
+#define WAIT_TIME K_SECONDS(1)
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static u8_t my_mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+static u8_t peer_mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0xff };
+
+static struct net_if *iface;
+
+static K_SEM_DEFINE(wait_data, 0, UINT_MAX);
+
+/* What the receive handler saw of a flow. Each entry is written only by
+ * the RX thread the flow is steered to.
+ */
+struct flow_info {
+	k_tid_t thread;
+	int cpu;
+	u32_t next_seq;
+	bool ok;
+};
+
+static struct flow_info flows[FLOWS];
+
+static void eth_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, my_mac, sizeof(my_mac),
+			     NET_LINK_ETHERNET);
+
+	ethernet_init(iface);
+}
+
+static int eth_tx(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static enum ethernet_hw_caps eth_caps(struct device *dev)
+{
+	return 0;
+}
+
+static struct ethernet_api api_funcs = {
+	.iface_api.init = eth_iface_init,
+
+	.get_capabilities = eth_caps,
+	.send = eth_tx,
+};
+
+static int eth_init(struct device *dev)
+{
+	return 0;
+}
+
+ETH_NET_DEVICE_INIT(eth_rx_flow_test, "eth_rx_flow_test",
+		    eth_init, NULL, NULL, CONFIG_ETH_INIT_PRIORITY,
+		    &api_funcs, NET_ETH_MTU);
+
+static enum net_verdict udp_received(struct net_conn *conn,
+				     struct net_pkt *pkt,
+				     union net_ip_header *ip_hdr,
+				     union net_proto_header *proto_hdr,
+				     void *user_data)
+{
+	u16_t flow = ntohs(proto_hdr->udp->src_port) - PEER_PORT;
+	int cpu = arch_curr_cpu()->id;
+	struct flow_info *info;
+	u32_t seq;
+
+	if (flow >= FLOWS) {
+		return NET_DROP;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, NET_IPV4UDPH_LEN) ||
+	    net_pkt_read_be32(pkt, &seq)) {
+		return NET_DROP;
+	}
+
+	info = &flows[flow];
+
+	if (!info->thread) {
+		info->thread = k_current_get();
+		info->cpu = cpu;
+	} else if (info->thread != k_current_get()) {
+		info->ok = false;
+	} else if (IS_ENABLED(CONFIG_SCHED_CPU_MASK) && info->cpu != cpu) {
+		/* The RX threads are pinned */
+		info->ok = false;
+	}
+
+	if (seq != info->next_seq) {
+		info->ok = false;
+	}
+
+	info->next_seq = seq + 1;
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&wait_data);
+
+	return NET_OK;
+}
+
+static void test_init(void)
+{
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(ETHERNET));
+	zassert_not_null(iface, "No Ethernet interface");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	ret = net_conn_register(IPPROTO_UDP, AF_INET, NULL, NULL, 0, PORT,
+				udp_received, NULL, NULL);
+	zassert_equal(ret, 0, "Cannot register UDP handler (%d)", ret);
+
+	net_if_up(iface);
+}
+
+/* Receive one UDP packet of a flow as if the peer had sent it */
+static void recv_udp(int flow, u32_t seq)
+{
+	struct net_eth_hdr eth = {
+		.type = htons(NET_ETH_PTYPE_IP),
+	};
+	struct net_pkt *pkt, *rx;
+	size_t len;
+
+	memcpy(eth.dst.addr, my_mac, sizeof(eth.dst.addr));
+	memcpy(eth.src.addr, peer_mac, sizeof(eth.src.addr));
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(seq), AF_INET,
+					IPPROTO_UDP, WAIT_TIME);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	seq = htonl(seq);
+
+	zassert_equal(net_ipv4_create(pkt, &peer_addr, &my_addr), 0,
+		      "Cannot create IPv4 header");
+	zassert_equal(net_udp_create(pkt, htons(PEER_PORT + flow),
+				     htons(PORT)), 0,
+		      "Cannot create UDP header");
+	zassert_equal(net_pkt_write(pkt, &seq, sizeof(seq)), 0,
+		      "Cannot write payload");
+
+	net_pkt_cursor_init(pkt);
+
+	zassert_equal(net_ipv4_finalize(pkt, IPPROTO_UDP), 0,
+		      "Cannot finalize packet");
+
+	/* Like a real driver, the frame is received into fresh buffers,
+	 * with the headers in the first one.
+	 */
+	len = net_pkt_get_len(pkt);
+
+	rx = net_pkt_rx_alloc_with_buffer(iface, sizeof(eth) + len,
+					  AF_UNSPEC, 0, WAIT_TIME);
+	zassert_not_null(rx, "Cannot allocate RX packet");
+
+	net_pkt_cursor_init(pkt);
+
+	zassert_equal(net_pkt_write(rx, &eth, sizeof(eth)), 0,
+		      "Cannot write Ethernet header");
+	zassert_equal(net_pkt_copy(rx, pkt, len), 0, "Cannot copy packet");
+
+	net_pkt_unref(pkt);
+
+	zassert_equal(net_recv_data(iface, rx), 0, "Cannot receive packet");
+}
+
+/* Send ROUNDS packets in every flow, the flows interleaved */
+static void recv_flows(void)
+{
+	int round, flow;
+
+	memset(flows, 0, sizeof(flows));
+
+	for (flow = 0; flow < FLOWS; flow++) {
+		flows[flow].ok = true;
+	}
+
+	k_sem_reset(&wait_data);
+
+	for (round = 0; round < ROUNDS; round++) {
+		for (flow = 0; flow < FLOWS; flow++) {
+			recv_udp(flow, round);
+		}
+
+		for (flow = 0; flow < FLOWS; flow++) {
+			zassert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+				      "Packet %d of round %d not received",
+				      flow, round);
+		}
+	}
+}
+
+static void test_same_flow(void)
+{
+	int flow;
+
+	recv_flows();
+
+	for (flow = 0; flow < FLOWS; flow++) {
+		zassert_true(flows[flow].ok,
+			     "Flow %d changed queues or was reordered", flow);
+		zassert_equal(flows[flow].next_seq, ROUNDS,
+			      "Flow %d lost packets", flow);
+	}
+}
+
+static void test_flows_spread(void)
+{
+	k_tid_t threads[CONFIG_NET_RX_FLOW_STEERING_QUEUES];
+	int count[CONFIG_NET_RX_FLOW_STEERING_QUEUES] = { 0 };
+	int queues = 0;
+	int flow, i;
+
+	recv_flows();
+
+	for (flow = 0; flow < FLOWS; flow++) {
+		for (i = 0; i < queues; i++) {
+			if (threads[i] == flows[flow].thread) {
+				break;
+			}
+		}
+
+		zassert_true(i < ARRAY_SIZE(threads), "Too many RX threads");
+
+		if (i == queues) {
+			threads[queues++] = flows[flow].thread;
+		}
+
+		count[i]++;
+	}
+
+	zassert_equal(queues, CONFIG_NET_RX_FLOW_STEERING_QUEUES,
+		      "Flows went to %d of %d queues", queues,
+		      CONFIG_NET_RX_FLOW_STEERING_QUEUES);
+
+	for (i = 0; i < queues; i++) {
+		TC_PRINT("Queue %d: %d flows\n", i, count[i]);
+
+		/* Half of an even share at least */
+		zassert_true(count[i] * queues * 2 >= FLOWS,
+			     "Queue %d got only %d flows", i, count[i]);
+	}
+}
+
+static void test_cpus(void)
+{
+	bool seen[CONFIG_MP_NUM_CPUS] = { false };
+	int cpus = 0;
+	int flow, i;
+
+	if (!IS_ENABLED(CONFIG_SCHED_CPU_MASK)) {
+		ztest_test_skip();
+	}
+
+	recv_flows();
+
+	for (flow = 0; flow < FLOWS; flow++) {
+		zassert_true(flows[flow].ok, "Flow %d moved between CPUs",
+			     flow);
+
+		seen[flows[flow].cpu] = true;
+	}
+
+	for (i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		cpus += seen[i];
+	}
+
+	zassert_equal(cpus, MIN(CONFIG_NET_RX_FLOW_STEERING_QUEUES,
+				CONFIG_MP_NUM_CPUS),
+		      "RX work ran on %d CPUs", cpus);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rx_flow_test,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_same_flow),
+			 ztest_unit_test(test_flows_spread),
+			 ztest_unit_test(test_cpus));
+
+	ztest_run_test_suite(net_rx_flow_test);
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <string.h>
+
+#include <net/dummy.h>
+#include <net/ethernet.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/socket.h>
+#include <net/socket_packet_ring.h>
+
+/* Frame spread over several network buffers */
+#define FRAME_LEN 300
+
+#define RING_SIZE 8
+#define COMP_RING_SIZE 4
+
+/* More frames than the completion ring holds, so that it only keeps up
+ * if every completion is reported
+ */
+#define TX_ROUNDS (3 * COMP_RING_SIZE)
+
+#define TX_OFFSET 64
+
+#define WAIT_TIME K_MSEC(500)
+
+static struct net_if *iface;
+
+static u8_t rx_ring_mem[NET_PACKET_RING_BYTES(RING_SIZE)] __aligned(4);
+static u8_t fill_ring_mem[NET_PACKET_RING_BYTES(RING_SIZE)] __aligned(4);
+static u8_t tx_ring_mem[NET_PACKET_RING_BYTES(RING_SIZE)] __aligned(4);
+static u8_t comp_ring_mem[NET_PACKET_RING_BYTES(COMP_RING_SIZE)] __aligned(4);
+
+static struct net_packet_ring *rx_ring =
+	(struct net_packet_ring *)rx_ring_mem;
+static struct net_packet_ring *fill_ring =
+	(struct net_packet_ring *)fill_ring_mem;
+static struct net_packet_ring *tx_ring =
+	(struct net_packet_ring *)tx_ring_mem;
+static struct net_packet_ring *comp_ring =
+	(struct net_packet_ring *)comp_ring_mem;
+
+static u8_t umem[512];
+
+static u8_t sent_data[FRAME_LEN];
+static size_t sent_len;
+static K_SEM_DEFINE(sent_sem, 0, 1);
+
+static inline u8_t pattern(size_t off, u8_t seed)
+{
+	return (off + seed) % 251;
+}
+
+static int packet_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void packet_iface_init(struct net_if *iface)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x02 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int packet_send(struct device *dev, struct net_pkt *pkt)
+{
+	ARG_UNUSED(dev);
+
+	if (net_pkt_family(pkt) != AF_PACKET) {
+		return 0;
+	}
+
+	sent_len = MIN(net_pkt_get_len(pkt), sizeof(sent_data));
+
+	net_pkt_cursor_init(pkt);
+	if (net_pkt_read(pkt, sent_data, sent_len) < 0) {
+		sent_len = 0;
+	}
+
+	k_sem_give(&sent_sem);
+
+	return 0;
+}
+
+static struct dummy_api packet_if_api = {
+	.iface_api.init = packet_iface_init,
+	.send = packet_send,
+};
+
+NET_DEVICE_INIT(packet_test, "packet_test", packet_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &packet_if_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1500);
+
+static int packet_socket(void)
+{
+	struct sockaddr_ll addr = { 0 };
+	int sock;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "No interface");
+
+	sock = socket(AF_PACKET, SOCK_RAW, ETH_P_ALL);
+	zassert_true(sock >= 0, "socket() failed (%d)", errno);
+
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = ETH_P_ALL;
+	addr.sll_ifindex = net_if_get_by_iface(iface);
+
+	zassert_equal(bind(sock, (struct sockaddr *)&addr, sizeof(addr)), 0,
+		      "bind() failed (%d)", errno);
+
+	return sock;
+}
+
+static void set_ring(int sock, int optname, struct net_packet_ring *ring,
+		     u32_t size)
+{
+	net_packet_ring_init(ring, size);
+
+	zassert_equal(setsockopt(sock, SOL_PACKET, optname, &ring,
+				 sizeof(ring)), 0,
+		      "setsockopt(%d) failed (%d)", optname, errno);
+}
+
+static void inject_frame(u8_t seed)
+{
+	struct net_pkt *pkt;
+	size_t i;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, FRAME_LEN, AF_UNSPEC, 0,
+					   K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	for (i = 0; i < FRAME_LEN; i++) {
+		zassert_equal(net_pkt_write_u8(pkt, pattern(i, seed)), 0,
+			      "Cannot write pkt");
+	}
+
+	zassert_equal(net_recv_data(iface, pkt), 0, "Cannot receive pkt");
+}
+
+/* Take one frame from the RX ring, check its data and give it back in
+ * the fill ring
+ */
+static void check_rx_frame(int sock, u8_t seed)
+{
+	struct pollfd pfd = { .fd = sock, .events = POLLIN };
+	struct net_packet_desc *desc;
+	struct net_packet_desc last;
+	size_t off = 0;
+	size_t i;
+
+	zassert_equal(poll(&pfd, 1, WAIT_TIME), 1, "No frame received");
+	zassert_true(pfd.revents & POLLIN, "POLLIN not set");
+
+	do {
+		desc = net_packet_ring_peek(rx_ring);
+		zassert_not_null(desc, "Frame is not complete");
+
+		for (i = 0; i < desc->len; i++) {
+			zassert_equal(((u8_t *)desc->addr)[i],
+				      pattern(off + i, seed),
+				      "Invalid data at %zu", off + i);
+		}
+
+		off += desc->len;
+		last = *desc;
+		net_packet_ring_release(rx_ring);
+	} while (last.flags & NET_PACKET_DESC_MORE);
+
+	zassert_equal(off, FRAME_LEN, "Invalid frame length");
+	zassert_not_null(last.cookie, "No cookie");
+	zassert_equal(net_packet_ring_count(rx_ring), 0,
+		      "Unexpected descriptors");
+
+	zassert_equal(net_packet_ring_put(fill_ring, &last), 0,
+		      "Fill ring full");
+}
+
+void test_packet_ring_rx(void)
+{
+	struct pollfd pfd;
+	struct k_mem_slab *rx_slab, *tx_slab;
+	struct net_buf_pool *rx_data, *tx_data;
+	u32_t free_pkts;
+	u8_t buf[4];
+	int sock;
+
+	net_pkt_get_info(&rx_slab, &tx_slab, &rx_data, &tx_data);
+
+	/* No TX ring, so nothing is ever sent that would drain the fill
+	 * ring on the way
+	 */
+	sock = packet_socket();
+	set_ring(sock, PACKET_RING_RX, rx_ring, RING_SIZE);
+	set_ring(sock, PACKET_RING_FILL, fill_ring, RING_SIZE);
+
+	free_pkts = k_mem_slab_num_free_get(rx_slab);
+
+	inject_frame(1);
+	check_rx_frame(sock, 1);
+
+	/* poll() gives the frame of the fill ring back */
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	zassert_equal(poll(&pfd, 1, K_NO_WAIT), 0, "Unexpected frame");
+	zassert_equal(net_packet_ring_count(fill_ring), 0,
+		      "Fill ring not drained by poll()");
+	zassert_equal(k_mem_slab_num_free_get(rx_slab), free_pkts,
+		      "Packet not released by poll()");
+
+	/* So does recv() */
+	inject_frame(2);
+	check_rx_frame(sock, 2);
+
+	zassert_equal(recv(sock, buf, sizeof(buf), MSG_DONTWAIT), -1,
+		      "Unexpected data");
+	zassert_equal(errno, EAGAIN, "Unexpected errno %d", errno);
+	zassert_equal(net_packet_ring_count(fill_ring), 0,
+		      "Fill ring not drained by recv()");
+	zassert_equal(k_mem_slab_num_free_get(rx_slab), free_pkts,
+		      "Packet not released by recv()");
+
+	zassert_equal(close(sock), 0, "close() failed");
+}
+
+static void wait_completion(struct net_packet_desc *desc)
+{
+	int i;
+
+	/* The completion is reported when the driver releases the frame,
+	 * right after it has been sent
+	 */
+	for (i = 0; i < 10 && !net_packet_ring_count(comp_ring); i++) {
+		k_sleep(K_MSEC(10));
+	}
+
+	zassert_equal(net_packet_ring_count(comp_ring), 1,
+		      "No completion");
+
+	*desc = *net_packet_ring_peek(comp_ring);
+	net_packet_ring_release(comp_ring);
+}
+
+void test_packet_ring_tx(void)
+{
+	struct net_packet_umem region = {
+		.addr = umem,
+		.len = sizeof(umem),
+	};
+	struct net_packet_desc desc;
+	int sock, round;
+	size_t i;
+
+	sock = packet_socket();
+
+	zassert_equal(setsockopt(sock, SOL_PACKET, PACKET_RING_UMEM,
+				 &region, sizeof(region)), 0,
+		      "setsockopt(PACKET_RING_UMEM) failed (%d)", errno);
+	set_ring(sock, PACKET_RING_TX, tx_ring, RING_SIZE);
+	set_ring(sock, PACKET_RING_COMPLETION, comp_ring, COMP_RING_SIZE);
+
+	for (round = 0; round < TX_ROUNDS; round++) {
+		for (i = 0; i < FRAME_LEN; i++) {
+			umem[TX_OFFSET + i] = pattern(i, round);
+		}
+
+		desc.addr = TX_OFFSET;
+		desc.len = FRAME_LEN;
+		desc.flags = 0U;
+		desc.cookie = NULL;
+		zassert_equal(net_packet_ring_put(tx_ring, &desc), 0,
+			      "TX ring full");
+
+		zassert_equal(send(sock, NULL, 0, 0), 1,
+			      "send() failed in round %d (%d)", round, errno);
+
+		zassert_equal(k_sem_take(&sent_sem, WAIT_TIME), 0,
+			      "Frame not sent");
+		zassert_equal(sent_len, FRAME_LEN, "Invalid sent length");
+		for (i = 0; i < FRAME_LEN; i++) {
+			zassert_equal(sent_data[i], pattern(i, round),
+				      "Invalid sent data at %zu", i);
+		}
+
+		wait_completion(&desc);
+		zassert_equal(desc.addr, TX_OFFSET, "Invalid completion");
+		zassert_equal(desc.len, FRAME_LEN, "Invalid completion");
+	}
+
+	zassert_equal(close(sock), 0, "close() failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_packet,
+			 ztest_unit_test(test_packet_ring_rx),
+			 ztest_unit_test(test_packet_ring_tx));
+
+	ztest_run_test_suite(socket_packet);
+}
@@ -906,6 +906,257 @@ void test_v6_sendmsg_with_txtime(void)
 	test_started = false;
 }
 
+void test_v4_recvmsg(void)
+{
+	int rv;
+	int opt = 1;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in addr;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	struct in_pktinfo info;
+	struct iovec io_vector[2];
+	static char rx_buf[2][400];
+	union {
+		struct cmsghdr hdr;
+		unsigned char  buf[CMSG_SPACE(sizeof(struct in_pktinfo))];
+	} cmsgbuf;
+	ssize_t recved;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = setsockopt(server_sock, IPPROTO_IP, IP_PKTINFO, &opt,
+			sizeof(opt));
+	zassert_equal(rv, 0, "setsockopt failed");
+
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	/* Scatter the datagram over two buffers */
+	io_vector[0].iov_base = rx_buf[0];
+	io_vector[0].iov_len = 16;
+	io_vector[1].iov_base = rx_buf[1];
+	io_vector[1].iov_len = sizeof(rx_buf[1]);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_control = &cmsgbuf.buf;
+	msg.msg_controllen = sizeof(cmsgbuf.buf);
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = 2;
+	msg.msg_name = &addr;
+	msg.msg_namelen = sizeof(addr);
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, STRLEN(TEST_STR2), "unexpected received bytes");
+	zassert_mem_equal(rx_buf[0], TEST_STR2, 16, "wrong data");
+	zassert_mem_equal(rx_buf[1], TEST_STR2 + 16, STRLEN(TEST_STR2) - 16,
+			  "wrong data");
+	zassert_equal(msg.msg_namelen, sizeof(struct sockaddr_in),
+		      "unexpected addrlen");
+	zassert_equal(msg.msg_flags, 0, "unexpected flags");
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	zassert_not_null(cmsg, "no control data");
+	zassert_equal(cmsg->cmsg_level, IPPROTO_IP, "wrong cmsg level");
+	zassert_equal(cmsg->cmsg_type, IP_PKTINFO, "wrong cmsg type");
+	memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+	zassert_true(net_ipv4_addr_cmp(&info.ipi_addr, &server_addr.sin_addr),
+		     "wrong destination address");
+	zassert_true(info.ipi_ifindex > 0, "wrong interface index");
+
+	/* Datagram longer than the buffers is truncated */
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	msg.msg_iovlen = 1;
+	msg.msg_controllen = 0;
+	msg.msg_namelen = sizeof(addr);
+
+	recved = recvmsg(server_sock, &msg, 0);
+	zassert_equal(recved, 16, "unexpected received bytes");
+	zassert_mem_equal(rx_buf[0], TEST_STR2, 16, "wrong data");
+	zassert_true(msg.msg_flags & MSG_TRUNC, "no truncation reported");
+	zassert_true(msg.msg_flags & MSG_CTRUNC, "no truncation reported");
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+#define MMSG_COUNT 3
+
+void test_v6_sendmmsg_recvmmsg(void)
+{
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in6 client_addr;
+	struct sockaddr_in6 server_addr;
+	struct mmsghdr msgs[MMSG_COUNT + 1];
+	struct iovec tx_iov[MMSG_COUNT];
+	struct iovec rx_iov[MMSG_COUNT + 1];
+	static ZTEST_BMEM char rx_buf[MMSG_COUNT + 1][32];
+	static const char * const tx_str[MMSG_COUNT] = {
+		"first", "second message", "third"
+	};
+	int received = 0;
+
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v6(CONFIG_NET_CONFIG_MY_IPV6_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = bind(client_sock,
+		  (struct sockaddr *)&client_addr,
+		  sizeof(client_addr));
+	zassert_equal(rv, 0, "client bind failed");
+
+	memset(msgs, 0, sizeof(msgs));
+	for (int i = 0; i < MMSG_COUNT; i++) {
+		tx_iov[i].iov_base = (void *)tx_str[i];
+		tx_iov[i].iov_len = strlen(tx_str[i]);
+		msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &server_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+	}
+
+	rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+	zassert_equal(rv, MMSG_COUNT, "sendmmsg failed");
+	for (int i = 0; i < MMSG_COUNT; i++) {
+		zassert_equal(msgs[i].msg_len, strlen(tx_str[i]),
+			      "unexpected sent bytes");
+	}
+
+	/* Datagrams may reach the socket one by one, so collect them until
+	 * all are in, waiting only for the first one of each call.
+	 */
+	while (received < MMSG_COUNT) {
+		int vlen = MMSG_COUNT + 1 - received;
+
+		memset(msgs, 0, sizeof(msgs));
+		for (int i = 0; i < vlen; i++) {
+			rx_iov[i].iov_base = rx_buf[received + i];
+			rx_iov[i].iov_len = sizeof(rx_buf[0]);
+			msgs[i].msg_hdr.msg_iov = &rx_iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		rv = recvmmsg(server_sock, msgs, vlen, MSG_WAITFORONE);
+		zassert_true(rv > 0, "recvmmsg failed");
+		zassert_true(received + rv <= MMSG_COUNT, "too many messages");
+
+		for (int i = 0; i < rv; i++) {
+			const char *str = tx_str[received + i];
+
+			zassert_equal(msgs[i].msg_len, strlen(str),
+				      "unexpected received bytes");
+			zassert_mem_equal(rx_buf[received + i], str,
+					  strlen(str), "wrong data");
+		}
+
+		received += rv;
+	}
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
+void test_v4_recv_zc(void)
+{
+#if defined(CONFIG_NET_SOCKETS_RECV_ZEROCOPY)
+	int rv;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct msghdr msg;
+	struct iovec io_vector[8];
+	static char rx_buf[400];
+	size_t offset = 0;
+	ssize_t recved;
+	void *handle;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = io_vector;
+	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+
+	recved = zsock_recv_zc(server_sock, &msg, 0, &handle);
+	zassert_equal(recved, STRLEN(TEST_STR2), "unexpected received bytes");
+	zassert_true(msg.msg_iovlen > 1, "payload expected in fragments");
+	zassert_equal(msg.msg_flags, 0, "unexpected flags");
+
+	clear_buf(rx_buf);
+	for (int i = 0; i < msg.msg_iovlen; i++) {
+		memcpy(rx_buf + offset, io_vector[i].iov_base,
+		       io_vector[i].iov_len);
+		offset += io_vector[i].iov_len;
+	}
+
+	zassert_equal(offset, STRLEN(TEST_STR2), "wrong iovec lengths");
+	zassert_mem_equal(rx_buf, BUF_AND_SIZE(TEST_STR2), "wrong data");
+
+	zsock_recv_zc_release(handle);
+
+	/* Not enough entries for all fragments */
+	rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR2), 0,
+		    (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(rv, STRLEN(TEST_STR2), "sendto failed");
+
+	msg.msg_iovlen = 1;
+	recved = zsock_recv_zc(server_sock, &msg, 0, &handle);
+	zassert_true(recved > 0 && recved < STRLEN(TEST_STR2),
+		     "unexpected received bytes");
+	zassert_equal(msg.msg_iovlen, 1, "unexpected iovec count");
+	zassert_true(msg.msg_flags & MSG_TRUNC, "no truncation reported");
+	zassert_mem_equal(io_vector[0].iov_base, TEST_STR2, recved,
+			  "wrong data");
+
+	zsock_recv_zc_release(handle);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+#else
+	ztest_test_skip();
+#endif
+}
+
 void test_main(void)
 {
 	k_thread_system_pool_assign(k_current_get());
@@ -922,6 +1173,10 @@ void test_main(void)
 			 ztest_unit_test(test_v6_sendmsg_recvfrom),
 			 ztest_unit_test(test_v4_sendmsg_recvfrom_connected),
 			 ztest_unit_test(test_v6_sendmsg_recvfrom_connected),
+			 ztest_unit_test(test_v4_recvmsg),
+			 ztest_unit_test(test_v6_sendmmsg_recvmmsg),
+			 ztest_user_unit_test(test_v6_sendmmsg_recvmmsg),
+			 ztest_unit_test(test_v4_recv_zc),
 			 ztest_unit_test(setup_eth),
 			 ztest_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_user_unit_test(test_v6_sendmsg_with_txtime)
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/printk.h>
+
+#include <net/dummy.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_context.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+#include "tcp2.h"
+
+#define SERVER_PORT 4242
+
+/* Amount of data moved by every throughput run */
+#define TRANSFER_SIZE (64 * 1024)
+
+/* Size of a single send request */
+#define CHUNK_SIZE 512
+
+/* Every LOSS_EVERY data segment is dropped by the lossy loopback */
+#define LOSS_EVERY 16
+
+#define TRANSFER_TIMEOUT K_SECONDS(60)
+
+/* Retransmission timeout bounds, msec */
+#define RTO_MIN 200
+#define RTO_MAX 60000
+
+static struct net_if *iface;
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_context *server_ctx;
+static struct net_context *accepted_ctx;
+
+static K_SEM_DEFINE(accepted, 0, 1);
+static K_SEM_DEFINE(received_all, 0, 1);
+
+static size_t received;
+static bool pattern_ok;
+
+static int loss_every;
+static int data_segments;
+static int dropped;
+
+static inline u8_t pattern(size_t off)
+{
+	/* Prime period, so that misplaced segments are detected */
+	return off % 251;
+}
+
+static int lossy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void lossy_iface_init(struct net_if *iface)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+/* Loop IPv4 TCP segments back, dropping every loss_every data segment.
+ * The peer address is not our own so the segments really go through the
+ * driver; swapping the addresses makes them look as if they came from the
+ * peer. The ports are left alone, which makes the client and the server
+ * each other's peer.
+ */
+static int lossy_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *ip = NET_IPV4_HDR(pkt);
+	struct net_tcp_hdr *th;
+	struct net_pkt *cloned;
+	struct in_addr addr;
+	size_t ip_len, len;
+
+	ARG_UNUSED(dev);
+
+	if (net_pkt_family(pkt) != AF_INET || ip->proto != IPPROTO_TCP) {
+		return 0;
+	}
+
+	ip_len = (ip->vhl & NET_IPV4_IHL_MASK) * 4;
+	th = (struct net_tcp_hdr *)((u8_t *)ip + ip_len);
+	len = ntohs(ip->len) - ip_len - (th->offset >> 4) * 4;
+
+	if (len && loss_every && ++data_segments % loss_every == 0) {
+		dropped++;
+		return 0;
+	}
+
+	net_ipaddr_copy(&addr, &ip->src);
+	net_ipaddr_copy(&ip->src, &ip->dst);
+	net_ipaddr_copy(&ip->dst, &addr);
+
+	cloned = net_pkt_clone(pkt, K_MSEC(100));
+	if (!cloned) {
+		return -ENOMEM;
+	}
+
+	if (net_recv_data(net_pkt_iface(cloned), cloned) < 0) {
+		net_pkt_unref(cloned);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static struct dummy_api lossy_if_api = {
+	.iface_api.init = lossy_iface_init,
+	.send = lossy_send,
+};
+
+NET_DEVICE_INIT(tcp2_lossy, "tcp2_lossy", lossy_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &lossy_if_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+static void recv_cb(struct net_context *context, struct net_pkt *pkt,
+		    union net_ip_header *ip_hdr,
+		    union net_proto_header *proto_hdr,
+		    int status, void *user_data)
+{
+	u8_t buf[64];
+	size_t len, i;
+
+	if (!pkt) {
+		return;
+	}
+
+	while ((len = MIN(net_pkt_remaining_data(pkt), sizeof(buf)))) {
+		if (net_pkt_read(pkt, buf, len) < 0) {
+			break;
+		}
+
+		for (i = 0; i < len; i++) {
+			if (buf[i] != pattern(received + i)) {
+				pattern_ok = false;
+			}
+		}
+
+		received += len;
+	}
+
+	net_pkt_unref(pkt);
+
+	if (received >= TRANSFER_SIZE) {
+		k_sem_give(&received_all);
+	}
+}
+
+static void accept_cb(struct net_context *context, struct sockaddr *addr,
+		      socklen_t addrlen, int status, void *user_data)
+{
+	accepted_ctx = context;
+
+	net_context_recv(context, recv_cb, K_NO_WAIT, NULL);
+
+	k_sem_give(&accepted);
+}
+
+static void test_init(void)
+{
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	struct net_if_addr *ifaddr;
+	struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+	int ret;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "No dummy interface");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &server_ctx);
+	zassert_equal(ret, 0, "Cannot get server context (%d)", ret);
+
+	ret = net_context_bind(server_ctx, (struct sockaddr *)&local,
+			       sizeof(local));
+	zassert_equal(ret, 0, "Cannot bind (%d)", ret);
+
+	ret = net_context_listen(server_ctx, 1);
+	zassert_equal(ret, 0, "Cannot listen (%d)", ret);
+
+	ret = net_context_accept(server_ctx, accept_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot accept (%d)", ret);
+}
+
+static struct net_context *transfer(int loss)
+{
+	struct sockaddr_in peer = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+		.sin_addr = peer_addr,
+	};
+	struct net_context *client_ctx;
+	u8_t buf[CHUNK_SIZE];
+	size_t sent = 0;
+	s64_t start;
+	u32_t elapsed;
+	int ret, i;
+
+	loss_every = loss;
+	data_segments = 0;
+	dropped = 0;
+	received = 0;
+	pattern_ok = true;
+	k_sem_reset(&received_all);
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &client_ctx);
+	zassert_equal(ret, 0, "Cannot get client context (%d)", ret);
+
+	ret = net_context_connect(client_ctx, (struct sockaddr *)&peer,
+				  sizeof(peer), NULL, K_SECONDS(1), NULL);
+	zassert_equal(ret, 0, "Cannot connect (%d)", ret);
+
+	zassert_equal(k_sem_take(&accepted, K_SECONDS(1)), 0,
+		      "Connection not accepted");
+
+	for (i = 0; i < 100; i++) {
+		if (net_context_get_state(client_ctx) ==
+		    NET_CONTEXT_CONNECTED) {
+			break;
+		}
+
+		k_sleep(K_MSEC(10));
+	}
+
+	zassert_equal(net_context_get_state(client_ctx),
+		      NET_CONTEXT_CONNECTED, "Not connected");
+
+	start = k_uptime_get();
+
+	while (sent < TRANSFER_SIZE) {
+		size_t len = MIN(sizeof(buf), TRANSFER_SIZE - sent);
+
+		for (i = 0; i < len; i++) {
+			buf[i] = pattern(sent + i);
+		}
+
+		ret = net_context_send(client_ctx, buf, len, NULL, K_NO_WAIT,
+				       NULL);
+		if (ret == -ENOBUFS) {
+			/* Send window full, let the stack drain it */
+			k_sleep(K_MSEC(1));
+			continue;
+		}
+
+		zassert_true(ret > 0, "Send failed (%d)", ret);
+
+		sent += ret;
+	}
+
+	zassert_equal(k_sem_take(&received_all, TRANSFER_TIMEOUT), 0,
+		      "Received only %zu of %d bytes", received,
+		      TRANSFER_SIZE);
+
+	elapsed = MAX(k_uptime_get() - start, 1);
+
+	zassert_true(pattern_ok, "Received data is corrupted");
+	zassert_equal(received, TRANSFER_SIZE, "Received too much data");
+
+	TC_PRINT("%d bytes in %u ms (%u KiB/s), %d of %d data segments "
+		 "dropped\n", TRANSFER_SIZE, elapsed,
+		 (u32_t)(TRANSFER_SIZE * 1000ULL / elapsed / 1024),
+		 dropped, data_segments);
+
+	return client_ctx;
+}
+
+static void test_throughput(void)
+{
+	struct net_context *ctx = transfer(0);
+	struct net_tcp_info info;
+
+	zassert_equal(net_tcp_get_info(ctx, &info), 0, "No connection");
+	zassert_equal(info.rexmit_count, 0, "Unexpected retransmissions");
+	zassert_equal(info.ssthresh, UINT32_MAX,
+		      "Congestion control reacted to no loss");
+
+	if (IS_ENABLED(CONFIG_NET_TCP2_SACK)) {
+		zassert_true(info.sack_ok, "SACK not negotiated");
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP2_WINDOW_SCALING)) {
+		zassert_true(info.wscale_ok, "Window scaling not negotiated");
+		zassert_equal(info.snd_wscale, info.rcv_wscale,
+			      "Window scale mismatch");
+	}
+
+	net_context_put(ctx);
+	net_context_put(accepted_ctx);
+}
+
+static void test_throughput_lossy(void)
+{
+	struct net_context *ctx = transfer(LOSS_EVERY);
+	struct net_tcp_info info;
+
+	zassert_equal(net_tcp_get_info(ctx, &info), 0, "No connection");
+	zassert_true(dropped > 0, "Nothing was dropped");
+	zassert_true(info.ssthresh != UINT32_MAX,
+		     "Congestion control did not react to loss");
+	zassert_true(info.rto >= RTO_MIN && info.rto <= RTO_MAX,
+		     "RTO out of bounds (%d)", info.rto);
+
+	net_context_put(ctx);
+	net_context_put(accepted_ctx);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tcp2_test,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_throughput),
+			 ztest_unit_test(test_throughput_lossy));
+
+	ztest_run_test_suite(net_tcp2_test);
+}
@@ -661,9 +661,110 @@ void test_udp(void)
 	zassert_false(test_failed, "udp tests failed");
 }
 
+#define DEMUX_CONNS 24
+#define DEMUX_LOCAL_PORT 5000
+#define DEMUX_REMOTE_PORT 6000
+
+/* Many connected handlers sharing a local port with a listener: each
+ * packet must reach the handler of its exact end points, or the listener.
+ */
+void test_udp_demux(void)
+{
+	static struct ud ud[DEMUX_CONNS + 1];
+	static struct sockaddr_in peer[DEMUX_CONNS];
+	static struct sockaddr_in local;
+	struct in_addr in4addr_my = { { { 192, 0, 2, 1 } } };
+	struct in_addr in4addr_peer = { { { 192, 0, 2, 9 } } };
+	struct net_if *iface = net_if_get_default();
+	struct ud *listener = &ud[DEMUX_CONNS];
+	int ret, i;
+	bool st;
+
+	k_thread_priority_set(k_current_get(), K_PRIO_COOP(7));
+
+	local.sin_family = AF_INET;
+	local.sin_port = htons(DEMUX_LOCAL_PORT);
+	net_ipaddr_copy(&local.sin_addr, &in4addr_my);
+
+	listener->local_addr = (struct sockaddr *)&local;
+	listener->local_port = DEMUX_LOCAL_PORT;
+	listener->test = "demux listener";
+
+	ret = net_udp_register(AF_INET, NULL, (struct sockaddr *)&local,
+			       0, DEMUX_LOCAL_PORT, test_ok, listener,
+			       (struct net_conn_handle **)&listener->handle);
+	zassert_equal(ret, 0, "listener register failed");
+
+	for (i = 0; i < DEMUX_CONNS; i++) {
+		peer[i].sin_family = AF_INET;
+		peer[i].sin_port = htons(DEMUX_REMOTE_PORT + i);
+		net_ipaddr_copy(&peer[i].sin_addr, &in4addr_peer);
+
+		ud[i].remote_addr = (struct sockaddr *)&peer[i];
+		ud[i].local_addr = (struct sockaddr *)&local;
+		ud[i].remote_port = DEMUX_REMOTE_PORT + i;
+		ud[i].local_port = DEMUX_LOCAL_PORT;
+		ud[i].test = "demux connected";
+
+		ret = net_udp_register(AF_INET, (struct sockaddr *)&peer[i],
+				       (struct sockaddr *)&local,
+				       DEMUX_REMOTE_PORT + i, DEMUX_LOCAL_PORT,
+				       test_ok, &ud[i],
+				       (struct net_conn_handle **)&ud[i].handle);
+		zassert_equal(ret, 0, "connected register %d failed", i);
+	}
+
+	/* Identical handler is refused */
+	ret = net_udp_register(AF_INET, (struct sockaddr *)&peer[0],
+			       (struct sockaddr *)&local,
+			       DEMUX_REMOTE_PORT, DEMUX_LOCAL_PORT,
+			       test_ok, &ud[0], NULL);
+	zassert_equal(ret, -EALREADY, "duplicate register not detected");
+
+	for (i = 0; i < DEMUX_CONNS; i++) {
+		st = send_ipv4_udp_msg(iface, &in4addr_peer, &in4addr_my,
+				       DEMUX_REMOTE_PORT + i, DEMUX_LOCAL_PORT,
+				       &ud[i], false);
+		zassert_true(st, "connected %d not matched", i);
+	}
+
+	st = send_ipv4_udp_msg(iface, &in4addr_peer, &in4addr_my,
+			       DEMUX_REMOTE_PORT + DEMUX_CONNS,
+			       DEMUX_LOCAL_PORT, listener, false);
+	zassert_true(st, "listener not matched");
+
+	/* Traffic of removed handlers falls back to the listener */
+	for (i = 0; i < DEMUX_CONNS; i += 2) {
+		ret = net_udp_unregister(ud[i].handle);
+		zassert_equal(ret, 0, "unregister %d failed", i);
+	}
+
+	for (i = 0; i < DEMUX_CONNS; i++) {
+		st = send_ipv4_udp_msg(iface, &in4addr_peer, &in4addr_my,
+				       DEMUX_REMOTE_PORT + i, DEMUX_LOCAL_PORT,
+				       (i % 2) ? &ud[i] : listener, false);
+		zassert_true(st, "handler for %d not matched", i);
+	}
+
+	for (i = 1; i < DEMUX_CONNS; i += 2) {
+		ret = net_udp_unregister(ud[i].handle);
+		zassert_equal(ret, 0, "unregister %d failed", i);
+	}
+
+	ret = net_udp_unregister(listener->handle);
+	zassert_equal(ret, 0, "listener unregister failed");
+
+	st = send_ipv4_udp_msg(iface, &in4addr_peer, &in4addr_my,
+			       DEMUX_REMOTE_PORT, DEMUX_LOCAL_PORT, NULL, true);
+	zassert_true(st, "packet matched after unregister");
+
+	zassert_false(test_failed, "udp tests failed");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_udp_fn,
-		ztest_unit_test(test_udp));
+		ztest_unit_test(test_udp),
+		ztest_unit_test(test_udp_demux));
 	ztest_run_test_suite(test_udp_fn);
 }
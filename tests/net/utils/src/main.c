@@ -832,12 +832,88 @@ void test_addr_parse(void)
 #endif
 }
 
+/* Sum data 16 bits at a time, as big endian words */
+static u16_t chksum_simple(const u8_t *data, size_t len)
+{
+	u32_t sum = 0U;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		sum += (i & 1) ? data[i] : data[i] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+void test_chksum(void)
+{
+	static u8_t data[300] __aligned(4);
+	size_t off, len, i;
+	u16_t sum;
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = i * 7 + 0xa5;
+	}
+
+	/* Every alignment and both odd and even lengths */
+	for (off = 0; off < 8; off++) {
+		for (len = 0; len < sizeof(data) - off; len += 13) {
+			zassert_equal(net_chksum_partial(0, data + off, len),
+				      chksum_simple(data + off, len),
+				      "Wrong sum at offset %zu length %zu",
+				      off, len);
+		}
+	}
+
+	/* A running sum is carried into the result */
+	sum = net_chksum_partial(0xffff, data, 2);
+	zassert_equal(sum, chksum_simple(data, 2),
+		      "End-around carry not applied");
+
+	memset(data, 0xff, 64);
+	zassert_equal(net_chksum_partial(0, data + 1, 63), 0xffff,
+		      "Wrong sum of all ones");
+}
+
+void test_chksum_update(void)
+{
+	u8_t hdr[20] = { 0x45, 0x00, 0x00, 0x54, 0x12, 0x34, 0x40, 0x00,
+			 0x40, 0x06, 0x00, 0x00, 192, 0, 2, 1,
+			 192, 0, 2, 2 };
+	u8_t addr[4] = { 198, 51, 100, 7 };
+	u16_t chksum, expected;
+
+	chksum = htons(~chksum_simple(hdr, sizeof(hdr)));
+
+	/* Rewrite the source address, like NAT does */
+	chksum = net_chksum_update(chksum, &hdr[12], addr, sizeof(addr));
+	memcpy(&hdr[12], addr, sizeof(addr));
+
+	expected = htons(~chksum_simple(hdr, sizeof(hdr)));
+	zassert_equal(chksum, expected, "Wrong updated checksum 0x%04x",
+		      ntohs(chksum));
+
+	/* Decrement the TTL, which shares a word with the protocol */
+	chksum = net_chksum_update16(chksum, htons(0x4006), htons(0x3f06));
+	hdr[8]--;
+
+	expected = htons(~chksum_simple(hdr, sizeof(hdr)));
+	zassert_equal(chksum, expected, "Wrong updated checksum 0x%04x",
+		      ntohs(chksum));
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_unit_test(test_net_addr),
 			 ztest_user_unit_test(test_net_addr),
-			 ztest_unit_test(test_addr_parse));
+			 ztest_unit_test(test_addr_parse),
+			 ztest_unit_test(test_chksum),
+			 ztest_unit_test(test_chksum_update));
 
 	ztest_run_test_suite(test_utils_fn);
 }
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Test packed log messages
+ */
+
+#include <logging/log_msg.h>
+#include <logging/log.h>
+
+#include <tc_util.h>
+#include <stdbool.h>
+#include <zephyr.h>
+#include <ztest.h>
+
+#define MAX_MSGS (CONFIG_LOG_BUFFER_SIZE / sizeof(void *))
+
+static const char my_string[] = "test_string";
+static struct log_msg *msgs[MAX_MSGS];
+
+/* Fill the buffer with one argument messages, return how many fit. */
+static int fill(void)
+{
+	int n;
+
+	for (n = 0; n < MAX_MSGS; n++) {
+		msgs[n] = log_msg_create_1(my_string, n);
+		if (msgs[n] == NULL) {
+			break;
+		}
+	}
+
+	return n;
+}
+
+static void release(int n)
+{
+	for (int i = 0; i < n; i++) {
+		log_msg_put(msgs[i]);
+	}
+}
+
+void test_log_packed_std_msg(void)
+{
+	log_arg_t args[] = {1, 2, 3, 4, 5, 6, 7, 8};
+	struct log_msg *msg;
+
+	for (int i = 0; i <= ARRAY_SIZE(args); i++) {
+		msg = log_msg_create_n(my_string, args, i);
+		zassert_not_null(msg, "Expected allocated message.");
+		zassert_equal(log_msg_nargs_get(msg), i, NULL);
+		zassert_equal(log_msg_str_get(msg), my_string, NULL);
+
+		for (int j = 0; j < i; j++) {
+			zassert_equal(log_msg_arg_get(msg, j), args[j],
+				      "Unexpected argument %d", j);
+		}
+		zassert_equal(log_msg_arg_get(msg, i), 0, NULL);
+
+		log_msg_put(msg);
+	}
+}
+
+/* A chunk holds a message with up to 3 (4 on 64 bit) arguments, so
+ * packed messages with one argument must fit more densely.
+ */
+void test_log_packed_capacity(void)
+{
+	int n = fill();
+
+	zassert_true(n > (CONFIG_LOG_BUFFER_SIZE / sizeof(union log_msg_chunk)),
+		     "Only %d messages fit", n);
+	for (int i = 0; i < n; i++) {
+		zassert_equal(log_msg_arg_get(msgs[i], 0), i, NULL);
+	}
+	release(n);
+
+	/* All space is reclaimed. */
+	zassert_equal(fill(), n, NULL);
+	release(n);
+}
+
+/* Space of a message freed early is reclaimed once older ones are freed */
+void test_log_packed_free_out_of_order(void)
+{
+	int n = fill();
+	int half;
+
+	zassert_true(n > 3, NULL);
+
+	for (int i = 1; i < n; i++) {
+		log_msg_put(msgs[i]);
+	}
+	zassert_is_null(log_msg_create_1(my_string, 0),
+			"Oldest message still holds the buffer.");
+
+	log_msg_put(msgs[0]);
+	zassert_equal(fill(), n, NULL);
+	release(n);
+
+	/* Wrap around: free the older half and allocate it again. */
+	n = fill();
+	half = n / 2;
+	release(half);
+	for (int i = 0; i < n - half; i++) {
+		msgs[i] = msgs[i + half];
+	}
+	for (int i = n - half; i < n; i++) {
+		msgs[i] = log_msg_create_1(my_string, i);
+		zassert_not_null(msgs[i], "Expected allocated message.");
+	}
+	release(n);
+}
+
+void test_log_packed_strdup(void)
+{
+	struct log_msg *msg[2 * CONFIG_LOG_STRDUP_BUF_COUNT];
+	const char *str;
+
+	/* Strings are inlined, so their log_strdup() buffers are released
+	 * on message creation and more messages than buffers can hold one.
+	 */
+	for (int i = 0; i < ARRAY_SIZE(msg); i++) {
+		char *dup = log_strdup(my_string);
+
+		zassert_true(log_is_strdup(dup), "Expected duplicated string.");
+		msg[i] = log_msg_create_2("%d %s", i, (log_arg_t)dup);
+		zassert_not_null(msg[i], "Expected allocated message.");
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(msg); i++) {
+		str = (const char *)log_msg_arg_get(msg[i], 1);
+		zassert_equal(log_msg_arg_get(msg[i], 0), i, NULL);
+		zassert_false(log_is_strdup(str), NULL);
+		zassert_true(log_msg_pool_contains(str), NULL);
+		zassert_equal(strcmp(str, my_string), 0, NULL);
+		log_msg_put(msg[i]);
+	}
+}
+
+void test_log_packed_hexdump(void)
+{
+	struct log_msg *msg;
+	u8_t data[100];
+	u8_t read_data[100];
+	size_t length;
+
+	for (int i = 0; i < sizeof(data); i++) {
+		data[i] = i;
+	}
+
+	msg = log_msg_hexdump_create("test", data, sizeof(data));
+	zassert_not_null(msg, "Expected allocated message.");
+	zassert_false(log_msg_is_std(msg), NULL);
+
+	length = sizeof(read_data);
+	log_msg_hexdump_data_get(msg, read_data, &length, 0);
+	zassert_equal(length, sizeof(data), NULL);
+	zassert_equal(memcmp(data, read_data, length), 0, "Expected data.");
+
+	/* Read past the end is truncated. */
+	length = 20;
+	log_msg_hexdump_data_get(msg, read_data, &length, 90);
+	zassert_equal(length, 10, NULL);
+	zassert_equal(memcmp(&data[90], read_data, length), 0, NULL);
+
+	length = 1;
+	log_msg_hexdump_data_get(msg, read_data, &length, sizeof(data));
+	zassert_equal(length, 0, NULL);
+
+	log_msg_put(msg);
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_log_message_packed,
+		ztest_unit_test(test_log_packed_std_msg),
+		ztest_unit_test(test_log_packed_capacity),
+		ztest_unit_test(test_log_packed_free_out_of_order),
+		ztest_unit_test(test_log_packed_strdup),
+		ztest_unit_test(test_log_packed_hexdump));
+	ztest_run_test_suite(test_log_message_packed);
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Round trip test of the dictionary log output.
+
+Builds this test (native_posix by default) and runs it, or takes the
+console output captured from a target running an existing build. The
+test prints every message twice as hex lines: "DICT:" holds the
+dictionary records, "TEXT:" the text output of the same message. The
+dictionary records are decoded with scripts/logging/dictionary/
+log_parser.py and the database database_gen.py generated for the build,
+and the result must match the text output line by line.
+
+sanitycheck runs it on qemu_x86 through the log_dictionary console
+harness (logging.log_output_dict.roundtrip), where string literals are
+in read only memory and %s arguments are looked up in the database.
+"""
+
+import argparse
+import difflib
+import io
+import os
+import subprocess
+import sys
+import tempfile
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+ZEPHYR_BASE = os.environ.get('ZEPHYR_BASE',
+                             os.path.join(TEST_DIR, '..', '..', '..', '..'))
+
+sys.path.insert(0, os.path.join(ZEPHYR_BASE, 'scripts', 'logging',
+                                'dictionary'))
+import log_parser  # noqa: E402
+
+
+def build(build_dir, board):
+    subprocess.run(['cmake', '-GNinja', '-DBOARD=' + board,
+                    '-B', build_dir, '-S', TEST_DIR], check=True)
+    subprocess.run(['ninja', '-C', build_dir], check=True)
+
+
+def run(build_dir):
+    exe = os.path.join(build_dir, 'zephyr', 'zephyr.exe')
+    proc = subprocess.run([exe], stdout=subprocess.PIPE, timeout=60)
+    return proc.stdout.decode('utf-8', 'replace')
+
+
+def records(console):
+    """Pairs of (dictionary data, text data) printed by the test."""
+    pairs = []
+    dict_data = None
+
+    for line in console.splitlines():
+        line = line.strip()
+        if line.startswith('DICT:'):
+            dict_data = bytes.fromhex(line[len('DICT:'):])
+        elif line.startswith('TEXT:'):
+            if dict_data is None:
+                sys.exit("TEXT line without DICT line")
+            pairs.append((dict_data, bytes.fromhex(line[len('TEXT:'):])))
+            dict_data = None
+
+    return pairs
+
+
+def compare(db, pairs):
+    failed = 0
+
+    for dict_data, text_data in pairs:
+        out = io.StringIO()
+        end = log_parser.decode(dict_data, db, 0, out)
+        decoded = out.getvalue().splitlines()
+        expected = text_data.decode('utf-8').replace('\r', '').splitlines()
+
+        if end != len(dict_data):
+            print("%d trailing bytes not decoded" % (len(dict_data) - end))
+            failed += 1
+        elif decoded != expected:
+            print('\n'.join(difflib.unified_diff(expected, decoded,
+                                                 'text', 'dictionary',
+                                                 lineterm='')))
+            failed += 1
+
+    return failed
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+
+    parser.add_argument("--board", default="native_posix",
+                        help="Board to build for, must be runnable on "
+                        "the host unless --console is given")
+    parser.add_argument("--build-dir",
+                        help="Existing build of this test, otherwise it "
+                        "is built in a temporary directory")
+    parser.add_argument("--console",
+                        help="Console output captured from the target "
+                        "running the build in --build-dir")
+
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        build_dir = args.build_dir
+        if build_dir is None:
+            if args.console:
+                sys.exit("--console needs --build-dir")
+            build_dir = tmp
+            build(build_dir, args.board)
+
+        if args.console:
+            with open(args.console) as f:
+                console = f.read()
+        else:
+            console = run(build_dir)
+
+        db = log_parser.Database(os.path.join(build_dir, 'zephyr',
+                                              'log_dictionary.json'))
+
+    if 'PROJECT EXECUTION SUCCESSFUL' not in console:
+        sys.exit("Test failed on the target")
+
+    pairs = records(console)
+    if not pairs:
+        sys.exit("No records found in the test output")
+
+    failed = compare(db, pairs)
+    print("%d of %d records decoded as expected" %
+          (len(pairs) - failed, len(pairs)))
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Test dictionary log output
+ *
+ * Every message is rendered once in dictionary format and once as text.
+ * Besides checking the records on the target, both renderings are
+ * printed as hex lines ("DICT:" and "TEXT:") so that roundtrip.py can
+ * decode the dictionary records with the database generated for this
+ * build and compare the result with the text output. On targets where
+ * string literals are in read only memory, %s arguments pointing to
+ * them are sent by address and looked up in the database.
+ */
+
+#include <logging/log_output.h>
+#include <logging/log_output_dict.h>
+#include <logging/log_msg.h>
+
+#include <tc_util.h>
+#include <stdbool.h>
+#include <zephyr.h>
+#include <ztest.h>
+
+#define LOG_MODULE_NAME test
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#define TEXT_FLAGS (LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP | \
+		    LOG_OUTPUT_FLAG_CRLF_LFONLY)
+#define DICT_FLAGS (TEXT_FLAGS | LOG_OUTPUT_FLAG_FORMAT_DICT)
+
+#define TIMESTAMP 123
+
+static u8_t mock_buffer[512];
+/* Smaller than most records, to test records split across flushes */
+static u8_t log_output_buf[16];
+static u32_t mock_len;
+
+static const u8_t hexdump_data[] = "0123456789abcdefghij\x01\x02\xff";
+
+static void reset_mock_buffer(void)
+{
+	mock_len = 0U;
+	memset(mock_buffer, 0, sizeof(mock_buffer));
+}
+
+static int mock_output_func(u8_t *buf, size_t size, void *ctx)
+{
+	zassert_true(mock_len + size <= sizeof(mock_buffer),
+		     "Mock buffer overflow");
+
+	memcpy(&mock_buffer[mock_len], buf, size);
+	mock_len += size;
+
+	return size;
+}
+
+LOG_OUTPUT_DEFINE(log_output, mock_output_func,
+		  log_output_buf, sizeof(log_output_buf));
+
+static struct log_msg_ids test_ids(void)
+{
+	struct log_msg_ids src_level = {
+		.level = LOG_LEVEL_INF,
+		.domain_id = CONFIG_LOG_DOMAIN_ID,
+		.source_id = LOG_CURRENT_MODULE_ID(),
+	};
+
+	return src_level;
+}
+
+static void dump(const char *tag)
+{
+	printk("%s:", tag);
+	for (u32_t i = 0; i < mock_len; i++) {
+		printk("%02x", mock_buffer[i]);
+	}
+	printk("\n");
+}
+
+static void validate_hdr(u8_t type, struct log_msg_ids src_level,
+			 u32_t timestamp)
+{
+	struct log_dict_hdr hdr;
+
+	zassert_true(mock_len > sizeof(hdr), "Record too short");
+	memcpy(&hdr, mock_buffer, sizeof(hdr));
+
+	zassert_equal(hdr.magic, LOG_DICT_MAGIC, "Unexpected magic");
+	zassert_equal(hdr.ids, LOG_DICT_IDS(type, src_level.level,
+					    src_level.domain_id),
+		      "Unexpected ids");
+	zassert_equal(hdr.source_id, src_level.source_id,
+		      "Unexpected source id");
+	zassert_equal(hdr.timestamp, timestamp, "Unexpected timestamp");
+}
+
+static void log_output_string_varg(u32_t flags, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	log_output_string(&log_output, test_ids(), TIMESTAMP, fmt, ap, flags);
+	va_end(ap);
+}
+
+static void string_roundtrip(const char *fmt, log_arg_t arg1,
+			     log_arg_t arg2, log_arg_t arg3)
+{
+	reset_mock_buffer();
+	log_output_string_varg(DICT_FLAGS, fmt, arg1, arg2, arg3);
+	validate_hdr(LOG_DICT_TYPE_STD, test_ids(), TIMESTAMP);
+	dump("DICT");
+
+	reset_mock_buffer();
+	log_output_string_varg(TEXT_FLAGS, fmt, arg1, arg2, arg3);
+	dump("TEXT");
+}
+
+void test_log_output_dict_string(void)
+{
+	char ram_str[] = "ram";
+
+	string_roundtrip("std %d %u %x", (log_arg_t)-1, 5, 0xabcd);
+	string_roundtrip("str %s %s %d", (log_arg_t)"rodata",
+			 (log_arg_t)ram_str, 7);
+}
+
+static void msg_roundtrip(struct log_msg *msg)
+{
+	zassert_not_null(msg, "Failed to allocate message");
+
+	msg->hdr.ids = test_ids();
+	msg->hdr.timestamp = TIMESTAMP;
+
+	reset_mock_buffer();
+	log_output_msg_process(&log_output, msg, DICT_FLAGS);
+	validate_hdr(log_msg_is_std(msg) ?
+		     LOG_DICT_TYPE_STD : LOG_DICT_TYPE_HEXDUMP,
+		     test_ids(), TIMESTAMP);
+	dump("DICT");
+
+	reset_mock_buffer();
+	log_output_msg_process(&log_output, msg, TEXT_FLAGS);
+	dump("TEXT");
+
+	log_msg_put(msg);
+}
+
+void test_log_output_dict_msg(void)
+{
+	log_arg_t args[] = {1, 2, 3, 4, 5, 6};
+	char ram_str[] = "ram";
+
+	msg_roundtrip(log_msg_create_3("msg %d %d %d", 1, -2, 3));
+	msg_roundtrip(log_msg_create_n("msg %d %d %d %d %d %d", args,
+				       ARRAY_SIZE(args)));
+	msg_roundtrip(log_msg_create_3("msg %s %s %d", (log_arg_t)"rodata",
+				       (log_arg_t)ram_str, 3));
+	msg_roundtrip(log_msg_hexdump_create("msg hexdump", hexdump_data,
+					     sizeof(hexdump_data)));
+}
+
+void test_log_output_dict_hexdump(void)
+{
+	char metadata[] = "ram hexdump";
+
+	reset_mock_buffer();
+	log_output_hexdump(&log_output, test_ids(), TIMESTAMP, "hexdump",
+			   hexdump_data, sizeof(hexdump_data), DICT_FLAGS);
+	validate_hdr(LOG_DICT_TYPE_HEXDUMP, test_ids(), TIMESTAMP);
+	dump("DICT");
+
+	reset_mock_buffer();
+	log_output_hexdump(&log_output, test_ids(), TIMESTAMP, "hexdump",
+			   hexdump_data, sizeof(hexdump_data), TEXT_FLAGS);
+	dump("TEXT");
+
+	reset_mock_buffer();
+	log_output_hexdump(&log_output, test_ids(), TIMESTAMP, metadata,
+			   hexdump_data, 5, DICT_FLAGS);
+	validate_hdr(LOG_DICT_TYPE_HEXDUMP, test_ids(), TIMESTAMP);
+	dump("DICT");
+
+	reset_mock_buffer();
+	log_output_hexdump(&log_output, test_ids(), TIMESTAMP, metadata,
+			   hexdump_data, 5, TEXT_FLAGS);
+	dump("TEXT");
+}
+
+void test_log_output_dict_dropped(void)
+{
+	struct log_msg_ids src_level = { 0 };
+
+	reset_mock_buffer();
+	log_output_dropped_dict_process(&log_output, 10);
+	validate_hdr(LOG_DICT_TYPE_DROPPED, src_level, 0);
+	dump("DICT");
+
+	reset_mock_buffer();
+	log_output_dropped_process(&log_output, 10);
+	dump("TEXT");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_log_output_dict,
+		ztest_unit_test(test_log_output_dict_string),
+		ztest_unit_test(test_log_output_dict_msg),
+		ztest_unit_test(test_log_output_dict_hexdump),
+		ztest_unit_test(test_log_output_dict_dropped));
+	ztest_run_test_suite(test_log_output_dict);
+}
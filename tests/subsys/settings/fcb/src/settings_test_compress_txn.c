@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "settings_test.h"
+#include "settings/settings_fcb.h"
+
+#if defined(CONFIG_SETTINGS_TXN)
+
+#define TXN_NAME "\x7ftxn"
+
+static struct flash_sector fcb_txn_sectors[2] = {
+	[0] = {
+		.fs_off = 0x00000000,
+		.fs_size = 4 * 1024
+	},
+	[1] = {
+		.fs_off = 0x00001000,
+		.fs_size = 4 * 1024
+	}
+};
+
+static const char * const c5_names[] = { "a", "b", "c" };
+static u32_t c5_val[ARRAY_SIZE(c5_names)];
+static bool c5_loaded[ARRAY_SIZE(c5_names)];
+
+static int c5_handle_set(const char *name, size_t len,
+			 settings_read_cb read_cb, void *cb_arg)
+{
+	const char *next;
+	int rc;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(c5_names); i++) {
+		if (settings_name_steq(name, c5_names[i], &next) && !next) {
+			rc = read_cb(cb_arg, &c5_val[i], sizeof(c5_val[i]));
+			zassert_true(rc >= 0, "SETTINGS_VALUE_SET callback");
+			c5_loaded[i] = true;
+			return 0;
+		}
+	}
+
+	/* The filler */
+	return 0;
+}
+
+static struct settings_handler c5_test_handler = {
+	.name = "5",
+	.h_set = c5_handle_set,
+};
+
+struct txn_counts {
+	int txn;
+	int names[ARRAY_SIZE(c5_names)];
+};
+
+static int count_entries_cb(struct fcb_entry_ctx *entry_ctx, void *arg)
+{
+	struct txn_counts *counts = arg;
+	char buf[16];
+	char name[8];
+	int len;
+	int rc;
+	int i;
+
+	len = MIN(entry_ctx->loc.fe_data_len, sizeof(buf) - 1);
+
+	rc = flash_area_read(entry_ctx->fap,
+			     FCB_ENTRY_FA_DATA_OFF(entry_ctx->loc), buf, len);
+	zassert_true(rc == 0, "Can't read entry");
+	buf[len] = '\0';
+
+	if (!strncmp(buf, TXN_NAME "=", sizeof(TXN_NAME))) {
+		counts->txn++;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(c5_names); i++) {
+		snprintf(name, sizeof(name), "5/%s=", c5_names[i]);
+		if (!strncmp(buf, name, strlen(name))) {
+			counts->names[i]++;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * A transaction entry whose records were partly superseded since is
+ * compressed record by record: only the records still in effect are
+ * copied, as entries of their own.
+ */
+void test_config_compress_txn(void)
+{
+	struct txn_counts counts = { 0 };
+	struct settings_fcb cf;
+	u32_t one = 1U;
+	u32_t two = 2U;
+	u32_t fill = 0U;
+	int rc;
+	int i;
+
+	config_wipe_srcs();
+	config_wipe_fcb(fcb_txn_sectors, ARRAY_SIZE(fcb_txn_sectors));
+
+	cf.cf_fcb.f_magic = CONFIG_SETTINGS_FCB_MAGIC;
+	cf.cf_fcb.f_sectors = fcb_txn_sectors;
+	cf.cf_fcb.f_sector_cnt = ARRAY_SIZE(fcb_txn_sectors);
+
+	rc = settings_fcb_src(&cf);
+	zassert_true(rc == 0, "can't register FCB as configuration source");
+
+	rc = settings_fcb_dst(&cf);
+	zassert_true(rc == 0,
+		     "can't register FCB as configuration destination");
+
+	rc = settings_register(&c5_test_handler);
+	zassert_true(rc == 0, "settings_register fail");
+
+	rc = settings_txn_begin();
+	zassert_true(rc == 0, "can't begin transaction");
+
+	for (i = 0; i < ARRAY_SIZE(c5_names); i++) {
+		char name[8];
+
+		snprintf(name, sizeof(name), "5/%s", c5_names[i]);
+		rc = settings_txn_save_one(name, &one, sizeof(one));
+		zassert_true(rc == 0, "can't stage %s", name);
+	}
+
+	rc = settings_txn_commit();
+	zassert_true(rc == 0, "can't commit transaction");
+
+	/* Supersede two of the three records */
+	rc = settings_save_one("5/a", &two, sizeof(two));
+	zassert_true(rc == 0, "fcb write error");
+
+	rc = settings_delete("5/c");
+	zassert_true(rc == 0, "fcb delete error");
+
+	/* Compression happens when the second sector becomes active */
+	while (cf.cf_fcb.f_active.fe_sector != &fcb_txn_sectors[1]) {
+		fill++;
+		rc = settings_save_one("5/fill", &fill, sizeof(fill));
+		zassert_true(rc == 0, "fcb write error");
+	}
+
+	rc = fcb_walk(&cf.cf_fcb, NULL, count_entries_cb, &counts);
+	zassert_true(rc == 0, "fcb walk error");
+
+	zassert_equal(counts.txn, 0, "transaction entry was copied");
+	zassert_equal(counts.names[0], 1, "5/a: %d entries", counts.names[0]);
+	zassert_equal(counts.names[1], 1, "5/b: %d entries", counts.names[1]);
+	zassert_equal(counts.names[2], 0, "deleted 5/c was copied");
+
+	memset(c5_val, 0, sizeof(c5_val));
+	memset(c5_loaded, 0, sizeof(c5_loaded));
+
+	rc = settings_load();
+	zassert_true(rc == 0, "fcb read error");
+
+	zassert_true(c5_loaded[0] && c5_val[0] == two,
+		     "superseded record was loaded");
+	zassert_true(c5_loaded[1] && c5_val[1] == one,
+		     "record still in effect was lost");
+	zassert_false(c5_loaded[2], "deleted record was loaded");
+}
+#else
+void test_config_compress_txn(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_SETTINGS_TXN */
@@ -12,6 +12,7 @@
 #include <zephyr.h>
 #include <ztest.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <settings/settings.h>
 #include <logging/log.h>
 LOG_MODULE_REGISTER(settings_basic_test);
@@ -613,6 +614,169 @@ static void test_direct_loading_filter(void)
 	}
 }
 
+#define MANY_COUNT 32
+#define MANY_ADDED 16
+
+/* Value loaded for each many/<n> key, -1 if not loaded */
+static int many_loaded[MANY_COUNT + MANY_ADDED];
+
+static int many_loader(const char *key, size_t len, settings_read_cb read_cb,
+		       void *cb_arg, void *param)
+{
+	unsigned long n;
+	u8_t val;
+	int rc;
+
+	zassert_not_null(key, NULL);
+	n = strtoul(key, NULL, 10);
+	zassert_true(n < ARRAY_SIZE(many_loaded), "Unexpected key: %s", key);
+
+	rc = read_cb(cb_arg, &val, sizeof(val));
+	zassert_equal(sizeof(val), rc, NULL);
+
+	many_loaded[n] = val;
+	return 0;
+}
+
+static void many_save(int n, u8_t val)
+{
+	char name[16];
+	int rc;
+
+	snprintk(name, sizeof(name), "many/%d", n);
+	rc = settings_save_one(name, &val, sizeof(val));
+	zassert_equal(0, rc, "Cannot save %s", name);
+}
+
+/* Save, overwrite and delete a number of keys, so that stored names are
+ * looked up and the freed entries are reused.
+ */
+static void test_save_many(void)
+{
+	char name[16];
+	int rc, n;
+
+	for (n = 0; n < MANY_COUNT; n++) {
+		many_save(n, n);
+	}
+
+	rc = settings_load();
+	zassert_equal(0, rc, NULL);
+
+	for (n = 0; n < MANY_COUNT; n++) {
+		if (n % 2) {
+			many_save(n, n + 100);
+		} else {
+			snprintk(name, sizeof(name), "many/%d", n);
+			rc = settings_delete(name);
+			zassert_equal(0, rc, "Cannot delete %s", name);
+		}
+	}
+
+	for (n = MANY_COUNT; n < MANY_COUNT + MANY_ADDED; n++) {
+		many_save(n, n);
+	}
+
+	for (n = 0; n < ARRAY_SIZE(many_loaded); n++) {
+		many_loaded[n] = -1;
+	}
+
+	rc = settings_load_subtree_direct("many", many_loader, NULL);
+	zassert_equal(0, rc, NULL);
+
+	for (n = 0; n < ARRAY_SIZE(many_loaded); n++) {
+		if (n >= MANY_COUNT) {
+			zassert_equal(n, many_loaded[n], "Invalid many/%d", n);
+		} else if (n % 2) {
+			zassert_equal(n + 100, many_loaded[n],
+				      "Invalid many/%d", n);
+		} else {
+			zassert_equal(-1, many_loaded[n],
+				      "Deleted many/%d loaded", n);
+		}
+	}
+}
+
+#if defined(CONFIG_SETTINGS_TXN)
+static void many_load(void)
+{
+	int rc, n;
+
+	for (n = 0; n < ARRAY_SIZE(many_loaded); n++) {
+		many_loaded[n] = -1;
+	}
+
+	rc = settings_load_subtree_direct("many", many_loader, NULL);
+	zassert_equal(0, rc, NULL);
+}
+
+static void txn_save(int n, u8_t val)
+{
+	char name[16];
+	int rc;
+
+	snprintk(name, sizeof(name), "many/%d", n);
+	rc = settings_txn_save_one(name, &val, sizeof(val));
+	zassert_equal(0, rc, "Cannot stage %s", name);
+}
+
+/* Runs after test_save_many(), which leaves many/<n> with odd n < 32 at
+ * n + 100 and many/<n> with n >= 32 at n.
+ */
+static void test_txn(void)
+{
+	int rc;
+
+	rc = settings_txn_commit();
+	zassert_equal(-EINVAL, rc, "Commit without a transaction");
+
+	rc = settings_txn_begin();
+	zassert_equal(0, rc, NULL);
+
+	rc = settings_txn_begin();
+	zassert_equal(-EBUSY, rc, "Nested transaction");
+
+	txn_save(1, 1);
+	txn_save(3, 3);
+	txn_save(1, 11);
+	txn_save(40, 140);
+	rc = settings_txn_delete("many/5");
+	zassert_equal(0, rc, NULL);
+
+	/* Nothing is stored before the commit */
+	many_load();
+	zassert_equal(101, many_loaded[1], NULL);
+	zassert_equal(105, many_loaded[5], NULL);
+
+	rc = settings_txn_commit();
+	zassert_equal(0, rc, NULL);
+
+	many_load();
+	zassert_equal(11, many_loaded[1], "Staged value not replaced");
+	zassert_equal(3, many_loaded[3], NULL);
+	zassert_equal(-1, many_loaded[5], "Deleted value loaded");
+	zassert_equal(107, many_loaded[7], NULL);
+	zassert_equal(140, many_loaded[40], NULL);
+
+	/* Values saved later on replace the committed ones */
+	many_save(3, 33);
+
+	rc = settings_txn_begin();
+	zassert_equal(0, rc, NULL);
+	txn_save(7, 0);
+	settings_txn_abort();
+
+	many_load();
+	zassert_equal(33, many_loaded[3], NULL);
+	zassert_equal(107, many_loaded[7], "Aborted value stored");
+	zassert_equal(11, many_loaded[1], NULL);
+}
+#else
+static void test_txn(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_SETTINGS_TXN */
 
 void test_main(void)
 {
@@ -621,7 +785,9 @@ void test_main(void)
 			 ztest_unit_test(test_support_rtn),
 			 ztest_unit_test(test_register_and_loading),
 			 ztest_unit_test(test_direct_loading),
-			 ztest_unit_test(test_direct_loading_filter)
+			 ztest_unit_test(test_direct_loading_filter),
+			 ztest_unit_test(test_save_many),
+			 ztest_unit_test(test_txn)
 			);
 
 	ztest_run_test_suite(settings_test_suite);
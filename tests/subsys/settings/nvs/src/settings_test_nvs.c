@@ -296,6 +296,8 @@ void test_config_getset_unknown(void);
 void test_config_getset_int(void);
 void test_config_getset_int64(void);
 void test_config_commit(void);
+void test_config_nvs_txn_recover(void);
+void test_config_nvs_txn_pending(void);
 
 void test_main(void)
 {
@@ -306,7 +308,9 @@ void test_main(void)
 			 ztest_unit_test(test_config_getset_unknown),
 			 ztest_unit_test(test_config_getset_int),
 			 ztest_unit_test(test_config_getset_int64),
-			 ztest_unit_test(test_config_commit)
+			 ztest_unit_test(test_config_commit),
+			 ztest_unit_test(test_config_nvs_txn_recover),
+			 ztest_unit_test(test_config_nvs_txn_pending)
 			);
 
 	ztest_run_test_suite(test_config_nvs);
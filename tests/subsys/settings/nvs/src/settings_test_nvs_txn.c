@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <storage/flash_map.h>
+
+#include "settings/settings_nvs.h"
+#include "settings_priv.h"
+#include "settings_test.h"
+
+#if defined(CONFIG_SETTINGS_TXN)
+
+static struct settings_nvs cf;
+
+/* Set up the NVS back-end on an erased storage area */
+static void config_setup_nvs(void)
+{
+	const struct flash_area *fa;
+	struct flash_sector sector;
+	u32_t sector_cnt = 1;
+	int rc;
+
+	rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fa);
+	zassert_true(rc == 0, "Can't open storage flash area");
+
+	rc = flash_area_get_sectors(DT_FLASH_AREA_STORAGE_ID, &sector_cnt,
+				    &sector);
+	zassert_true(rc == 0 || rc == -ENOMEM, "Can't get flash sectors");
+
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	zassert_true(rc == 0, "Can't erase storage flash area");
+
+	cf.cf_nvs.sector_size = sector.fs_size;
+	cf.cf_nvs.sector_count = MIN(fa->fa_size / sector.fs_size,
+				     SETTINGS_TEST_NVS_FLASH_CNT);
+	cf.cf_nvs.offset = fa->fa_off;
+	cf.flash_dev_name = fa->fa_dev_name;
+
+	rc = settings_nvs_backend_init(&cf);
+	zassert_true(rc == 0, "Can't initialize NVS back-end");
+
+	config_wipe_srcs();
+
+	rc = settings_nvs_src(&cf);
+	zassert_true(rc == 0, "Can't register NVS as configuration source");
+
+	rc = settings_nvs_dst(&cf);
+	zassert_true(rc == 0,
+		     "Can't register NVS as configuration destination");
+}
+
+/* Append a record laid out as in the transaction buffer */
+static size_t txn_rec_add(char *buf, size_t off, const char *name,
+			  const void *value, u16_t val_len)
+{
+	strcpy(&buf[off], name);
+	off += strlen(name) + 1;
+	memcpy(&buf[off], &val_len, sizeof(val_len));
+	off += sizeof(val_len);
+	memcpy(&buf[off], value, val_len);
+
+	return off + val_len;
+}
+
+/*
+ * A journal entry left by a commit that was interrupted is completed when
+ * the back-end is initialized, and then deleted.
+ */
+void test_config_nvs_txn_recover(void)
+{
+	char buf[64];
+	u8_t new_val8 = 0x42;
+	u32_t new_val32 = 0x12345678;
+	size_t len = 0;
+	ssize_t rc;
+
+	config_setup_nvs();
+
+	rc = settings_register(&c_test_handlers[0]);
+	zassert_true(rc == 0 || rc == -EEXIST, "settings_register fail");
+	rc = settings_register(&c_test_handlers[2]);
+	zassert_true(rc == 0 || rc == -EEXIST, "settings_register fail");
+
+	val8 = 1U;
+	rc = settings_save_one("myfoo/mybar", &val8, sizeof(val8));
+	zassert_true(rc == 0, "Can't save myfoo/mybar");
+
+	val64 = 64U;
+	rc = settings_save_one("myfoo/mybar64", &val64, sizeof(val64));
+	zassert_true(rc == 0, "Can't save myfoo/mybar64");
+
+	len = txn_rec_add(buf, len, "myfoo/mybar", &new_val8,
+			  sizeof(new_val8));
+	len = txn_rec_add(buf, len, "3/v", &new_val32, sizeof(new_val32));
+	len = txn_rec_add(buf, len, "myfoo/mybar64", NULL, 0);
+
+	rc = nvs_write(&cf.cf_nvs, NVS_TXN_ID, buf, len);
+	zassert_equal(rc, len, "Can't write transaction journal");
+
+	rc = settings_nvs_backend_init(&cf);
+	zassert_true(rc == 0, "Can't initialize NVS back-end");
+
+	zassert_false(cf.txn_pending, "Transaction still pending");
+
+	rc = nvs_read(&cf.cf_nvs, NVS_TXN_ID, buf, sizeof(buf));
+	zassert_equal(rc, -ENOENT, "Transaction journal not deleted");
+
+	val8 = 0U;
+	val32 = 0U;
+	val64 = 0U;
+
+	rc = settings_load();
+	zassert_true(rc == 0, "Can't load settings");
+
+	zassert_equal(val8, new_val8, "Journaled value not applied");
+	zassert_equal(val32, new_val32, "Journaled value not applied");
+	zassert_equal(val64, 0U, "Journaled deletion not applied");
+}
+
+/*
+ * Nothing is saved while a transaction is waiting to be completed, as
+ * completing it would overwrite the newer values.
+ */
+void test_config_nvs_txn_pending(void)
+{
+	u8_t val = 7U;
+	int rc;
+
+	config_setup_nvs();
+
+	/* As left by a commit whose records could not all be saved */
+	cf.txn_pending = true;
+
+	rc = settings_save_one("myfoo/mybar", &val, sizeof(val));
+	zassert_equal(rc, -EIO, "Value saved over a pending transaction");
+
+	rc = settings_txn_begin();
+	zassert_true(rc == 0, "Can't begin transaction");
+
+	rc = settings_txn_save_one("myfoo/mybar", &val, sizeof(val));
+	zassert_true(rc == 0, "Can't stage value");
+
+	rc = settings_txn_commit();
+	zassert_equal(rc, -EIO,
+		      "Transaction committed over a pending transaction");
+
+	/* Completed by the next initialization, there is no journal left */
+	rc = settings_nvs_backend_init(&cf);
+	zassert_true(rc == 0, "Can't initialize NVS back-end");
+	zassert_false(cf.txn_pending, "Transaction still pending");
+
+	rc = settings_save_one("myfoo/mybar", &val, sizeof(val));
+	zassert_true(rc == 0, "Can't save after the transaction completed");
+}
+#else
+void test_config_nvs_txn_recover(void)
+{
+	ztest_test_skip();
+}
+
+void test_config_nvs_txn_pending(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_SETTINGS_TXN */